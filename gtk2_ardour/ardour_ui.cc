@@ -78,6 +78,7 @@
 #include "ardour/midi_track.h"
 #include "ardour/filesystem_paths.h"
 #include "ardour/filename_extensions.h"
+#include "ardour/source_work_pool.h"
 
 typedef uint64_t microseconds_t;
 
@@ -246,6 +247,10 @@ ARDOUR_UI::ARDOUR_UI (int *argcp, char **argvp[])
 	ARDOUR::Diskstream::DiskOverrun.connect (forever_connections, MISSING_INVALIDATOR, boost::bind (&ARDOUR_UI::disk_overrun_handler, this), gui_context());
 	ARDOUR::Diskstream::DiskUnderrun.connect (forever_connections, MISSING_INVALIDATOR, boost::bind (&ARDOUR_UI::disk_underrun_handler, this), gui_context());
 
+	/* show progress of background peak building and analysis */
+
+	ARDOUR::SourceWorkPool::Progress.connect (forever_connections, MISSING_INVALIDATOR, ui_bind (&ARDOUR_UI::update_source_work, this, _1, _2), gui_context());
+
 	/* handle dialog requests */
 
 	ARDOUR::Session::Dialog.connect (forever_connections, MISSING_INVALIDATOR, ui_bind (&ARDOUR_UI::session_dialog, this, _1), gui_context());
@@ -985,6 +990,22 @@ ARDOUR_UI::update_sample_rate (framecnt_t)
 	sample_rate_label.set_text (buf);
 }
 
+void
+ARDOUR_UI::update_source_work (uint32_t, uint32_t)
+{
+	/* signals from different threads may arrive out of order, so ask for the current state */
+
+	uint32_t done;
+	uint32_t total;
+	SourceWorkPool::progress (done, total);
+
+	if (done == total) {
+		source_work_label.set_text ("");
+	} else {
+		source_work_label.set_text (string_compose (_("Processing sources: %1/%2"), done, total));
+	}
+}
+
 void
 ARDOUR_UI::update_format ()
 {
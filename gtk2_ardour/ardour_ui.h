@@ -526,6 +526,10 @@ class ARDOUR_UI : public Gtkmm2ext::UI, public ARDOUR::SessionHandlePtr
 	Gtk::Label    format_label;
 	Gtk::EventBox format_box;
 	void update_format ();
+
+	Gtk::Label    source_work_label;
+	Gtk::EventBox source_work_box;
+	void update_source_work (uint32_t, uint32_t);
 	
 	gint every_second ();
 	gint every_point_one_seconds ();
@@ -546,6 +546,10 @@ ARDOUR_UI::build_menu_bar ()
 	format_box.set_name ("Format");
 	format_label.set_name ("Format");
 
+	source_work_box.add (source_work_label);
+	source_work_box.set_name ("Format");
+	source_work_label.set_name ("Format");
+
 #ifndef TOP_MENUBAR
  	menu_hbox.pack_start (*menu_bar, false, false);
 #else
@@ -564,6 +568,7 @@ ARDOUR_UI::build_menu_bar ()
 	menu_hbox.pack_end (buffer_load_box, false, false, 4);
 	menu_hbox.pack_end (sample_rate_box, false, false, 4);
 	menu_hbox.pack_end (format_box, false, false, 4);
+	menu_hbox.pack_end (source_work_box, false, false, 4);
 
 	menu_bar_base.set_name ("MainMenuBar");
 	menu_bar_base.add (menu_hbox);
@@ -31,6 +31,7 @@
 #include "ardour/session.h"
 
 #include "pbd/memento_command.h"
+#include "pbd/stateful_diff_command.h"
 #include "pbd/stacktrace.h"
 
 #include "evoral/Curve.hpp"
@@ -1007,12 +1008,8 @@ AudioRegionView::add_gain_point_event (ArdourCanvas::Item *item, GdkEvent *ev)
 
 	gain_line->view_to_model_coord (x, y);
 
-	/* XXX STATEFUL: can't convert to stateful diff until we
-	   can represent automation data with it.
-	*/
-
 	trackview.session()->begin_reversible_command (_("add gain control point"));
-	XMLNode &before = audio_region()->envelope()->get_state();
+	audio_region()->envelope()->clear_changes ();
 
 	if (!audio_region()->envelope_active()) {
 		XMLNode &region_before = audio_region()->get_state();
@@ -1023,8 +1020,7 @@ AudioRegionView::add_gain_point_event (ArdourCanvas::Item *item, GdkEvent *ev)
 
 	audio_region()->envelope()->add (fx, y);
 
-	XMLNode &after = audio_region()->envelope()->get_state();
-	trackview.session()->add_command (new MementoCommand<AutomationList>(*audio_region()->envelope().get(), &before, &after));
+	trackview.session()->add_command (new StatefulDiffCommand (audio_region()->envelope()));
 	trackview.session()->commit_reversible_command ();
 }
 
@@ -23,8 +23,8 @@
 #include <fstream>
 
 #include "pbd/stl_delete.h"
-#include "pbd/memento_command.h"
 #include "pbd/stacktrace.h"
+#include "pbd/stateful_diff_command.h"
 
 #include "ardour/automation_list.h"
 #include "ardour/dB.h"
@@ -228,9 +228,7 @@ AutomationLine::modify_point_y (ControlPoint& cp, double y)
 	double const x = trackview.editor().frame_to_unit (_time_converter.to((*cp.model())->when) - _offset);
 
 	trackview.editor().session()->begin_reversible_command (_("automation event move"));
-	trackview.editor().session()->add_command (
-		new MementoCommand<AutomationList> (memento_command_binder(), &get_state(), 0)
-		);
+	begin_list_change ();
 
 	cp.move_to (x, y, ControlPoint::Full);
 
@@ -246,10 +244,7 @@ AutomationLine::modify_point_y (ControlPoint& cp, double y)
 
 	update_pending = false;
 
-	trackview.editor().session()->add_command (
-		new MementoCommand<AutomationList> (memento_command_binder(), 0, &alist->get_state())
-		);
-
+	trackview.editor().session()->add_command (end_list_change ());
 	trackview.editor().session()->commit_reversible_command ();
 	trackview.editor().session()->set_dirty ();
 }
@@ -584,9 +579,7 @@ void
 AutomationLine::start_drag_single (ControlPoint* cp, double x, float fraction)
 {
 	trackview.editor().session()->begin_reversible_command (_("automation event move"));
-	trackview.editor().session()->add_command (
-		new MementoCommand<AutomationList> (memento_command_binder(), &get_state(), 0)
-		);
+	begin_list_change ();
 
 	_drag_points.clear ();
 	_drag_points.push_back (cp);
@@ -611,9 +604,7 @@ void
 AutomationLine::start_drag_line (uint32_t i1, uint32_t i2, float fraction)
 {
 	trackview.editor().session()->begin_reversible_command (_("automation range move"));
-	trackview.editor().session()->add_command (
-		new MementoCommand<AutomationList> (memento_command_binder (), &get_state(), 0)
-		);
+	begin_list_change ();
 
 	_drag_points.clear ();
 	for (uint32_t i = i1; i <= i2; i++) {
@@ -623,17 +614,15 @@ AutomationLine::start_drag_line (uint32_t i1, uint32_t i2, float fraction)
 	start_drag_common (0, fraction);
 }
 
-/** Start dragging multiple points (with no change in x)
+/** Start dragging multiple points (with no change in x).  The caller must already
+ *  have called begin_list_change(), since it may have changed the list itself.
  *  @param cp Points to drag.
  *  @param fraction Initial y position (as a fraction of the track height, where 0 is the bottom and 1 the top)
  */
 void
-AutomationLine::start_drag_multiple (list<ControlPoint*> cp, float fraction, XMLNode* state)
+AutomationLine::start_drag_multiple (list<ControlPoint*> cp, float fraction)
 {
 	trackview.editor().session()->begin_reversible_command (_("automation range move"));
-	trackview.editor().session()->add_command (
-		new MementoCommand<AutomationList> (memento_command_binder(), state, 0)
-		);
 
 	_drag_points = cp;
 	start_drag_common (0, fraction);
@@ -800,9 +789,7 @@ AutomationLine::end_drag ()
 
 	update_pending = false;
 
-	trackview.editor().session()->add_command (
-		new MementoCommand<AutomationList>(memento_command_binder (), 0, &alist->get_state())
-		);
+	trackview.editor().session()->add_command (end_list_change ());
 
 	trackview.editor().session()->set_dirty ();
 }
@@ -943,13 +930,11 @@ AutomationLine::remove_point (ControlPoint& cp)
 	model_representation (cp, mr);
 
 	trackview.editor().session()->begin_reversible_command (_("remove control point"));
-	XMLNode &before = alist->get_state();
+	begin_list_change ();
 
 	alist->erase (mr.start, mr.end);
 
-	trackview.editor().session()->add_command(
-		new MementoCommand<AutomationList> (memento_command_binder (), &before, &alist->get_state())
-		);
+	trackview.editor().session()->add_command (end_list_change ());
 
 	trackview.editor().session()->commit_reversible_command ();
 	trackview.editor().session()->set_dirty ();
@@ -1100,12 +1085,10 @@ void
 AutomationLine::clear ()
 {
 	/* parent must create and commit command */
-	XMLNode &before = alist->get_state();
+	begin_list_change ();
 	alist->clear();
 
-	trackview.editor().session()->add_command (
-		new MementoCommand<AutomationList> (memento_command_binder (), &before, &alist->get_state())
-		);
+	trackview.editor().session()->add_command (end_list_change ());
 }
 
 void
@@ -1321,10 +1304,16 @@ AutomationLine::connect_to_list ()
 		);
 }
 
-MementoCommandBinder<AutomationList>*
-AutomationLine::memento_command_binder ()
+void
+AutomationLine::begin_list_change ()
+{
+	alist->clear_changes ();
+}
+
+Command*
+AutomationLine::end_list_change ()
 {
-	return new SimpleMementoCommandBinder<AutomationList> (*alist.get());
+	return new StatefulDiffCommand (alist);
 }
 
 /** Set the maximum time that points on this line can be at, relative
@@ -77,7 +77,7 @@ class AutomationLine : public sigc::trackable, public PBD::StatefulDestructible
 	/* dragging API */
 	virtual void start_drag_single (ControlPoint*, double, float);
 	virtual void start_drag_line (uint32_t, uint32_t, float);
-	virtual void start_drag_multiple (std::list<ControlPoint*>, float, XMLNode *);
+	virtual void start_drag_multiple (std::list<ControlPoint*>, float);
 	virtual std::pair<double, float> drag_motion (double, float, bool, bool);
 	virtual void end_drag ();
 
@@ -132,7 +132,14 @@ class AutomationLine : public sigc::trackable, public PBD::StatefulDestructible
 	void add_always_in_view (double);
 	void clear_always_in_view ();
 
-	virtual MementoCommandBinder<ARDOUR::AutomationList>* memento_command_binder ();
+	/** Note the list's state before a change, so that end_list_change()
+	 *  can describe the change.
+	 */
+	virtual void begin_list_change ();
+	/** @return a new command to undo or redo the list changes made since
+	 *  the last begin_list_change(); the caller adds it to the session.
+	 */
+	virtual PBD::Command* end_list_change ();
 
 	const Evoral::TimeConverter<double, ARDOUR::framepos_t>& time_converter () const {
 		return _time_converter;
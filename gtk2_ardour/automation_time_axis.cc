@@ -23,8 +23,8 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
 
-#include "pbd/memento_command.h"
 #include "pbd/stacktrace.h"
+#include "pbd/stateful_diff_command.h"
 
 #include "ardour/automation_control.h"
 #include "ardour/event_type_map.h"
@@ -578,12 +578,11 @@ AutomationTimeAxisView::add_automation_event (ArdourCanvas::Item* /*item*/, GdkE
 	boost::shared_ptr<AutomationList> list = _line->the_list ();
 
 	_session->begin_reversible_command (_("add automation event"));
-	XMLNode& before = list->get_state();
+	list->clear_changes ();
 
 	list->add (when, y);
 
-	XMLNode& after = list->get_state();
-	_session->commit_reversible_command (new MementoCommand<ARDOUR::AutomationList> (*list, &before, &after));
+	_session->commit_reversible_command (new StatefulDiffCommand (list));
 	_session->set_dirty ();
 }
 
@@ -608,7 +607,7 @@ AutomationTimeAxisView::cut_copy_clear_one (AutomationLine& line, Selection& sel
 	boost::shared_ptr<Evoral::ControlList> what_we_got;
 	boost::shared_ptr<AutomationList> alist (line.the_list());
 
-	XMLNode &before = alist->get_state();
+	alist->clear_changes ();
 
 	/* convert time selection to automation list model coordinates */
 	const Evoral::TimeConverter<double, ARDOUR::framepos_t>& tc = line.time_converter ();
@@ -618,7 +617,7 @@ AutomationTimeAxisView::cut_copy_clear_one (AutomationLine& line, Selection& sel
 	switch (op) {
 	case Delete:
 		if (alist->cut (start, end) != 0) {
-			_session->add_command(new MementoCommand<AutomationList>(*alist.get(), &before, &alist->get_state()));
+			_session->add_command (new StatefulDiffCommand (alist));
 		}
 		break;
 
@@ -626,7 +625,7 @@ AutomationTimeAxisView::cut_copy_clear_one (AutomationLine& line, Selection& sel
 
 		if ((what_we_got = alist->cut (start, end)) != 0) {
 			_editor.get_cut_buffer().add (what_we_got);
-			_session->add_command(new MementoCommand<AutomationList>(*alist.get(), &before, &alist->get_state()));
+			_session->add_command (new StatefulDiffCommand (alist));
 		}
 		break;
 	case Copy:
@@ -637,7 +636,7 @@ AutomationTimeAxisView::cut_copy_clear_one (AutomationLine& line, Selection& sel
 
 	case Clear:
 		if ((what_we_got = alist->cut (start, end)) != 0) {
-			_session->add_command(new MementoCommand<AutomationList>(*alist.get(), &before, &alist->get_state()));
+			_session->add_command (new StatefulDiffCommand (alist));
 		}
 		break;
 	}
@@ -673,7 +672,7 @@ AutomationTimeAxisView::reset_objects_one (AutomationLine& line, PointSelection&
 {
 	boost::shared_ptr<AutomationList> alist(line.the_list());
 
-	_session->add_command (new MementoCommand<AutomationList>(*alist.get(), &alist->get_state(), 0));
+	alist->clear_changes ();
 
 	for (PointSelection::iterator i = selection.begin(); i != selection.end(); ++i) {
 
@@ -683,6 +682,8 @@ AutomationTimeAxisView::reset_objects_one (AutomationLine& line, PointSelection&
 
 		alist->reset_range ((*i).start, (*i).end);
 	}
+
+	_session->add_command (new StatefulDiffCommand (alist));
 }
 
 void
@@ -705,8 +706,9 @@ AutomationTimeAxisView::cut_copy_clear_objects_one (AutomationLine& line, PointS
 {
 	boost::shared_ptr<Evoral::ControlList> what_we_got;
 	boost::shared_ptr<AutomationList> alist(line.the_list());
+	bool changed = false;
 
-	XMLNode &before = alist->get_state();
+	alist->clear_changes ();
 
 	for (PointSelection::iterator i = selection.begin(); i != selection.end(); ++i) {
 
@@ -717,13 +719,13 @@ AutomationTimeAxisView::cut_copy_clear_objects_one (AutomationLine& line, PointS
 		switch (op) {
 		case Delete:
 			if (alist->cut ((*i).start, (*i).end) != 0) {
-				_session->add_command (new MementoCommand<AutomationList>(*alist.get(), new XMLNode (before), &alist->get_state()));
+				changed = true;
 			}
 			break;
 		case Cut:
 			if ((what_we_got = alist->cut ((*i).start, (*i).end)) != 0) {
 				_editor.get_cut_buffer().add (what_we_got);
-				_session->add_command (new MementoCommand<AutomationList>(*alist.get(), new XMLNode (before), &alist->get_state()));
+				changed = true;
 			}
 			break;
 		case Copy:
@@ -734,13 +736,16 @@ AutomationTimeAxisView::cut_copy_clear_objects_one (AutomationLine& line, PointS
 
 		case Clear:
 			if ((what_we_got = alist->cut ((*i).start, (*i).end)) != 0) {
-				_session->add_command (new MementoCommand<AutomationList>(*alist.get(), new XMLNode (before), &alist->get_state()));
+				changed = true;
 			}
 			break;
 		}
 	}
 
-	delete &before;
+	if (changed) {
+		/* one command for all the ranges, since each diff is taken against the state before the first */
+		_session->add_command (new StatefulDiffCommand (alist));
+	}
 
 	if (what_we_got) {
 		for (AutomationList::iterator x = what_we_got->begin(); x != what_we_got->end(); ++x) {
@@ -806,9 +811,9 @@ AutomationTimeAxisView::paste_one (AutomationLine& line, framepos_t pos, float t
 
 	double const model_pos = line.time_converter().from (pos - line.time_converter().origin_b ());
 
-	XMLNode &before = alist->get_state();
+	alist->clear_changes ();
 	alist->paste (copy, model_pos, times);
-	_session->add_command (new MementoCommand<AutomationList>(*alist.get(), &before, &alist->get_state()));
+	_session->add_command (new StatefulDiffCommand (alist));
 
 	return true;
 }
@@ -42,6 +42,7 @@
 #include "pbd/error.h"
 #include "pbd/enumwriter.h"
 #include "pbd/memento_command.h"
+#include "pbd/stateful_diff_command.h"
 #include "pbd/unknown_type.h"
 
 #include <glibmm/miscutils.h>
@@ -73,6 +74,7 @@
 #include "ardour/tempo.h"
 #include "ardour/utils.h"
 #include "ardour/session_playlists.h"
+#include "ardour/source_work_pool.h"
 #include "ardour/audioengine.h"
 
 #include "control_protocol/control_protocol.h"
@@ -714,6 +716,10 @@ Editor::Editor ()
 
 	TimeAxisView::CatchDeletion.connect (*this, invalidator (*this), ui_bind (&Editor::timeaxisview_deleted, this, _1), gui_context());
 
+	_prioritise_sources_queued = false;
+	_source_work_total = 0;
+	SourceWorkPool::Progress.connect (*this, invalidator (*this), ui_bind (&Editor::source_work_progress, this, _1, _2), gui_context());
+
 	_ignore_region_action = false;
 	_last_region_menu_was_main = false;
 	_popup_region_menu_item = 0;
@@ -4350,10 +4356,85 @@ Editor::idle_visual_changer ()
 
 	_summary->set_overlays_dirty ();
 
+	prioritise_visible_sources ();
+
 	pending_visual_change.idle_handler_id = -1;
 	return 0; /* this is always a one-shot call */
 }
 
+/** Move peak building and analysis of the sources of regions which are
+ *  on screen to the front of the queue, so that their waveforms appear first.
+ */
+void
+Editor::prioritise_visible_sources ()
+{
+	if (!_session || SourceWorkPool::empty ()) {
+		return;
+	}
+
+	framepos_t const start = leftmost_frame;
+	framepos_t const end = leftmost_frame + current_page_frames ();
+	double const top = vertical_adjustment.get_value ();
+	double const bottom = top + vertical_adjustment.get_page_size () - canvas_timebars_vsize;
+
+	/* each call to prioritise() puts its jobs in front of any earlier ones,
+	   so work up from the bottom of the screen to end with the top track first
+	*/
+
+	for (TrackViewList::reverse_iterator i = track_views.rbegin(); i != track_views.rend(); ++i) {
+
+		RouteTimeAxisView* rtv = dynamic_cast<RouteTimeAxisView*> (*i);
+
+		if (!rtv || rtv->hidden() || rtv->y_position() > bottom || rtv->y_position() + rtv->effective_height() < top) {
+			continue;
+		}
+
+		boost::shared_ptr<Playlist> pl = rtv->playlist ();
+
+		if (!pl) {
+			continue;
+		}
+
+		Playlist::RegionList* regions = pl->regions_touched (start, end);
+
+		for (Playlist::RegionList::iterator r = regions->begin(); r != regions->end(); ++r) {
+			SourceList const & sources = (*r)->sources ();
+			for (SourceList::const_iterator s = sources.begin(); s != sources.end(); ++s) {
+				SourceWorkPool::prioritise (*s);
+			}
+		}
+
+		delete regions;
+	}
+}
+
+void
+Editor::source_work_progress (uint32_t done, uint32_t total)
+{
+	if (done == total) {
+		/* the pool is idle, and counts its next batch of jobs from zero */
+		_source_work_total = 0;
+		return;
+	}
+
+	/* new work has been queued, which may be for sources on screen */
+
+	if (total > _source_work_total && !_prioritise_sources_queued) {
+		_prioritise_sources_queued = true;
+		Glib::signal_idle().connect (sigc::mem_fun (*this, &Editor::idle_prioritise_visible_sources));
+	}
+
+	_source_work_total = total;
+}
+
+bool
+Editor::idle_prioritise_visible_sources ()
+{
+	_prioritise_sources_queued = false;
+	prioritise_visible_sources ();
+	return false;
+}
+
 struct EditorOrderTimeAxisSorter {
     bool operator() (const TimeAxisView* a, const TimeAxisView* b) const {
 	    return a->order () < b->order ();
@@ -4435,11 +4516,10 @@ Editor::set_loop_range (framepos_t start, framepos_t end, string cmd)
 
 	if ((tll = transport_loop_location()) == 0) {
 		Location* loc = new Location (*_session, start, end, _("Loop"),  Location::IsAutoLoop);
-		XMLNode &before = _session->locations()->get_state();
+		_session->locations()->clear_changes ();
 		_session->locations()->add (loc, true);
 		_session->set_auto_loop_location (loc);
-		XMLNode &after = _session->locations()->get_state();
-		_session->add_command (new MementoCommand<Locations>(*(_session->locations()), &before, &after));
+		_session->add_command (new StatefulDiffCommand (*_session->locations()));
 	} else {
 		XMLNode &before = tll->get_state();
 		tll->set_hidden (false, this);
@@ -4462,11 +4542,10 @@ Editor::set_punch_range (framepos_t start, framepos_t end, string cmd)
 
 	if ((tpl = transport_punch_location()) == 0) {
 		Location* loc = new Location (*_session, start, end, _("Loop"),  Location::IsAutoPunch);
-		XMLNode &before = _session->locations()->get_state();
+		_session->locations()->clear_changes ();
 		_session->locations()->add (loc, true);
 		_session->set_auto_loop_location (loc);
-		XMLNode &after = _session->locations()->get_state();
-		_session->add_command (new MementoCommand<Locations>(*(_session->locations()), &before, &after));
+		_session->add_command (new StatefulDiffCommand (*_session->locations()));
 	}
 	else {
 		XMLNode &before = tpl->get_state();
@@ -1022,6 +1022,14 @@ class Editor : public PublicEditor, public PBD::ScopedConnectionList, public ARD
 	void queue_visual_change_y (double);
 	void ensure_visual_change_idle_handler ();
 
+	/* background peak building and analysis */
+
+	void prioritise_visible_sources ();
+	void source_work_progress (uint32_t, uint32_t);
+	bool idle_prioritise_visible_sources ();
+	bool _prioritise_sources_queued;
+	uint32_t _source_work_total;
+
 	/* track views */
 	TrackViewList track_views;
 	std::pair<TimeAxisView*, ARDOUR::layer_t> trackview_by_y_position (double);
@@ -1197,6 +1205,7 @@ class Editor : public PublicEditor, public PBD::ScopedConnectionList, public ARD
 
 	int  import_sndfiles (std::vector<std::string> paths, Editing::ImportMode mode,  ARDOUR::SrcQuality, framepos_t& pos,
 			      int target_regions, int target_tracks, boost::shared_ptr<ARDOUR::Track>&, bool);
+	bool run_import (std::vector<std::string> paths, ARDOUR::SrcQuality, bool replace);
 	int  embed_sndfiles (std::vector<std::string> paths, bool multiple_files, bool& check_sample_rate, Editing::ImportMode mode,
 			     framepos_t& pos, int target_regions, int target_tracks, boost::shared_ptr<ARDOUR::Track>&);
 
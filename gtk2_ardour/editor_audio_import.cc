@@ -378,6 +378,8 @@ Editor::do_import (vector<string> paths, ImportDisposition chns, ImportMode mode
 
 		bool replace = false;
 
+		/* ask about all the files first, so that they can be imported together */
+
 		for (vector<string>::iterator a = paths.begin(); a != paths.end(); ++a) {
 
 			const int check = check_whether_and_how_to_import (*a, true);
@@ -398,47 +400,63 @@ Editor::do_import (vector<string> paths, ImportDisposition chns, ImportMode mode
 				/* NOTREACHED*/
 			}
 
-			/* have to reset this for every file we handle */
+			to_import.push_back (*a);
+		}
 
-			if (use_timestamp) {
-				pos = -1;
-			}
+		if (!to_import.empty()) {
 
 			ipw.show ();
 
-			switch (chns) {
-			case Editing::ImportDistinctFiles:
+			set_canvas_cursor (_cursors->wait);
+			gdk_flush ();
+
+			bool const imported = run_import (to_import, quality, replace);
+			ok = imported;
 
-				to_import.clear ();
-				to_import.push_back (*a);
+			for (size_t n = 0; imported && n < to_import.size(); ++n) {
 
-				if (mode == Editing::ImportToTrack) {
-					track = get_nth_selected_audio_track (nth++);
+				/* have to reset this for every file we handle */
+
+				if (use_timestamp) {
+					pos = -1;
 				}
 
-				ok = (import_sndfiles (to_import, mode, quality, pos, 1, -1, track, replace) == 0);
-				break;
+				vector<string> path (1, to_import[n]);
+				SourceList& sources (import_status.path_sources[n]);
 
-			case Editing::ImportDistinctChannels:
+				if (sources.empty()) {
+					continue;
+				}
 
-				to_import.clear ();
-				to_import.push_back (*a);
+				int result = 0;
 
-				ok = (import_sndfiles (to_import, mode, quality, pos, -1, -1, track, replace) == 0);
-				break;
+				switch (chns) {
+				case Editing::ImportDistinctFiles:
 
-			case Editing::ImportSerializeFiles:
+					if (mode == Editing::ImportToTrack) {
+						track = get_nth_selected_audio_track (nth++);
+					}
 
-				to_import.clear ();
-				to_import.push_back (*a);
+					result = add_sources (path, sources, pos, mode, 1, -1, track, false);
+					break;
 
-				ok = (import_sndfiles (to_import, mode, quality, pos, 1, 1, track, replace) == 0);
-				break;
+				case Editing::ImportDistinctChannels:
+					result = add_sources (path, sources, pos, mode, -1, -1, track, false);
+					break;
 
-			case Editing::ImportMergeFiles:
-				// Not entered, handled in earlier if() branch
-				break;
+				case Editing::ImportSerializeFiles:
+					result = add_sources (path, sources, pos, mode, 1, 1, track, false);
+					break;
+
+				case Editing::ImportMergeFiles:
+					// Not entered, handled in earlier if() branch
+					break;
+				}
+
+				ok = (result == 0);
 			}
+
+			set_canvas_cursor (current_canvas_cursor);
 		}
 	}
 
@@ -535,13 +553,6 @@ int
 Editor::import_sndfiles (vector<string> paths, ImportMode mode, SrcQuality quality, framepos_t& pos,
 			 int target_regions, int target_tracks, boost::shared_ptr<Track>& track, bool replace)
 {
-	import_status.paths = paths;
-	import_status.done = false;
-	import_status.cancel = false;
-	import_status.freeze = false;
-	import_status.quality = quality;
-	import_status.replace_existing_source = replace;
-
 	import_status.mode = mode;
 	import_status.pos = pos;
 	import_status.target_tracks = target_tracks;
@@ -552,23 +563,9 @@ Editor::import_sndfiles (vector<string> paths, ImportMode mode, SrcQuality quali
 	set_canvas_cursor (_cursors->wait);
 	gdk_flush ();
 
-	/* start import thread for this spec. this will ultimately call Session::import_audiofiles()
-	   which, if successful, will add the files as regions to the region list. its up to us
-	   (the GUI) to direct additional steps after that.
-	*/
-
-	pthread_create_and_store ("import", &import_status.thread, _import_thread, this);
-	pthread_detach (import_status.thread);
-
-	while (!import_status.done && !import_status.cancel) {
-		gtk_main_iteration ();
-	}
-
-	import_status.done = true;
-
 	int result = -1;
 
-	if (!import_status.cancel && !import_status.sources.empty()) {
+	if (run_import (paths, quality, replace) && !import_status.sources.empty()) {
 		result = add_sources (
 			import_status.paths,
 			import_status.sources,
@@ -588,6 +585,37 @@ Editor::import_sndfiles (vector<string> paths, ImportMode mode, SrcQuality quali
 	return result;
 }
 
+/** Import some files into the session, in a thread which runs while we wait for it.
+ *  The new sources are left in import_status.
+ *  @return true if the import succeeded.
+ */
+bool
+Editor::run_import (vector<string> paths, SrcQuality quality, bool replace)
+{
+	import_status.paths = paths;
+	import_status.done = false;
+	import_status.cancel = false;
+	import_status.freeze = false;
+	import_status.quality = quality;
+	import_status.replace_existing_source = replace;
+
+	/* start import thread for this spec. this will ultimately call Session::import_audiofiles()
+	   which, if successful, will add the files as regions to the region list. its up to us
+	   (the GUI) to direct additional steps after that.
+	*/
+
+	pthread_create_and_store ("import", &import_status.thread, _import_thread, this);
+	pthread_detach (import_status.thread);
+
+	while (!import_status.done && !import_status.cancel) {
+		gtk_main_iteration ();
+	}
+
+	import_status.done = true;
+
+	return !import_status.cancel;
+}
+
 int
 Editor::embed_sndfiles (vector<string> paths, bool multifile,
 			bool& check_sample_rate, ImportMode mode, framepos_t& pos, int target_regions, int target_tracks,
@@ -724,6 +724,7 @@ Editor::tie_vertical_scrolling ()
 
 	if (pending_visual_change.idle_handler_id < 0) {
 		_summary->set_overlays_dirty ();
+		prioritise_visible_sources ();
 	}
 }
 
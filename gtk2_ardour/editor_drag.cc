@@ -1926,10 +1926,9 @@ MeterMarkerDrag::finished (GdkEvent* event, bool movement_occurred)
 
 	if (_copy == true) {
 		_editor->begin_reversible_command (_("copy meter mark"));
-		XMLNode &before = map.get_state();
+		map.clear_changes ();
 		map.add_meter (_marker->meter(), when);
-		XMLNode &after = map.get_state();
-		_editor->session()->add_command(new MementoCommand<TempoMap>(map, &before, &after));
+		_editor->session()->add_command(new StatefulDiffCommand (map));
 		_editor->commit_reversible_command ();
 
 		// delete the dummy marker we used for visual representation of copying.
@@ -1937,10 +1936,9 @@ MeterMarkerDrag::finished (GdkEvent* event, bool movement_occurred)
 		delete _marker;
 	} else {
 		_editor->begin_reversible_command (_("move meter mark"));
-		XMLNode &before = map.get_state();
+		map.clear_changes ();
 		map.move_meter (_marker->meter(), when);
-		XMLNode &after = map.get_state();
-		_editor->session()->add_command(new MementoCommand<TempoMap>(map, &before, &after));
+		_editor->session()->add_command(new StatefulDiffCommand (map));
 		_editor->commit_reversible_command ();
 	}
 }
@@ -2019,10 +2017,9 @@ TempoMarkerDrag::finished (GdkEvent* event, bool movement_occurred)
 
 	if (_copy == true) {
 		_editor->begin_reversible_command (_("copy tempo mark"));
-		XMLNode &before = map.get_state();
+		map.clear_changes ();
 		map.add_tempo (_marker->tempo(), when);
-		XMLNode &after = map.get_state();
-		_editor->session()->add_command (new MementoCommand<TempoMap>(map, &before, &after));
+		_editor->session()->add_command (new StatefulDiffCommand (map));
 		_editor->commit_reversible_command ();
 
 		// delete the dummy marker we used for visual representation of copying.
@@ -2030,10 +2027,9 @@ TempoMarkerDrag::finished (GdkEvent* event, bool movement_occurred)
 		delete _marker;
 	} else {
 		_editor->begin_reversible_command (_("move tempo mark"));
-		XMLNode &before = map.get_state();
+		map.clear_changes ();
 		map.move_tempo (_marker->tempo(), when);
-		XMLNode &after = map.get_state();
-		_editor->session()->add_command (new MementoCommand<TempoMap>(map, &before, &after));
+		_editor->session()->add_command (new StatefulDiffCommand (map));
 		_editor->commit_reversible_command ();
 	}
 }
@@ -2269,14 +2265,13 @@ FadeInDrag::finished (GdkEvent* event, bool movement_occurred)
 		}
 
 		boost::shared_ptr<AutomationList> alist = tmp->audio_region()->fade_in();
-		XMLNode &before = alist->get_state();
+		alist->clear_changes ();
 
 		tmp->audio_region()->set_fade_in_length (fade_length);
 		tmp->audio_region()->set_fade_in_active (true);
 		tmp->hide_fade_line();
 
-		XMLNode &after = alist->get_state();
-		_editor->session()->add_command(new MementoCommand<AutomationList>(*alist.get(), &before, &after));
+		_editor->session()->add_command (new StatefulDiffCommand (alist));
 	}
 
 	_editor->commit_reversible_command ();
@@ -2392,14 +2387,13 @@ FadeOutDrag::finished (GdkEvent* event, bool movement_occurred)
 		}
 
 		boost::shared_ptr<AutomationList> alist = tmp->audio_region()->fade_out();
-		XMLNode &before = alist->get_state();
+		alist->clear_changes ();
 
 		tmp->audio_region()->set_fade_out_length (fade_length);
 		tmp->audio_region()->set_fade_out_active (true);
 		tmp->hide_fade_line();
 
-		XMLNode &after = alist->get_state();
-		_editor->session()->add_command(new MementoCommand<AutomationList>(*alist.get(), &before, &after));
+		_editor->session()->add_command (new StatefulDiffCommand (alist));
 	}
 
 	_editor->commit_reversible_command ();
@@ -2698,7 +2692,7 @@ MarkerDrag::finished (GdkEvent* event, bool movement_occurred)
 	_editor->_dragging_edit_point = false;
 
 	_editor->begin_reversible_command ( _("move marker") );
-	XMLNode &before = _editor->session()->locations()->get_state();
+	_editor->session()->locations()->clear_changes ();
 
 	MarkerSelection::iterator i;
 	list<Location*>::iterator x;
@@ -2724,8 +2718,7 @@ MarkerDrag::finished (GdkEvent* event, bool movement_occurred)
 		}
 	}
 
-	XMLNode &after = _editor->session()->locations()->get_state();
-	_editor->session()->add_command(new MementoCommand<Locations>(*(_editor->session()->locations()), &before, &after));
+	_editor->session()->add_command(new StatefulDiffCommand (*_editor->session()->locations()));
 	_editor->commit_reversible_command ();
 }
 
@@ -3668,7 +3661,7 @@ RangeMarkerBarDrag::finished (GdkEvent* event, bool movement_occurred)
 		case CreateCDMarker:
 		    {
 			_editor->begin_reversible_command (_("new range marker"));
-			XMLNode &before = _editor->session()->locations()->get_state();
+			_editor->session()->locations()->clear_changes ();
 			_editor->session()->locations()->next_available_name(rangename,"unnamed");
 			if (_operation == CreateCDMarker) {
 				flags = Location::IsRangeMarker | Location::IsCDMarker;
@@ -3683,8 +3676,7 @@ RangeMarkerBarDrag::finished (GdkEvent* event, bool movement_occurred)
 				);
 
 			_editor->session()->locations()->add (newloc, true);
-			XMLNode &after = _editor->session()->locations()->get_state();
-			_editor->session()->add_command(new MementoCommand<Locations>(*(_editor->session()->locations()), &before, &after));
+			_editor->session()->add_command(new StatefulDiffCommand (*_editor->session()->locations()));
 			_editor->commit_reversible_command ();
 			break;
 		    }
@@ -3993,7 +3985,6 @@ AutomationRangeDrag::AutomationRangeDrag (Editor* editor, ArdourCanvas::Item* it
 		if (k != _ranges.end()) {
 			Line n;
 			n.line = *i;
-			n.state = 0;
 			n.range = r;
 			_lines.push_back (n);
 		}
@@ -4009,9 +4000,9 @@ AutomationRangeDrag::start_grab (GdkEvent* event, Gdk::Cursor* cursor)
 {
 	Drag::start_grab (event, cursor);
 
-	/* Get line states before we start changing things */
+	/* Note line states before we start changing things */
 	for (list<Line>::iterator i = _lines.begin(); i != _lines.end(); ++i) {
-		i->state = &i->line->get_state ();
+		i->line->begin_list_change ();
 	}
 
 	if (_ranges.empty()) {
@@ -4121,7 +4112,7 @@ AutomationRangeDrag::start_grab (GdkEvent* event, Gdk::Cursor* cursor)
 	}
 
 	for (list<Line>::iterator i = _lines.begin(); i != _lines.end(); ++i) {
-		i->line->start_drag_multiple (i->points, 1 - (_drags->current_pointer_y() / i->line->height ()), i->state);
+		i->line->start_drag_multiple (i->points, 1 - (_drags->current_pointer_y() / i->line->height ()));
 	}
 }
 
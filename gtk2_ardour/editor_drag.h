@@ -889,7 +889,6 @@ private:
 		boost::shared_ptr<AutomationLine> line; ///< the line
 		std::list<ControlPoint*> points; ///< points to drag on the line
 		std::pair<ARDOUR::framepos_t, ARDOUR::framepos_t> range; ///< the range of all points on the line, in session frames
-		XMLNode* state; ///< the XML state node before the drag
 	};
 
 	std::list<Line> _lines;
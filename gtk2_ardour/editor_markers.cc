@@ -27,7 +27,7 @@
 #include "ardour/session.h"
 #include "ardour/location.h"
 #include "ardour/profile.h"
-#include "pbd/memento_command.h"
+#include "pbd/stateful_diff_command.h"
 
 #include "editor.h"
 #include "marker.h"
@@ -645,10 +645,9 @@ Editor::mouse_add_new_marker (framepos_t where, bool is_cd, bool is_xrun)
 		}
 		Location *location = new Location (*_session, where, where, markername, (Location::Flags) flags);
 		_session->begin_reversible_command (_("add marker"));
-		XMLNode &before = _session->locations()->get_state();
+		_session->locations()->clear_changes ();
 		_session->locations()->add (location, true);
-		XMLNode &after = _session->locations()->get_state();
-		_session->add_command (new MementoCommand<Locations>(*(_session->locations()), &before, &after));
+		_session->add_command (new StatefulDiffCommand (*_session->locations()));
 		_session->commit_reversible_command ();
 
 		/* find the marker we just added */
@@ -687,10 +686,9 @@ gint
 Editor::really_remove_marker (Location* loc)
 {
 	_session->begin_reversible_command (_("remove marker"));
-	XMLNode &before = _session->locations()->get_state();
+	_session->locations()->clear_changes ();
 	_session->locations()->remove (loc);
-	XMLNode &after = _session->locations()->get_state();
-	_session->add_command (new MementoCommand<Locations>(*(_session->locations()), &before, &after));
+	_session->add_command (new StatefulDiffCommand (*_session->locations()));
 	_session->commit_reversible_command ();
 	return FALSE;
 }
@@ -1332,13 +1330,12 @@ Editor::marker_menu_rename ()
 	}
 
 	begin_reversible_command ( _("rename marker") );
-	XMLNode &before = _session->locations()->get_state();
+	_session->locations()->clear_changes ();
 
 	dialog.get_result(txt);
 	loc->set_name (txt);
 
-	XMLNode &after = _session->locations()->get_state();
-	_session->add_command (new MementoCommand<Locations>(*(_session->locations()), &before, &after));
+	_session->add_command (new StatefulDiffCommand (*_session->locations()));
 	commit_reversible_command ();
 }
 
@@ -1671,10 +1671,9 @@ Editor::add_location_from_selection ()
 	Location *location = new Location (*_session, start, end, rangename, Location::IsRangeMarker);
 
 	_session->begin_reversible_command (_("add marker"));
-	XMLNode &before = _session->locations()->get_state();
+	_session->locations()->clear_changes ();
 	_session->locations()->add (location, true);
-	XMLNode &after = _session->locations()->get_state();
-	_session->add_command(new MementoCommand<Locations>(*(_session->locations()), &before, &after));
+	_session->add_command(new StatefulDiffCommand (*_session->locations()));
 	_session->commit_reversible_command ();
 }
 
@@ -1691,10 +1690,9 @@ Editor::add_location_mark (framepos_t where)
 	}
 	Location *location = new Location (*_session, where, where, markername, Location::IsMark);
 	_session->begin_reversible_command (_("add marker"));
-	XMLNode &before = _session->locations()->get_state();
+	_session->locations()->clear_changes ();
 	_session->locations()->add (location, true);
-	XMLNode &after = _session->locations()->get_state();
-	_session->add_command(new MementoCommand<Locations>(*(_session->locations()), &before, &after));
+	_session->add_command(new StatefulDiffCommand (*_session->locations()));
 	_session->commit_reversible_command ();
 }
 
@@ -1715,7 +1713,7 @@ Editor::add_locations_from_region ()
 	}
 
 	_session->begin_reversible_command (selection->regions.size () > 1 ? _("add markers") : _("add marker"));
-	XMLNode &before = _session->locations()->get_state();
+	_session->locations()->clear_changes ();
 
 	for (RegionSelection::iterator i = rs.begin (); i != rs.end (); ++i) {
 
@@ -1726,8 +1724,7 @@ Editor::add_locations_from_region ()
 		_session->locations()->add (location, true);
 	}
 
-	XMLNode &after = _session->locations()->get_state();
-	_session->add_command (new MementoCommand<Locations>(*(_session->locations()), &before, &after));
+	_session->add_command (new StatefulDiffCommand (*_session->locations()));
 	_session->commit_reversible_command ();
 }
 
@@ -1742,7 +1739,7 @@ Editor::add_location_from_region ()
 	}
 
 	_session->begin_reversible_command (_("add marker"));
-	XMLNode &before = _session->locations()->get_state();
+	_session->locations()->clear_changes ();
 
 	string markername;
 
@@ -1762,8 +1759,7 @@ Editor::add_location_from_region ()
 	Location *location = new Location (*_session, selection->regions.start(), selection->regions.end_frame(), markername, Location::IsRangeMarker);
 	_session->locations()->add (location, true);
 
-	XMLNode &after = _session->locations()->get_state();
-	_session->add_command (new MementoCommand<Locations>(*(_session->locations()), &before, &after));
+	_session->add_command (new StatefulDiffCommand (*_session->locations()));
 	_session->commit_reversible_command ();
 }
 
@@ -1821,10 +1817,9 @@ Editor::clear_markers ()
 {
 	if (_session) {
 		_session->begin_reversible_command (_("clear markers"));
-		XMLNode &before = _session->locations()->get_state();
+		_session->locations()->clear_changes ();
 		_session->locations()->clear_markers ();
-		XMLNode &after = _session->locations()->get_state();
-		_session->add_command(new MementoCommand<Locations>(*(_session->locations()), &before, &after));
+		_session->add_command(new StatefulDiffCommand (*_session->locations()));
 		_session->commit_reversible_command ();
 	}
 }
@@ -1834,7 +1829,7 @@ Editor::clear_ranges ()
 {
 	if (_session) {
 		_session->begin_reversible_command (_("clear ranges"));
-		XMLNode &before = _session->locations()->get_state();
+		_session->locations()->clear_changes ();
 
 		Location * looploc = _session->locations()->auto_loop_location();
 		Location * punchloc = _session->locations()->auto_punch_location();
@@ -1844,8 +1839,7 @@ Editor::clear_ranges ()
 		if (looploc) _session->locations()->add (looploc);
 		if (punchloc) _session->locations()->add (punchloc);
 
-		XMLNode &after = _session->locations()->get_state();
-		_session->add_command(new MementoCommand<Locations>(*(_session->locations()), &before, &after));
+		_session->add_command(new StatefulDiffCommand (*_session->locations()));
 		_session->commit_reversible_command ();
 	}
 }
@@ -1854,10 +1848,9 @@ void
 Editor::clear_locations ()
 {
 	_session->begin_reversible_command (_("clear locations"));
-	XMLNode &before = _session->locations()->get_state();
+	_session->locations()->clear_changes ();
 	_session->locations()->clear ();
-	XMLNode &after = _session->locations()->get_state();
-	_session->add_command(new MementoCommand<Locations>(*(_session->locations()), &before, &after));
+	_session->add_command(new StatefulDiffCommand (*_session->locations()));
 	_session->commit_reversible_command ();
 	_session->locations()->clear ();
 }
@@ -4589,10 +4582,10 @@ Editor::reset_region_gain_envelopes ()
 		AudioRegionView* const arv = dynamic_cast<AudioRegionView*>(*i);
 		if (arv) {
 			boost::shared_ptr<AutomationList> alist (arv->audio_region()->envelope());
-			XMLNode& before (alist->get_state());
+			alist->clear_changes ();
 
 			arv->audio_region()->set_default_envelope ();
-			_session->add_command (new MementoCommand<AutomationList>(*arv->audio_region()->envelope().get(), &before, &alist->get_state()));
+			_session->add_command (new StatefulDiffCommand (alist));
 		}
 	}
 
@@ -4802,7 +4795,7 @@ Editor::set_fade_length (bool in)
 			alist = tmp->audio_region()->fade_out();
 		}
 
-		XMLNode &before = alist->get_state();
+		alist->clear_changes ();
 
 		if (in) {
 			tmp->audio_region()->set_fade_in_length (len);
@@ -4812,8 +4805,7 @@ Editor::set_fade_length (bool in)
 			tmp->audio_region()->set_fade_out_active (true);
 		}
 
-		XMLNode &after = alist->get_state();
-		_session->add_command(new MementoCommand<AutomationList>(*alist, &before, &after));
+		_session->add_command (new StatefulDiffCommand (alist));
 	}
 
 	commit_reversible_command ();
@@ -4838,12 +4830,11 @@ Editor::set_fade_in_shape (FadeShape shape)
 		}
 
 		boost::shared_ptr<AutomationList> alist = tmp->audio_region()->fade_in();
-		XMLNode &before = alist->get_state();
+		alist->clear_changes ();
 
 		tmp->audio_region()->set_fade_in_shape (shape);
 
-		XMLNode &after = alist->get_state();
-		_session->add_command(new MementoCommand<AutomationList>(*alist.get(), &before, &after));
+		_session->add_command (new StatefulDiffCommand (alist));
 	}
 
 	commit_reversible_command ();
@@ -4869,12 +4860,11 @@ Editor::set_fade_out_shape (FadeShape shape)
 		}
 
 		boost::shared_ptr<AutomationList> alist = tmp->audio_region()->fade_out();
-		XMLNode &before = alist->get_state();
+		alist->clear_changes ();
 
 		tmp->audio_region()->set_fade_out_shape (shape);
 
-		XMLNode &after = alist->get_state();
-		_session->add_command(new MementoCommand<AutomationList>(*alist.get(), &before, &after));
+		_session->add_command (new StatefulDiffCommand (alist));
 	}
 
 	commit_reversible_command ();
@@ -5464,7 +5454,7 @@ Editor::define_one_bar (framepos_t start, framepos_t end)
 	}
 
 	begin_reversible_command (_("set tempo from region"));
-	XMLNode& before (_session->tempo_map().get_state());
+	_session->tempo_map().clear_changes ();
 
 	if (do_global) {
 		_session->tempo_map().change_initial_tempo (beats_per_minute, t.note_type());
@@ -5474,9 +5464,8 @@ Editor::define_one_bar (framepos_t start, framepos_t end)
 		_session->tempo_map().add_tempo (Tempo (beats_per_minute, t.note_type()), start);
 	}
 
-	XMLNode& after (_session->tempo_map().get_state());
 
-	_session->add_command (new MementoCommand<TempoMap>(_session->tempo_map(), &before, &after));
+	_session->add_command (new StatefulDiffCommand (_session->tempo_map()));
 	commit_reversible_command ();
 }
 
@@ -6169,7 +6158,7 @@ Editor::insert_time (framepos_t pos, framecnt_t frames, InsertTimeOption opt,
 	/* markers */
 	if (markers_too) {
 		bool moved = false;
-		XMLNode& before (_session->locations()->get_state());
+		_session->locations()->clear_changes ();
 		Locations::LocationList copy (_session->locations()->list());
 
 		for (Locations::LocationList::iterator i = copy.begin(); i != copy.end(); ++i) {
@@ -6199,8 +6188,7 @@ Editor::insert_time (framepos_t pos, framecnt_t frames, InsertTimeOption opt,
 		}
 
 		if (moved) {
-			XMLNode& after (_session->locations()->get_state());
-			_session->add_command (new MementoCommand<Locations>(*_session->locations(), &before, &after));
+			_session->add_command (new StatefulDiffCommand (*_session->locations()));
 		}
 	}
 
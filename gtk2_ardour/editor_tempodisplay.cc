@@ -30,7 +30,7 @@
 #include <libgnomecanvasmm.h>
 
 #include "pbd/error.h"
-#include "pbd/memento_command.h"
+#include "pbd/stateful_diff_command.h"
 
 #include <gtkmm2ext/utils.h>
 #include <gtkmm2ext/gtk_ui.h>
@@ -165,10 +165,12 @@ Editor::compute_current_bbt_points (framepos_t leftmost, framepos_t rightmost)
 	}
 	next_beat.ticks = 0;
 
-	delete current_bbt_points;
-	current_bbt_points = 0;
+	if (!current_bbt_points) {
+		current_bbt_points = new TempoMap::BBTPointList;
+	}
 
-	current_bbt_points = _session->tempo_map().get_points (_session->tempo_map().frame_time (previous_beat), _session->tempo_map().frame_time (next_beat) + 1);
+	/* refill the existing list, to save reallocating it on every redraw */
+	_session->tempo_map().get_points (*current_bbt_points, _session->tempo_map().frame_time (previous_beat), _session->tempo_map().frame_time (next_beat) + 1);
 }
 
 void
@@ -233,10 +235,9 @@ Editor::mouse_add_new_tempo_event (framepos_t frame)
 	tempo_dialog.get_bbt_time (requested);
 
 	begin_reversible_command (_("add tempo mark"));
-        XMLNode &before = map.get_state();
+        map.clear_changes ();
 	map.add_tempo (Tempo (bpm,nt), requested);
-        XMLNode &after = map.get_state();
-	_session->add_command(new MementoCommand<TempoMap>(map, &before, &after));
+	_session->add_command(new StatefulDiffCommand (map));
 	commit_reversible_command ();
 
 	//map.dump (cerr);
@@ -276,9 +277,9 @@ Editor::mouse_add_new_meter_event (framepos_t frame)
 	meter_dialog.get_bbt_time (requested);
 
 	begin_reversible_command (_("add meter mark"));
-        XMLNode &before = map.get_state();
+        map.clear_changes ();
 	map.add_meter (Meter (bpb, note_type), requested);
-	_session->add_command(new MementoCommand<TempoMap>(map, &before, &map.get_state()));
+	_session->add_command(new StatefulDiffCommand (map));
 	commit_reversible_command ();
 
 	//map.dump (cerr);
@@ -327,10 +328,9 @@ Editor::edit_meter_section (MeterSection* section)
 	double note_type = meter_dialog.get_note_type ();
 
 	begin_reversible_command (_("replace tempo mark"));
-        XMLNode &before = _session->tempo_map().get_state();
+        _session->tempo_map().clear_changes ();
 	_session->tempo_map().replace_meter (*section, Meter (bpb, note_type));
-        XMLNode &after = _session->tempo_map().get_state();
-	_session->add_command(new MementoCommand<TempoMap>(_session->tempo_map(), &before, &after));
+	_session->add_command(new StatefulDiffCommand (_session->tempo_map()));
 	commit_reversible_command ();
 }
 
@@ -359,13 +359,12 @@ Editor::edit_tempo_section (TempoSection* section)
 	cerr << "Editing tempo section to be at " << when << endl;
 	_session->tempo_map().dump (cerr);
 	begin_reversible_command (_("replace tempo mark"));
-	XMLNode &before = _session->tempo_map().get_state();
+	_session->tempo_map().clear_changes ();
 	_session->tempo_map().replace_tempo (*section, Tempo (bpm,nt));
 	_session->tempo_map().dump (cerr);
 	_session->tempo_map().move_tempo (*section, when);
 	_session->tempo_map().dump (cerr);
-	XMLNode &after = _session->tempo_map().get_state();
-	_session->add_command (new MementoCommand<TempoMap>(_session->tempo_map(), &before, &after));
+	_session->add_command (new StatefulDiffCommand (_session->tempo_map()));
 	commit_reversible_command ();
 }
 
@@ -411,10 +410,9 @@ gint
 Editor::real_remove_tempo_marker (TempoSection *section)
 {
 	begin_reversible_command (_("remove tempo mark"));
-	XMLNode &before = _session->tempo_map().get_state();
+	_session->tempo_map().clear_changes ();
 	_session->tempo_map().remove_tempo (*section);
-	XMLNode &after = _session->tempo_map().get_state();
-	_session->add_command(new MementoCommand<TempoMap>(_session->tempo_map(), &before, &after));
+	_session->add_command(new StatefulDiffCommand (_session->tempo_map()));
 	commit_reversible_command ();
 
 	return FALSE;
@@ -445,10 +443,9 @@ gint
 Editor::real_remove_meter_marker (MeterSection *section)
 {
 	begin_reversible_command (_("remove tempo mark"));
-	XMLNode &before = _session->tempo_map().get_state();
+	_session->tempo_map().clear_changes ();
 	_session->tempo_map().remove_meter (*section);
-	XMLNode &after = _session->tempo_map().get_state();
-	_session->add_command(new MementoCommand<TempoMap>(_session->tempo_map(), &before, &after));
+	_session->add_command(new StatefulDiffCommand (_session->tempo_map()));
 	commit_reversible_command ();
 
 	return FALSE;
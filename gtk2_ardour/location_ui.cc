@@ -25,7 +25,7 @@
 #include "ardour/utils.h"
 #include "ardour/configuration.h"
 #include "ardour/session.h"
-#include "pbd/memento_command.h"
+#include "pbd/stateful_diff_command.h"
 
 #include "ardour_ui.h"
 #include "clock_group.h"
@@ -854,10 +854,9 @@ LocationUI::do_location_remove (ARDOUR::Location *loc)
 	}
 
 	_session->begin_reversible_command (_("remove marker"));
-	XMLNode &before = _session->locations()->get_state();
+	_session->locations()->clear_changes ();
 	_session->locations()->remove (loc);
-	XMLNode &after = _session->locations()->get_state();
-	_session->add_command(new MementoCommand<Locations>(*(_session->locations()), &before, &after));
+	_session->add_command(new StatefulDiffCommand (*_session->locations()));
 	_session->commit_reversible_command ();
 
 	return FALSE;
@@ -1018,10 +1017,9 @@ LocationUI::add_new_location()
 			newest_location = location;
 		}
 		_session->begin_reversible_command (_("add marker"));
-		XMLNode &before = _session->locations()->get_state();
+		_session->locations()->clear_changes ();
 		_session->locations()->add (location, true);
-		XMLNode &after = _session->locations()->get_state();
-		_session->add_command (new MementoCommand<Locations>(*(_session->locations()), &before, &after));
+		_session->add_command (new StatefulDiffCommand (*_session->locations()));
 		_session->commit_reversible_command ();
 	}
 
@@ -1037,10 +1035,9 @@ LocationUI::add_new_range()
 		_session->locations()->next_available_name(rangename,"unnamed");
 		Location *location = new Location (*_session, where, where, rangename, Location::IsRangeMarker);
 		_session->begin_reversible_command (_("add range marker"));
-		XMLNode &before = _session->locations()->get_state();
+		_session->locations()->clear_changes ();
 		_session->locations()->add (location, true);
-		XMLNode &after = _session->locations()->get_state();
-		_session->add_command (new MementoCommand<Locations>(*(_session->locations()), &before, &after));
+		_session->add_command (new StatefulDiffCommand (*_session->locations()));
 		_session->commit_reversible_command ();
 	}
 }
@@ -33,10 +33,31 @@ MidiAutomationLine::MidiAutomationLine (
   : AutomationLine (name, tav, group, list, converter)
   , _region (region)
   , _parameter (parameter)
+  , _before (0)
 {
 
 }
 
+MidiAutomationLine::~MidiAutomationLine ()
+{
+	delete _before;
+}
+
+void
+MidiAutomationLine::begin_list_change ()
+{
+	delete _before;
+	_before = &alist->get_state ();
+}
+
+PBD::Command*
+MidiAutomationLine::end_list_change ()
+{
+	PBD::Command* c = new MementoCommand<ARDOUR::AutomationList> (memento_command_binder (), _before, &alist->get_state ());
+	_before = 0;
+	return c;
+}
+
 MementoCommandBinder<ARDOUR::AutomationList>*
 MidiAutomationLine::memento_command_binder ()
 {
@@ -21,7 +21,8 @@
 #include "automation_line.h"
 
 /** Stub class so that lines for MIDI AutomationRegionViews can use the correct
- *  MementoCommandBinder.
+ *  MementoCommandBinder; their lists live in the MidiModel, so their changes
+ *  are recorded as mementos rather than diffs.
  */
 class MidiAutomationLine : public AutomationLine
 {
@@ -32,9 +33,15 @@ public:
 			    Evoral::Parameter,
 			    const Evoral::TimeConverter<double, ARDOUR::framepos_t>* converter = 0);
 
-	MementoCommandBinder<ARDOUR::AutomationList>* memento_command_binder ();
+	~MidiAutomationLine ();
+
+	void begin_list_change ();
+	PBD::Command* end_list_change ();
 
 private:
+	MementoCommandBinder<ARDOUR::AutomationList>* memento_command_binder ();
+
 	boost::shared_ptr<ARDOUR::MidiRegion> _region;
 	Evoral::Parameter _parameter;
+	XMLNode* _before; ///< list state at the last begin_list_change(), or 0
 };
@@ -804,6 +804,18 @@ RCOptionEditor::RCOptionEditor ()
                 }
 
                 add_option (_("Misc"), procs);
+
+                ComboOption<ProcessorScheduling>* sched = new ComboOption<ProcessorScheduling> (
+                        "processor-scheduling",
+                        _("Distribute work between processors"),
+                        sigc::mem_fun (*_rc_config, &RCConfiguration::get_processor_scheduling),
+                        sigc::mem_fun (*_rc_config, &RCConfiguration::set_processor_scheduling)
+                        );
+
+                sched->add (SharedQueueScheduling, _("using a single shared queue"));
+                sched->add (WorkStealingScheduling, _("using per-processor queues with work stealing"));
+
+                add_option (_("Misc"), sched);
         }
 
 	add_option (_("Misc"), new OptionEditorHeading (_("Metering")));
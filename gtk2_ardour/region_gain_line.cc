@@ -72,7 +72,7 @@ AudioRegionGainLine::remove_point (ControlPoint& cp)
 	model_representation (cp, mr);
 
 	trackview.editor().session()->begin_reversible_command (_("remove control point"));
-	XMLNode &before = alist->get_state();
+	alist->clear_changes ();
 
 	if (!rv.audio_region()->envelope_active()) {
                 rv.audio_region()->clear_changes ();
@@ -82,7 +82,7 @@ AudioRegionGainLine::remove_point (ControlPoint& cp)
 
 	alist->erase (mr.start, mr.end);
 
-	trackview.editor().session()->add_command (new MementoCommand<AutomationList>(*alist.get(), &before, &alist->get_state()));
+	trackview.editor().session()->add_command (new StatefulDiffCommand (alist));
 	trackview.editor().session()->commit_reversible_command ();
 	trackview.editor().session()->set_dirty ();
 }
@@ -19,21 +19,15 @@
 
 #include "ardour/analyser.h"
 #include "ardour/audiofilesource.h"
-#include "ardour/session_event.h"
+#include "ardour/source_work_pool.h"
 #include "ardour/transient_detector.h"
 
-#include "pbd/pthread_utils.h"
 #include "pbd/convert.h"
 
 using namespace std;
 using namespace ARDOUR;
 using namespace PBD;
 
-Analyser* Analyser::the_analyser = 0;
-Glib::StaticMutex Analyser::analysis_queue_lock = GLIBMM_STATIC_MUTEX_INIT;
-Glib::Cond* Analyser::SourcesToAnalyse = 0;
-list<boost::weak_ptr<Source> > Analyser::analysis_queue;
-
 Analyser::Analyser ()
 {
 
@@ -43,19 +37,7 @@ Analyser::~Analyser ()
 {
 }
 
-static void
-analyser_work ()
-{
-	Analyser::work ();
-}
-
-void
-Analyser::init ()
-{
-	SourcesToAnalyse = new Glib::Cond();
-	Glib::Thread::create (sigc::ptr_fun (analyser_work), false);
-}
-
+/** Queue a source to be analysed by the SourceWorkPool */
 void
 Analyser::queue_source_for_analysis (boost::shared_ptr<Source> src, bool force)
 {
@@ -67,37 +49,17 @@ Analyser::queue_source_for_analysis (boost::shared_ptr<Source> src, bool force)
 		return;
 	}
 
-	Glib::Mutex::Lock lm (analysis_queue_lock);
-	analysis_queue.push_back (boost::weak_ptr<Source>(src));
-	SourcesToAnalyse->broadcast ();
+	SourceWorkPool::queue (src, SourceWorkPool::Analyse);
 }
 
+/** Analyse a source in the calling thread */
 void
-Analyser::work ()
+Analyser::analyse (boost::shared_ptr<Source> src)
 {
-	SessionEvent::create_per_thread_pool ("Analyser", 64);
-
-	while (true) {
-		analysis_queue_lock.lock ();
-
-	  wait:
-		if (analysis_queue.empty()) {
-			SourcesToAnalyse->wait (analysis_queue_lock);
-		}
-
-		if (analysis_queue.empty()) {
-			goto wait;
-		}
-
-		boost::shared_ptr<Source> src (analysis_queue.front().lock());
-		analysis_queue.pop_front();
-		analysis_queue_lock.unlock ();
-
-		boost::shared_ptr<AudioFileSource> afs = boost::dynamic_pointer_cast<AudioFileSource> (src);
+	boost::shared_ptr<AudioFileSource> afs = boost::dynamic_pointer_cast<AudioFileSource> (src);
 
-		if (afs && afs->length(afs->timeline_position())) {
-			analyse_audio_file_source (afs);
-		}
+	if (afs && afs->length(afs->timeline_position())) {
+		analyse_audio_file_source (afs);
 	}
 }
 
@@ -1,7 +1,6 @@
 #ifndef __ardour_analyser_h__
 #define __ardour_analyser_h__
 
-#include <glibmm/thread.h>
 #include <boost/shared_ptr.hpp>
 
 namespace ARDOUR {
@@ -16,16 +15,10 @@ class Analyser {
 	Analyser();
 	~Analyser ();
 
-	static void init ();
 	static void queue_source_for_analysis (boost::shared_ptr<Source>, bool force);
-	static void work ();
+	static void analyse (boost::shared_ptr<Source>);
 
   private:
-	static Analyser* the_analyser;
-	static Glib::StaticMutex analysis_queue_lock;
-	static Glib::Cond* SourcesToAnalyse;
-	static std::list<boost::weak_ptr<Source> > analysis_queue;
-
 	static void analyse_audio_file_source (boost::shared_ptr<AudioFileSource>);
 };
 
@@ -0,0 +1,174 @@
+/*
+    Copyright (C) 2011 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_audio_backend_h__
+#define __ardour_audio_backend_h__
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include <boost/function.hpp>
+#include <boost/utility.hpp>
+
+#include <jack/jack.h>
+
+#include "ardour/data_type.h"
+#include "ardour/types.h"
+
+namespace ARDOUR {
+
+class AudioEngine;
+
+/** The interface between AudioEngine (and its Ports) and whatever it is
+ *  that actually runs the process cycle and moves data in and out of
+ *  ports: JACK, or the built-in dummy backend.
+ *
+ *  Port flags, latency ranges and transport states use the JACK types and
+ *  values, since the rest of libardour already speaks in those terms.
+ *
+ *  Once open() has succeeded, the backend calls the AudioEngine back
+ *  from its own threads: AudioEngine::process_callback() once per
+ *  cycle, and the other AudioEngine::*_callback() methods as things
+ *  change.
+ */
+class AudioBackend : public boost::noncopyable
+{
+public:
+	/** Opaque handle to a port owned by the backend */
+	typedef void* PortHandle;
+
+	AudioBackend () : _engine (0) {}
+	virtual ~AudioBackend () {}
+
+	/** @return a name for this backend, for messages and the UI */
+	virtual std::string name () const = 0;
+
+	void set_engine (AudioEngine* e) { _engine = e; }
+
+	/* client */
+
+	/** Connect to the backend, without starting processing.
+	 *  @return 0 on success.
+	 */
+	virtual int open (std::string const & client_name, std::string const & session_uuid) = 0;
+	/** Stop processing if required, and drop all ports and connections */
+	virtual int close () = 0;
+	virtual bool connected () const = 0;
+	/** The connection has gone away underneath us; forget it without trying to close it */
+	virtual void client_died () {}
+	/** @return the client name, which may differ from the one passed to open() */
+	virtual std::string client_name () const = 0;
+
+	/** Start calling AudioEngine::process_callback() */
+	virtual int start () = 0;
+	/** Stop calling AudioEngine::process_callback() */
+	virtual int stop () = 0;
+
+	virtual bool is_realtime () const = 0;
+	/** @return priority to give to process threads, or 0 if they should not be realtime */
+	virtual int client_real_time_priority () = 0;
+	virtual int create_process_thread (boost::function<void()> f, pthread_t* thread, size_t stacksize) = 0;
+
+	virtual framecnt_t sample_rate () const = 0;
+	virtual pframes_t buffer_size () const = 0;
+	virtual int set_buffer_size (pframes_t) = 0;
+	/** @return size in bytes of the buffer behind a port of the given type */
+	virtual size_t raw_buffer_size (DataType) const = 0;
+
+	virtual pframes_t frames_since_cycle_start () const = 0;
+	virtual pframes_t frame_time () const = 0;
+	virtual pframes_t frame_time_at_cycle_start () const = 0;
+
+	/** @return percentage of the available time spent processing */
+	virtual float cpu_load () const = 0;
+
+	virtual int freewheel (bool) = 0;
+
+	/* transport; a backend with no transport of its own is always stopped */
+
+	virtual void transport_start () {}
+	virtual void transport_stop () {}
+	virtual void transport_locate (framepos_t) {}
+	virtual jack_transport_state_t transport_state () const { return JackTransportStopped; }
+	virtual framepos_t transport_frame () const { return 0; }
+	virtual int reset_timebase () { return 0; }
+	virtual bool get_sync_offset (pframes_t& offset) const { offset = 0; return false; }
+
+	virtual void update_total_latencies () {}
+
+	/* ports.  Names passed in are full names (client:port) unless stated otherwise. */
+
+	/** @param shortname Port name without the client name.
+	 *  @param flags JackPortFlags.
+	 *  @return new port, or 0.
+	 */
+	virtual PortHandle register_port (std::string const & shortname, DataType type, uint32_t flags) = 0;
+	virtual void unregister_port (PortHandle) = 0;
+	/** @param shortname New name, without the client name */
+	virtual int set_port_name (PortHandle, std::string const & shortname) = 0;
+	virtual PortHandle get_port_by_name (std::string const &) const = 0;
+	virtual uint32_t port_flags (PortHandle) const = 0;
+	virtual DataType port_data_type (PortHandle) const = 0;
+
+	/** As jack_get_ports(): the result is a NULL-terminated array, which the
+	 *  caller must release with free() and which is 0 if there are no matches.
+	 *  @param port_name_pattern Regular expression, or empty to match all names.
+	 *  @param type_name_pattern Port type name (as DataType::to_jack_type()), or empty for any type.
+	 *  @param flags JackPortFlags, all of which must be set for a port to match.
+	 */
+	virtual const char** get_ports (std::string const & port_name_pattern, std::string const & type_name_pattern, uint32_t flags) const = 0;
+
+	virtual int connect (std::string const & src, std::string const & dst) = 0;
+	virtual int disconnect (std::string const & src, std::string const & dst) = 0;
+	virtual int disconnect_all (PortHandle) = 0;
+	virtual bool connected (PortHandle) const = 0;
+	virtual bool connected_to (PortHandle, std::string const &) const = 0;
+	/** Add full names of the ports connected to a port to the vector */
+	virtual int get_connections (PortHandle, std::vector<std::string>&) const = 0;
+
+	virtual bool can_monitor_input () const = 0;
+	virtual int ensure_monitor_input (PortHandle, bool) = 0;
+	virtual int request_monitor_input (PortHandle, bool) = 0;
+	virtual bool monitoring_input (PortHandle) const = 0;
+
+	virtual void set_latency_range (PortHandle, bool playback, jack_latency_range_t) = 0;
+	virtual jack_latency_range_t get_latency_range (PortHandle, bool playback) const = 0;
+
+	/** @return the port's data for this cycle; only valid in the process thread */
+	virtual void* get_buffer (PortHandle, pframes_t) = 0;
+
+	/* MIDI data, in buffers returned by get_buffer() */
+
+	virtual uint32_t midi_event_count (void* buf) const = 0;
+	/** @return 0 on success */
+	virtual int midi_event_get (pframes_t& timestamp, size_t& size, uint8_t const** data, void* buf, uint32_t index) const = 0;
+	/** @return 0 on success */
+	virtual int midi_event_put (void* buf, pframes_t timestamp, uint8_t const* data, size_t size) = 0;
+	virtual void midi_clear (void* buf) = 0;
+
+protected:
+	AudioEngine* _engine;
+};
+
+} // namespace ARDOUR
+
+#endif /* __ardour_audio_backend_h__ */
@@ -146,6 +146,12 @@ class AudioDiskstream : public Diskstream
 
 	CubicInterpolation interpolation;
 
+	/** Give the calling thread its own working buffers for do_refill(),
+	 *  so that it can refill diskstreams in parallel with the butler, or
+	 *  resize them if disk_io_frames() has changed since.
+	 */
+	static void allocate_thread_working_buffers ();
+
   protected:
 	friend class Session;
 
@@ -229,7 +235,7 @@ class AudioDiskstream : public Diskstream
 
 	/* The two central butler operations */
 	int do_flush (RunContext context, bool force = false);
-	int do_refill () { return _do_refill(_mixdown_buffer, _gain_buffer); }
+	int do_refill ();
 
 	int do_refill_with_alloc ();
 
@@ -237,6 +243,9 @@ class AudioDiskstream : public Diskstream
 	          framepos_t& start, framecnt_t cnt,
 	          ChannelInfo* channel_info, int channel, bool reversed);
 
+	int read (Sample** bufs, uint32_t n_bufs, Sample* mixdown_buffer, float* gain_buffer,
+	          framepos_t& start, framecnt_t cnt, int first_channel, bool reversed);
+
 	void finish_capture (bool rec_monitors_input, boost::shared_ptr<ChannelList>);
 	void transport_stopped_wallclock (struct tm&, time_t, bool abort);
 	void transport_looped (framepos_t transport_frame);
@@ -281,6 +290,8 @@ class AudioDiskstream : public Diskstream
  /* really */
   private:
 	int _do_refill (Sample *mixdown_buffer, float *gain_buffer);
+	bool refill_all_channels (boost::shared_ptr<ChannelList>, Sample* mixdown_buffer, float* gain_buffer,
+	                          framecnt_t total_space, bool reversed, int& ret);
 
 	int add_channel_to (boost::shared_ptr<ChannelList>, uint32_t how_many);
 	int remove_channel_from (boost::shared_ptr<ChannelList>, uint32_t how_many);
@@ -33,6 +33,8 @@
 
 #include <glibmm/thread.h>
 
+#include <boost/unordered_map.hpp>
+
 #include "pbd/rcu.h"
 #include "pbd/signals.h"
 
@@ -51,6 +53,7 @@
 
 namespace ARDOUR {
 
+class AudioBackend;
 class InternalPort;
 class MidiPort;
 class Port;
@@ -67,17 +70,25 @@ public:
 		virtual const char *what() const throw() { return "AudioEngine is disconnected"; }
 	};
 
-	AudioEngine (std::string client_name, std::string session_uuid);
+	/** @param backend Backend to use, which the engine takes ownership of,
+	 *  or 0 to use JACK.
+	 */
+	AudioEngine (std::string client_name, std::string session_uuid, AudioBackend* backend = 0);
 	virtual ~AudioEngine ();
 
+	AudioBackend* backend () const { return _backend; }
+
+	/** @return our JACK client, or 0 if we are not using the JACK backend */
 	jack_client_t* jack() const;
-	bool connected() const { return _jack != 0; }
+	bool connected() const;
 
 	bool is_realtime () const;
 
 	ProcessThread* main_thread() const { return _main_thread; }
 
-	std::string client_name() const { return jack_client_name; }
+	std::string client_name() const { return _client_name; }
+
+	Session* session () const { return _session; }
 
 	int reconnect_to_jack ();
 	int disconnect_from_jack();
@@ -100,50 +111,17 @@ public:
 
 	bool get_sync_offset (pframes_t & offset) const;
 
-	pframes_t frames_since_cycle_start () {
-  	        jack_client_t* _priv_jack = _jack;
-		if (!_running || !_priv_jack) {
-			return 0;
-		}
-		return jack_frames_since_cycle_start (_priv_jack);
-	}
-
-	pframes_t frame_time () {
-  	        jack_client_t* _priv_jack = _jack;
-		if (!_running || !_priv_jack) {
-			return 0;
-		}
-		return jack_frame_time (_priv_jack);
-	}
-
-	pframes_t frame_time_at_cycle_start () {
-  	        jack_client_t* _priv_jack = _jack;
-		if (!_running || !_priv_jack) {
-			return 0;
-		}
-		return jack_last_frame_time (_priv_jack);
-	}
-
-	pframes_t transport_frame () const {
-  	        const jack_client_t* _priv_jack = _jack;
-		if (!_running || !_priv_jack) {
-			return 0;
-		}
-		return jack_get_current_transport_frame (_priv_jack);
-	}
+	pframes_t frames_since_cycle_start ();
+	pframes_t frame_time ();
+	pframes_t frame_time_at_cycle_start ();
+	pframes_t transport_frame () const;
 
 	int request_buffer_size (pframes_t);
 
 	framecnt_t set_monitor_check_interval (framecnt_t);
 	framecnt_t processed_frames() const { return _processed_frames; }
 
-	float get_cpu_load() {
-  	        jack_client_t* _priv_jack = _jack;
-		if (!_running || !_priv_jack) {
-			return 0;
-		}
-		return jack_cpu_load (_priv_jack);
-	}
+	float get_cpu_load();
 
 	void set_session (Session *);
 	void remove_session (); // not a replacement for SessionHandle::session_going_away()
@@ -169,6 +147,7 @@ public:
 	Port *register_input_port (DataType, const std::string& portname);
 	Port *register_output_port (DataType, const std::string& portname);
 	int   unregister_port (Port &);
+	void  port_renamed (const std::string& old_relative_name, const std::string& new_relative_name);
 
 	bool port_is_physical (const std::string&) const;
 	void ensure_monitor_input (const std::string&, bool) const;
@@ -261,12 +240,31 @@ _	   the regular process() call to session->process() is not made.
 	void died ();
 
 	int create_process_thread (boost::function<void()>, pthread_t*, size_t stacksize);
+	/** @return priority to give to our own process threads, or 0 if they should not be realtime */
+	int client_real_time_priority ();
+
+	/* These are called by the backend, from whichever of its threads
+	   the event happens in, and should not be called by anything else.
+	*/
+
+	static void thread_init_callback ();
+	void process_thread_init ();
+	int  process_callback (pframes_t nframes);
+	int  sample_rate_callback (pframes_t);
+	int  buffer_size_callback (pframes_t);
+	void freewheel_callback (bool);
+	void latency_callback (bool for_playback);
+	void graph_order_callback ();
+	void xrun_callback ();
+	void port_registration_callback ();
+	void port_connect_callback (std::string const &, std::string const &, bool);
+	void halted_callback (const char* reason);
 
 private:
 	static AudioEngine*       _instance;
 
-	jack_client_t* volatile   _jack; /* could be reset to null by SIGPIPE or another thread */
-	std::string                jack_client_name;
+	AudioBackend*             _backend;
+	std::string               _client_name;
 	Glib::Mutex               _process_lock;
 	Glib::Cond                 session_removed;
 	bool                       session_remove_pending;
@@ -290,10 +288,12 @@ private:
 
 	SerializedRCUManager<Ports> ports;
 
+	/** our ports, keyed by their relative names; written with the ports RCU writer held */
+	typedef boost::unordered_map<std::string, Port*> PortMap;
+	SerializedRCUManager<PortMap> ports_by_name;
+
 	Port* register_port (DataType type, const std::string& portname, bool input);
 
-	int    process_callback (pframes_t nframes);
-	void*  process_thread ();
 	void   remove_all_ports ();
 
 	ChanCount n_physical (unsigned long) const;
@@ -301,35 +301,7 @@ private:
 
 	void port_registration_failure (const std::string& portname);
 
-	static int  _xrun_callback (void *arg);
-#ifdef HAVE_JACK_SESSION
-	static void _session_callback (jack_session_event_t *event, void *arg);
-#endif
-	static int  _graph_order_callback (void *arg);
-	static int  _process_callback (pframes_t nframes, void *arg);
-	static void* _process_thread (void *arg);
-	static int  _sample_rate_callback (pframes_t nframes, void *arg);
-	static int  _bufsize_callback (pframes_t nframes, void *arg);
-	static void _jack_timebase_callback (jack_transport_state_t, pframes_t, jack_position_t*, int, void*);
-	static int  _jack_sync_callback (jack_transport_state_t, jack_position_t*, void *arg);
-	static void _freewheel_callback (int , void *arg);
-	static void _registration_callback (jack_port_id_t, int, void *);
-	static void _connect_callback (jack_port_id_t, jack_port_id_t, int, void *);
-
-	void jack_timebase_callback (jack_transport_state_t, pframes_t, jack_position_t*, int);
-	int  jack_sync_callback (jack_transport_state_t, jack_position_t*);
-	int  jack_bufsize_callback (pframes_t);
-	int  jack_sample_rate_callback (pframes_t);
-
-	void set_jack_callbacks ();
-
-	static void _latency_callback (jack_latency_callback_mode_t, void*);
-	void jack_latency_callback (jack_latency_callback_mode_t);
-
-	int connect_to_jack (std::string client_name, std::string session_uuid);
-
-	static void halted (void *);
-	static void halted_info (jack_status_t,const char*,void *);
+	int connect_to_backend (std::string client_name, std::string session_uuid);
 
 	void meter_thread ();
 	void start_metering_thread ();
@@ -339,17 +311,6 @@ private:
 	static gint      m_meter_exit;
 
 	ProcessThread* _main_thread;
-
-	struct ThreadData {
-		AudioEngine* engine;
-		boost::function<void()> f;
-		size_t stacksize;
-
-		ThreadData (AudioEngine* ae, boost::function<void()> fp, size_t stacksz)
-		: engine (ae) , f (fp) , stacksize (stacksz) {}
-	};
-
-	static void* _start_process_thread (void*);
 };
 
 } // namespace ARDOUR
@@ -79,6 +79,7 @@ public:
 	void clear (bool with_signals=true);
 
 	framecnt_t read (Sample *dst, Sample *mixdown, float *gain_buffer, framepos_t start, framecnt_t cnt, uint32_t chan_n=0);
+	framecnt_t read (Sample **dst, uint32_t n_dst, Sample *mixdown, float *gain_buffer, framepos_t start, framecnt_t cnt, uint32_t first_chan=0);
 
 	int set_state (const XMLNode&, int version);
 
@@ -114,6 +114,9 @@ class AudioRegion : public Region
 				    framecnt_t cnt,
 				    uint32_t   chan_n = 0) const;
 
+	framecnt_t read_at (Sample **bufs, uint32_t n_bufs, Sample *mixdown_buf, float *gain_buf,
+			    framepos_t position, framecnt_t cnt, uint32_t first_chan = 0) const;
+
 	virtual framecnt_t master_read_at (Sample *buf, Sample *mixdown_buf, float *gain_buf,
 					   framepos_t position, framecnt_t cnt, uint32_t chan_n=0) const;
 
@@ -212,6 +215,32 @@ class AudioRegion : public Region
 			     uint32_t chan_n = 0,
 			     ReadOps readops = ReadOps (~0)) const;
 
+	framecnt_t read_extent (framecnt_t limit, framepos_t position, framecnt_t& cnt,
+				frameoffset_t& internal_offset, frameoffset_t& buf_offset) const;
+
+	/** The gain for a read: gain_buffer[n] * scale for n in one of up to two
+	 *  ranges (in order, and not overlapping), and scale alone elsewhere.
+	 */
+	struct ReadGain {
+		ReadGain (float s = 1.0f) : n_ranges (0), scale (s) {}
+
+		void add_range (framecnt_t s, framecnt_t e) {
+			start[n_ranges] = s;
+			end[n_ranges] = e;
+			++n_ranges;
+		}
+
+		framecnt_t start[2];
+		framecnt_t end[2];
+		uint32_t   n_ranges;
+		float      scale;
+	};
+
+	void compute_read_gain (ReadGain& g, Sample *mixdown_buffer, float *gain_buffer, float *curve_buffer,
+				frameoffset_t internal_offset, framecnt_t to_read, framecnt_t limit, ReadOps rops) const;
+	void apply_read_gain (ReadGain const & g, Sample *buf, Sample *mixdown_buffer, float const *gain_buffer,
+			      framecnt_t to_read) const;
+
 	void recompute_at_start ();
 	void recompute_at_end ();
 
@@ -56,6 +56,24 @@ class AudioSource : virtual public Source,
 	virtual framecnt_t available_peaks (double zoom) const;
 
 	virtual framecnt_t read (Sample *dst, framepos_t start, framecnt_t cnt, int channel=0) const;
+
+	/** Read the same range of several channels of this source's file.
+	 *  @param dst One destination per channel, each with room for @a cnt samples.
+	 *  @param chans The file channel to deliver into each destination. Each must
+	 *  be file_channel() of this source or of a source for which
+	 *  shares_file_with() is true.
+	 *  @param n Number of entries in @a dst and @a chans.
+	 *  @return number of frames read into each destination.
+	 */
+	framecnt_t read_channels (Sample** dst, uint16_t const * chans, uint32_t n, framepos_t start, framecnt_t cnt) const;
+
+	/** @return the channel of the underlying file that this source reads */
+	virtual uint16_t file_channel () const { return 0; }
+
+	/** @return true if @a other reads a different channel of the same interleaved
+	 *  file, so that read_channels() on this source can deliver its data too.
+	 */
+	virtual bool shares_file_with (AudioSource const & /*other*/) const { return false; }
 	virtual framecnt_t write (Sample *src, framecnt_t cnt);
 
 	virtual float sample_rate () const = 0;
@@ -64,7 +82,7 @@ class AudioSource : virtual public Source,
 
 	virtual bool can_truncate_peaks() const { return true; }
 
-	void set_captured_for (std::string str) { _captured_for = str; }
+	void set_captured_for (std::string str) { _captured_for = str; StateChanged (); }
 	std::string captured_for() const { return _captured_for; }
 
 	uint32_t read_data_count() const { return _read_data_count; }
@@ -86,6 +104,8 @@ class AudioSource : virtual public Source,
 	int rename_peakfile (std::string newpath);
 	void touch_peakfile ();
 
+	static int remove_peakfile (std::string const & path);
+
 	static void set_build_missing_peakfiles (bool yn) {
 		_build_missing_peakfiles = yn;
 	}
@@ -142,7 +162,19 @@ class AudioSource : virtual public Source,
 
 	mutable off_t _peak_byte_max; // modified in compute_and_write_peak()
 
+	/** The peakfile proper is level 0 of a pyramid of peak data; each level above
+	 *  it has peak_level_factor times the frames per peak of the one below, and is
+	 *  kept in its own file alongside the peakfile.
+	 */
+	static const uint32_t   peak_levels = 3;
+	static const framecnt_t peak_level_factor = 16;
+
+	static std::string peak_level_path (std::string const & path, uint32_t level);
+	static framecnt_t  level_fpp (uint32_t level);
+
 	virtual framecnt_t read_unlocked (Sample *dst, framepos_t start, framecnt_t cnt) const = 0;
+	virtual framecnt_t read_channels_unlocked (Sample** dst, uint16_t const * chans, uint32_t n,
+	                                           framepos_t start, framecnt_t cnt) const;
 	virtual framecnt_t write_unlocked (Sample *dst, framecnt_t cnt) = 0;
 	virtual std::string peak_path(std::string audio_path) = 0;
 	virtual std::string find_broken_peakfile (std::string missing_peak_path,
@@ -172,6 +204,33 @@ class AudioSource : virtual public Source,
 	framecnt_t peak_leftover_size;
 	Sample*    peak_leftovers;
 	framepos_t peak_leftover_frame;
+
+	struct PeakLevel {
+		PeakLevel () : descriptor (0), fd (-1), byte_max (0), map (0), map_size (0) {}
+
+		PBD::FdFileDescriptor* descriptor; ///< open while peaks are being written
+		int        fd;
+		off_t      byte_max;               ///< end of the valid data in the file
+		PeakData*  map;                    ///< read-only mapping of the file, or 0
+		size_t     map_size;
+	};
+
+	/** The levels of the peak pyramid.  Level 0 is the peakfile itself, which is
+	 *  written through _peakfile_fd and whose extent is _peak_byte_max, so only
+	 *  the mapping fields of its entry are used.
+	 */
+	mutable PeakLevel _peak_level[peak_levels];
+	/** Protects the mappings in _peak_level */
+	mutable Glib::Mutex _peak_map_lock;
+
+	int  open_peak_levels ();
+	void close_peak_levels ();
+	int  update_peak_levels (framepos_t first_peak, framecnt_t npeaks);
+	int  check_peak_levels (time_t peakfile_mtime);
+	int  build_peak_levels ();
+	off_t peak_level_byte_max (uint32_t level) const;
+	framecnt_t read_peak_data (uint32_t level, PeakData* dst, framepos_t first_peak, framecnt_t npeaks) const;
+	void drop_peak_maps () const;
 };
 
 }
@@ -22,6 +22,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <vector>
 #include <cmath>
 
 #include <glibmm/thread.h>
@@ -29,6 +30,7 @@
 #include "pbd/undo.h"
 #include "pbd/xml++.h"
 #include "pbd/statefuldestructible.h"
+#include "pbd/property_basics.h"
 
 #include "ardour/ardour.h"
 
@@ -36,6 +38,78 @@
 
 namespace ARDOUR {
 
+class AutomationList;
+
+namespace Properties {
+	/* fake the type, since the points are handled by AutomationEventsProperty
+	   which doesn't care about such things.
+	*/
+	extern PBD::PropertyDescriptor<bool> events;
+}
+
+/** A property which records changes to the points of an AutomationList
+ *  as the range of points which was replaced, and the points which
+ *  replaced it, so that undo history holds only the points which were
+ *  edited.  clear_changes() takes a copy of the list's points to compare
+ *  with later, so it must be called before the edit is made; the copy is
+ *  dropped once get_changes_as_properties() has recorded the edit.
+ */
+class AutomationEventsProperty : public PBD::PropertyBase
+{
+  public:
+	AutomationEventsProperty (AutomationList &);
+	AutomationEventsProperty (AutomationEventsProperty const &);
+
+	struct Point {
+		Point (double w, double v) : when (w), value (v) {}
+
+		bool operator== (Point const & other) const {
+			return when == other.when && value == other.value;
+		}
+
+		double when;
+		double value;
+	};
+
+	typedef std::vector<Point> Points;
+
+	/* the list's state is saved by the list */
+	bool set_value (XMLNode const &) { return false; }
+	void get_value (XMLNode &) const {}
+
+	void clear_changes ();
+	bool changed () const;
+	void invert ();
+
+	void get_changes_as_xml (XMLNode *) const;
+	void get_changes_as_properties (PBD::PropertyList &, Command *) const;
+	AutomationEventsProperty* clone_from_xml (XMLNode const &) const;
+
+	AutomationEventsProperty* clone () const;
+	void apply_changes (PBD::PropertyBase const *);
+	size_t approximate_size () const;
+
+  private:
+	AutomationEventsProperty ();
+
+	/** list whose points we describe, or 0 if we are just a record of changes */
+	AutomationList* _list;
+	/** the list's points when clear_changes() was last called, until the
+	 *  change since then has been recorded
+	 */
+	mutable Points _old_points;
+	mutable bool _have_old;
+
+	void drop_old_points () const;
+
+	/* the change: points from _offset to _offset + _removed.size()
+	   were replaced by _added
+	*/
+	size_t _offset;
+	Points _removed;
+	Points _added;
+};
+
 class AutomationList : public PBD::StatefulDestructible, public Evoral::ControlList
 {
   public:
@@ -82,7 +156,15 @@ class AutomationList : public PBD::StatefulDestructible, public Evoral::ControlL
 	XMLNode& state (bool full);
 	XMLNode& serialize_events ();
 
+	static void make_property_quarks ();
+
   private:
+	friend class AutomationEventsProperty;
+
+	void register_properties ();
+	void get_points (AutomationEventsProperty::Points &) const;
+	bool replace_points (size_t offset, AutomationEventsProperty::Points const & removed, AutomationEventsProperty::Points const & added);
+
 	void create_curve_if_necessary ();
 	int deserialize_events (const XMLNode&);
 
@@ -91,6 +173,8 @@ class AutomationList : public PBD::StatefulDestructible, public Evoral::ControlL
 	AutoState    _state;
 	AutoStyle    _style;
 	gint         _touching;
+
+	AutomationEventsProperty _events_property;
 };
 
 } // namespace
@@ -20,6 +20,10 @@
 #ifndef __ardour_butler_h__
 #define __ardour_butler_h__
 
+#include <deque>
+#include <set>
+#include <vector>
+
 #include <glibmm/thread.h>
 
 #include "pbd/ringbuffer.h"
@@ -29,6 +33,8 @@
 
 namespace ARDOUR {
 
+class Track;
+
 /**
  *  One of the Butler's functions is to clean up (ie delete) unused CrossThreadPools.
  *  When a thread with a CrossThreadPool terminates, its CTP is added to pool_trash.
@@ -61,6 +67,9 @@ class Butler : public SessionHandleRef
 	static void* _thread_work(void *arg);
 	void*         thread_work();
 
+	static void* _disk_worker_work(void *arg);
+	void*         disk_worker_work();
+
 	struct Request {
 		enum Type {
 			Wake,
@@ -84,6 +93,56 @@ class Butler : public SessionHandleRef
 private:
 	void empty_pool_trash ();
 	void config_changed (std::string);
+
+	/** One diskstream's worth of butler work: either writing its
+	 *  capture buffer to disk, or refilling its playback buffer.
+	 */
+	struct DiskJob {
+		DiskJob () : load (0), flush (false) {}
+		DiskJob (boost::shared_ptr<Track> t, float l, bool f) : track (t), load (l), flush (f) {}
+
+		bool operator< (DiskJob const & other) const { return load < other.load; }
+
+		boost::shared_ptr<Track> track;
+		/** fill level for playback, free space for capture; in both
+		    cases the lowest value is the most urgent.
+		*/
+		float load;
+		bool  flush;
+	};
+
+	/* the butler thread and the (optional) extra disk workers all
+	   take jobs from these queues, capture flushes first.
+	*/
+	Glib::Mutex          disk_work_lock;
+	Glib::Cond           disk_work_available;
+	Glib::Cond           disk_work_done;
+	std::deque<DiskJob>  flush_queue;
+	std::deque<DiskJob>  refill_queue;
+	/** tracks with a job in progress; a track's flush and refill
+	    are never run at the same time.
+	*/
+	std::set<Track*>     busy_tracks;
+	uint32_t             disk_jobs_in_progress;
+	bool                 disk_workers_should_quit;
+	std::vector<pthread_t> disk_workers;
+
+	/* results of the current pass, protected by disk_work_lock */
+	int32_t  pass_bytes_read;
+	int32_t  pass_bytes_written;
+	uint32_t pass_write_errors;
+	bool     pass_read_failed;
+	bool     pass_work_outstanding;
+
+	void start_disk_workers ();
+	void stop_disk_workers ();
+	void queue_disk_work (RouteList const & flush_routes, RouteList const & refill_routes);
+	void do_disk_work ();
+	bool next_disk_job (DiskJob&);
+	bool take_disk_job (std::deque<DiskJob>&, DiskJob&);
+	void run_disk_job (DiskJob const &);
+	void finish_disk_job (DiskJob const &);
+	void abandon_disk_work_if_interrupted ();
 };
 
 } // namespace ARDOUR
@@ -121,6 +121,7 @@ class Crossfade : public ARDOUR::AudioRegion
 	OverlapType coverage (framepos_t start, framepos_t end) const;
 
 	static void set_buffer_size (framecnt_t);
+	static void allocate_thread_buffers ();
 
 	bool active () const { return _active; }
 	void set_active (bool yn);
@@ -165,6 +166,7 @@ class Crossfade : public ARDOUR::AudioRegion
 	mutable AutomationList _fade_in;
 	mutable AutomationList _fade_out;
 
+	static framecnt_t _buffer_size;
 	static Sample* crossfade_buffer_out;
 	static Sample* crossfade_buffer_in;
 
@@ -0,0 +1,159 @@
+/*
+    Copyright (C) 2011 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_dsp_profiler_h__
+#define __ardour_dsp_profiler_h__
+
+#include <map>
+#include <list>
+
+#include <pthread.h>
+#include <glib.h>
+#include <glibmm/thread.h>
+
+#include "pbd/ringbuffer.h"
+
+#include "ardour/cycles.h"
+
+namespace ARDOUR {
+
+/** Summary of the time taken by one route's or processor's
+ *  process cycles since the profiler was last reset.  All times
+ *  are in microseconds.
+ */
+struct DSPStats {
+	DSPStats () : count (0), min (0), max (0), avg (0), p50 (0), p95 (0), p99 (0) {}
+
+	uint64_t count;
+	double min;
+	double max;
+	double avg;
+	double p50;
+	double p95;
+	double p99;
+};
+
+/** Collects the time spent in each route and processor on the
+ *  process graph's threads.
+ *
+ *  Each DSP thread writes (object, cycles) measurements into its own
+ *  ring buffer, which is lock-free and allocation-free.  A
+ *  non-realtime thread drains the ring buffers a few times a second
+ *  and folds the measurements into per-object histograms, from which
+ *  get_stats() computes min/avg/max and percentiles.
+ *
+ *  Objects are identified only by address; the profiler never
+ *  dereferences them.
+ */
+class DSPProfiler
+{
+  public:
+	DSPProfiler ();
+	~DSPProfiler ();
+
+	void set_enabled (bool);
+	bool enabled () const { return g_atomic_int_get (&_enabled); }
+
+	/* called by each DSP thread as it starts and stops; these may
+	   allocate, so must not be called from the process loop.
+	*/
+	void register_thread ();
+	void unregister_thread ();
+
+	/** Record one measurement for @param who.  RT-safe; does nothing if
+	 *  profiling is disabled or if called from a thread that has not
+	 *  been registered.
+	 */
+	void record (void const * who, cycles_t cycles) {
+		if (!g_atomic_int_get (&_enabled)) {
+			return;
+		}
+		ThreadBuffer* tb = (ThreadBuffer*) pthread_getspecific (_thread_key);
+		if (tb) {
+			Measurement m;
+			m.who = who;
+			m.cycles = cycles;
+			if (tb->measurements.write (&m, 1) != 1) {
+				g_atomic_int_inc (&_dropped);
+			}
+		}
+	}
+
+	bool get_stats (void const * who, DSPStats&);
+	void forget (void const * who);
+	void reset ();
+
+	/** @return number of measurements lost because a ring buffer was full */
+	uint32_t dropped () const { return g_atomic_int_get (&_dropped); }
+
+  private:
+	struct Measurement {
+		void const * who;
+		cycles_t cycles;
+	};
+
+	struct ThreadBuffer {
+		ThreadBuffer () : measurements (32768), retired (false) {}
+		RingBuffer<Measurement> measurements;
+		bool retired;
+	};
+
+	/* quarter-octave histogram of cycle counts, from 1 to 2^48 cycles */
+	static const uint32_t histogram_buckets = 192;
+
+	struct Accumulator {
+		Accumulator ();
+		void add (cycles_t);
+		cycles_t percentile (double) const;
+
+		uint64_t count;
+		cycles_t min;
+		cycles_t max;
+		double   total;
+		uint32_t histogram[histogram_buckets];
+	};
+
+	typedef std::map<void const *, Accumulator> Accumulators;
+
+	pthread_key_t            _thread_key;
+	mutable volatile gint    _enabled;
+	mutable volatile gint    _dropped;
+
+	Glib::Mutex              _buffers_lock;
+	std::list<ThreadBuffer*> _buffers;
+
+	Glib::Mutex              _stats_lock;
+	Accumulators             _stats;
+	float                    _cycles_per_usec;
+
+	Glib::Thread*            _collector_thread;
+	volatile gint            _collector_exit;
+
+	void start_collector_thread ();
+	void stop_collector_thread ();
+	void collector_thread ();
+	void collect ();
+
+	static uint32_t bucket_for (cycles_t);
+	static cycles_t bucket_value (uint32_t);
+};
+
+} // namespace ARDOUR
+
+#endif /* __ardour_dsp_profiler_h__ */
@@ -0,0 +1,204 @@
+/*
+    Copyright (C) 2011 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_dummy_audio_backend_h__
+#define __ardour_dummy_audio_backend_h__
+
+#include <string>
+#include <vector>
+
+#include <glib.h>
+#include <glibmm/thread.h>
+
+#include "ardour/audio_backend.h"
+
+namespace ARDOUR {
+
+struct DummyPort;
+
+/** AudioBackend which needs no audio hardware and no server.  It runs
+ *  the process cycle from a thread of its own, either in real time or
+ *  as fast as it can, and provides a set of `physical' ports: capture
+ *  ports carry silence, a test signal, or the contents of a sound file,
+ *  and whatever is sent to the playback ports is thrown away.
+ *
+ *  It is intended for running sessions headless, for tests and for
+ *  benchmarking the process path: in FreeRunning mode, cpu_load() says
+ *  how much of each nominal cycle period was actually spent processing,
+ *  so 100 divided by it is how many times faster than real time the
+ *  session can run on this machine.
+ */
+class DummyAudioBackend : public AudioBackend
+{
+public:
+	enum Mode {
+		/** Run one cycle every buffer_size / sample_rate seconds */
+		Realtime,
+		/** Run each cycle as soon as the previous one has finished */
+		FreeRunning
+	};
+
+	enum InputSignal {
+		Silence,
+		/** a sine wave at 440Hz on the first capture port, 880Hz on the second and so on */
+		Sine,
+		/** white noise */
+		Noise,
+		/** the file given to set_input_file(), looped */
+		File
+	};
+
+	DummyAudioBackend (framecnt_t sample_rate = 48000, pframes_t buffer_size = 1024, Mode mode = Realtime);
+	~DummyAudioBackend ();
+
+	/** Set the number of physical ports that will be created by the next open() */
+	void set_physical_ports (uint32_t audio_capture, uint32_t audio_playback, uint32_t midi_capture, uint32_t midi_playback);
+	void set_input_signal (InputSignal);
+	/** Read a sound file to play into the audio capture ports; channel n
+	 *  of the file feeds port n, wrapping around if the file has fewer
+	 *  channels than there are ports.
+	 *  @return 0 on success.
+	 */
+	int set_input_file (std::string const & path);
+
+	Mode mode () const { return _mode; }
+	void set_mode (Mode m) { _mode = m; }
+
+	/** @return number of process cycles run since start() */
+	uint64_t cycles () const { return _cycles; }
+	/** @return number of cycles that finished too late, in Realtime mode */
+	uint32_t xruns () const { return _xruns; }
+	/** @return total time spent in the engine's process callback since start(), in microseconds */
+	int64_t process_usecs () const { return _process_usecs; }
+
+	std::string name () const { return "Dummy"; }
+
+	int open (std::string const & client_name, std::string const & session_uuid);
+	int close ();
+	bool connected () const { return _connected; }
+	std::string client_name () const { return _client_name; }
+
+	int start ();
+	int stop ();
+
+	bool is_realtime () const { return false; }
+	int client_real_time_priority () { return 0; }
+	int create_process_thread (boost::function<void()> f, pthread_t* thread, size_t stacksize);
+
+	framecnt_t sample_rate () const { return _sample_rate; }
+	pframes_t buffer_size () const { return _buffer_size; }
+	int set_buffer_size (pframes_t);
+	size_t raw_buffer_size (DataType) const;
+
+	pframes_t frames_since_cycle_start () const;
+	pframes_t frame_time () const;
+	pframes_t frame_time_at_cycle_start () const { return _frame_time; }
+
+	/** @return percentage of the nominal cycle period spent processing, averaged over recent cycles */
+	float cpu_load () const { return _cpu_load; }
+
+	int freewheel (bool);
+
+	PortHandle register_port (std::string const & shortname, DataType type, uint32_t flags);
+	void unregister_port (PortHandle);
+	int set_port_name (PortHandle, std::string const & shortname);
+	PortHandle get_port_by_name (std::string const &) const;
+	uint32_t port_flags (PortHandle) const;
+	DataType port_data_type (PortHandle) const;
+
+	const char** get_ports (std::string const & port_name_pattern, std::string const & type_name_pattern, uint32_t flags) const;
+
+	int connect (std::string const & src, std::string const & dst);
+	int disconnect (std::string const & src, std::string const & dst);
+	int disconnect_all (PortHandle);
+	bool connected (PortHandle) const;
+	bool connected_to (PortHandle, std::string const &) const;
+	int get_connections (PortHandle, std::vector<std::string>&) const;
+
+	bool can_monitor_input () const { return false; }
+	int ensure_monitor_input (PortHandle, bool);
+	int request_monitor_input (PortHandle, bool);
+	bool monitoring_input (PortHandle) const;
+
+	void set_latency_range (PortHandle, bool playback, jack_latency_range_t);
+	jack_latency_range_t get_latency_range (PortHandle, bool playback) const;
+
+	void* get_buffer (PortHandle, pframes_t);
+
+	uint32_t midi_event_count (void* buf) const;
+	int midi_event_get (pframes_t& timestamp, size_t& size, uint8_t const** data, void* buf, uint32_t index) const;
+	int midi_event_put (void* buf, pframes_t timestamp, uint8_t const* data, size_t size);
+	void midi_clear (void* buf);
+
+private:
+	std::string       _client_name;
+	framecnt_t        _sample_rate;
+	pframes_t         _buffer_size;
+	volatile Mode     _mode;
+	bool              _connected;
+
+	uint32_t          _n_audio_capture;
+	uint32_t          _n_audio_playback;
+	uint32_t          _n_midi_capture;
+	uint32_t          _n_midi_playback;
+
+	InputSignal        _input_signal;
+	std::vector<float> _input_file_data; ///< interleaved
+	uint32_t           _input_file_channels;
+
+	/** all ports, ours and the physical ones; protected by _port_lock, which
+	 *  the process thread holds for the duration of each cycle
+	 */
+	std::vector<DummyPort*> _ports;
+	mutable Glib::RecMutex  _port_lock;
+
+	pthread_t         _process_thread;
+	gint              _running;
+	gint              _freewheel_requested;
+	bool              _freewheeling;
+	gint              _pending_buffer_size;
+
+	volatile pframes_t _frame_time;       ///< frame time at the start of the current cycle
+	volatile int64_t   _cycle_start_usecs;
+	volatile float     _cpu_load;
+	volatile uint64_t  _cycles;
+	volatile uint32_t  _xruns;
+	volatile int64_t   _process_usecs;
+
+	static void* _process_thread_entry (void *);
+	void* process_thread ();
+	void fill_capture_buffers (pframes_t nframes);
+	void apply_buffer_size (pframes_t nframes);
+
+	void create_physical_ports ();
+	DummyPort* find_port (std::string const &) const;
+	void allocate_buffer (DummyPort*);
+
+	struct ThreadData {
+		boost::function<void()> f;
+
+		ThreadData (boost::function<void()> fp) : f (fp) {}
+	};
+
+	static void* _start_process_thread (void*);
+};
+
+} // namespace ARDOUR
+
+#endif /* __ardour_dummy_audio_backend_h__ */
@@ -29,7 +29,6 @@
 #include "audiographer/utils/identity_vertex.h"
 
 #include <boost/ptr_container/ptr_list.hpp>
-#include <glibmm/threadpool.h>
 
 namespace AudioGrapher {
 	class SampleRateConverter;
@@ -61,11 +60,17 @@ class ExportGraphBuilder
 	ExportGraphBuilder (Session const & session);
 	~ExportGraphBuilder ();
 
-	int process (framecnt_t frames, bool last_cycle);
+	/** Pass a block of session output to every timespan which covers some of it.
+	 *  Each timespan is told that its input has ended in the block which reaches its end.
+	 *  @param frames Number of frames in the block.
+	 *  @param position Session position of the start of the block.
+	 */
+	int process (framecnt_t frames, framepos_t position);
 	bool process_normalize (); // returns true when finished
 	bool will_normalize() { return !normalizers.empty(); }
 
 	void reset ();
+	/// Subsequent calls to add_config() add files for this timespan
 	void set_current_timespan (boost::shared_ptr<ExportTimespan> span);
 	void add_config (FileSpec const & config);
 
@@ -214,21 +219,42 @@ class ExportGraphBuilder
 		framecnt_t                max_frames;
 	};
 
+	typedef boost::ptr_list<ChannelConfig> ChannelConfigList;
+
+	// The processor trees for one timespan
+	class Timespan {
+	  public:
+		Timespan (boost::shared_ptr<ExportTimespan> span) : span (span), finished (false) {}
+
+		boost::shared_ptr<ExportTimespan> span;
+		ChannelConfigList channel_configs; // roots for export processor trees
+		ChannelMap        channels;        // inputs of the trees
+		bool              finished;        // true once the end of the timespan has been processed
+	};
+
+	// A timespan's input for an export channel
+	struct ChannelOutput {
+		ChannelOutput (Timespan * timespan, IdentityVertexPtr vertex) : timespan (timespan), vertex (vertex) {}
+
+		Timespan *        timespan;
+		IdentityVertexPtr vertex;
+	};
+
+	typedef std::map<ExportChannelPtr, std::list<ChannelOutput> > ChannelOutputMap;
+
+	void map_channels ();
+
 	Session const & session;
 	boost::shared_ptr<ExportTimespan> timespan;
 
-	// Roots for export processor trees
-	typedef boost::ptr_list<ChannelConfig> ChannelConfigList;
-	ChannelConfigList channel_configs;
+	boost::ptr_list<Timespan> timespans;
 
-	// The sources of all data, each channel is read only once
-	ChannelMap channels;
+	// The sources of all data, each channel is read only once for all timespans
+	ChannelOutputMap channels;
 
 	framecnt_t process_buffer_frames;
 
 	std::list<Normalizer *> normalizers;
-
-	Glib::ThreadPool thread_pool;
 };
 
 } // namespace ARDOUR
@@ -127,16 +127,20 @@ class ExportHandler : public ExportElementFactory
 	bool               realtime;
 	bool               normalizing;
 
-	/* Timespan management */
+	/* Timespan management
+	 * Timespans which overlap are exported together, in one pass over
+	 * the union of their ranges.
+	 */
 
-	void start_timespan ();
-	int  process_timespan (framecnt_t frames);
+	void start_pass ();
+	int  process_pass (framecnt_t frames);
 	int  process_normalize ();
-	void finish_timespan ();
+	void finish_pass ();
 
-	typedef std::pair<ConfigMap::iterator, ConfigMap::iterator> TimespanBounds;
-	ExportTimespanPtr     current_timespan;
-	TimespanBounds        timespan_bounds;
+	typedef std::list<ExportTimespanPtr> TimespanList;
+	TimespanList          pass_timespans;
+	framepos_t            pass_end;
+	uint32_t              timespans_done;
 
 	PBD::ScopedConnection process_connection;
 	framepos_t             process_position;
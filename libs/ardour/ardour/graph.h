@@ -34,9 +34,11 @@
 #include <pthread.h>
 
 #include "pbd/semutils.h"
+#include "pbd/work_stealing_deque.h"
 
 #include "ardour/types.h"
 #include "ardour/session_handle.h"
+#include "ardour/dsp_profiler.h"
 
 namespace ARDOUR
 {
@@ -70,7 +72,7 @@ public:
 	void restart_cycle();
 
 	bool run_one();
-	void helper_thread();
+	void helper_thread(uint32_t id);
 	void main_thread();
 
 	int silent_process_routes (pframes_t nframes, framepos_t start_frame, framepos_t end_frame,
@@ -88,6 +90,8 @@ public:
 
 	bool in_process_thread () const;
 
+	DSPProfiler& dsp_profiler () { return _dsp_profiler; }
+
 protected:
 	virtual void session_going_away ();
 
@@ -100,6 +104,35 @@ private:
 	void reset_thread_list ();
 	void drop_threads ();
 
+	/* state private to one DSP thread when using WorkStealingScheduling */
+	struct Worker {
+		Worker (uint32_t i) : id (i), queue (8192) {}
+
+		uint32_t id;
+		PBD::WorkStealingDeque<GraphNode> queue;
+	};
+
+	std::vector<Worker*> _workers;
+	pthread_key_t        _worker_key;
+	bool                 _work_stealing;
+	volatile gint        _shared_queue_size;
+
+	void start_worker (uint32_t id);
+	bool run_one_shared ();
+	bool run_one_stealing ();
+	GraphNode* find_work (Worker* self);
+	bool work_available () const;
+	bool claim_execution_token ();
+
+	void queue_ready_node (GraphNode*);
+	void run_node (GraphNode*);
+
+	struct CriticalPathSorter {
+		CriticalPathSorter (int c) : chain (c) {}
+		bool operator() (node_ptr_t const & a, node_ptr_t const & b) const;
+		int chain;
+	};
+
 	node_list_t _nodes_rt[2];
 
 	node_list_t _init_trigger_list[2];
@@ -139,6 +172,8 @@ private:
 	bool _process_noroll;
 	int	 _process_retval;
 	bool _process_need_butler;
+
+	DSPProfiler _dsp_profiler;
 };
 
 } // namespace
@@ -27,9 +27,12 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include "ardour/cycles.h"
+
 namespace ARDOUR
 {
 
+class DSPProfiler;
 class Graph;
 class GraphNode;
 
@@ -49,6 +52,15 @@ class GraphNode
 
 	virtual void process();
 
+	/** @return smoothed cost of one call to process(), in cycles */
+	cycles_t cost () const { return _cost; }
+	void add_cost_sample (cycles_t);
+
+	cycles_t critical_path (int chain) const { return _critical_path[chain]; }
+
+    protected:
+	DSPProfiler& dsp_profiler () const;
+
     private:
 	friend class Graph;
 
@@ -58,6 +70,17 @@ class GraphNode
 
 	gint _refcount;
 	gint _init_refcount[2];
+
+	/* written only by the thread running this node; read by
+	   Graph::rechain() without synchronization, as the result
+	   is only used as a scheduling hint.
+	*/
+	cycles_t _cost;
+
+	/** cost of the most expensive path from the start of this node
+	    to the end of the graph, as of the last rechain.
+	*/
+	cycles_t _critical_path[2];
 };
 
 }
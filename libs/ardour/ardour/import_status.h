@@ -47,6 +47,8 @@ struct ImportStatus : public InterThreadInfo {
 
 	/* result */
 	SourceList sources;
+	/** the sources for each of paths, in the same order */
+	std::vector<SourceList> path_sources;
 };
 
 } // namespace ARDOUR
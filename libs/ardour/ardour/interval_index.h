@@ -0,0 +1,394 @@
+/*
+    Copyright (C) 2011 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_interval_index_h__
+#define __ardour_interval_index_h__
+
+#include <vector>
+#include <set>
+#include <map>
+#include <algorithm>
+#include <limits>
+#include <sys/types.h>
+
+#include <boost/noncopyable.hpp>
+
+#include "ardour/types.h"
+
+namespace ARDOUR {
+
+/** An index of closed intervals [first, last] on the timeline, each carrying
+ *  a different value, which is kept up to date as intervals are added and
+ *  removed.
+ *
+ *  The intervals are sorted by start and split into blocks of at most
+ *  max_block_size, each of which records the greatest end of its intervals.
+ *  A segment tree over those ends finds each block that reaches into a query
+ *  in O(log n), so a query with k results costs O(log n + k), with a constant
+ *  of up to max_block_size per block looked inside.
+ *
+ *  Adding or removing an interval costs O(log n + max_block_size), except
+ *  that the segment tree is rebuilt, in O(n / max_block_size), when a block
+ *  is split or emptied.
+ */
+template<typename T>
+class IntervalIndex : public boost::noncopyable
+{
+  public:
+	IntervalIndex () : _size (0), _next_order (0), _leaves (0) {}
+	~IntervalIndex () { clear (); }
+
+	void clear () {
+		for (typename std::vector<Block*>::iterator b = _blocks.begin(); b != _blocks.end(); ++b) {
+			delete *b;
+		}
+		_blocks.clear ();
+		_keys.clear ();
+		_size = 0;
+		build_tree ();
+	}
+
+	/** Add an interval for @a value, which must not already have one.
+	 *  Intervals that start at the same frame keep the order they were added in.
+	 */
+	void add (framepos_t first, framepos_t last, T const & value) {
+		Entry const e (first, std::max (first, last), _next_order++, value);
+
+		_keys[value] = std::make_pair (e.first, e.order);
+		++_size;
+
+		if (_blocks.empty ()) {
+			Block* block = new Block;
+			block->entries.push_back (e);
+			block->max_last = e.last;
+			_blocks.push_back (block);
+			build_tree ();
+			return;
+		}
+
+		typename std::vector<Block*>::iterator b = block_for (e);
+		Block* block = *b;
+
+		block->entries.insert (std::upper_bound (block->entries.begin(), block->entries.end(), e), e);
+		block->max_last = std::max (block->max_last, e.last);
+
+		if (block->entries.size() > max_block_size) {
+			/* split it in two */
+			Block* after = new Block;
+			after->entries.assign (block->entries.begin() + max_block_size / 2, block->entries.end());
+			block->entries.erase (block->entries.begin() + max_block_size / 2, block->entries.end());
+			block->update ();
+			after->update ();
+			_blocks.insert (b + 1, after);
+			build_tree ();
+		} else {
+			update_tree (b - _blocks.begin());
+		}
+	}
+
+	/** Remove the interval carrying @a value.
+	 *  @return true if there was one.
+	 */
+	bool remove (T const & value) {
+		typename std::map<T, std::pair<framepos_t, size_t> >::iterator k = _keys.find (value);
+
+		if (k == _keys.end()) {
+			return false;
+		}
+
+		Entry const e (k->second.first, k->second.first, k->second.second, T());
+		typename std::vector<Block*>::iterator b = block_for (e);
+		Block* block = *b;
+
+		block->entries.erase (std::lower_bound (block->entries.begin(), block->entries.end(), e));
+
+		if (block->entries.empty ()) {
+			delete block;
+			_blocks.erase (b);
+			build_tree ();
+		} else {
+			block->update ();
+			update_tree (b - _blocks.begin());
+		}
+
+		_keys.erase (k);
+		--_size;
+		return true;
+	}
+
+	bool empty () const { return _size == 0; }
+	size_t size () const { return _size; }
+
+	/** Append the values of every interval that overlaps [first, last] to @a result,
+	 *  in order of start.
+	 */
+	void overlapping (framepos_t first, framepos_t last, std::vector<T>& result) const {
+		size_t const end = blocks_starting_by (last);
+		for (size_t b = next_block (0, end, first); b < end; b = next_block (b + 1, end, first)) {
+			Block const * block = _blocks[b];
+			for (typename std::vector<Entry>::const_iterator i = block->entries.begin(); i != block->entries.end() && i->first <= last; ++i) {
+				if (i->last >= first) {
+					result.push_back (i->value);
+				}
+			}
+		}
+	}
+
+	/** @return the number of intervals that overlap [first, last] */
+	size_t count_overlapping (framepos_t first, framepos_t last) const {
+		size_t n = 0;
+		size_t const end = blocks_starting_by (last);
+		for (size_t b = next_block (0, end, first); b < end; b = next_block (b + 1, end, first)) {
+			Block const * block = _blocks[b];
+			for (typename std::vector<Entry>::const_iterator i = block->entries.begin(); i != block->entries.end() && i->first <= last; ++i) {
+				if (i->last >= first) {
+					++n;
+				}
+			}
+		}
+		return n;
+	}
+
+  private:
+	static const size_t max_block_size = 128;
+
+	struct Entry {
+		Entry (framepos_t f, framepos_t l, size_t o, T const & v)
+			: first (f), last (l), order (o), value (v) {}
+
+		framepos_t first;
+		framepos_t last;
+		size_t     order;    ///< position in the add() sequence, to keep the sort stable
+		T          value;
+
+		bool operator< (Entry const & other) const {
+			return first < other.first || (first == other.first && order < other.order);
+		}
+	};
+
+	struct Block {
+		Block () : max_last (0) {}
+
+		void update () {
+			max_last = entries.front().last;
+			for (typename std::vector<Entry>::const_iterator i = entries.begin(); i != entries.end(); ++i) {
+				max_last = std::max (max_last, i->last);
+			}
+		}
+
+		std::vector<Entry> entries;
+		framepos_t         max_last; ///< greatest last of entries
+	};
+
+	struct BlockCompare {
+		bool operator() (Entry const & e, Block const * b) const {
+			return e < b->entries.front();
+		}
+		bool operator() (framepos_t f, Block const * b) const {
+			return f < b->entries.front().first;
+		}
+	};
+
+	/** @return the block that @a e belongs in: the last one whose first entry is not after it,
+	 *  or the first block if there is none.
+	 */
+	typename std::vector<Block*>::iterator block_for (Entry const & e) {
+		typename std::vector<Block*>::iterator b = std::upper_bound (_blocks.begin(), _blocks.end(), e, BlockCompare ());
+		if (b != _blocks.begin()) {
+			--b;
+		}
+		return b;
+	}
+
+	/** @return the number of blocks whose first interval starts at or before @a last */
+	size_t blocks_starting_by (framepos_t last) const {
+		return std::upper_bound (_blocks.begin(), _blocks.end(), last, BlockCompare ()) - _blocks.begin();
+	}
+
+	/** Rebuild the segment tree, after blocks have been added or removed */
+	void build_tree () {
+		_leaves = 1;
+		while (_leaves < _blocks.size()) {
+			_leaves <<= 1;
+		}
+
+		_tree.assign (_leaves * 2, std::numeric_limits<framepos_t>::min());
+
+		for (size_t b = 0; b < _blocks.size(); ++b) {
+			_tree[_leaves + b] = _blocks[b]->max_last;
+		}
+
+		for (size_t i = _leaves - 1; i > 0; --i) {
+			_tree[i] = std::max (_tree[i * 2], _tree[i * 2 + 1]);
+		}
+	}
+
+	/** Update the segment tree after the greatest end of block @a b has changed */
+	void update_tree (size_t b) {
+		size_t i = _leaves + b;
+		_tree[i] = _blocks[b]->max_last;
+		for (i /= 2; i > 0; i /= 2) {
+			_tree[i] = std::max (_tree[i * 2], _tree[i * 2 + 1]);
+		}
+	}
+
+	/** @return the first block from @a b onwards, and before @a end, with an interval
+	 *  that ends at or after @a first; or @a end if there is none.
+	 */
+	size_t next_block (size_t b, size_t end, framepos_t first) const {
+		if (b >= end) {
+			return end;
+		}
+
+		size_t i = _leaves + b;
+
+		/* climb until we reach a subtree, starting at or after b, that
+		   reaches first; then go down to its leftmost block that does
+		*/
+
+		while (_tree[i] < first) {
+			while (i & 1) {
+				i /= 2;
+			}
+			if (i == 0) {
+				return end;
+			}
+			++i;
+		}
+
+		while (i < _leaves) {
+			i *= 2;
+			if (_tree[i] < first) {
+				++i;
+			}
+		}
+
+		return std::min (i - _leaves, end);
+	}
+
+	std::vector<Block*> _blocks;
+	std::map<T, std::pair<framepos_t, size_t> > _keys; ///< start and order of each value's interval, to find it for remove()
+	size_t _size;
+	size_t _next_order;
+
+	/** segment tree of the blocks' greatest ends: node i has children 2i and 2i + 1,
+	 *  and block b is the leaf at _leaves + b.
+	 */
+	std::vector<framepos_t> _tree;
+	size_t _leaves;
+};
+
+/** A sorted set of timeline positions, each carrying a different value, for
+ *  finding the nearest position before or after a given frame in O(log n).
+ *  Positions may be added and removed at any time, also in O(log n).
+ */
+template<typename T>
+class PositionIndex
+{
+  public:
+	PositionIndex () : _next_order (0) {}
+
+	void clear () {
+		_entries.clear ();
+		_positions.clear ();
+	}
+
+	/** Add a position for @a value, which must not already have one.
+	 *  Equal positions keep the order they were added in.
+	 */
+	void add (framepos_t pos, T const & value) {
+		_positions[value] = _entries.insert (Entry (pos, _next_order++, value)).first;
+	}
+
+	/** Remove the position carrying @a value.
+	 *  @return true if there was one.
+	 */
+	bool remove (T const & value) {
+		typename std::map<T, typename Entries::iterator>::iterator p = _positions.find (value);
+
+		if (p == _positions.end()) {
+			return false;
+		}
+
+		_entries.erase (p->second);
+		_positions.erase (p);
+		return true;
+	}
+
+	bool empty () const { return _entries.empty(); }
+	size_t size () const { return _entries.size(); }
+
+	/** Find the smallest position greater than @a frame; of several
+	 *  at that position, the first added wins.
+	 *  @return true if there is one.
+	 */
+	bool next_after (framepos_t frame, framepos_t& pos, T& value) const {
+		typename Entries::const_iterator i = _entries.upper_bound (Entry (frame, ~size_t (0), T()));
+
+		if (i == _entries.end()) {
+			return false;
+		}
+
+		pos = i->pos;
+		value = i->value;
+		return true;
+	}
+
+	/** Find the greatest position less than @a frame; of several
+	 *  at that position, the first added wins.
+	 *  @return true if there is one.
+	 */
+	bool previous_before (framepos_t frame, framepos_t& pos, T& value) const {
+		typename Entries::const_iterator i = _entries.lower_bound (Entry (frame, 0, T()));
+
+		if (i == _entries.begin()) {
+			return false;
+		}
+
+		--i;
+		i = _entries.lower_bound (Entry (i->pos, 0, T()));
+
+		pos = i->pos;
+		value = i->value;
+		return true;
+	}
+
+  private:
+	struct Entry {
+		Entry (framepos_t p, size_t o, T const & v) : pos (p), order (o), value (v) {}
+
+		framepos_t pos;
+		size_t     order;
+		T          value;
+
+		bool operator< (Entry const & other) const {
+			return pos < other.pos || (pos == other.pos && order < other.order);
+		}
+	};
+
+	typedef std::set<Entry> Entries;
+
+	Entries _entries;
+	std::map<T, typename Entries::iterator> _positions; ///< entry for each value, to find it for remove()
+	size_t _next_order;
+};
+
+} /* namespace */
+
+#endif /* __ardour_interval_index_h__ */
@@ -0,0 +1,154 @@
+/*
+    Copyright (C) 2011 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_jack_audio_backend_h__
+#define __ardour_jack_audio_backend_h__
+
+#ifdef WAF_BUILD
+#include "libardour-config.h"
+#endif
+
+#include <string>
+
+#include <jack/jack.h>
+#include <jack/transport.h>
+
+#ifdef HAVE_JACK_SESSION
+#include <jack/session.h>
+#endif
+
+#include "ardour/audio_backend.h"
+
+namespace ARDOUR {
+
+/** AudioBackend which runs as a JACK client */
+class JACKAudioBackend : public AudioBackend
+{
+public:
+	JACKAudioBackend ();
+	~JACKAudioBackend ();
+
+	std::string name () const { return "JACK"; }
+
+	jack_client_t* jack () const { return _jack; }
+
+	int open (std::string const & client_name, std::string const & session_uuid);
+	int close ();
+	bool connected () const { return _jack != 0; }
+	void client_died () { _jack = 0; }
+	std::string client_name () const { return _client_name; }
+
+	int start ();
+	int stop ();
+
+	bool is_realtime () const;
+	int client_real_time_priority ();
+	int create_process_thread (boost::function<void()> f, pthread_t* thread, size_t stacksize);
+
+	framecnt_t sample_rate () const;
+	pframes_t buffer_size () const;
+	int set_buffer_size (pframes_t);
+	size_t raw_buffer_size (DataType) const;
+
+	pframes_t frames_since_cycle_start () const;
+	pframes_t frame_time () const;
+	pframes_t frame_time_at_cycle_start () const;
+
+	float cpu_load () const;
+
+	int freewheel (bool);
+
+	void transport_start ();
+	void transport_stop ();
+	void transport_locate (framepos_t);
+	jack_transport_state_t transport_state () const;
+	framepos_t transport_frame () const;
+	int reset_timebase ();
+	bool get_sync_offset (pframes_t& offset) const;
+
+	void update_total_latencies ();
+
+	PortHandle register_port (std::string const & shortname, DataType type, uint32_t flags);
+	void unregister_port (PortHandle);
+	int set_port_name (PortHandle, std::string const & shortname);
+	PortHandle get_port_by_name (std::string const &) const;
+	uint32_t port_flags (PortHandle) const;
+	DataType port_data_type (PortHandle) const;
+
+	const char** get_ports (std::string const & port_name_pattern, std::string const & type_name_pattern, uint32_t flags) const;
+
+	int connect (std::string const & src, std::string const & dst);
+	int disconnect (std::string const & src, std::string const & dst);
+	int disconnect_all (PortHandle);
+	bool connected (PortHandle) const;
+	bool connected_to (PortHandle, std::string const &) const;
+	int get_connections (PortHandle, std::vector<std::string>&) const;
+
+	bool can_monitor_input () const;
+	int ensure_monitor_input (PortHandle, bool);
+	int request_monitor_input (PortHandle, bool);
+	bool monitoring_input (PortHandle) const;
+
+	void set_latency_range (PortHandle, bool playback, jack_latency_range_t);
+	jack_latency_range_t get_latency_range (PortHandle, bool playback) const;
+
+	void* get_buffer (PortHandle, pframes_t);
+
+	uint32_t midi_event_count (void* buf) const;
+	int midi_event_get (pframes_t& timestamp, size_t& size, uint8_t const** data, void* buf, uint32_t index) const;
+	int midi_event_put (void* buf, pframes_t timestamp, uint8_t const* data, size_t size);
+	void midi_clear (void* buf);
+
+private:
+	jack_client_t* volatile _jack; /* could be reset to null by SIGPIPE or another thread */
+	std::string             _client_name;
+
+	void set_jack_callbacks ();
+	void* process_thread ();
+
+	static void  _thread_init_callback (void *arg);
+	static void* _process_thread (void *arg);
+	static int   _xrun_callback (void *arg);
+#ifdef HAVE_JACK_SESSION
+	static void  _session_callback (jack_session_event_t *event, void *arg);
+#endif
+	static int   _graph_order_callback (void *arg);
+	static int   _sample_rate_callback (pframes_t nframes, void *arg);
+	static int   _bufsize_callback (pframes_t nframes, void *arg);
+	static void  _jack_timebase_callback (jack_transport_state_t, pframes_t, jack_position_t*, int, void*);
+	static int   _jack_sync_callback (jack_transport_state_t, jack_position_t*, void *arg);
+	static void  _freewheel_callback (int , void *arg);
+	static void  _registration_callback (jack_port_id_t, int, void *);
+	static void  _connect_callback (jack_port_id_t, jack_port_id_t, int, void *);
+	static void  _latency_callback (jack_latency_callback_mode_t, void*);
+	static void  _halted (void *);
+	static void  _halted_info (jack_status_t,const char*,void *);
+
+	struct ThreadData {
+		boost::function<void()> f;
+
+		ThreadData (boost::function<void()> fp) : f (fp) {}
+	};
+
+	static void* _start_process_thread (void*);
+};
+
+} // namespace ARDOUR
+
+#endif /* __ardour_jack_audio_backend_h__ */
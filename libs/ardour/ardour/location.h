@@ -32,12 +32,20 @@
 #include "pbd/undo.h"
 #include "pbd/stateful.h"
 #include "pbd/statefuldestructible.h"
+#include "pbd/state_diff_property.h"
 
 #include "ardour/ardour.h"
 #include "ardour/session_handle.h"
 
 namespace ARDOUR {
 
+namespace Properties {
+	/* fake the type, since the list of locations is handled by
+	   PBD::StateDiffProperty which doesn't care about such things.
+	*/
+	extern PBD::PropertyDescriptor<bool> locations;
+}
+
 class Location : public SessionHandleRef, public PBD::StatefulDestructible
 {
   public:
@@ -166,6 +174,8 @@ class Locations : public SessionHandleRef, public PBD::StatefulDestructible
 
 	void find_all_between (framepos_t start, framepos_t, LocationList&, Location::Flags);
 
+	static void make_property_quarks ();
+
 	enum Change {
 		ADDITION, ///< a location was added, but nothing else changed
 		REMOVAL, ///< a location was removed, but nothing else changed
@@ -196,6 +206,9 @@ class Locations : public SessionHandleRef, public PBD::StatefulDestructible
 	Location            *current_location;
 	mutable Glib::Mutex  lock;
 
+	/** records changes to the locations for undo, as the locations which changed */
+	PBD::StateDiffProperty _locations_property;
+
 	int set_current_unlocked (Location *);
 	void location_changed (Location*);
 };
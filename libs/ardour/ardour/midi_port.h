@@ -66,7 +66,7 @@ class MidiPort : public Port {
 	bool        _resolve_required;
 	bool        _input_active;
 
-	void resolve_notes (void* jack_buffer, MidiBuffer::TimeType when);
+	void resolve_notes (void* port_buffer, MidiBuffer::TimeType when);
 };
 
 } // namespace ARDOUR
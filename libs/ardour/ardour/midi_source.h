@@ -93,7 +93,7 @@ class MidiSource : virtual public Source, public boost::enable_shared_from_this<
 	virtual void session_saved();
 
 	std::string captured_for() const               { return _captured_for; }
-	void        set_captured_for (std::string str) { _captured_for = str; }
+	void        set_captured_for (std::string str) { _captured_for = str; StateChanged (); }
 
 	uint32_t read_data_count()  const { return _read_data_count; }
 	uint32_t write_data_count() const { return _write_data_count; }
@@ -33,6 +33,29 @@ void  x86_sse_mix_buffers_no_gain  (ARDOUR::Sample * dst, const ARDOUR::Sample *
 }
 
 void  x86_sse_find_peaks               (const ARDOUR::Sample * buf, ARDOUR::pframes_t nsamples, float *min, float *max);
+void  x86_sse_xmm_mix_buffers_with_gain(ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes, float gain);
+void  x86_sse_apply_gain_vector_to_buffer (ARDOUR::Sample * buf, const ARDOUR::gain_t * gain, ARDOUR::pframes_t nframes, float scale);
+void  x86_sse_mix_buffers_with_gain_vector (ARDOUR::Sample * dst, const ARDOUR::Sample * src, const ARDOUR::gain_t * gain, ARDOUR::pframes_t nframes, float scale);
+
+/* AVX functions */
+
+float x86_avx_compute_peak             (const ARDOUR::Sample * buf, ARDOUR::pframes_t nsamples, float current);
+void  x86_avx_find_peaks               (const ARDOUR::Sample * buf, ARDOUR::pframes_t nsamples, float *min, float *max);
+void  x86_avx_apply_gain_to_buffer     (ARDOUR::Sample * buf, ARDOUR::pframes_t nframes, float gain);
+void  x86_avx_mix_buffers_with_gain    (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes, float gain);
+void  x86_avx_mix_buffers_no_gain      (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes);
+void  x86_avx_apply_gain_vector_to_buffer (ARDOUR::Sample * buf, const ARDOUR::gain_t * gain, ARDOUR::pframes_t nframes, float scale);
+void  x86_avx_mix_buffers_with_gain_vector (ARDOUR::Sample * dst, const ARDOUR::Sample * src, const ARDOUR::gain_t * gain, ARDOUR::pframes_t nframes, float scale);
+
+/* AVX-512 functions */
+
+float x86_avx512f_compute_peak         (const ARDOUR::Sample * buf, ARDOUR::pframes_t nsamples, float current);
+void  x86_avx512f_find_peaks           (const ARDOUR::Sample * buf, ARDOUR::pframes_t nsamples, float *min, float *max);
+void  x86_avx512f_apply_gain_to_buffer (ARDOUR::Sample * buf, ARDOUR::pframes_t nframes, float gain);
+void  x86_avx512f_mix_buffers_with_gain(ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes, float gain);
+void  x86_avx512f_mix_buffers_no_gain  (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes);
+void  x86_avx512f_apply_gain_vector_to_buffer (ARDOUR::Sample * buf, const ARDOUR::gain_t * gain, ARDOUR::pframes_t nframes, float scale);
+void  x86_avx512f_mix_buffers_with_gain_vector (ARDOUR::Sample * dst, const ARDOUR::Sample * src, const ARDOUR::gain_t * gain, ARDOUR::pframes_t nframes, float scale);
 
 /* debug wrappers for SSE functions */
 
@@ -43,6 +66,18 @@ void  debug_mix_buffers_no_gain        (ARDOUR::Sample * dst, const ARDOUR::Samp
 
 #endif
 
+#if defined (BUILD_NEON_OPTIMIZATIONS)
+
+float arm_neon_compute_peak            (const ARDOUR::Sample * buf, ARDOUR::pframes_t nsamples, float current);
+void  arm_neon_find_peaks              (const ARDOUR::Sample * buf, ARDOUR::pframes_t nsamples, float *min, float *max);
+void  arm_neon_apply_gain_to_buffer    (ARDOUR::Sample * buf, ARDOUR::pframes_t nframes, float gain);
+void  arm_neon_mix_buffers_with_gain   (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes, float gain);
+void  arm_neon_mix_buffers_no_gain     (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes);
+void  arm_neon_apply_gain_vector_to_buffer (ARDOUR::Sample * buf, const ARDOUR::gain_t * gain, ARDOUR::pframes_t nframes, float scale);
+void  arm_neon_mix_buffers_with_gain_vector (ARDOUR::Sample * dst, const ARDOUR::Sample * src, const ARDOUR::gain_t * gain, ARDOUR::pframes_t nframes, float scale);
+
+#endif
+
 #if defined (__APPLE__)
 
 float veclib_compute_peak              (const ARDOUR::Sample * buf, ARDOUR::pframes_t nsamples, float current);
@@ -60,5 +95,7 @@ void  default_find_peaks                (const ARDOUR::Sample * buf, ARDOUR::pfr
 void  default_apply_gain_to_buffer      (ARDOUR::Sample * buf, ARDOUR::pframes_t nframes, float gain);
 void  default_mix_buffers_with_gain     (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes, float gain);
 void  default_mix_buffers_no_gain       (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes);
+void  default_apply_gain_vector_to_buffer (ARDOUR::Sample * buf, const ARDOUR::gain_t * gain, ARDOUR::pframes_t nframes, float scale);
+void  default_mix_buffers_with_gain_vector (ARDOUR::Sample * dst, const ARDOUR::Sample * src, const ARDOUR::gain_t * gain, ARDOUR::pframes_t nframes, float scale);
 
 #endif /* __ardour_mix_h__ */
@@ -43,6 +43,7 @@
 #include "ardour/ardour.h"
 #include "ardour/session_object.h"
 #include "ardour/data_type.h"
+#include "ardour/interval_index.h"
 
 namespace ARDOUR  {
 
@@ -183,6 +184,11 @@ public:
 	PBD::Signal0<void>      LengthChanged;
 	PBD::Signal0<void>      LayeringChanged;
 
+	/** Emitted when a part of our state that is not a property, such as
+	    whether we are frozen, changes.
+	*/
+	PBD::Signal0<void>      StateChanged;
+
 	/** Emitted when regions have moved (not when regions have only been trimmed) */
 	PBD::Signal2<void,std::list< Evoral::RangeMove<framepos_t> > const &, bool> RangesMoved;
 
@@ -205,7 +211,7 @@ public:
 
 	/* XXX: use of diskstream here is a little unfortunate */
 	const PBD::ID& get_orig_diskstream_id () const { return _orig_diskstream_id; }
-	void set_orig_diskstream_id (const PBD::ID& did) { _orig_diskstream_id = did; }
+	void set_orig_diskstream_id (const PBD::ID& did) { _orig_diskstream_id = did; StateChanged (); }
 
 	/* destructive editing */
 
@@ -299,6 +305,18 @@ public:
 	bool             auto_partition;
 	uint32_t        _combine_ops;
 
+	/* Indices of `regions' for the FINDING THINGS queries; these are
+	   updated as regions are added, removed or have their bounds changed.
+	*/
+	IntervalIndex<boost::shared_ptr<Region> > _region_extents;
+	PositionIndex<boost::shared_ptr<Region> > _region_starts;
+	PositionIndex<boost::shared_ptr<Region> > _region_ends;
+	PositionIndex<boost::shared_ptr<Region> > _region_sync_points;
+
+	void index_region (boost::shared_ptr<Region>);
+	bool unindex_region (boost::shared_ptr<Region>);
+	void clear_region_index ();
+
 	/** true if relayering should be done using region's current layers and their `pending explicit relayer'
 	 *  flags; otherwise false if relayering should be done using the layer-model (most recently moved etc.)
 	 *  Explicit relayering is used by tracks in stacked regionview mode.
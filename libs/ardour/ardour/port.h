@@ -29,6 +29,7 @@
 #include <boost/utility.hpp>
 #include "pbd/signals.h"
 
+#include "ardour/audio_backend.h"
 #include "ardour/data_type.h"
 #include "ardour/types.h"
 
@@ -99,7 +100,7 @@ public:
 	bool last_monitor() const { return _last_monitor; }
 	void set_last_monitor (bool yn) { _last_monitor = yn; }
 
-	jack_port_t* jack_port() const { return _jack_port; }
+	AudioBackend::PortHandle port_handle () const { return _port_handle; }
 
 	void get_connected_latency_range (jack_latency_range_t& range, bool playback) const;
 
@@ -144,7 +145,7 @@ protected:
 
 	Port (std::string const &, DataType, Flags);
 
-	jack_port_t* _jack_port; ///< JACK port
+	AudioBackend::PortHandle _port_handle; ///< our port in the engine's backend
 
 	static bool	  _connecting_blocked;
 	static pframes_t  _global_port_buffer_offset;   /* access only from process() tree */
@@ -163,7 +164,7 @@ private:
 	bool        _last_monitor;
 
 	/** ports that we are connected to, kept so that we can
-	    reconnect to JACK when required
+	    reconnect to the backend when required
 	*/
 	std::set<std::string> _connections;
 
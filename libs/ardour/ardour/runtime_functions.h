@@ -29,12 +29,20 @@ namespace ARDOUR {
 	typedef void  (*apply_gain_to_buffer_t)		(ARDOUR::Sample *, pframes_t, float);
 	typedef void  (*mix_buffers_with_gain_t)	(ARDOUR::Sample *, const ARDOUR::Sample *, pframes_t, float);
 	typedef void  (*mix_buffers_no_gain_t)		(ARDOUR::Sample *, const ARDOUR::Sample *, pframes_t);
+	typedef void  (*apply_gain_vector_to_buffer_t)	(ARDOUR::Sample *, const ARDOUR::gain_t *, pframes_t, float);
+	typedef void  (*mix_buffers_with_gain_vector_t)	(ARDOUR::Sample *, const ARDOUR::Sample *, const ARDOUR::gain_t *, pframes_t, float);
 
 	extern compute_peak_t		compute_peak;
 	extern find_peaks_t             find_peaks;
 	extern apply_gain_to_buffer_t	apply_gain_to_buffer;
 	extern mix_buffers_with_gain_t	mix_buffers_with_gain;
 	extern mix_buffers_no_gain_t	mix_buffers_no_gain;
+
+	/* per-sample gain, times a constant: buf[n] *= gain[n] * scale and
+	   dst[n] += src[n] * (gain[n] * scale) respectively.
+	*/
+	extern apply_gain_vector_to_buffer_t	apply_gain_vector_to_buffer;
+	extern mix_buffers_with_gain_vector_t	mix_buffers_with_gain_vector;
 }
 
 #endif /* __ardour_runtime_functions_h__ */
@@ -55,6 +55,7 @@
 #include "ardour/location.h"
 #include "ardour/interpolation.h"
 #include "ardour/speakers.h"
+#include "ardour/tempo.h"
 
 #ifdef HAVE_JACK_SESSION
 #include <jack/session.h>
@@ -121,9 +122,12 @@ class SessionPlaylists;
 class Slave;
 class Source;
 class Speakers;
+class StateCache;
+class StateWriter;
 class TempoMap;
 class VSTPlugin;
 class Graph;
+struct DSPStats;
 class Track;
 
 extern void setup_enum_writer ();
@@ -195,6 +199,13 @@ class Session : public PBD::StatefulDestructible, public PBD::ScopedConnectionLi
 	BufferSet& get_scratch_buffers (ChanCount count = ChanCount::ZERO);
 	BufferSet& get_mix_buffers (ChanCount count = ChanCount::ZERO);
 
+	/* DSP load of individual routes and processors; only collected
+	   when the "dsp-profiling" option is enabled.
+	*/
+	bool route_dsp_stats (boost::shared_ptr<Route>, DSPStats&) const;
+	bool processor_dsp_stats (boost::shared_ptr<Processor>, DSPStats&) const;
+	void reset_dsp_stats ();
+
 	bool have_rec_enabled_track () const;
 
 	bool have_captured() const { return _have_captured; }
@@ -820,6 +831,7 @@ class Session : public PBD::StatefulDestructible, public PBD::ScopedConnectionLi
 
   protected:
 	friend class AudioEngine;
+	friend class JACKAudioBackend;
 	void set_block_size (pframes_t nframes);
 	void set_frame_rate (framecnt_t nframes);
 
@@ -1004,6 +1016,8 @@ class Session : public PBD::StatefulDestructible, public PBD::ScopedConnectionLi
 	std::string _current_snapshot_name;
 
 	XMLTree*         state_tree;
+	StateWriter*     _state_writer;
+	StateCache*      _state_cache;
 	bool             state_was_pending;
 	StateOfTheState _state_of_the_state;
 
@@ -1251,6 +1265,7 @@ class Session : public PBD::StatefulDestructible, public PBD::ScopedConnectionLi
 
   private:
 	int load_sources (const XMLNode& node);
+	int load_source (const XMLNode& node);
 	XMLNode& get_sources_as_xml ();
 
 	boost::shared_ptr<Source> XMLSourceFactory (const XMLNode&);
@@ -1356,7 +1371,10 @@ class Session : public PBD::StatefulDestructible, public PBD::ScopedConnectionLi
 
 	void  update_latency (bool playback);
 
-	XMLNode& state(bool);
+	/** @param reuse_cached_state true to reuse the cached state of
+	 *  playlists and sources that have not changed since it was collected.
+	 */
+	XMLNode& state(bool, bool reuse_cached_state = false);
 
 	/* click track */
 
@@ -1368,6 +1386,7 @@ class Session : public PBD::StatefulDestructible, public PBD::ScopedConnectionLi
 	framecnt_t             click_length;
 	framecnt_t             click_emphasis_length;
 	mutable Glib::RWLock   click_lock;
+	TempoMap::BBTPointList click_points;
 
 	static const Sample     default_click[];
 	static const framecnt_t default_click_length;
@@ -41,6 +41,7 @@ class Playlist;
 class Region;
 class Source;
 class Session;
+class StateCache;
 class Crossfade;
 
 class SessionPlaylists : public PBD::ScopedConnectionList
@@ -70,7 +71,7 @@ private:
 	uint32_t n_playlists() const;
 	void find_equivalent_playlist_regions (boost::shared_ptr<Region>, std::vector<boost::shared_ptr<Region> >& result);
 	void update_after_tempo_map_change ();
-	void add_state (XMLNode *, bool);
+	void add_state (XMLNode *, bool, StateCache *);
 	bool maybe_delete_unused (boost::function<int(boost::shared_ptr<Playlist>)>);
 	int load (Session &, const XMLNode&);
 	int load_unused (Session &, const XMLNode&);
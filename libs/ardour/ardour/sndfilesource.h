@@ -57,6 +57,7 @@ class SndFileSource : public AudioFileSource {
 	bool set_destructive (bool yn);
 
 	bool one_of_several_channels () const;
+	bool shares_file_with (AudioSource const &) const;
 
 	bool clamped_at_unity () const;
 
@@ -70,6 +71,8 @@ class SndFileSource : public AudioFileSource {
 	void set_header_timeline_position ();
 
 	framecnt_t read_unlocked (Sample *dst, framepos_t start, framecnt_t cnt) const;
+	framecnt_t read_channels_unlocked (Sample** dst, uint16_t const * chans, uint32_t n,
+	                                   framepos_t start, framecnt_t cnt) const;
 	framecnt_t write_unlocked (Sample *dst, framecnt_t cnt);
 	framecnt_t write_float (Sample* data, framepos_t pos, framecnt_t cnt);
 
@@ -58,7 +58,7 @@ class Source : public SessionObject
 	DataType type() { return _type; }
 
 	time_t timestamp() const { return _timestamp; }
-	void stamp (time_t when) { _timestamp = when; }
+	void stamp (time_t when) { _timestamp = when; StateChanged (); }
 
 	virtual bool       empty () const = 0;
 	virtual framecnt_t length (framepos_t pos) const = 0;
@@ -90,6 +90,9 @@ class Source : public SessionObject
 
 	PBD::Signal0<void> AnalysisChanged;
 
+	/** Emitted when something in our saved state, other than a property, changes */
+	PBD::Signal0<void> StateChanged;
+
 	AnalysisFeatureList transients;
 	std::string get_transients_path() const;
 	int load_transients (const std::string&);
@@ -36,11 +36,9 @@ class Playlist;
 
 class SourceFactory {
   public:
-	static void init ();
-
 	static PBD::Signal1<void,boost::shared_ptr<Source> > SourceCreated;
 
-	static boost::shared_ptr<Source> create (Session&, const XMLNode& node, bool async = false);
+	static boost::shared_ptr<Source> create (Session&, const XMLNode& node, bool async = false, bool announce = true);
 	static boost::shared_ptr<Source> createSilent (Session&, const XMLNode& node,
 	                                               framecnt_t nframes, float sample_rate);
 
@@ -59,10 +57,6 @@ class SourceFactory {
 		(DataType type, Session& s, boost::shared_ptr<Playlist> p, const PBD::ID& orig, const std::string& name,
 		 uint32_t chn, frameoffset_t start, framecnt_t len, bool copy, bool defer_peaks);
 
-	static Glib::Cond*                               PeaksToBuild;
-	static Glib::StaticMutex                         peak_building_lock;
-	static std::list< boost::weak_ptr<AudioSource> > files_with_peaks;
-
 	static int setup_peakfile (boost::shared_ptr<Source>, bool async);
 };
 
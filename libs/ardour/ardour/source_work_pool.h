@@ -0,0 +1,97 @@
+/*
+    Copyright (C) 2011 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_source_work_pool_h__
+#define __ardour_source_work_pool_h__
+
+#include <list>
+
+#include <glibmm/thread.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include "pbd/signals.h"
+
+namespace ARDOUR {
+
+class Source;
+
+/** A fixed number of threads which build peak files for, and analyse, sources
+ *  in the background.  Jobs are run in the order in which they were queued,
+ *  except that those for sources which have been prioritised (because they
+ *  are visible in the editor, for example) are moved to the front.
+ *
+ *  Peaks are built in parallel, but only one source is analysed at a time,
+ *  since the VAMP plugin loader used for analysis is not thread-safe.
+ */
+class SourceWorkPool {
+
+  public:
+	enum Job {
+		BuildPeaks,
+		Analyse
+	};
+
+	static void init ();
+
+	/** Queue a job, unless the same job for the same source is already queued */
+	static void queue (boost::shared_ptr<Source>, Job);
+
+	/** Move any queued jobs for a source to the front of the queue */
+	static void prioritise (boost::shared_ptr<Source>);
+
+	/** @return true if there are no jobs waiting to be run */
+	static bool empty ();
+
+	/** Get the number of jobs finished and the number queued since the pool was last idle */
+	static void progress (uint32_t& done, uint32_t& total);
+
+	/** Emitted when a job is queued or finished, with the number of jobs finished
+	 *  and the number queued since the pool was last idle; the two are equal
+	 *  when it becomes idle again.  Emitted from the queueing or worker thread,
+	 *  so emissions from different threads may arrive out of order; use progress()
+	 *  for the current state.
+	 */
+	static PBD::Signal2<void,uint32_t,uint32_t> Progress;
+
+  private:
+	struct Item {
+		Item (boost::shared_ptr<Source> s, Job j) : source (s), key (s.get()), job (j) {}
+
+		boost::weak_ptr<Source> source;
+		Source const *          key; ///< for comparison without locking source
+		Job                     job;
+	};
+
+	static Glib::StaticMutex _lock;
+	static Glib::Cond*       _work_to_do;
+	static std::list<Item>   _queue;
+	static uint32_t          _running; ///< jobs being run
+	static bool              _analysing; ///< true if an Analyse job is being run
+	static uint32_t          _done;    ///< jobs finished since we were last idle
+	static uint32_t          _total;   ///< jobs queued since we were last idle
+
+	static std::list<Item>::iterator next_job ();
+	static void work ();
+	static void run (Item const &);
+};
+
+}
+
+#endif /* __ardour_source_work_pool_h__ */
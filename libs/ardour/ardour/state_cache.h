@@ -0,0 +1,129 @@
+/*
+    Copyright (C) 2011 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_state_cache_h__
+#define __ardour_state_cache_h__
+
+#include <map>
+
+#include <glib.h>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "pbd/id.h"
+#include "pbd/signals.h"
+
+class XMLNode;
+
+namespace ARDOUR {
+
+class Crossfade;
+class Playlist;
+class Route;
+class Source;
+
+/** Keeps the state of each playlist and source from one save of the session
+ *  to the next, so that a save need not call get_state() on objects which
+ *  have not changed since.
+ *
+ *  An object is marked as changed by its own change signals, which are
+ *  watched from the time its state is collected.  State is only reused for
+ *  objects whose whole state is covered by those signals:
+ *
+ *  - a playlist's state is its properties, extra XML, regions and, for an
+ *    audio playlist, crossfades.  A region's is its properties (including,
+ *    for an audio region, its envelope and fades) and extra XML, and a
+ *    crossfade's is those plus its fade curves.  Playlists with compound
+ *    regions, whose state includes that of their nested sources, are not
+ *    reused.
+ *
+ *  - a source's state is its name, flags, timestamp, capture name and
+ *    extra XML, and for a MIDI source its interpolation and automation
+ *    styles, each of which signals when it changes.  Playlist sources,
+ *    whose state includes that of their playlist, are not reused.
+ *
+ *  A route's state includes those of its processors, whose plugins may
+ *  change their own state without notice, so routes are always collected
+ *  afresh.  Cached state is only reused when asked to; the session does
+ *  that for pending saves.
+ */
+class StateCache : public boost::noncopyable
+{
+  public:
+	StateCache ();
+	~StateCache ();
+
+	/** Start collecting the state of the session.
+	 *  @param reuse true to reuse the state of unchanged objects.
+	 */
+	void start (bool reuse);
+
+	/** Finish collecting the state of the session, forgetting any object
+	 *  whose state was not asked for since start().
+	 */
+	void finish ();
+
+	/* Each of these returns the state of an object, which the caller owns */
+	XMLNode& state (boost::shared_ptr<Route>);
+	XMLNode& state (boost::shared_ptr<Playlist>);
+	XMLNode& state (boost::shared_ptr<Source>);
+
+	/** Mark the state of every object as changed */
+	void invalidate ();
+
+	struct Stats {
+		Stats () : collected (0), reused (0) {}
+
+		uint32_t collected; ///< objects whose get_state() was called
+		uint32_t reused;    ///< objects whose state was reused
+	};
+
+	Stats stats () const { return _stats; }
+
+  private:
+	struct Entry : public boost::noncopyable {
+		Entry () : node (0), changed (1), used (false) {}
+		~Entry ();
+
+		XMLNode*                  node;    ///< copy of the state from the last time it was collected
+		volatile gint             changed; ///< set by any thread that signals a change
+		bool                      used;    ///< true if the state was asked for since start()
+		PBD::ScopedConnectionList connections;
+	};
+
+	typedef std::map<PBD::ID, Entry*> Entries;
+
+	Entries _entries;
+	bool    _reuse;
+	Stats   _stats;
+
+	Entry* entry (PBD::ID const &);
+	bool can_reuse (Entry *);
+	XMLNode& store (Entry *, XMLNode &);
+	XMLNode& collect (XMLNode &);
+
+	static void changed (Entry *);
+	static void watch_crossfade (Entry *, boost::shared_ptr<Crossfade>);
+
+	template<typename S> static void watch (Entry *, S &);
+};
+
+} // namespace ARDOUR
+
+#endif /* __ardour_state_cache_h__ */
@@ -0,0 +1,131 @@
+/*
+    Copyright (C) 2011 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_state_writer_h__
+#define __ardour_state_writer_h__
+
+#include <string>
+#include <list>
+#include <map>
+
+#include <glib.h>
+#include <glibmm/thread.h>
+
+class XMLNode;
+
+namespace ARDOUR {
+
+/** Writes session state files, either in the calling thread or in a
+ *  thread of its own, so that the caller need only wait for the state
+ *  to be collected and not for it to be serialised and flushed to disk.
+ *
+ *  Each file is written to a temporary file, which is synced and then
+ *  renamed over the target, so that a crash part way through a save
+ *  leaves the previous file intact.
+ *
+ *  In incremental mode, the text of each object two levels down in the
+ *  state (each route, playlist, source and so on) is kept from one
+ *  write to the next, and objects whose state has not changed are not
+ *  serialised again.
+ */
+class StateWriter
+{
+  public:
+	StateWriter ();
+	~StateWriter ();
+
+	/** Write state in the calling thread, after any background write to the same file.
+	 *  @param root State; we take ownership of it.
+	 *  @param path File to write.
+	 *  @param tmp_path Temporary file to write first.
+	 *  @return 0 on success.
+	 */
+	int write (XMLNode* root, std::string const & path, std::string const & tmp_path);
+
+	/** Queue state to be written in our thread.  Any queued write to the same
+	 *  file which has not yet started is dropped in favour of this one.
+	 *  @param root State; we take ownership of it.
+	 *  @param path File to write.
+	 *  @param tmp_path Temporary file to write first.
+	 */
+	void write_in_background (XMLNode* root, std::string const & path, std::string const & tmp_path);
+
+	/** Wait until all queued writes have finished */
+	void wait ();
+
+	/** Set whether subsequent writes should reuse the text of unchanged objects */
+	void set_incremental (bool);
+
+	struct Stats {
+		Stats () : writes (0), objects_written (0), objects_reused (0) {}
+
+		uint32_t writes;
+		uint32_t objects_written; ///< objects serialised
+		uint32_t objects_reused;  ///< objects whose text was reused from the previous write
+	};
+
+	Stats stats () const;
+
+  private:
+	struct Job {
+		Job (XMLNode* r, std::string const & p, std::string const & t, bool i)
+			: root (r), path (p), tmp_path (t), incremental (i) {}
+
+		XMLNode* root;
+		std::string path;
+		std::string tmp_path;
+		bool incremental;
+	};
+
+	/** An object's state, and its text, from the last write */
+	struct CachedObject {
+		CachedObject () : node (0), used (false) {}
+
+		XMLNode const * node; ///< points into _last_root
+		std::string text;
+		bool used;            ///< true if the object was in the current write
+	};
+
+	typedef std::map<std::string, CachedObject> Cache;
+
+	/** protects _queue, _busy, _incremental and the thread */
+	mutable Glib::Mutex _queue_lock;
+	Glib::Cond          _queue_cond;
+	std::list<Job>      _queue;
+	bool                _busy;
+	bool                _incremental;
+	bool                _quit;
+	Glib::Thread*       _thread;
+
+	/** held while a file is written; protects the members below */
+	mutable Glib::Mutex _write_lock;
+	Cache               _cache;
+	XMLNode*            _last_root;
+	Stats               _stats;
+
+	void thread_work ();
+	int do_write (Job const &);
+	std::string serialise (XMLNode const &, bool incremental);
+	void serialise_node (std::string &, XMLNode const &, std::string const &, int, bool);
+	int write_file (std::string const & text, std::string const & path, std::string const & tmp_path);
+};
+
+} // namespace ARDOUR
+
+#endif /* __ardour_state_writer_h__ */
@@ -27,8 +27,10 @@
 #include <glibmm/thread.h>
 
 #include "pbd/undo.h"
+#include "pbd/rcu.h"
 #include "pbd/stateful.h"
 #include "pbd/statefuldestructible.h"
+#include "pbd/state_diff_property.h"
 
 
 #include "ardour/ardour.h"
@@ -163,6 +165,13 @@ class TempoMetric {
 	Timecode::BBT_Time _start;
 };
 
+namespace Properties {
+	/* fake the type, since the tempo and meter sections are handled by
+	   PBD::StateDiffProperty which doesn't care about such things.
+	*/
+	extern PBD::PropertyDescriptor<bool> metrics;
+}
+
 class TempoMap : public PBD::StatefulDestructible
 {
   public:
@@ -197,6 +206,12 @@ class TempoMap : public PBD::StatefulDestructible
 	}
 
 	BBTPointList *get_points (framepos_t start, framepos_t end) const;
+	/** As above, but fill a list supplied by the caller, which is cleared
+	 *  first.  This does not allocate memory unless the list has to grow,
+	 *  so it may be used from the process thread with a list that has been
+	 *  reserve()d in advance.
+	 */
+	void get_points (BBTPointList& points, framepos_t start, framepos_t end) const;
 
 	void      bbt_time (framepos_t when, Timecode::BBT_Time&) const;
 	framecnt_t frame_time (const Timecode::BBT_Time&) const;
@@ -259,18 +274,50 @@ class TempoMap : public PBD::StatefulDestructible
 
 	framecnt_t frame_rate () const { return _frame_rate; }
 
+	static void make_property_quarks ();
+
   private:
 	static Tempo    _default_tempo;
 	static Meter    _default_meter;
 
 	Metrics*             metrics;
+
+	/** The state of the map from one MetricSection onwards: the section's
+	 *  position and the meter and tempo in effect from there.
+	 */
+	struct MetricPoint {
+		framepos_t          frame;
+		Timecode::BBT_Time  start;
+		const MeterSection* meter;
+		const TempoSection* tempo;
+		bool                new_meter; ///< true if this point's section is a MeterSection
+	};
+
+	/** An immutable copy of the positions in `metrics', which readers can
+	 *  binary-search without taking `lock'.  It is rebuilt and republished
+	 *  whenever metrics are added, removed or re-timestamped.
+	 */
+	struct MetricIndex {
+		std::vector<MetricPoint>         points;
+		std::vector<const MeterSection*> meters;
+	};
+
+	SerializedRCUManager<MetricIndex> _index;
+
 	framecnt_t           _frame_rate;
 	framepos_t           last_bbt_when;
 	bool                 last_bbt_valid;
 	Timecode::BBT_Time   last_bbt;
 	mutable Glib::RWLock lock;
 
+	/** records changes to the map for undo, as the sections which changed */
+	PBD::StateDiffProperty _metrics_property;
+
 	void timestamp_metrics (bool use_bbt);
+	void rebuild_index ();
+	static int point_at (MetricIndex const &, framepos_t);
+	static int point_at (MetricIndex const &, Timecode::BBT_Time const &);
+	TempoMetric metric_at_point (MetricIndex const &, int) const;
 
 	framepos_t round_to_type (framepos_t fr, int dir, BBTPointType);
 
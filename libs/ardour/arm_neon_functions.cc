@@ -0,0 +1,167 @@
+/*
+    Copyright (C) 2011 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+/* NEON is part of every ARM target we build these for (it is mandatory
+   on aarch64, and the compiler only defines __ARM_NEON on 32 bit ARM
+   when told that the target has it), so there is no runtime check.
+*/
+
+#include <cmath>
+
+#include "ardour/mix.h"
+
+#if defined (BUILD_NEON_OPTIMIZATIONS) && (defined (__ARM_NEON__) || defined (__ARM_NEON))
+
+#include <arm_neon.h>
+
+using namespace ARDOUR;
+
+static inline float
+hmax (float32x4_t v)
+{
+	float32x2_t m = vpmax_f32 (vget_low_f32 (v), vget_high_f32 (v));
+	m = vpmax_f32 (m, m);
+	return vget_lane_f32 (m, 0);
+}
+
+static inline float
+hmin (float32x4_t v)
+{
+	float32x2_t m = vpmin_f32 (vget_low_f32 (v), vget_high_f32 (v));
+	m = vpmin_f32 (m, m);
+	return vget_lane_f32 (m, 0);
+}
+
+float
+arm_neon_compute_peak (const Sample * buf, pframes_t nsamples, float current)
+{
+	float32x4_t peak0 = vdupq_n_f32 (current);
+	float32x4_t peak1 = peak0;
+
+	for (; nsamples >= 8; nsamples -= 8, buf += 8) {
+		peak0 = vmaxq_f32 (peak0, vabsq_f32 (vld1q_f32 (buf)));
+		peak1 = vmaxq_f32 (peak1, vabsq_f32 (vld1q_f32 (buf + 4)));
+	}
+
+	current = hmax (vmaxq_f32 (peak0, peak1));
+
+	for (; nsamples > 0; --nsamples, ++buf) {
+		float const a = fabsf (*buf);
+		if (a > current) {
+			current = a;
+		}
+	}
+
+	return current;
+}
+
+void
+arm_neon_find_peaks (const Sample * buf, pframes_t nframes, float *min, float *max)
+{
+	float32x4_t vmin = vdupq_n_f32 (*min);
+	float32x4_t vmax = vdupq_n_f32 (*max);
+
+	for (; nframes >= 4; nframes -= 4, buf += 4) {
+		float32x4_t const a = vld1q_f32 (buf);
+		vmin = vminq_f32 (vmin, a);
+		vmax = vmaxq_f32 (vmax, a);
+	}
+
+	float lo = hmin (vmin);
+	float hi = hmax (vmax);
+
+	for (; nframes > 0; --nframes, ++buf) {
+		if (*buf < lo) {
+			lo = *buf;
+		}
+		if (*buf > hi) {
+			hi = *buf;
+		}
+	}
+
+	*min = lo;
+	*max = hi;
+}
+
+void
+arm_neon_apply_gain_to_buffer (Sample * buf, pframes_t nframes, float gain)
+{
+	for (; nframes >= 4; nframes -= 4, buf += 4) {
+		vst1q_f32 (buf, vmulq_n_f32 (vld1q_f32 (buf), gain));
+	}
+
+	for (; nframes > 0; --nframes, ++buf) {
+		*buf *= gain;
+	}
+}
+
+void
+arm_neon_mix_buffers_with_gain (Sample * dst, const Sample * src, pframes_t nframes, float gain)
+{
+	for (; nframes >= 4; nframes -= 4, dst += 4, src += 4) {
+		/* multiply and add separately (not vmlaq/vfmaq) to round like default_mix_buffers_with_gain() */
+		float32x4_t const s = vmulq_n_f32 (vld1q_f32 (src), gain);
+		vst1q_f32 (dst, vaddq_f32 (vld1q_f32 (dst), s));
+	}
+
+	for (; nframes > 0; --nframes, ++dst, ++src) {
+		*dst += *src * gain;
+	}
+}
+
+void
+arm_neon_mix_buffers_no_gain (Sample * dst, const Sample * src, pframes_t nframes)
+{
+	for (; nframes >= 4; nframes -= 4, dst += 4, src += 4) {
+		vst1q_f32 (dst, vaddq_f32 (vld1q_f32 (dst), vld1q_f32 (src)));
+	}
+
+	for (; nframes > 0; --nframes, ++dst, ++src) {
+		*dst += *src;
+	}
+}
+
+void
+arm_neon_apply_gain_vector_to_buffer (Sample * buf, const gain_t * gain, pframes_t nframes, float scale)
+{
+	for (; nframes >= 4; nframes -= 4, buf += 4, gain += 4) {
+		float32x4_t const g = vmulq_n_f32 (vld1q_f32 (gain), scale);
+		vst1q_f32 (buf, vmulq_f32 (vld1q_f32 (buf), g));
+	}
+
+	for (; nframes > 0; --nframes, ++buf, ++gain) {
+		*buf *= *gain * scale;
+	}
+}
+
+void
+arm_neon_mix_buffers_with_gain_vector (Sample * dst, const Sample * src, const gain_t * gain, pframes_t nframes, float scale)
+{
+	for (; nframes >= 4; nframes -= 4, dst += 4, src += 4, gain += 4) {
+		float32x4_t const g = vmulq_n_f32 (vld1q_f32 (gain), scale);
+		float32x4_t const x = vmulq_f32 (vld1q_f32 (src), g);
+		vst1q_f32 (dst, vaddq_f32 (vld1q_f32 (dst), x));
+	}
+
+	for (; nframes > 0; --nframes, ++dst, ++src, ++gain) {
+		*dst += *src * (*gain * scale);
+	}
+}
+
+#endif /* BUILD_NEON_OPTIMIZATIONS */
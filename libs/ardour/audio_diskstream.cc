@@ -71,6 +71,24 @@ size_t  AudioDiskstream::_working_buffers_size = 0;
 Sample* AudioDiskstream::_mixdown_buffer       = 0;
 gain_t* AudioDiskstream::_gain_buffer          = 0;
 
+struct ThreadWorkingBuffers {
+	ThreadWorkingBuffers (framecnt_t sz)
+		: size (sz)
+		, mixdown (new Sample[sz])
+		, gain (new gain_t[sz]) {}
+
+	~ThreadWorkingBuffers () {
+		delete [] mixdown;
+		delete [] gain;
+	}
+
+	framecnt_t size;
+	Sample*    mixdown;
+	gain_t*    gain;
+};
+
+static Glib::StaticPrivate<ThreadWorkingBuffers> thread_working_buffers = GLIBMM_STATIC_PRIVATE_INIT;
+
 AudioDiskstream::AudioDiskstream (Session &sess, const string &name, Diskstream::Flag flag)
 	: Diskstream(sess, name, flag)
 	, channels (new ChannelList)
@@ -141,6 +159,17 @@ AudioDiskstream::allocate_working_buffers()
 	_gain_buffer          = new gain_t[_working_buffers_size];
 }
 
+void
+AudioDiskstream::allocate_thread_working_buffers ()
+{
+	ThreadWorkingBuffers* twb = thread_working_buffers.get ();
+
+	if (twb == 0 || twb->size != disk_io_frames()) {
+		/* this deletes any old buffers */
+		thread_working_buffers.set (new ThreadWorkingBuffers (disk_io_frames()));
+	}
+}
+
 void
 AudioDiskstream::free_working_buffers()
 {
@@ -868,6 +897,17 @@ AudioDiskstream::read (Sample* buf, Sample* mixdown_buffer, float* gain_buffer,
                        framepos_t& start, framecnt_t cnt,
                        ChannelInfo* /*channel_info*/, int channel, bool reversed)
 {
+	return read (&buf, 1, mixdown_buffer, gain_buffer, start, cnt, channel, reversed);
+}
+
+/** Read @a cnt frames of channels @a first_channel ... @a first_channel + @a n_bufs - 1
+ *  from our playlist into @a bufs, taking loops and reverse play into account.
+ */
+int
+AudioDiskstream::read (Sample** bufs, uint32_t n_bufs, Sample* mixdown_buffer, float* gain_buffer,
+                       framepos_t& start, framecnt_t cnt, int first_channel, bool reversed)
+{
+	vector<Sample*> dst (n_bufs);
 	framecnt_t this_read = 0;
 	bool reloop = false;
 	framepos_t loop_end = 0;
@@ -931,7 +971,11 @@ AudioDiskstream::read (Sample* buf, Sample* mixdown_buffer, float* gain_buffer,
 
 		this_read = min(cnt,this_read);
 
-		if (audio_playlist()->read (buf+offset, mixdown_buffer, gain_buffer, start, this_read, channel) != this_read) {
+		for (uint32_t n = 0; n < n_bufs; ++n) {
+			dst[n] = bufs[n] + offset;
+		}
+
+		if (audio_playlist()->read (&dst[0], n_bufs, mixdown_buffer, gain_buffer, start, this_read, first_channel) != this_read) {
 			error << string_compose(_("AudioDiskstream %1: cannot read %2 from playlist at frame %3"), _id, this_read,
 					 start) << endmsg;
 			return -1;
@@ -941,7 +985,9 @@ AudioDiskstream::read (Sample* buf, Sample* mixdown_buffer, float* gain_buffer,
 
 		if (reversed) {
 
-			swap_by_ptr (buf, buf + this_read - 1);
+			for (uint32_t n = 0; n < n_bufs; ++n) {
+				swap_by_ptr (dst[n], dst[n] + this_read - 1);
+			}
 
 		} else {
 
@@ -961,6 +1007,20 @@ AudioDiskstream::read (Sample* buf, Sample* mixdown_buffer, float* gain_buffer,
 	return 0;
 }
 
+int
+AudioDiskstream::do_refill ()
+{
+	ThreadWorkingBuffers* twb = thread_working_buffers.get ();
+
+	if (twb) {
+		return _do_refill (twb->mixdown, twb->gain);
+	}
+
+	/* the butler's own thread uses the shared buffers */
+
+	return _do_refill (_mixdown_buffer, _gain_buffer);
+}
+
 int
 AudioDiskstream::do_refill_with_alloc ()
 {
@@ -1104,6 +1164,10 @@ AudioDiskstream::_do_refill (Sample* mixdown_buffer, float* gain_buffer)
 		}
 	}
 
+	if (refill_all_channels (c, mixdown_buffer, gain_buffer, total_space, reversed, ret)) {
+		return ret;
+	}
+
 	framepos_t file_frame_tmp = 0;
 
 	for (chan_n = 0, i = c->begin(); i != c->end(); ++i, ++chan_n) {
@@ -1192,6 +1256,91 @@ AudioDiskstream::_do_refill (Sample* mixdown_buffer, float* gain_buffer)
 	return ret;
 }
 
+/** Try to refill every channel with the same read, so that regions whose channels
+ *  come from one interleaved file decode it once rather than once per channel.
+ *  This is only possible when all the playback buffers have the same free space
+ *  layout, which is the usual case since they are written and read in lock step.
+ *
+ *  @return false if the channels could not be read together, in which case
+ *  nothing has been done; otherwise true, with @a ret set as for _do_refill().
+ */
+bool
+AudioDiskstream::refill_all_channels (boost::shared_ptr<ChannelList> c, Sample* mixdown_buffer, float* gain_buffer,
+                                      framecnt_t total_space, bool reversed, int& ret)
+{
+	uint32_t const n_chans = c->size();
+
+	if (n_chans < 2) {
+		return false;
+	}
+
+	vector<RingBufferNPT<Sample>::rw_vector> vectors (n_chans);
+	vector<Sample*> bufs (n_chans);
+	ChannelList::iterator i;
+	uint32_t n;
+
+	for (n = 0, i = c->begin(); i != c->end(); ++i, ++n) {
+
+		(*i)->playback_buf->get_write_vector (&vectors[n]);
+
+		if (vectors[n].len[0] != vectors[0].len[0] || vectors[n].len[1] != vectors[0].len[1]) {
+			return false;
+		}
+	}
+
+	/* see _do_refill() for why the second part is ignored here */
+
+	framecnt_t const len1 = vectors[0].len[0];
+	framecnt_t const len2 = (len1 > disk_io_chunk_frames) ? 0 : vectors[0].len[1];
+	framepos_t file_frame_tmp = file_frame;
+	framecnt_t ts = total_space;
+	framecnt_t to_read;
+
+	to_read = min (ts, len1);
+	to_read = min (to_read, disk_io_chunk_frames);
+
+	if (to_read) {
+
+		for (n = 0; n < n_chans; ++n) {
+			bufs[n] = vectors[n].buf[0];
+		}
+
+		if (read (&bufs[0], n_chans, mixdown_buffer, gain_buffer, file_frame_tmp, to_read, 0, reversed)) {
+			ret = -1;
+			return true;
+		}
+
+		for (i = c->begin(); i != c->end(); ++i) {
+			(*i)->playback_buf->increment_write_ptr (to_read);
+		}
+
+		ts -= to_read;
+	}
+
+	to_read = min (ts, len2);
+
+	if (to_read) {
+
+		for (n = 0; n < n_chans; ++n) {
+			bufs[n] = vectors[n].buf[1];
+		}
+
+		if (read (&bufs[0], n_chans, mixdown_buffer, gain_buffer, file_frame_tmp, to_read, 0, reversed)) {
+			ret = -1;
+			return true;
+		}
+
+		for (i = c->begin(); i != c->end(); ++i) {
+			(*i)->playback_buf->increment_write_ptr (to_read);
+		}
+	}
+
+	file_frame = file_frame_tmp;
+	assert (file_frame >= 0);
+
+	return true;
+}
+
 /** Flush pending data to disk.
  *
  * Important note: this function will write *AT MOST* disk_io_chunk_frames
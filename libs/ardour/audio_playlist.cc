@@ -258,11 +258,22 @@ struct RegionSortByLayer {
 ARDOUR::framecnt_t
 AudioPlaylist::read (Sample *buf, Sample *mixdown_buffer, float *gain_buffer, framepos_t start,
 		     framecnt_t cnt, unsigned chan_n)
+{
+	return read (&buf, 1, mixdown_buffer, gain_buffer, start, cnt, chan_n);
+}
+
+/** Read channels @a first_chan ... @a first_chan + @a n_bufs - 1 of the
+ *  playlist into @a bufs.  Regions decode all of those channels that share an
+ *  interleaved file in one pass, rather than once per channel.
+ */
+ARDOUR::framecnt_t
+AudioPlaylist::read (Sample **bufs, uint32_t n_bufs, Sample *mixdown_buffer, float *gain_buffer, framepos_t start,
+		     framecnt_t cnt, uint32_t first_chan)
 {
 	framecnt_t ret = cnt;
 
-	DEBUG_TRACE (DEBUG::AudioPlayback, string_compose ("Playlist %1 read @ %2 for %3, channel %4, regions %5 xfades %6\n",
-							   name(), start, cnt, chan_n, regions.size(), _crossfades.size()));
+	DEBUG_TRACE (DEBUG::AudioPlayback, string_compose ("Playlist %1 read @ %2 for %3, channels %4..%5, regions %6 xfades %7\n",
+							   name(), start, cnt, first_chan, first_chan + n_bufs - 1, regions.size(), _crossfades.size()));
 
 	/* optimizing this memset() away involves a lot of conditionals
 	   that may well cause more of a hit due to cache misses
@@ -277,7 +288,9 @@ AudioPlaylist::read (Sample *buf, Sample *mixdown_buffer, float *gain_buffer, fr
 	   zeroed.
 	*/
 
-	memset (buf, 0, sizeof (Sample) * cnt);
+	for (uint32_t n = 0; n < n_bufs; ++n) {
+		memset (bufs[n], 0, sizeof (Sample) * cnt);
+	}
 
 	/* this function is never called from a realtime thread, so
 	   its OK to block (for short intervals).
@@ -343,13 +356,15 @@ AudioPlaylist::read (Sample *buf, Sample *mixdown_buffer, float *gain_buffer, fr
 			boost::shared_ptr<AudioRegion> ar = boost::dynamic_pointer_cast<AudioRegion>(*i);
                         DEBUG_TRACE (DEBUG::AudioPlayback, string_compose ("read from region %1\n", ar->name()));
 			assert(ar);
-			ar->read_at (buf, mixdown_buffer, gain_buffer, start, cnt, chan_n);
+			ar->read_at (bufs, n_bufs, mixdown_buffer, gain_buffer, start, cnt, first_chan);
 			_read_data_count += ar->read_data_count();
 		}
 
 		for (vector<boost::shared_ptr<Crossfade> >::iterator i = x.begin(); i != x.end(); ++i) {
                         DEBUG_TRACE (DEBUG::AudioPlayback, string_compose ("read from xfade between %1 & %2\n", (*i)->out()->name(), (*i)->in()->name()));
-			(*i)->read_at (buf, mixdown_buffer, gain_buffer, start, cnt, chan_n);
+			for (uint32_t n = 0; n < n_bufs; ++n) {
+				(*i)->read_at (bufs[n], mixdown_buffer, gain_buffer, start, cnt, first_chan + n);
+			}
 
 			/* don't JACK up _read_data_count, since its the same data as we just
 			   read from the regions, and the OS should handle that for us.
@@ -838,6 +853,7 @@ AudioPlaylist::destroy_region (boost::shared_ptr<Region> region)
 
 			if ((*i) == region) {
 				regions.erase (i);
+				unindex_region (region);
 				changed = true;
 			}
 
@@ -46,6 +46,8 @@ using namespace std;
 using namespace ARDOUR;
 using namespace PBD;
 
+static Glib::StaticRecMutex nested_read_lock = GLIBMM_STATIC_REC_MUTEX_INIT;
+
 AudioPlaylistSource::AudioPlaylistSource (Session& s, const ID& orig, const std::string& name, boost::shared_ptr<AudioPlaylist> p,
 					  uint32_t chn, frameoffset_t begin, framecnt_t len, Source::Flag flags)
 	: Source (s, DataType::AUDIO, name)
@@ -150,6 +152,12 @@ AudioPlaylistSource::read_unlocked (Sample* dst, framepos_t start, framecnt_t cn
 		to_zero = 0;
 	}
 
+	/* the per-level buffers are shared by every nested source, so
+	   only one thread at a time may be reading them. this is
+	   recursive because reading one level may read the next.
+	*/
+	Glib::RecMutex::Lock rm (nested_read_lock);
+
 	{
 		/* Don't need to hold the lock for the actual read, and
 		   actually, we cannot, but we do want to interlock
@@ -74,7 +74,7 @@ AudioBuffer&
 AudioPort::get_audio_buffer (pframes_t nframes)
 {
 	/* caller must hold process lock */
-       _buffer->set_data ((Sample *) jack_port_get_buffer (_jack_port, _cycle_nframes) +
+       _buffer->set_data ((Sample *) _engine->backend()->get_buffer (_port_handle, _cycle_nframes) +
                           _global_port_buffer_offset + _port_buffer_offset, nframes);
 	return *_buffer;
 }
@@ -25,9 +25,6 @@
 #include <sstream>
 
 #include <glibmm/timer.h>
-#include <jack/weakjack.h>
-#include <jack/jack.h>
-#include <jack/thread.h>
 
 #include "pbd/pthread_utils.h"
 #include "pbd/stacktrace.h"
@@ -41,6 +38,7 @@
 #include "ardour/amp.h"
 #include "ardour/audio_port.h"
 #include "ardour/audioengine.h"
+#include "ardour/jack_audio_backend.h"
 #include "ardour/buffer.h"
 #include "ardour/buffer_set.h"
 #include "ardour/cycle_timer.h"
@@ -66,11 +64,10 @@ using namespace PBD;
 gint AudioEngine::m_meter_exit;
 AudioEngine* AudioEngine::_instance = 0;
 
-#define GET_PRIVATE_JACK_POINTER(j)  jack_client_t* _priv_jack = (jack_client_t*) (j); if (!_priv_jack) { return; }
-#define GET_PRIVATE_JACK_POINTER_RET(j,r) jack_client_t* _priv_jack = (jack_client_t*) (j); if (!_priv_jack) { return r; }
-
-AudioEngine::AudioEngine (string client_name, string session_uuid)
-	: ports (new Ports)
+AudioEngine::AudioEngine (string client_name, string session_uuid, AudioBackend* backend)
+	: _backend (backend)
+	, ports (new Ports)
+	, ports_by_name (new PortMap)
 {
 	_instance = this; /* singleton */
 
@@ -81,7 +78,6 @@ AudioEngine::AudioEngine (string client_name, string session_uuid)
 	monitor_check_interval = INT32_MAX;
 	_processed_frames = 0;
 	_usecs_per_cycle = 0;
-	_jack = 0;
 	_frame_rate = 0;
 	_buffer_size = 0;
 	_freewheeling = false;
@@ -91,7 +87,14 @@ AudioEngine::AudioEngine (string client_name, string session_uuid)
 	m_meter_thread = 0;
 	g_atomic_int_set (&m_meter_exit, 0);
 
-	if (connect_to_jack (client_name, session_uuid)) {
+	if (!_backend) {
+		_backend = new JACKAudioBackend;
+	}
+
+	_backend->set_engine (this);
+
+	if (connect_to_backend (client_name, session_uuid)) {
+		delete _backend;
 		throw NoBackendAvailable ();
 	}
 
@@ -105,22 +108,30 @@ AudioEngine::~AudioEngine ()
 		session_removed.signal ();
 
 		if (_running) {
-			jack_client_close (_jack);
-			_jack = 0;
+			_backend->close ();
 		}
 
 		stop_metering_thread ();
 	}
+
+	delete _backend;
 }
 
 jack_client_t*
 AudioEngine::jack() const
 {
-	return _jack;
+	JACKAudioBackend* j = dynamic_cast<JACKAudioBackend*> (_backend);
+	return j ? j->jack () : 0;
+}
+
+bool
+AudioEngine::connected () const
+{
+	return _backend->connected ();
 }
 
 void
-_thread_init_callback (void * /*arg*/)
+AudioEngine::thread_init_callback ()
 {
 	/* make sure that anybody who needs to know about this thread
 	   knows about it.
@@ -136,86 +147,27 @@ _thread_init_callback (void * /*arg*/)
 	MIDI::Port::set_process_thread (pthread_self());
 }
 
-static void
-ardour_jack_error (const char* msg)
-{
-	error << "JACK: " << msg << endmsg;
-}
-
-void
-AudioEngine::set_jack_callbacks ()
-{
-	GET_PRIVATE_JACK_POINTER (_jack);
-
-        if (jack_on_info_shutdown) {
-                jack_on_info_shutdown (_priv_jack, halted_info, this);
-        } else {
-                jack_on_shutdown (_priv_jack, halted, this);
-        }
-
-        jack_set_thread_init_callback (_priv_jack, _thread_init_callback, this);
-        jack_set_process_thread (_priv_jack, _process_thread, this);
-        jack_set_sample_rate_callback (_priv_jack, _sample_rate_callback, this);
-        jack_set_buffer_size_callback (_priv_jack, _bufsize_callback, this);
-        jack_set_graph_order_callback (_priv_jack, _graph_order_callback, this);
-        jack_set_port_registration_callback (_priv_jack, _registration_callback, this);
-        jack_set_port_connect_callback (_priv_jack, _connect_callback, this);
-        jack_set_xrun_callback (_priv_jack, _xrun_callback, this);
-        jack_set_sync_callback (_priv_jack, _jack_sync_callback, this);
-        jack_set_freewheel_callback (_priv_jack, _freewheel_callback, this);
-
-        if (_session && _session->config.get_jack_time_master()) {
-                jack_set_timebase_callback (_priv_jack, 0, _jack_timebase_callback, this);
-        }
-
-#ifdef HAVE_JACK_SESSION
-        if( jack_set_session_callback)
-                jack_set_session_callback (_priv_jack, _session_callback, this);
-#endif
-
-        if (jack_set_latency_callback) {
-                jack_set_latency_callback (_priv_jack, _latency_callback, this);
-        }
-
-        jack_set_error_function (ardour_jack_error);
-}
-
 int
 AudioEngine::start ()
 {
-	GET_PRIVATE_JACK_POINTER_RET (_jack, -1);
+	if (!connected ()) {
+		return -1;
+	}
 
 	if (!_running) {
 
-                if (!jack_port_type_get_buffer_size) {
-                        warning << _("This version of JACK is old - you should upgrade to a newer version that supports jack_port_type_get_buffer_size()") << endmsg;
-		}
-
 		if (_session) {
 			BootMessage (_("Connect session to engine"));
-			_session->set_frame_rate (jack_get_sample_rate (_priv_jack));
+			_session->set_frame_rate (_backend->sample_rate ());
 		}
 
-                /* a proxy for whether jack_activate() will definitely call the buffer size
-                 * callback. with older versions of JACK, this function symbol will be null.
-                 * this is reliable, but not clean.
-                 */
-
-                if (!jack_port_type_get_buffer_size) {
-			jack_bufsize_callback (jack_get_buffer_size (_priv_jack));
-                }
-		
 		_processed_frames = 0;
 		last_monitor_check = 0;
 
-                set_jack_callbacks ();
-
-		if (jack_activate (_priv_jack) == 0) {
+		if (_backend->start () == 0) {
 			_running = true;
 			_has_run = true;
 			Running(); /* EMIT SIGNAL */
-		} else {
-			// error << _("cannot activate JACK client") << endmsg;
 		}
 	}
 		
@@ -225,16 +177,16 @@ AudioEngine::start ()
 int
 AudioEngine::stop (bool forever)
 {
-	GET_PRIVATE_JACK_POINTER_RET (_jack, -1);
+	if (!connected ()) {
+		return -1;
+	}
 
-	if (_priv_jack) {
-		if (forever) {
-			disconnect_from_jack ();
-		} else {
-			jack_deactivate (_priv_jack);
-			Stopped(); /* EMIT SIGNAL */
-			MIDI::Port::JackHalted (); /* EMIT SIGNAL */
-		}
+	if (forever) {
+		disconnect_from_jack ();
+	} else {
+		_backend->stop ();
+		Stopped(); /* EMIT SIGNAL */
+		MIDI::Port::JackHalted (); /* EMIT SIGNAL */
 	}
 
         if (forever) {
@@ -248,161 +200,69 @@ AudioEngine::stop (bool forever)
 bool
 AudioEngine::get_sync_offset (pframes_t& offset) const
 {
-
-#ifdef HAVE_JACK_VIDEO_SUPPORT
-
-	GET_PRIVATE_JACK_POINTER_RET (_jack, false);
-
-	jack_position_t pos;
-
-	if (_priv_jack) {
-		(void) jack_transport_query (_priv_jack, &pos);
-
-		if (pos.valid & JackVideoFrameOffset) {
-			offset = pos.video_offset;
-			return true;
-		}
-	}
-#else
-	/* keep gcc happy */
-	offset = 0;
-#endif
-
-	return false;
+	return _backend->get_sync_offset (offset);
 }
 
 void
-AudioEngine::_jack_timebase_callback (jack_transport_state_t state, pframes_t nframes,
-				      jack_position_t* pos, int new_position, void *arg)
+AudioEngine::xrun_callback ()
 {
-	static_cast<AudioEngine*> (arg)->jack_timebase_callback (state, nframes, pos, new_position);
+	Xrun (); /* EMIT SIGNAL */
 }
 
 void
-AudioEngine::jack_timebase_callback (jack_transport_state_t state, pframes_t nframes,
-				     jack_position_t* pos, int new_position)
+AudioEngine::graph_order_callback ()
 {
-	if (_jack && _session && _session->synced_to_jack()) {
-		_session->jack_timebase_callback (state, nframes, pos, new_position);
+	if (!port_remove_in_progress) {
+		GraphReordered (); /* EMIT SIGNAL */
 	}
 }
 
-int
-AudioEngine::_jack_sync_callback (jack_transport_state_t state, jack_position_t* pos, void* arg)
-{
-	return static_cast<AudioEngine*> (arg)->jack_sync_callback (state, pos);
-}
-
-int
-AudioEngine::jack_sync_callback (jack_transport_state_t state, jack_position_t* pos)
-{
-	if (_jack && _session) {
-		return _session->jack_sync_callback (state, pos);
-	}
-
-	return true;
-}
-
-int
-AudioEngine::_xrun_callback (void *arg)
-{
-	AudioEngine* ae = static_cast<AudioEngine*> (arg);
-	if (ae->connected()) {
-		ae->Xrun (); /* EMIT SIGNAL */
-	}
-	return 0;
-}
-
-#ifdef HAVE_JACK_SESSION
 void
-AudioEngine::_session_callback (jack_session_event_t *event, void *arg)
-{
-	printf( "helo.... " );
-	AudioEngine* ae = static_cast<AudioEngine*> (arg);
-	if (ae->connected()) {
-		ae->JackSessionEvent ( event ); /* EMIT SIGNAL */
-	}
-}
-#endif
-int
-AudioEngine::_graph_order_callback (void *arg)
-{
-	AudioEngine* ae = static_cast<AudioEngine*> (arg);
-
-	if (ae->connected() && !ae->port_remove_in_progress) {
-		ae->GraphReordered (); /* EMIT SIGNAL */
-	}
-	return 0;
-}
-
-/** Wrapped which is called by JACK as its process callback.  It is just
- * here to get us back into C++ land by calling AudioEngine::process_callback()
- * @param nframes Number of frames passed by JACK.
- * @param arg User argument passed by JACK, which will be the AudioEngine*.
- */
-int
-AudioEngine::_process_callback (pframes_t nframes, void *arg)
+AudioEngine::freewheel_callback (bool onoff)
 {
-	return static_cast<AudioEngine *> (arg)->process_callback (nframes);
-}
-
-void*
-AudioEngine::_process_thread (void *arg)
-{
-	return static_cast<AudioEngine *> (arg)->process_thread ();
-}
-
-void
-AudioEngine::_freewheel_callback (int onoff, void *arg)
-{
-	static_cast<AudioEngine*>(arg)->_freewheeling = onoff;
+	_freewheeling = onoff;
 }
 
 void
-AudioEngine::_registration_callback (jack_port_id_t /*id*/, int /*reg*/, void* arg)
+AudioEngine::port_registration_callback ()
 {
-	AudioEngine* ae = static_cast<AudioEngine*> (arg);
-
-	if (!ae->port_remove_in_progress) {
-		ae->PortRegisteredOrUnregistered (); /* EMIT SIGNAL */
+	if (!port_remove_in_progress) {
+		PortRegisteredOrUnregistered (); /* EMIT SIGNAL */
 	}
 }
 
+/** Called by the backend when a connection between two ports has been made or broken.
+ *  @param a Full name of one port.
+ *  @param b Full name of the other.
+ *  @param conn true if the ports were connected, false if they were disconnected.
+ */
 void
-AudioEngine::_latency_callback (jack_latency_callback_mode_t mode, void* arg)
-{
-	return static_cast<AudioEngine *> (arg)->jack_latency_callback (mode);
-}
-
-void
-AudioEngine::_connect_callback (jack_port_id_t id_a, jack_port_id_t id_b, int conn, void* arg)
+AudioEngine::port_connect_callback (string const & a, string const & b, bool conn)
 {
-	AudioEngine* ae = static_cast<AudioEngine*> (arg);
-
-	if (ae->port_remove_in_progress) {
+	if (port_remove_in_progress) {
 		return;
 	}
 
-	GET_PRIVATE_JACK_POINTER (ae->_jack);
+	/* ports that are not ours are reported as 0 */
 
-	jack_port_t* jack_port_a = jack_port_by_id (_priv_jack, id_a);
-	jack_port_t* jack_port_b = jack_port_by_id (_priv_jack, id_b);
+	string const rel_a = port_is_mine (a) ? make_port_name_relative (a) : string ();
+	string const rel_b = port_is_mine (b) ? make_port_name_relative (b) : string ();
 
 	Port* port_a = 0;
 	Port* port_b = 0;
 
-	boost::shared_ptr<Ports> pr = ae->ports.reader ();
+	boost::shared_ptr<Ports> pr = ports.reader ();
 	Ports::iterator i = pr->begin ();
 	while (i != pr->end() && (port_a == 0 || port_b == 0)) {
-		if (jack_port_a == (*i)->jack_port()) {
+		if (!rel_a.empty() && rel_a == (*i)->name()) {
 			port_a = *i;
-		} else if (jack_port_b == (*i)->jack_port()) {
+		} else if (!rel_b.empty() && rel_b == (*i)->name()) {
 			port_b = *i;
 		}
 		++i;
 	}
 
-	ae->PortConnectedOrDisconnected (port_a, port_b, conn == 0 ? false : true); /* EMIT SIGNAL */
+	PortConnectedOrDisconnected (port_a, port_b, conn); /* EMIT SIGNAL */
 }
 
 void
@@ -421,39 +281,21 @@ AudioEngine::split_cycle (pframes_t offset)
 	}
 }
 
-void*
-AudioEngine::process_thread ()
+/** Called by the backend from its process thread, before the first cycle */
+void
+AudioEngine::process_thread_init ()
 {
-        /* JACK doesn't do this for us when we use the wait API
-         */
-
-        _thread_init_callback (0);
+	thread_init_callback ();
 
-        _main_thread = new ProcessThread;
-
-        while (1) {
-                GET_PRIVATE_JACK_POINTER_RET(_jack,0);
-
-                pframes_t nframes = jack_cycle_wait (_priv_jack);
-
-                if (process_callback (nframes)) {
-                        return 0;
-                }
-
-		jack_cycle_signal (_priv_jack, 0);
-        }
-
-        return 0;
+	_main_thread = new ProcessThread;
 }
 
-/** Method called by JACK (via _process_callback) which says that there
- * is work to be done.
+/** Method called by the backend which says that there is work to be done.
  * @param nframes Number of frames to process.
  */
 int
 AudioEngine::process_callback (pframes_t nframes)
 {
-	GET_PRIVATE_JACK_POINTER_RET(_jack,0);
 	// CycleTimer ct ("AudioEngine::process");
 	Glib::Mutex::Lock tm (_process_lock, Glib::TRY_LOCK);
 
@@ -507,7 +349,7 @@ AudioEngine::process_callback (pframes_t nframes)
 		 */
                 boost::optional<int> r = Freewheel (nframes);
 		if (r.get_value_or (0)) {
-			jack_set_freewheel (_priv_jack, false);
+			_backend->freewheel (false);
 		}
 
 	} else {
@@ -571,13 +413,7 @@ AudioEngine::process_callback (pframes_t nframes)
 }
 
 int
-AudioEngine::_sample_rate_callback (pframes_t nframes, void *arg)
-{
-	return static_cast<AudioEngine *> (arg)->jack_sample_rate_callback (nframes);
-}
-
-int
-AudioEngine::jack_sample_rate_callback (pframes_t nframes)
+AudioEngine::sample_rate_callback (pframes_t nframes)
 {
 	_frame_rate = nframes;
 	_usecs_per_cycle = (int) floor ((((double) frames_per_cycle() / nframes)) * 1000000.0);
@@ -597,21 +433,15 @@ AudioEngine::jack_sample_rate_callback (pframes_t nframes)
 }
 
 void
-AudioEngine::jack_latency_callback (jack_latency_callback_mode_t mode)
+AudioEngine::latency_callback (bool for_playback)
 {
         if (_session) {
-                _session->update_latency (mode == JackPlaybackLatency);
+                _session->update_latency (for_playback);
         }
 }
 
 int
-AudioEngine::_bufsize_callback (pframes_t nframes, void *arg)
-{
-	return static_cast<AudioEngine *> (arg)->jack_bufsize_callback (nframes);
-}
-
-int
-AudioEngine::jack_bufsize_callback (pframes_t nframes)
+AudioEngine::buffer_size_callback (pframes_t nframes)
 {
         /* if the size has not changed, this should be a no-op */
 
@@ -619,31 +449,16 @@ AudioEngine::jack_bufsize_callback (pframes_t nframes)
                 return 0;
         }
 
-	GET_PRIVATE_JACK_POINTER_RET (_jack, 1);
+	if (!connected ()) {
+		return 1;
+	}
 
 	_buffer_size = nframes;
 	_usecs_per_cycle = (int) floor ((((double) nframes / frame_rate())) * 1000000.0);
 	last_monitor_check = 0;
 
-        if (jack_port_type_get_buffer_size) {
-                _raw_buffer_sizes[DataType::AUDIO] = jack_port_type_get_buffer_size (_priv_jack, JACK_DEFAULT_AUDIO_TYPE);
-                _raw_buffer_sizes[DataType::MIDI] = jack_port_type_get_buffer_size (_priv_jack, JACK_DEFAULT_MIDI_TYPE);
-        } else {
-
-                /* Old version of JACK.
-
-                   These crude guesses, see below where we try to get the right answers.
-
-                   Note that our guess for MIDI deliberatey tries to overestimate
-                   by a little. It would be nicer if we could get the actual
-                   size from a port, but we have to use this estimate in the
-                   event that there are no MIDI ports currently. If there are
-                   the value will be adjusted below.
-                */
-
-                _raw_buffer_sizes[DataType::AUDIO] = nframes * sizeof (Sample);
-                _raw_buffer_sizes[DataType::MIDI] = nframes * 4 - (nframes/2);
-        }
+	_raw_buffer_sizes[DataType::AUDIO] = _backend->raw_buffer_size (DataType::AUDIO);
+	_raw_buffer_sizes[DataType::MIDI] = _backend->raw_buffer_size (DataType::MIDI);
 
 	{
 		Glib::Mutex::Lock lm (_process_lock);
@@ -707,7 +522,7 @@ AudioEngine::set_session (Session *s)
 
 		start_metering_thread ();
 
-		pframes_t blocksize = jack_get_buffer_size (_jack);
+		pframes_t blocksize = _backend->buffer_size ();
 
 		/* page in as much of the session process code as we
 		   can before we really start running.
@@ -758,19 +573,21 @@ AudioEngine::remove_session ()
 void
 AudioEngine::port_registration_failure (const std::string& portname)
 {
-	GET_PRIVATE_JACK_POINTER (_jack);
-	string full_portname = jack_client_name;
+	if (!connected ()) {
+		return;
+	}
+
+	string full_portname = _client_name;
 	full_portname += ':';
 	full_portname += portname;
 
-
-	jack_port_t* p = jack_port_by_name (_priv_jack, full_portname.c_str());
+	AudioBackend::PortHandle p = _backend->get_port_by_name (full_portname);
 	string reason;
 
 	if (p) {
 		reason = string_compose (_("a port with the name \"%1\" already exists: check for duplicated track/bus names"), portname);
 	} else {
-		reason = string_compose (_("No more JACK ports are available. You will need to stop %1 and restart JACK with ports if you need this many tracks."), PROGRAM_NAME);
+		reason = string_compose (_("No more %2 ports are available. You will need to stop %1 and restart %2 with ports if you need this many tracks."), PROGRAM_NAME, _backend->name ());
 	}
 
 	throw PortRegistrationFailure (string_compose (_("AudioEngine: cannot register port \"%1\": %2"), portname, reason).c_str());
@@ -794,7 +611,11 @@ AudioEngine::register_port (DataType dtype, const string& portname, bool input)
 		boost::shared_ptr<Ports> ps = writer.get_copy ();
 		ps->insert (ps->begin(), newport);
 
-		/* writer goes out of scope, forces update */
+		RCUWriter<PortMap> map_writer (ports_by_name);
+		boost::shared_ptr<PortMap> pm = map_writer.get_copy ();
+		(*pm)[newport->name()] = newport;
+
+		/* writers go out of scope, forcing updates */
 
 		return newport;
 	}
@@ -837,20 +658,46 @@ AudioEngine::unregister_port (Port& port)
 		RCUWriter<Ports> writer (ports);
 		boost::shared_ptr<Ports> ps = writer.get_copy ();
 
+		RCUWriter<PortMap> map_writer (ports_by_name);
+		boost::shared_ptr<PortMap> pm = map_writer.get_copy ();
+
 		for (Ports::iterator i = ps->begin(); i != ps->end(); ++i) {
 			if ((*i) == &port) {
+				PortMap::iterator x = pm->find ((*i)->name());
+				if (x != pm->end() && x->second == *i) {
+					pm->erase (x);
+				}
 				delete *i;
 				ps->erase (i);
 				break;
 			}
 		}
 
-		/* writer goes out of scope, forces update */
+		/* writers go out of scope, forcing updates */
 	}
 
 	return 0;
 }
 
+/** Called by a Port when its name has been changed.
+ *  @param old_relative_name Port's old name, without the client name.
+ *  @param new_relative_name Port's new name, without the client name.
+ */
+void
+AudioEngine::port_renamed (const string& old_relative_name, const string& new_relative_name)
+{
+	RCUWriter<PortMap> writer (ports_by_name);
+	boost::shared_ptr<PortMap> pm = writer.get_copy ();
+
+	PortMap::iterator x = pm->find (old_relative_name);
+
+	if (x != pm->end()) {
+		Port* p = x->second;
+		pm->erase (x);
+		(*pm)[new_relative_name] = p;
+	}
+}
+
 int
 AudioEngine::connect (const string& source, const string& destination)
 {
@@ -926,7 +773,9 @@ AudioEngine::disconnect (const string& source, const string& destination)
 int
 AudioEngine::disconnect (Port& port)
 {
-	GET_PRIVATE_JACK_POINTER_RET (_jack,-1);
+	if (!connected ()) {
+		return -1;
+	}
 
 	if (!_running) {
 		if (!_has_run) {
@@ -943,9 +792,11 @@ AudioEngine::disconnect (Port& port)
 ARDOUR::framecnt_t
 AudioEngine::frame_rate () const
 {
-	GET_PRIVATE_JACK_POINTER_RET (_jack, 0);
+	if (!connected ()) {
+		return 0;
+	}
 	if (_frame_rate == 0) {
-		return (_frame_rate = jack_get_sample_rate (_priv_jack));
+		return (_frame_rate = _backend->sample_rate ());
 	} else {
 		return _frame_rate;
 	}
@@ -961,9 +812,11 @@ AudioEngine::raw_buffer_size (DataType t)
 ARDOUR::pframes_t
 AudioEngine::frames_per_cycle () const
 {
-	GET_PRIVATE_JACK_POINTER_RET (_jack,0);
+	if (!connected ()) {
+		return 0;
+	}
 	if (_buffer_size == 0) {
-		return jack_get_buffer_size (_jack);
+		return _backend->buffer_size ();
 	} else {
 		return _buffer_size;
 	}
@@ -990,14 +843,11 @@ AudioEngine::get_port_by_name (const string& portname)
                 return 0;
         }
 
-	std::string const rel = make_port_name_relative (portname);
+	boost::shared_ptr<PortMap> pm = ports_by_name.reader();
+	PortMap::const_iterator x = pm->find (make_port_name_relative (portname));
 
-	boost::shared_ptr<Ports> pr = ports.reader();
-
-	for (Ports::iterator i = pr->begin(); i != pr->end(); ++i) {
-		if (rel == (*i)->name()) {
-			return *i;
-		}
+	if (x != pm->end()) {
+		return x->second;
 	}
 
         return 0;
@@ -1006,7 +856,9 @@ AudioEngine::get_port_by_name (const string& portname)
 const char **
 AudioEngine::get_ports (const string& port_name_pattern, const string& type_name_pattern, uint32_t flags)
 {
-	GET_PRIVATE_JACK_POINTER_RET (_jack,0);
+	if (!connected ()) {
+		return 0;
+	}
 	if (!_running) {
 		if (!_has_run) {
 			fatal << _("get_ports called before engine was started") << endmsg;
@@ -1015,58 +867,25 @@ AudioEngine::get_ports (const string& port_name_pattern, const string& type_name
 			return 0;
 		}
 	}
-	return jack_get_ports (_priv_jack, port_name_pattern.c_str(), type_name_pattern.c_str(), flags);
-}
-
-void
-AudioEngine::halted_info (jack_status_t code, const char* reason, void *arg)
-{
-        /* called from jack shutdown handler  */
-
-        AudioEngine* ae = static_cast<AudioEngine *> (arg);
-        bool was_running = ae->_running;
-
-        ae->stop_metering_thread ();
-
-        ae->_running = false;
-        ae->_buffer_size = 0;
-        ae->_frame_rate = 0;
-        ae->_jack = 0;
-
-        if (was_running) {
-#ifdef HAVE_JACK_ON_INFO_SHUTDOWN
-                switch (code) {
-                case JackBackendError:
-                        ae->Halted(reason); /* EMIT SIGNAL */
-                        break;
-                default:
-                        ae->Halted(""); /* EMIT SIGNAL */
-                }
-#else
-                ae->Halted(""); /* EMIT SIGNAL */
-#endif
-        }
+	return _backend->get_ports (port_name_pattern, type_name_pattern, flags);
 }
 
+/** Called by the backend, from whatever thread it likes, when it has stopped
+ *  running us of its own accord.
+ */
 void
-AudioEngine::halted (void *arg)
+AudioEngine::halted_callback (const char* reason)
 {
-        cerr << "HALTED by JACK\n";
-
-        /* called from jack shutdown handler  */
+	bool const was_running = _running;
 
-	AudioEngine* ae = static_cast<AudioEngine *> (arg);
-	bool was_running = ae->_running;
-
-	ae->stop_metering_thread ();
+	stop_metering_thread ();
 
-	ae->_running = false;
-	ae->_buffer_size = 0;
-	ae->_frame_rate = 0;
-        ae->_jack = 0;
+	_running = false;
+	_buffer_size = 0;
+	_frame_rate = 0;
 
 	if (was_running) {
-		ae->Halted(""); /* EMIT SIGNAL */
+		Halted (reason); /* EMIT SIGNAL */
 		MIDI::Port::JackHalted (); /* EMIT SIGNAL */
 	}
 }
@@ -1081,22 +900,14 @@ AudioEngine::died ()
         _running = false;
 	_buffer_size = 0;
 	_frame_rate = 0;
-	_jack = 0;
+
+	_backend->client_died ();
 }
 
 bool
 AudioEngine::can_request_hardware_monitoring ()
 {
-	GET_PRIVATE_JACK_POINTER_RET (_jack,false);
-	const char ** ports;
-
-	if ((ports = jack_get_ports (_priv_jack, NULL, JACK_DEFAULT_AUDIO_TYPE, JackPortCanMonitor)) == 0) {
-		return false;
-	}
-
-	free (ports);
-
-	return true;
+	return connected () && _backend->can_monitor_input ();
 }
 
 ChanCount
@@ -1104,21 +915,26 @@ AudioEngine::n_physical (unsigned long flags) const
 {
 	ChanCount c;
 
-	GET_PRIVATE_JACK_POINTER_RET (_jack, c);
-
-	const char ** ports = jack_get_ports (_priv_jack, NULL, NULL, JackPortIsPhysical | flags);
-	if (ports == 0) {
+	if (!connected ()) {
 		return c;
 	}
 
-	for (uint32_t i = 0; ports[i]; ++i) {
-		if (!strstr (ports[i], "Midi-Through")) {
-			DataType t (jack_port_type (jack_port_by_name (_jack, ports[i])));
-			c.set (t, c.get (t) + 1);
+	for (DataType::iterator t = DataType::begin(); t != DataType::end(); ++t) {
+
+		const char ** ports = _backend->get_ports ("", (*t).to_jack_type(), JackPortIsPhysical | flags);
+
+		if (ports == 0) {
+			continue;
 		}
-	}
 
-	free (ports);
+		for (uint32_t i = 0; ports[i]; ++i) {
+			if (!strstr (ports[i], "Midi-Through")) {
+				c.set (*t, c.get (*t) + 1);
+			}
+		}
+
+		free (ports);
+	}
 
 	return c;
 }
@@ -1138,10 +954,13 @@ AudioEngine::n_physical_outputs () const
 void
 AudioEngine::get_physical (DataType type, unsigned long flags, vector<string>& phy)
 {
-	GET_PRIVATE_JACK_POINTER (_jack);
+	if (!connected ()) {
+		return;
+	}
+
 	const char ** ports;
 
-	if ((ports = jack_get_ports (_priv_jack, NULL, type.to_jack_type(), JackPortIsPhysical | flags)) == 0) {
+	if ((ports = _backend->get_ports ("", type.to_jack_type(), JackPortIsPhysical | flags)) == 0) {
 		return;
 	}
 
@@ -1177,53 +996,87 @@ AudioEngine::get_physical_outputs (DataType type, vector<string>& outs)
 void
 AudioEngine::transport_stop ()
 {
-	GET_PRIVATE_JACK_POINTER (_jack);
-	jack_transport_stop (_priv_jack);
+	_backend->transport_stop ();
 }
 
 void
 AudioEngine::transport_start ()
 {
-	GET_PRIVATE_JACK_POINTER (_jack);
-	jack_transport_start (_priv_jack);
+	_backend->transport_start ();
 }
 
 void
 AudioEngine::transport_locate (framepos_t where)
 {
-	GET_PRIVATE_JACK_POINTER (_jack);
-	jack_transport_locate (_priv_jack, where);
+	_backend->transport_locate (where);
 }
 
 AudioEngine::TransportState
 AudioEngine::transport_state ()
 {
-	GET_PRIVATE_JACK_POINTER_RET (_jack, ((TransportState) JackTransportStopped));
-	jack_position_t pos;
-	return (TransportState) jack_transport_query (_priv_jack, &pos);
+	return (TransportState) _backend->transport_state ();
+}
+
+pframes_t
+AudioEngine::transport_frame () const
+{
+	if (!_running || !connected ()) {
+		return 0;
+	}
+	return _backend->transport_frame ();
+}
+
+pframes_t
+AudioEngine::frames_since_cycle_start ()
+{
+	if (!_running || !connected ()) {
+		return 0;
+	}
+	return _backend->frames_since_cycle_start ();
+}
+
+pframes_t
+AudioEngine::frame_time ()
+{
+	if (!_running || !connected ()) {
+		return 0;
+	}
+	return _backend->frame_time ();
+}
+
+pframes_t
+AudioEngine::frame_time_at_cycle_start ()
+{
+	if (!_running || !connected ()) {
+		return 0;
+	}
+	return _backend->frame_time_at_cycle_start ();
+}
+
+float
+AudioEngine::get_cpu_load ()
+{
+	if (!_running || !connected ()) {
+		return 0;
+	}
+	return _backend->cpu_load ();
 }
 
 int
 AudioEngine::reset_timebase ()
 {
-	GET_PRIVATE_JACK_POINTER_RET (_jack, -1);
-	if (_session) {
-		if (_session->config.get_jack_time_master()) {
-			return jack_set_timebase_callback (_priv_jack, 0, _jack_timebase_callback, this);
-		} else {
-			return jack_release_timebase (_jack);
-		}
-	}
-	return 0;
+	return _backend->reset_timebase ();
 }
 
 int
 AudioEngine::freewheel (bool onoff)
 {
-	GET_PRIVATE_JACK_POINTER_RET (_jack, -1);
+	if (!connected ()) {
+		return -1;
+	}
 
 	if (onoff != _freewheeling) {
-                return jack_set_freewheel (_priv_jack, onoff);
+                return _backend->freewheel (onoff);
 
 	} else {
                 /* already doing what has been asked for */
@@ -1234,7 +1087,7 @@ AudioEngine::freewheel (bool onoff)
 void
 AudioEngine::remove_all_ports ()
 {
-	/* make sure that JACK callbacks that will be invoked as we cleanup
+	/* make sure that backend callbacks that will be invoked as we cleanup
 	 * ports know that they have nothing to do.
 	 */
 
@@ -1252,11 +1105,15 @@ AudioEngine::remove_all_ports ()
 			to_be_deleted.push_back (*i);
 		}
 		ps->clear ();
+
+		RCUWriter<PortMap> map_writer (ports_by_name);
+		map_writer.get_copy()->clear ();
 	}
 
-	/* clear dead wood list in RCU */
+	/* clear dead wood lists in RCU */
 
 	ports.flush ();
+	ports_by_name.flush ();
 
 	/* now do the actual deletion, given that "ports" is now empty, thus
 	   preventing anyone else from getting a handle on a Port
@@ -1270,40 +1127,15 @@ AudioEngine::remove_all_ports ()
 }
 
 int
-AudioEngine::connect_to_jack (string client_name, string session_uuid)
+AudioEngine::connect_to_backend (string client_name, string session_uuid)
 {
-        EnvironmentalProtectionAgency* global_epa = EnvironmentalProtectionAgency::get_global_epa ();
-        boost::scoped_ptr<EnvironmentalProtectionAgency> current_epa;
-	jack_options_t options = JackNullOption;
-	jack_status_t status;
-	const char *server_name = NULL;
-
-        /* revert all environment settings back to whatever they were when ardour started
-         */
-
-        if (global_epa) {
-                current_epa.reset (new EnvironmentalProtectionAgency(true)); /* will restore settings when we leave scope */
-                global_epa->restore ();
-        }
-
-	jack_client_name = client_name; /* might be reset below */
-#ifdef HAVE_JACK_SESSION
-	if (! session_uuid.empty())
-	    _jack = jack_client_open (jack_client_name.c_str(), JackSessionID, &status, session_uuid.c_str());
-	else
-#endif
-	    _jack = jack_client_open (jack_client_name.c_str(), options, &status, server_name);
-
-	if (_jack == NULL) {
-		// error message is not useful here
+	if (_backend->open (client_name, session_uuid)) {
 		return -1;
 	}
 
-	GET_PRIVATE_JACK_POINTER_RET (_jack, -1);
+	/* the backend may have had to change the name */
 
-	if (status & JackNameNotUnique) {
-		jack_client_name = jack_get_client_name (_priv_jack);
-	}
+	_client_name = _backend->client_name ();
 
 	return 0;
 }
@@ -1311,7 +1143,9 @@ AudioEngine::connect_to_jack (string client_name, string session_uuid)
 int
 AudioEngine::disconnect_from_jack ()
 {
-	GET_PRIVATE_JACK_POINTER_RET (_jack, 0);
+	if (!connected ()) {
+		return 0;
+	}
 
 	if (_running) {
 		stop_metering_thread ();
@@ -1319,8 +1153,7 @@ AudioEngine::disconnect_from_jack ()
 
 	{
 		Glib::Mutex::Lock lm (_process_lock);
-		jack_client_close (_priv_jack);
-		_jack = 0;
+		_backend->close ();
 	}
 
 	_buffer_size = 0;
@@ -1345,8 +1178,8 @@ AudioEngine::reconnect_to_jack ()
 		Glib::usleep (250000);
 	}
 
-	if (connect_to_jack (jack_client_name, "")) {
-		error << _("failed to connect to JACK") << endmsg;
+	if (connect_to_backend (_client_name, "")) {
+		error << string_compose (_("failed to connect to %1"), _backend->name ()) << endmsg;
 		return -1;
 	}
 
@@ -1366,21 +1199,17 @@ AudioEngine::reconnect_to_jack ()
 		return -1;
 	}
 
-	GET_PRIVATE_JACK_POINTER_RET (_jack,-1);
-
-	MIDI::Manager::instance()->reestablish (_priv_jack);
+	MIDI::Manager::instance()->reestablish (jack ());
 
 	if (_session) {
-		_session->reset_jack_connection (_priv_jack);
-                jack_bufsize_callback (jack_get_buffer_size (_priv_jack));
-		_session->set_frame_rate (jack_get_sample_rate (_priv_jack));
+		_session->reset_jack_connection (jack ());
+                buffer_size_callback (_backend->buffer_size ());
+		_session->set_frame_rate (_backend->sample_rate ());
 	}
 
 	last_monitor_check = 0;
 
-        set_jack_callbacks ();
-
-	if (jack_activate (_priv_jack) == 0) {
+	if (_backend->start () == 0) {
 		_running = true;
 		_has_run = true;
 	} else {
@@ -1405,20 +1234,17 @@ AudioEngine::reconnect_to_jack ()
 int
 AudioEngine::request_buffer_size (pframes_t nframes)
 {
-	GET_PRIVATE_JACK_POINTER_RET (_jack, -1);
-
-	if (nframes == jack_get_buffer_size (_priv_jack)) {
-                return 0;
+	if (!connected ()) {
+		return -1;
 	}
 
-	return jack_set_buffer_size (_priv_jack, nframes);
+	return _backend->set_buffer_size (nframes);
 }
 
 void
 AudioEngine::update_total_latencies ()
 {
-	GET_PRIVATE_JACK_POINTER (_jack);
-	jack_recompute_total_latencies (_priv_jack);
+	_backend->update_total_latencies ();
 }
 
 string
@@ -1435,7 +1261,7 @@ AudioEngine::make_port_name_relative (string portname) const
 		}
 	}
 
-	if ((n != len) && (portname.substr (0, n) == jack_client_name)) {
+	if ((n != len) && (portname.substr (0, n) == _client_name)) {
 		return portname.substr (n+1);
 	}
 
@@ -1451,7 +1277,7 @@ AudioEngine::make_port_name_non_relative (string portname) const
 		return portname;
 	}
 
-	str  = jack_client_name;
+	str  = _client_name;
 	str += ':';
 	str += portname;
 
@@ -1462,7 +1288,7 @@ bool
 AudioEngine::port_is_mine (const string& portname) const
 {
 	if (portname.find_first_of (':') != string::npos) {
-		if (portname.substr (0, jack_client_name.length ()) != jack_client_name) {
+		if (portname.substr (0, _client_name.length ()) != _client_name) {
                         return false;
                 }
         }
@@ -1472,60 +1298,55 @@ AudioEngine::port_is_mine (const string& portname) const
 bool
 AudioEngine::is_realtime () const
 {
-	GET_PRIVATE_JACK_POINTER_RET (_jack,false);
-	return jack_is_realtime (_priv_jack);
+	return connected () && _backend->is_realtime ();
 }
 
 int
-AudioEngine::create_process_thread (boost::function<void()> f, pthread_t* thread, size_t stacksize)
+AudioEngine::client_real_time_priority ()
 {
-        GET_PRIVATE_JACK_POINTER_RET (_jack, 0);
-        ThreadData* td = new ThreadData (this, f, stacksize);
-
-        if (jack_client_create_thread (_priv_jack, thread, jack_client_real_time_priority (_priv_jack),
-                                       jack_is_realtime (_priv_jack), _start_process_thread, td)) {
-                return -1;
-        }
-
-        return 0;
+	if (!connected ()) {
+		return 0;
+	}
+	return _backend->client_real_time_priority ();
 }
 
-void*
-AudioEngine::_start_process_thread (void* arg)
+int
+AudioEngine::create_process_thread (boost::function<void()> f, pthread_t* thread, size_t stacksize)
 {
-        ThreadData* td = reinterpret_cast<ThreadData*> (arg);
-        boost::function<void()> f = td->f;
-        delete td;
-
-        f ();
-
-        return 0;
+	if (!connected ()) {
+		return 0;
+	}
+	return _backend->create_process_thread (f, thread, stacksize);
 }
 
 bool
 AudioEngine::port_is_physical (const std::string& portname) const
 {
-        GET_PRIVATE_JACK_POINTER_RET(_jack, false);
+	if (!connected ()) {
+		return false;
+	}
 
-        jack_port_t *port = jack_port_by_name (_priv_jack, portname.c_str());
+	AudioBackend::PortHandle port = _backend->get_port_by_name (portname);
 
-        if (!port) {
-                return false;
-        }
+	if (!port) {
+		return false;
+	}
 
-        return jack_port_flags (port) & JackPortIsPhysical;
+	return _backend->port_flags (port) & JackPortIsPhysical;
 }
 
 void
 AudioEngine::ensure_monitor_input (const std::string& portname, bool yn) const
 {
-        GET_PRIVATE_JACK_POINTER(_jack);
+	if (!connected ()) {
+		return;
+	}
 
-        jack_port_t *port = jack_port_by_name (_priv_jack, portname.c_str());
+	AudioBackend::PortHandle port = _backend->get_port_by_name (portname);
 
-        if (!port) {
-                return;
-        }
+	if (!port) {
+		return;
+	}
 
-        jack_port_request_monitor (port, yn);
+	_backend->request_monitor_input (port, yn);
 }
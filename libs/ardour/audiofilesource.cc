@@ -140,7 +140,7 @@ AudioFileSource::~AudioFileSource ()
 	DEBUG_TRACE (DEBUG::Destruction, string_compose ("AudioFileSource destructor %1, removable? %2\n", _path, removable()));
 	if (removable()) {
 		unlink (_path.c_str());
-		unlink (peakpath.c_str());
+		remove_peakfile (peakpath);
 	}
 }
 
@@ -298,7 +298,7 @@ AudioFileSource::mark_streaming_write_completed ()
 int
 AudioFileSource::move_dependents_to_trash()
 {
-	return ::unlink (peakpath.c_str());
+	return remove_peakfile (peakpath);
 }
 
 void
@@ -20,6 +20,7 @@
 #include <cmath>
 #include <climits>
 #include <cfloat>
+#include <cstring>
 #include <algorithm>
 
 #include <set>
@@ -389,24 +390,11 @@ AudioRegion::_read_at (const SourceList& srcs, framecnt_t limit,
 		return 0; /* read nothing */
 	}
 
-	/* precondition: caller has verified that we cover the desired section */
-
-	if (position < _position) {
-		internal_offset = 0;
-		buf_offset = _position - position;
-		cnt -= buf_offset;
-	} else {
-		internal_offset = position - _position;
-		buf_offset = 0;
-	}
-
-	if (internal_offset >= limit) {
+	if ((to_read = read_extent (limit, position, cnt, internal_offset, buf_offset)) == 0) {
 		return 0; /* read nothing */
 	}
 
-	if ((to_read = min (cnt, limit - internal_offset)) == 0) {
-		return 0; /* read nothing */
-	}
+	Sample* const scratch = mixdown_buffer;
 
 	if (opaque() || raw) {
 		/* overwrite whatever is there */
@@ -454,33 +442,95 @@ AudioRegion::_read_at (const SourceList& srcs, framecnt_t limit,
 		}
 	}
 
-	if (rops & ReadOpsFades) {
+	/* opaque and raw reads go straight into buf, leaving the caller's
+	   mixdown buffer free to help with the gain calculation.
+	*/
 
-		/* fade in */
+	ReadGain g;
+	compute_read_gain (g, mixdown_buffer, gain_buffer, (mixdown_buffer == buf + buf_offset) ? scratch : 0,
+			   internal_offset, to_read, limit, rops);
 
-		if (_fade_in_active && _session.config.get_use_region_fades()) {
+	if (!opaque() && (mixdown_buffer != buf + buf_offset)) {
 
-			framecnt_t fade_in_length = (framecnt_t) _fade_in->back()->when;
+		/* gack. the things we do for users.
+		 */
 
-			/* see if this read is within the fade in */
+		apply_read_gain (g, buf + buf_offset, mixdown_buffer, gain_buffer, to_read);
 
-			if (internal_offset < fade_in_length) {
+	} else {
+		apply_read_gain (g, 0, mixdown_buffer, gain_buffer, to_read);
+	}
 
-				framecnt_t fi_limit;
+	return to_read;
+}
 
-				fi_limit = min (to_read, fade_in_length - internal_offset);
+/** Work out which part of a read starting at @a position falls within this region.
+ *  On return @a cnt has been reduced by @a buf_offset, the number of frames of the
+ *  destination that precede the region.
+ *  @return number of frames to read, or 0 if the read misses the region entirely.
+ */
+framecnt_t
+AudioRegion::read_extent (framecnt_t limit, framepos_t position, framecnt_t& cnt,
+			  frameoffset_t& internal_offset, frameoffset_t& buf_offset) const
+{
+	/* precondition: caller has verified that we cover the desired section */
 
-				_fade_in->curve().get_vector (internal_offset, internal_offset+fi_limit, gain_buffer, fi_limit);
+	if (position < _position) {
+		internal_offset = 0;
+		buf_offset = _position - position;
+		cnt -= buf_offset;
+	} else {
+		internal_offset = position - _position;
+		buf_offset = 0;
+	}
 
-				for (framecnt_t n = 0; n < fi_limit; ++n) {
-					mixdown_buffer[n] *= gain_buffer[n];
-				}
+	if (internal_offset >= limit) {
+		return 0; /* read nothing */
+	}
+
+	return min (cnt, limit - internal_offset);
+}
+
+/** Work out the gain to apply to frames @a internal_offset ... @a internal_offset + @a to_read - 1
+ *  of this region: the product of whichever of the fades, envelope and scale apply.  The
+ *  per-frame part is left in @a gain_buffer, and the ranges of it that are valid in @a g;
+ *  outside them only @a g.scale applies.
+ *
+ *  @param curve_buffer Space for @a to_read values that is used to combine the fades with
+ *  the envelope, or 0 if there is none.  In that case the fades are applied directly to the
+ *  @a to_read frames of @a mixdown_buffer when they cannot be combined with the envelope.
+ */
+void
+AudioRegion::compute_read_gain (ReadGain& g, Sample *mixdown_buffer, float *gain_buffer, float *curve_buffer,
+				frameoffset_t internal_offset, framecnt_t to_read, framecnt_t limit, ReadOps rops) const
+{
+	g = ReadGain ();
+
+	if ((rops & ReadOpsOwnScaling) && _scale_amplitude != 1.0f) {
+		g.scale = _scale_amplitude;
+	}
+
+	/* the parts of this read that are within each fade, as offsets into the buffers */
+
+	framecnt_t fi_end = 0;
+	framecnt_t fo_start = 0;
+	framecnt_t fo_end = 0;
+	framecnt_t fo_curve_offset = 0;
+
+	if ((rops & ReadOpsFades) && _session.config.get_use_region_fades()) {
+
+		if (_fade_in_active) {
+
+			framecnt_t fade_in_length = (framecnt_t) _fade_in->back()->when;
+
+			/* see if this read is within the fade in */
+
+			if (internal_offset < fade_in_length) {
+				fi_end = min (to_read, fade_in_length - internal_offset);
 			}
 		}
 
-		/* fade out */
-
-		if (_fade_out_active && _session.config.get_use_region_fades()) {
+		if (_fade_out_active) {
 
 			/* see if some part of this read is within the fade out */
 
@@ -500,64 +550,248 @@ AudioRegion::_read_at (const SourceList& srcs, framecnt_t limit,
 
 		*/
 
-
 			framecnt_t fade_out_length     = (framecnt_t) _fade_out->back()->when;
 			framecnt_t fade_interval_start = max(internal_offset, limit-fade_out_length);
 			framecnt_t fade_interval_end   = min(internal_offset + to_read, limit);
 
 			if (fade_interval_end > fade_interval_start) {
 				/* (part of the) the fade out is  in this buffer */
+				fo_curve_offset = fade_interval_start - (limit-fade_out_length);
+				fo_start = fade_interval_start - internal_offset;
+				fo_end = fo_start + (fade_interval_end - fade_interval_start);
+			}
+		}
+	}
 
-				framecnt_t fo_limit = fade_interval_end - fade_interval_start;
-				framecnt_t curve_offset = fade_interval_start - (limit-fade_out_length);
-				framecnt_t fade_offset = fade_interval_start - internal_offset;
+	if ((rops & ReadOpsOwnAutomation) && envelope_active()) {
 
-				_fade_out->curve().get_vector (curve_offset, curve_offset+fo_limit, gain_buffer, fo_limit);
+		if (!curve_buffer) {
 
-				for (framecnt_t n = 0, m = fade_offset; n < fo_limit; ++n, ++m) {
-					mixdown_buffer[m] *= gain_buffer[n];
-				}
+			/* gain_buffer is about to be taken by the envelope, and there is nowhere
+			   else to put the fades, so apply them now.
+			*/
+
+			if (fi_end) {
+				_fade_in->curve().get_vector (internal_offset, internal_offset + fi_end, gain_buffer, fi_end);
+				apply_gain_vector_to_buffer (mixdown_buffer, gain_buffer, fi_end, 1.0f);
+				fi_end = 0;
 			}
 
+			if (fo_end > fo_start) {
+				_fade_out->curve().get_vector (fo_curve_offset, fo_curve_offset + fo_end - fo_start, gain_buffer, fo_end - fo_start);
+				apply_gain_vector_to_buffer (mixdown_buffer + fo_start, gain_buffer, fo_end - fo_start, 1.0f);
+				fo_end = fo_start;
+			}
 		}
+
+		_envelope->curve().get_vector (internal_offset, internal_offset + to_read, gain_buffer, to_read);
+		g.add_range (0, to_read);
+
+		if (fi_end) {
+			_fade_in->curve().get_vector (internal_offset, internal_offset + fi_end, curve_buffer, fi_end);
+			apply_gain_vector_to_buffer (gain_buffer, curve_buffer, fi_end, 1.0f);
+		}
+
+		if (fo_end > fo_start) {
+			_fade_out->curve().get_vector (fo_curve_offset, fo_curve_offset + fo_end - fo_start, curve_buffer, fo_end - fo_start);
+			apply_gain_vector_to_buffer (gain_buffer + fo_start, curve_buffer, fo_end - fo_start, 1.0f);
+		}
+
+		return;
 	}
 
-	/* Regular gain curves and scaling */
+	if (fi_end) {
+		_fade_in->curve().get_vector (internal_offset, internal_offset + fi_end, gain_buffer, fi_end);
+		g.add_range (0, fi_end);
+	}
 
-	if ((rops & ReadOpsOwnAutomation) && envelope_active())  {
-		_envelope->curve().get_vector (internal_offset, internal_offset + to_read, gain_buffer, to_read);
+	if (fo_end > fo_start) {
 
-		if ((rops & ReadOpsOwnScaling) && _scale_amplitude != 1.0f) {
-			for (framecnt_t n = 0; n < to_read; ++n) {
-				mixdown_buffer[n] *= gain_buffer[n] * _scale_amplitude;
+		if (fo_start >= fi_end) {
+
+			/* the usual case: the fades do not overlap */
+
+			_fade_out->curve().get_vector (fo_curve_offset, fo_curve_offset + fo_end - fo_start, gain_buffer + fo_start, fo_end - fo_start);
+			g.add_range (fo_start, fo_end);
+
+		} else if (curve_buffer) {
+
+			/* multiply the overlap into the fade in, and copy the rest */
+
+			framecnt_t const overlap = min (fi_end, fo_end) - fo_start;
+
+			_fade_out->curve().get_vector (fo_curve_offset, fo_curve_offset + fo_end - fo_start, curve_buffer, fo_end - fo_start);
+			apply_gain_vector_to_buffer (gain_buffer + fo_start, curve_buffer, overlap, 1.0f);
+
+			if (fo_end > fi_end) {
+				memcpy (gain_buffer + fi_end, curve_buffer + overlap, sizeof (float) * (fo_end - fi_end));
 			}
+
+			g = ReadGain (g.scale);
+			g.add_range (0, max (fi_end, fo_end));
+
 		} else {
-			for (framecnt_t n = 0; n < to_read; ++n) {
-				mixdown_buffer[n] *= gain_buffer[n];
+
+			apply_gain_vector_to_buffer (mixdown_buffer, gain_buffer, fi_end, 1.0f);
+
+			_fade_out->curve().get_vector (fo_curve_offset, fo_curve_offset + fo_end - fo_start, gain_buffer + fo_start, fo_end - fo_start);
+			g = ReadGain (g.scale);
+			g.add_range (fo_start, fo_end);
+		}
+	}
+}
+
+/** Apply the gain worked out by compute_read_gain() to @a to_read frames of source data
+ *  in @a mixdown_buffer, in a single pass.  If @a buf is non-zero the result is mixed into
+ *  it, and @a mixdown_buffer is left as it was; otherwise @a mixdown_buffer is changed in place.
+ */
+void
+AudioRegion::apply_read_gain (ReadGain const & g, Sample *buf, Sample *mixdown_buffer, float const *gain_buffer,
+			      framecnt_t to_read) const
+{
+	framecnt_t pos = 0;
+
+	for (uint32_t r = 0; r <= g.n_ranges; ++r) {
+
+		/* a stretch of constant gain, up to the next range (if any) */
+
+		framecnt_t const end = (r < g.n_ranges) ? g.start[r] : to_read;
+
+		if (end > pos) {
+			if (buf) {
+				if (g.scale == 1.0f) {
+					mix_buffers_no_gain (buf + pos, mixdown_buffer + pos, end - pos);
+				} else {
+					mix_buffers_with_gain (buf + pos, mixdown_buffer + pos, end - pos, g.scale);
+				}
+			} else if (g.scale != 1.0f) {
+				apply_gain_to_buffer (mixdown_buffer + pos, end - pos, g.scale);
 			}
 		}
-	} else if ((rops & ReadOpsOwnScaling) && _scale_amplitude != 1.0f) {
 
-		// XXX this should be using what in 2.0 would have been:
-		// Session::apply_gain_to_buffer (mixdown_buffer, to_read, _scale_amplitude);
+		if (r == g.n_ranges) {
+			break;
+		}
+
+		/* a range of per-frame gain */
+
+		framecnt_t const s = g.start[r];
+		framecnt_t const n = g.end[r] - s;
 
-		for (framecnt_t n = 0; n < to_read; ++n) {
-			mixdown_buffer[n] *= _scale_amplitude;
+		if (buf) {
+			mix_buffers_with_gain_vector (buf + s, mixdown_buffer + s, gain_buffer + s, n, g.scale);
+		} else {
+			apply_gain_vector_to_buffer (mixdown_buffer + s, gain_buffer + s, n, g.scale);
 		}
+
+		pos = g.end[r];
 	}
+}
 
-	if (!opaque() && (buf != mixdown_buffer)) {
+/** Read the same range of channels @a first_chan ... @a first_chan + @a n_bufs - 1
+ *  into @a bufs, with fades etc. as for read_at().  Channels that come from the
+ *  same interleaved file are decoded together, in one pass.
+ */
+framecnt_t
+AudioRegion::read_at (Sample **bufs, uint32_t n_bufs, Sample *mixdown_buffer, float *gain_buffer,
+		      framepos_t position, framecnt_t cnt, uint32_t first_chan) const
+{
+	if (n_bufs == 1 || !opaque()) {
 
-		/* gack. the things we do for users.
-		 */
+		/* a transparent region has to mix each channel through
+		   mixdown_buffer in turn.
+		*/
 
-		buf += buf_offset;
+		framecnt_t ret = 0;
+		uint32_t data_count = 0;
 
-		for (framecnt_t n = 0; n < to_read; ++n) {
-			buf[n] += mixdown_buffer[n];
+		for (uint32_t c = 0; c < n_bufs; ++c) {
+			ret = read_at (bufs[c], mixdown_buffer, gain_buffer, position, cnt, first_chan + c);
+			data_count += _read_data_count;
 		}
+
+		_read_data_count = data_count;
+		return ret;
 	}
 
+	frameoffset_t internal_offset;
+	frameoffset_t buf_offset;
+	framecnt_t const total = cnt;
+	framecnt_t to_read;
+	uint32_t data_count = 0;
+
+	if (n_channels() == 0 || muted()) {
+		return 0;
+	}
+
+	if ((to_read = read_extent (_length, position, cnt, internal_offset, buf_offset)) == 0) {
+		return 0; /* read nothing */
+	}
+
+	/* the gain is the same for every channel, so work it out once; the data go
+	   straight into bufs, so mixdown_buffer is free to help.
+	*/
+
+	ReadGain g;
+	compute_read_gain (g, 0, gain_buffer, mixdown_buffer, internal_offset, to_read, _length, ReadOps (~0));
+
+	vector<bool> done (n_bufs, false);
+	vector<Sample*> dst;
+	vector<uint16_t> chans;
+	vector<uint32_t> members;
+
+	for (uint32_t c = 0; c < n_bufs && first_chan + c < n_channels(); ++c) {
+
+		if (done[c]) {
+			continue;
+		}
+
+		boost::shared_ptr<AudioSource> src = boost::dynamic_pointer_cast<AudioSource> (_sources[first_chan + c]);
+
+		dst.clear ();
+		chans.clear ();
+		members.clear ();
+
+		for (uint32_t o = c; o < n_bufs && first_chan + o < n_channels(); ++o) {
+
+			if (done[o]) {
+				continue;
+			}
+
+			boost::shared_ptr<AudioSource> other = boost::dynamic_pointer_cast<AudioSource> (_sources[first_chan + o]);
+
+			if (o == c || src->shares_file_with (*other)) {
+				dst.push_back (bufs[o] + buf_offset);
+				chans.push_back (other->file_channel ());
+				members.push_back (o);
+				done[o] = true;
+			}
+		}
+
+		if (src->read_channels (&dst[0], &chans[0], dst.size(), _start + internal_offset, to_read) != to_read) {
+			return 0; /* "read nothing" */
+		}
+
+		data_count += src->read_data_count();
+
+		for (vector<uint32_t>::iterator m = members.begin(); m != members.end(); ++m) {
+			apply_read_gain (g, 0, bufs[*m] + buf_offset, gain_buffer, to_read);
+		}
+	}
+
+	/* track has more channels than this region: the single-channel
+	   read knows how to replicate or silence them.  This reuses
+	   gain_buffer, so it comes last.
+	*/
+
+	for (uint32_t c = n_channels() > first_chan ? n_channels() - first_chan : 0; c < n_bufs; ++c) {
+		if (read_at (bufs[c], mixdown_buffer, gain_buffer, position, total, first_chan + c) != to_read) {
+			return 0;
+		}
+	}
+
+	_read_data_count = data_count;
+
 	return to_read;
 }
 
@@ -18,6 +18,7 @@
 */
 
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <poll.h>
@@ -61,6 +62,25 @@ bool AudioSource::_build_peakfiles = false;
 
 #define _FPP 256
 
+const uint32_t   AudioSource::peak_levels;
+const framecnt_t AudioSource::peak_level_factor;
+
+/** seconds of slop allowed when comparing peakfile and source mtimes, because of various disk action "races" */
+static const time_t peak_mtime_slop = 6;
+
+/** @return frames per peak at level @a level of the peak pyramid */
+framecnt_t
+AudioSource::level_fpp (uint32_t level)
+{
+	framecnt_t fpp = _FPP;
+
+	while (level--) {
+		fpp *= peak_level_factor;
+	}
+
+	return fpp;
+}
+
 AudioSource::AudioSource (Session& s, string name)
 	: Source (s, DataType::AUDIO, name)
 	, _length (0)
@@ -104,6 +124,9 @@ AudioSource::~AudioSource ()
 
 	delete _peakfile_descriptor;
 	delete [] peak_leftovers;
+
+	close_peak_levels ();
+	drop_peak_maps ();
 }
 
 XMLNode&
@@ -209,11 +232,44 @@ AudioSource::rename_peakfile (string newpath)
 		}
 	}
 
+	for (uint32_t l = 1; l < peak_levels; ++l) {
+		string const oldlevel = peak_level_path (oldpath, l);
+		if (Glib::file_test (oldlevel, Glib::FILE_TEST_EXISTS)) {
+			if (rename (oldlevel.c_str(), peak_level_path (newpath, l).c_str()) != 0) {
+				/* the level will be rebuilt from the peakfile when next needed */
+				::unlink (oldlevel.c_str());
+			}
+		}
+	}
+
+	drop_peak_maps ();
+
 	peakpath = newpath;
 
 	return 0;
 }
 
+/** @return the file holding level @a level of the peak pyramid whose peakfile is @a path */
+string
+AudioSource::peak_level_path (string const & path, uint32_t level)
+{
+	if (level == 0) {
+		return path;
+	}
+
+	return string_compose ("%1.%2", path, level_fpp (level));
+}
+
+int
+AudioSource::remove_peakfile (string const & path)
+{
+	for (uint32_t l = 1; l < peak_levels; ++l) {
+		::unlink (peak_level_path (path, l).c_str());
+	}
+
+	return ::unlink (path.c_str());
+}
+
 int
 AudioSource::initialize_peakfile (bool newfile, string audio_path)
 {
@@ -262,11 +318,7 @@ AudioSource::initialize_peakfile (bool newfile, string audio_path)
 
 			} else {
 
-				/* allow 6 seconds slop on checking peak vs. file times because of various
-				   disk action "races"
-				*/
-
-				if (stat_file.st_mtime > statbuf.st_mtime && (stat_file.st_mtime - statbuf.st_mtime > 6)) {
+				if (stat_file.st_mtime > statbuf.st_mtime && (stat_file.st_mtime - statbuf.st_mtime > peak_mtime_slop)) {
 					_peaks_built = false;
 					_peak_byte_max = 0;
 				} else {
@@ -277,6 +329,10 @@ AudioSource::initialize_peakfile (bool newfile, string audio_path)
 		}
 	}
 
+	if (_peaks_built) {
+		check_peak_levels (statbuf.st_mtime);
+	}
+
 	if (!newfile && !_peaks_built && _build_missing_peakfiles && _build_peakfiles) {
 		build_peaks_from_scratch ();
 	}
@@ -291,19 +347,58 @@ AudioSource::read (Sample *dst, framepos_t start, framecnt_t cnt, int /*channel*
 	return read_unlocked (dst, start, cnt);
 }
 
+framecnt_t
+AudioSource::read_channels (Sample** dst, uint16_t const * chans, uint32_t n, framepos_t start, framecnt_t cnt) const
+{
+	Glib::Mutex::Lock lm (_lock);
+	return read_channels_unlocked (dst, chans, n, start, cnt);
+}
+
+/** Default implementation for sources that cannot share a file with any other:
+ *  every requested channel must be our own, so just read it repeatedly.
+ */
+framecnt_t
+AudioSource::read_channels_unlocked (Sample** dst, uint16_t const * chans, uint32_t n, framepos_t start, framecnt_t cnt) const
+{
+	framecnt_t ret = 0;
+
+	for (uint32_t i = 0; i < n; ++i) {
+		if ((ret = read_unlocked (dst[i], start, cnt)) != cnt) {
+			return ret;
+		}
+	}
+
+	return ret;
+}
+
 framecnt_t
 AudioSource::write (Sample *dst, framecnt_t cnt)
 {
 	Glib::Mutex::Lock lm (_lock);
 	/* any write makes the fill not removable */
-	_flags = Flag (_flags & ~Removable);
+	if (_flags & Removable) {
+		_flags = Flag (_flags & ~Removable);
+		StateChanged (); /* EMIT SIGNAL */
+	}
 	return write_unlocked (dst, cnt);
 }
 
 int
 AudioSource::read_peaks (PeakData *peaks, framecnt_t npeaks, framepos_t start, framecnt_t cnt, double samples_per_visual_peak) const
 {
-	return read_peaks_with_fpp (peaks, npeaks, start, cnt, samples_per_visual_peak, _FPP);
+	/* use the coarsest level of the peak pyramid that still has at least
+	   as much detail as asked for, and that has data for the whole range.
+	*/
+
+	uint32_t level = 0;
+
+	while (level + 1 < peak_levels &&
+	       level_fpp (level + 1) <= samples_per_visual_peak &&
+	       (off_t) (((start + cnt) / level_fpp (level + 1)) * sizeof (PeakData)) <= peak_level_byte_max (level + 1)) {
+		++level;
+	}
+
+	return read_peaks_with_fpp (peaks, npeaks, start, cnt, samples_per_visual_peak, level_fpp (level));
 }
 
 /** @param peaks Buffer to write peak data.
@@ -325,9 +420,11 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 	int ret = -1;
 	PeakData* staging = 0;
 	Sample* raw_staging = 0;
+	uint32_t level = 0;
 
-	FdFileDescriptor* peakfile_descriptor = new FdFileDescriptor (peakpath, false, 0664);
-	int peakfile_fd = -1;
+	while (level + 1 < peak_levels && level_fpp (level) < samples_per_file_peak) {
+		++level;
+	}
 
 	expected_peaks = (cnt / (double) samples_per_file_peak);
 	scale = npeaks/expected_peaks;
@@ -378,31 +475,21 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 			peaks[i].min = raw_staging[i];
 		}
 
-		delete peakfile_descriptor;
 		delete [] raw_staging;
 		return 0;
 	}
 
 	if (scale == 1.0) {
 
-		off_t first_peak_byte = (start / samples_per_file_peak) * sizeof (PeakData);
-
-		/* open, read, close */
-
-		if ((peakfile_fd = peakfile_descriptor->allocate ()) < 0) {
-			error << string_compose(_("AudioSource: cannot open peakpath (a) \"%1\" (%2)"), peakpath, strerror (errno)) << endmsg;
-			delete peakfile_descriptor;
-			return -1;
-		}
+		framepos_t first_peak = start / samples_per_file_peak;
 
 #ifdef DEBUG_READ_PEAKS
 		cerr << "DIRECT PEAKS\n";
 #endif
 
-		nread = ::pread (peakfile_fd, peaks, sizeof (PeakData)* npeaks, first_peak_byte);
-		delete peakfile_descriptor;
+		nread = read_peak_data (level, peaks, first_peak, npeaks);
 
-		if (nread != sizeof (PeakData) * npeaks) {
+		if (nread != npeaks) {
 			cerr << "AudioSource["
 			     << _name
 			     << "]: cannot read peaks from peakfile! (read only "
@@ -411,11 +498,10 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 			     << npeaks
 			      << "at sample "
 			     << start
-			     << " = byte "
-			     << first_peak_byte
+			     << " = peak "
+			     << first_peak
 			     << ')'
 			     << endl;
-			delete peakfile_descriptor;
 			return -1;
 		}
 
@@ -423,7 +509,6 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 			memset (&peaks[npeaks], 0, sizeof (PeakData) * zero_fill);
 		}
 
-		delete peakfile_descriptor;
 		return 0;
 	}
 
@@ -464,43 +549,29 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 
 		current_stored_peak = min (current_stored_peak, stored_peak_before_next_visual_peak);
 
-		/* open ... close during out: handling */
-
-		if ((peakfile_fd = peakfile_descriptor->allocate ()) < 0) {
-			error << string_compose(_("AudioSource: cannot open peakpath (b) \"%1\" (%2)"), peakpath, strerror (errno)) << endmsg;
-			delete peakfile_descriptor;
-			delete [] staging;
-			return 0;
-		}
-
 		while (nvisual_peaks < npeaks) {
 
 			if (i == stored_peaks_read) {
 
-				uint32_t       start_byte = current_stored_peak * sizeof(PeakData);
 				tnp = min ((framecnt_t)(_length/samples_per_file_peak - current_stored_peak), (framecnt_t) expected_peaks);
 				to_read = min (chunksize, tnp);
 
 #ifdef DEBUG_READ_PEAKS
-				cerr << "read " << sizeof (PeakData) * to_read << " from peakfile @ " << start_byte << endl;
+				cerr << "read " << to_read << " peaks from level " << level << " @ " << current_stored_peak << endl;
 #endif
 
-				if ((nread = ::pread (peakfile_fd, staging, sizeof (PeakData) * to_read, start_byte))
-				    != sizeof (PeakData) * to_read) {
-
-					off_t fend = lseek (peakfile_fd, 0, SEEK_END);
+				if ((nread = read_peak_data (level, staging, current_stored_peak, to_read)) != (uint32_t) to_read) {
 
 					cerr << "AudioSource["
 					     << _name
 					     << "]: cannot read peak data from peakfile ("
-					     << (nread / sizeof(PeakData))
+					     << nread
 					     << " peaks instead of "
 					     << to_read
-					     << ") ("
-					     << strerror (errno)
-					     << ')'
-					     << " at start_byte = " << start_byte
-					     << " _length = " << _length << " versus len = " << fend
+					     << ")"
+					     << " at peak " << current_stored_peak
+					     << " of level " << level
+					     << " _length = " << _length << " versus len = " << peak_level_byte_max (level) / sizeof (PeakData)
 					     << " expected maxpeaks = " << (_length - current_frame)/samples_per_file_peak
 					     << " npeaks was " << npeaks
 					     << endl;
@@ -508,7 +579,7 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 				}
 
 				i = 0;
-				stored_peaks_read = nread / sizeof(PeakData);
+				stored_peaks_read = nread;
 			}
 
 			xmax = -1.0;
@@ -627,8 +698,6 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 	}
 
   out:
-	delete peakfile_descriptor;
-
 	delete [] staging;
 	delete [] raw_staging;
 
@@ -697,7 +766,8 @@ AudioSource::build_peaks_from_scratch ()
 
   out:
 	if (ret) {
-		unlink (peakpath.c_str());
+		drop_peak_maps ();
+		remove_peakfile (peakpath);
 	}
 
 	delete [] buf;
@@ -713,7 +783,12 @@ AudioSource::prepare_for_peakfile_writes ()
 		error << string_compose(_("AudioSource: cannot open peakpath (c) \"%1\" (%2)"), peakpath, strerror (errno)) << endmsg;
 		return -1;
 	}
-	return 0;
+
+	/* the files are about to change under any existing mappings */
+
+	drop_peak_maps ();
+
+	return open_peak_levels ();
 }
 
 void
@@ -731,6 +806,8 @@ AudioSource::done_with_peakfile_writes (bool done)
 
 	delete _peakfile_descriptor;
 	_peakfile_descriptor = 0;
+
+	close_peak_levels ();
 }
 
 /** @param first_frame Offset from the source start of the first frame to process */
@@ -783,6 +860,10 @@ AudioSource::compute_and_write_peaks (Sample* buf, framecnt_t first_frame, frame
 
 			_peak_byte_max = max (_peak_byte_max, (off_t) (byte + sizeof(PeakData)));
 
+			if (fpp == _FPP) {
+				update_peak_levels (peak_leftover_frame / fpp, 1);
+			}
+
 			{
 				Glib::Mutex::Lock lm (_peaks_ready_lock);
 				PeakRangeReady (peak_leftover_frame, peak_leftover_cnt); /* EMIT SIGNAL */
@@ -895,6 +976,12 @@ AudioSource::compute_and_write_peaks (Sample* buf, framecnt_t first_frame, frame
 
 	_peak_byte_max = max (_peak_byte_max, (off_t) (first_peak_byte + sizeof(PeakData)*peaks_computed));
 
+	if (fpp == _FPP && peaks_computed) {
+		if (update_peak_levels (first_frame / fpp, peaks_computed)) {
+			goto out;
+		}
+	}
+
 	if (frames_done) {
 		Glib::Mutex::Lock lm (_peaks_ready_lock);
 		PeakRangeReady (first_frame, frames_done); /* EMIT SIGNAL */
@@ -928,6 +1015,278 @@ AudioSource::truncate_peakfile ()
 	if (end > _peak_byte_max) {
 		(void) ftruncate (_peakfile_fd, _peak_byte_max);
 	}
+
+	for (uint32_t l = 1; l < peak_levels; ++l) {
+		PeakLevel& level (_peak_level[l]);
+		if (level.fd >= 0 && lseek (level.fd, 0, SEEK_END) > level.byte_max) {
+			(void) ftruncate (level.fd, level.byte_max);
+		}
+	}
+}
+
+int
+AudioSource::open_peak_levels ()
+{
+	for (uint32_t l = 1; l < peak_levels; ++l) {
+
+		PeakLevel& level (_peak_level[l]);
+
+		if (level.descriptor) {
+			continue;
+		}
+
+		string const path = peak_level_path (peakpath, l);
+
+		level.descriptor = new FdFileDescriptor (path, true, 0664);
+
+		if ((level.fd = level.descriptor->allocate()) < 0) {
+			error << string_compose(_("AudioSource: cannot open peakpath (d) \"%1\" (%2)"), path, strerror (errno)) << endmsg;
+			delete level.descriptor;
+			level.descriptor = 0;
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+void
+AudioSource::close_peak_levels ()
+{
+	for (uint32_t l = 1; l < peak_levels; ++l) {
+		delete _peak_level[l].descriptor;
+		_peak_level[l].descriptor = 0;
+		_peak_level[l].fd = -1;
+	}
+}
+
+/** Bring the coarser levels of the peak pyramid up to date after level 0 peaks
+ *  @a first_peak ... @a first_peak + @a npeaks - 1 have been written.  Each
+ *  affected peak of a level is recomputed in full from the level below, so this
+ *  is correct even if level 0 was written out of order.
+ */
+int
+AudioSource::update_peak_levels (framepos_t first_peak, framecnt_t npeaks)
+{
+	int lower_fd = _peakfile_fd;
+	off_t lower_byte_max = _peak_byte_max;
+
+	for (uint32_t l = 1; l < peak_levels; ++l) {
+
+		PeakLevel& level (_peak_level[l]);
+
+		if (level.fd < 0) {
+			return -1;
+		}
+
+		framepos_t const first = first_peak / peak_level_factor;
+		framepos_t const lower_first = first * peak_level_factor;
+		framepos_t const lower_end = min ((framepos_t) (lower_byte_max / sizeof (PeakData)),
+		                                  ((first_peak + npeaks - 1) / peak_level_factor + 1) * peak_level_factor);
+
+		if (lower_end <= lower_first) {
+			return 0;
+		}
+
+		framecnt_t const lower_cnt = lower_end - lower_first;
+		framecnt_t const cnt = (lower_cnt + peak_level_factor - 1) / peak_level_factor;
+		PeakData* lower = new PeakData[lower_cnt];
+		PeakData* upper = new PeakData[cnt];
+
+		if (::pread (lower_fd, lower, sizeof (PeakData) * lower_cnt, lower_first * sizeof (PeakData)) != (ssize_t) (sizeof (PeakData) * lower_cnt)) {
+			error << string_compose(_("%1: could not read peak file data (%2)"), _name, strerror (errno)) << endmsg;
+			delete [] lower;
+			delete [] upper;
+			return -1;
+		}
+
+		for (framecnt_t n = 0; n < cnt; ++n) {
+
+			framecnt_t const end = min ((n + 1) * peak_level_factor, lower_cnt);
+
+			upper[n] = lower[n * peak_level_factor];
+
+			for (framecnt_t i = n * peak_level_factor + 1; i < end; ++i) {
+				upper[n].max = max (upper[n].max, lower[i].max);
+				upper[n].min = min (upper[n].min, lower[i].min);
+			}
+		}
+
+		ssize_t const written = ::pwrite (level.fd, upper, sizeof (PeakData) * cnt, first * sizeof (PeakData));
+
+		delete [] lower;
+		delete [] upper;
+
+		if (written != (ssize_t) (sizeof (PeakData) * cnt)) {
+			error << string_compose(_("%1: could not write peak file data (%2)"), _name, strerror (errno)) << endmsg;
+			return -1;
+		}
+
+		{
+			Glib::Mutex::Lock lm (_peak_map_lock);
+			level.byte_max = max (level.byte_max, (off_t) ((first + cnt) * sizeof (PeakData)));
+		}
+
+		first_peak = first;
+		npeaks = cnt;
+		lower_fd = level.fd;
+		lower_byte_max = level.byte_max;
+	}
+
+	return 0;
+}
+
+/** Find the coarser levels of the peak pyramid for an existing peakfile, and
+ *  (re)build any that are missing, incomplete or older than it.
+ */
+int
+AudioSource::check_peak_levels (time_t peakfile_mtime)
+{
+	framecnt_t const npeaks = _peak_byte_max / sizeof (PeakData);
+	framecnt_t expected = npeaks;
+	bool rebuild = false;
+
+	for (uint32_t l = 1; l < peak_levels; ++l) {
+
+		struct stat statbuf;
+
+		expected = (expected + peak_level_factor - 1) / peak_level_factor;
+
+		if (stat (peak_level_path (peakpath, l).c_str(), &statbuf) ||
+		    statbuf.st_size < (off_t) (expected * sizeof (PeakData)) ||
+		    statbuf.st_mtime + peak_mtime_slop < peakfile_mtime) {
+			rebuild = true;
+			break;
+		}
+
+		Glib::Mutex::Lock lm (_peak_map_lock);
+		_peak_level[l].byte_max = expected * sizeof (PeakData);
+	}
+
+	if (rebuild) {
+		return build_peak_levels ();
+	}
+
+	return 0;
+}
+
+int
+AudioSource::build_peak_levels ()
+{
+	Glib::Mutex::Lock lp (_lock);
+
+	framecnt_t const npeaks = _peak_byte_max / sizeof (PeakData);
+	framecnt_t const chunk = 65536; /* a multiple of every level's peak_level_factor^n */
+	int ret = 0;
+
+	if (prepare_for_peakfile_writes ()) {
+		close_peak_levels ();
+		return -1;
+	}
+
+	for (uint32_t l = 1; l < peak_levels; ++l) {
+		Glib::Mutex::Lock lm (_peak_map_lock);
+		_peak_level[l].byte_max = 0;
+	}
+
+	for (framepos_t p = 0; p < npeaks && ret == 0; p += chunk) {
+		ret = update_peak_levels (p, min (chunk, npeaks - p));
+	}
+
+	truncate_peakfile ();
+
+	delete _peakfile_descriptor;
+	_peakfile_descriptor = 0;
+	close_peak_levels ();
+
+	return ret;
+}
+
+off_t
+AudioSource::peak_level_byte_max (uint32_t level) const
+{
+	if (level == 0) {
+		return _peak_byte_max;
+	}
+
+	Glib::Mutex::Lock lm (_peak_map_lock);
+	return _peak_level[level].byte_max;
+}
+
+/** Copy peaks @a first_peak ... @a first_peak + @a npeaks - 1 of level @a level of
+ *  the peak pyramid to @a dst, from a mapping of its file that is kept between calls.
+ *  @return number of peaks copied, which is less than @a npeaks if there is not
+ *  that much valid data.
+ */
+framecnt_t
+AudioSource::read_peak_data (uint32_t level, PeakData* dst, framepos_t first_peak, framecnt_t npeaks) const
+{
+	Glib::Mutex::Lock lm (_peak_map_lock);
+	PeakLevel& pl (_peak_level[level]);
+
+	off_t const byte_max = (level == 0) ? _peak_byte_max : pl.byte_max;
+	framecnt_t const available = (framecnt_t) (byte_max / sizeof (PeakData)) - first_peak;
+
+	if (available <= 0 || npeaks <= 0) {
+		return 0;
+	}
+
+	npeaks = min (npeaks, available);
+
+	size_t const needed = (first_peak + npeaks) * sizeof (PeakData);
+
+	if (pl.map_size < needed) {
+
+		/* not mapped yet, or the file has grown since */
+
+		if (pl.map) {
+			munmap (pl.map, pl.map_size);
+			pl.map = 0;
+			pl.map_size = 0;
+		}
+
+		int fd = ::open (peak_level_path (peakpath, level).c_str(), O_RDONLY);
+
+		if (fd < 0) {
+			return 0;
+		}
+
+		struct stat statbuf;
+
+		if (fstat (fd, &statbuf) || (size_t) statbuf.st_size < needed) {
+			::close (fd);
+			return 0;
+		}
+
+		void* addr = mmap (0, statbuf.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		::close (fd);
+
+		if (addr == MAP_FAILED) {
+			error << string_compose(_("AudioSource: cannot map peak file \"%1\" (%2)"), peak_level_path (peakpath, level), strerror (errno)) << endmsg;
+			return 0;
+		}
+
+		pl.map = (PeakData*) addr;
+		pl.map_size = statbuf.st_size;
+	}
+
+	memcpy (dst, pl.map + first_peak, npeaks * sizeof (PeakData));
+
+	return npeaks;
+}
+
+void
+AudioSource::drop_peak_maps () const
+{
+	Glib::Mutex::Lock lm (_peak_map_lock);
+
+	for (uint32_t l = 0; l < peak_levels; ++l) {
+		if (_peak_level[l].map) {
+			munmap (_peak_level[l].map, _peak_level[l].map_size);
+			_peak_level[l].map = 0;
+			_peak_level[l].map_size = 0;
+		}
+	}
 }
 
 framecnt_t
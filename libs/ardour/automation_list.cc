@@ -22,12 +22,16 @@
 #include <float.h>
 #include <cmath>
 #include <sstream>
+#include <iomanip>
 #include <algorithm>
 #include "ardour/automation_list.h"
 #include "ardour/event_type_map.h"
 #include "evoral/Curve.hpp"
 #include "pbd/stacktrace.h"
 #include "pbd/enumwriter.h"
+#include "pbd/compose.h"
+#include "pbd/property_list.h"
+#include "ardour/debug.h"
 
 #include "i18n.h"
 
@@ -37,6 +41,19 @@ using namespace PBD;
 
 PBD::Signal1<void,AutomationList *> AutomationList::AutomationListCreated;
 
+namespace ARDOUR {
+	namespace Properties {
+		PBD::PropertyDescriptor<bool> events;
+	}
+}
+
+void
+AutomationList::make_property_quarks ()
+{
+	Properties::events.property_id = g_quark_from_static_string (X_("events"));
+	DEBUG_TRACE (DEBUG::Properties, string_compose ("quark for events = %1\n", Properties::events.property_id));
+}
+
 #if 0
 static void dumpit (const AutomationList& al, string prefix = "")
 {
@@ -49,7 +66,10 @@ static void dumpit (const AutomationList& al, string prefix = "")
 #endif
 AutomationList::AutomationList (Evoral::Parameter id)
 	: ControlList(id)
+	, _events_property (*this)
 {
+	register_properties ();
+
 	_state = Off;
 	_style = Absolute;
 	g_atomic_int_set (&_touching, 0);
@@ -63,7 +83,10 @@ AutomationList::AutomationList (Evoral::Parameter id)
 AutomationList::AutomationList (const AutomationList& other)
 	: StatefulDestructible()
 	, ControlList(other)
+	, _events_property (*this)
 {
+	register_properties ();
+
 	_style = other._style;
 	_state = other._state;
 	g_atomic_int_set (&_touching, other.touching());
@@ -76,7 +99,10 @@ AutomationList::AutomationList (const AutomationList& other)
 
 AutomationList::AutomationList (const AutomationList& other, double start, double end)
 	: ControlList(other, start, end)
+	, _events_property (*this)
 {
+	register_properties ();
+
 	_style = other._style;
 	_state = other._state;
 	g_atomic_int_set (&_touching, other.touching());
@@ -92,7 +118,10 @@ AutomationList::AutomationList (const AutomationList& other, double start, doubl
  */
 AutomationList::AutomationList (const XMLNode& node, Evoral::Parameter id)
 	: ControlList(id)
+	, _events_property (*this)
 {
+	register_properties ();
+
 	g_atomic_int_set (&_touching, 0);
 	_state = Off;
 	_style = Absolute;
@@ -113,6 +142,12 @@ AutomationList::~AutomationList()
 {
 }
 
+void
+AutomationList::register_properties ()
+{
+	add_property (_events_property);
+}
+
 boost::shared_ptr<Evoral::ControlList>
 AutomationList::create(Evoral::Parameter id)
 {
@@ -154,6 +189,7 @@ AutomationList::operator= (const AutomationList& other)
 			_events.push_back (new Evoral::ControlEvent (**i));
 		}
 
+		_index_dirty = true;
 		_min_yval = other._min_yval;
 		_max_yval = other._max_yval;
 		_max_xval = other._max_xval;
@@ -515,3 +551,297 @@ AutomationList::set_state (const XMLNode& node, int version)
 	return 0;
 }
 
+/** Copy our points into a vector */
+void
+AutomationList::get_points (AutomationEventsProperty::Points& points) const
+{
+	Glib::Mutex::Lock lm (ControlList::_lock);
+
+	points.clear ();
+	points.reserve (_events.size ());
+
+	for (const_iterator i = _events.begin(); i != _events.end(); ++i) {
+		points.push_back (AutomationEventsProperty::Point ((*i)->when, (*i)->value));
+	}
+}
+
+/** Replace the points from offset to offset + removed.size() with some others.
+ *  If the points there are not the ones given in removed, look for them by time.
+ *  @return true if the points were replaced.
+ */
+bool
+AutomationList::replace_points (size_t offset, AutomationEventsProperty::Points const & removed, AutomationEventsProperty::Points const & added)
+{
+	{
+		Glib::Mutex::Lock lm (ControlList::_lock);
+
+		bool found = false;
+		iterator pos = _events.begin ();
+
+		for (int attempt = 0; attempt < 2 && !found; ++attempt) {
+
+			if (attempt == 0) {
+				size_t n = 0;
+				for (pos = _events.begin(); n < offset && pos != _events.end(); ++pos) {
+					++n;
+				}
+				if (n < offset) {
+					continue;
+				}
+			} else {
+				/* something else has changed the list since this change was made;
+				   try to find where the change should go by time instead.
+				*/
+				double const t = removed.empty() ? (added.empty() ? 0 : added.front().when) : removed.front().when;
+				pos = unlocked_lower_bound (t);
+			}
+
+			found = true;
+
+			iterator j = pos;
+			for (size_t i = 0; i < removed.size(); ++i, ++j) {
+				if (j == _events.end() || (*j)->when != removed[i].when || (*j)->value != removed[i].value) {
+					found = false;
+					break;
+				}
+			}
+
+			if (found && removed.empty() && !added.empty()) {
+				/* check that the new points fit here */
+				if (pos != _events.begin()) {
+					iterator before = pos;
+					--before;
+					if ((*before)->when > added.front().when) {
+						found = false;
+					}
+				}
+				if (pos != _events.end() && (*pos)->when < added.back().when) {
+					found = false;
+				}
+			}
+		}
+
+		if (!found) {
+			error << _("automation list has changed since this edit; cannot undo or redo it") << endmsg;
+			return false;
+		}
+
+		iterator e = pos;
+		for (size_t i = 0; i < removed.size(); ++i, ++e) {
+			delete *e;
+		}
+
+		pos = _events.erase (pos, e);
+
+		for (AutomationEventsProperty::Points::const_iterator i = added.begin(); i != added.end(); ++i) {
+			_events.insert (pos, new Evoral::ControlEvent (i->when, i->value));
+		}
+
+		_index_dirty = true;
+		mark_dirty ();
+	}
+
+	maybe_signal_changed ();
+
+	return true;
+}
+
+AutomationEventsProperty::AutomationEventsProperty (AutomationList& list)
+	: PBD::PropertyBase (Properties::events.property_id)
+	, _list (&list)
+	, _have_old (false)
+	, _offset (0)
+{
+
+}
+
+AutomationEventsProperty::AutomationEventsProperty ()
+	: PBD::PropertyBase (Properties::events.property_id)
+	, _list (0)
+	, _have_old (false)
+	, _offset (0)
+{
+
+}
+
+/** Copy only the record of changes; the copy has no list */
+AutomationEventsProperty::AutomationEventsProperty (AutomationEventsProperty const & other)
+	: PBD::PropertyBase (other)
+	, _list (0)
+	, _have_old (false)
+	, _offset (other._offset)
+	, _removed (other._removed)
+	, _added (other._added)
+{
+
+}
+
+void
+AutomationEventsProperty::clear_changes ()
+{
+	if (!_list) {
+		_removed.clear ();
+		_added.clear ();
+		return;
+	}
+
+	_list->get_points (_old_points);
+	_have_old = true;
+}
+
+bool
+AutomationEventsProperty::changed () const
+{
+	if (!_list) {
+		return !_removed.empty() || !_added.empty();
+	}
+
+	if (!_have_old) {
+		return false;
+	}
+
+	Points current;
+	_list->get_points (current);
+	return current != _old_points;
+}
+
+void
+AutomationEventsProperty::invert ()
+{
+	_removed.swap (_added);
+}
+
+void
+AutomationEventsProperty::get_changes_as_properties (PBD::PropertyList& changes, Command *) const
+{
+	if (!_list || !_have_old) {
+		return;
+	}
+
+	Points current;
+	_list->get_points (current);
+
+	/* skip the points which are the same at the start and at the end */
+
+	size_t start = 0;
+	while (start < _old_points.size() && start < current.size() && _old_points[start] == current[start]) {
+		++start;
+	}
+
+	size_t old_end = _old_points.size ();
+	size_t new_end = current.size ();
+	while (old_end > start && new_end > start && _old_points[old_end - 1] == current[new_end - 1]) {
+		--old_end;
+		--new_end;
+	}
+
+	if (old_end != start || new_end != start) {
+		AutomationEventsProperty* p = new AutomationEventsProperty;
+		p->_offset = start;
+		p->_removed.assign (_old_points.begin() + start, _old_points.begin() + old_end);
+		p->_added.assign (current.begin() + start, current.begin() + new_end);
+		changes.add (p);
+	}
+
+	/* the change is recorded, so we no longer need a copy of the whole list */
+	drop_old_points ();
+}
+
+void
+AutomationEventsProperty::drop_old_points () const
+{
+	Points ().swap (_old_points);
+	_have_old = false;
+}
+
+void
+AutomationEventsProperty::apply_changes (PBD::PropertyBase const * p)
+{
+	if (!_list) {
+		return;
+	}
+
+	AutomationEventsProperty const * change = dynamic_cast<AutomationEventsProperty const *> (p);
+	assert (change);
+
+	_list->replace_points (change->_offset, change->_removed, change->_added);
+}
+
+static void
+points_to_xml (AutomationEventsProperty::Points const & points, XMLNode* node)
+{
+	stringstream str;
+
+	/* enough digits to get exactly the same doubles back */
+	str.precision (17);
+
+	for (AutomationEventsProperty::Points::const_iterator i = points.begin(); i != points.end(); ++i) {
+		str << i->when << ' ' << i->value << '\n';
+	}
+
+	node->add_content (str.str ());
+}
+
+static void
+points_from_xml (XMLNode const * node, AutomationEventsProperty::Points& points)
+{
+	if (!node || node->children().empty()) {
+		return;
+	}
+
+	stringstream str (node->children().front()->content ());
+
+	double x;
+	double y;
+
+	while (str >> x >> y) {
+		points.push_back (AutomationEventsProperty::Point (x, y));
+	}
+}
+
+void
+AutomationEventsProperty::get_changes_as_xml (XMLNode* history_node) const
+{
+	LocaleGuard lg (X_("POSIX"));
+
+	XMLNode* node = history_node->add_child (X_("Events"));
+	node->add_property (X_("offset"), (long) _offset);
+
+	points_to_xml (_removed, node->add_child (X_("Removed")));
+	points_to_xml (_added, node->add_child (X_("Added")));
+}
+
+AutomationEventsProperty*
+AutomationEventsProperty::clone_from_xml (XMLNode const & history_node) const
+{
+	XMLNode const * node = history_node.child (X_("Events"));
+	if (!node) {
+		return 0;
+	}
+
+	LocaleGuard lg (X_("POSIX"));
+
+	AutomationEventsProperty* p = new AutomationEventsProperty;
+
+	XMLProperty const * prop = node->property (X_("offset"));
+	if (prop) {
+		p->_offset = atoi (prop->value().c_str());
+	}
+
+	points_from_xml (node->child (X_("Removed")), p->_removed);
+	points_from_xml (node->child (X_("Added")), p->_added);
+
+	return p;
+}
+
+AutomationEventsProperty*
+AutomationEventsProperty::clone () const
+{
+	return new AutomationEventsProperty (*this);
+}
+
+size_t
+AutomationEventsProperty::approximate_size () const
+{
+	return sizeof (AutomationEventsProperty) + (_removed.capacity() + _added.capacity()) * sizeof (Point);
+}
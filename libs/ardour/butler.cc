@@ -21,8 +21,10 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <poll.h>
+#include <algorithm>
 #include "pbd/error.h"
 #include "pbd/pthread_utils.h"
+#include "ardour/audio_diskstream.h"
 #include "ardour/butler.h"
 #include "ardour/crossfade.h"
 #include "ardour/io.h"
@@ -47,6 +49,13 @@ Butler::Butler(Session& s)
 	, audio_dstream_playback_buffer_size(0)
 	, midi_dstream_buffer_size(0)
 	, pool_trash(16)
+	, disk_jobs_in_progress (0)
+	, disk_workers_should_quit (false)
+	, pass_bytes_read (0)
+	, pass_bytes_written (0)
+	, pass_write_errors (0)
+	, pass_read_failed (false)
+	, pass_work_outstanding (false)
 {
 	g_atomic_int_set(&should_do_transport_work, 0);
 	SessionEvent::pool->set_trash (&pool_trash);
@@ -69,6 +78,11 @@ Butler::config_changed (std::string p)
         } else if (p == "capture-buffer-seconds") {
                 audio_dstream_capture_buffer_size = (uint32_t) floor (Config->get_audio_capture_buffer_seconds() * _session.frame_rate());
                 _session.adjust_capture_buffering ();
+        } else if (p == "butler-threads") {
+                if (thread) {
+                        stop_disk_workers ();
+                        start_disk_workers ();
+                }
         }
 }
 
@@ -116,11 +130,51 @@ Butler::start_thread()
 		return -1;
 	}
 
+	start_disk_workers ();
+
 	//pthread_detach (thread);
 
 	return 0;
 }
 
+/** Start butler-threads - 1 extra disk threads; the butler thread
+ *  itself counts as one of the butler threads.
+ */
+void
+Butler::start_disk_workers ()
+{
+	disk_workers_should_quit = false;
+
+	for (uint32_t n = 1; n < Config->get_butler_threads(); ++n) {
+		pthread_t worker;
+		if (pthread_create_and_store (string_compose ("disk butler %1", n), &worker, _disk_worker_work, this)) {
+			warning << string_compose (_("Session: could not create disk i/o thread %1"), n) << endmsg;
+			break;
+		}
+		disk_workers.push_back (worker);
+	}
+}
+
+/** Stop the extra disk threads, each after it finishes its current
+ *  job; the butler thread carries on with any work they leave.
+ */
+void
+Butler::stop_disk_workers ()
+{
+	{
+		Glib::Mutex::Lock lm (disk_work_lock);
+		disk_workers_should_quit = true;
+		disk_work_available.broadcast ();
+	}
+
+	for (std::vector<pthread_t>::iterator i = disk_workers.begin(); i != disk_workers.end(); ++i) {
+		void* status;
+		pthread_join (*i, &status);
+	}
+
+	disk_workers.clear ();
+}
+
 void
 Butler::terminate_thread ()
 {
@@ -130,6 +184,8 @@ Butler::terminate_thread ()
 		(void) ::write (request_pipe[1], &c, 1);
 		pthread_join (thread, &status);
 	}
+
+	stop_disk_workers ();
 }
 
 void *
@@ -140,17 +196,22 @@ Butler::_thread_work (void* arg)
 	return ((Butler *) arg)->thread_work ();
 }
 
+void *
+Butler::_disk_worker_work (void* arg)
+{
+	SessionEvent::create_per_thread_pool ("butler events", 4096);
+	pthread_set_name (X_("butler disk i/o"));
+	return ((Butler *) arg)->disk_worker_work ();
+}
+
 void *
 Butler::thread_work ()
 {
 	uint32_t err = 0;
-	int32_t bytes;
-	bool compute_io;
 	microseconds_t begin, end;
 
 	struct pollfd pfd[1];
 	bool disk_work_outstanding = false;
-	RouteList::iterator i;
 
 	while (true) {
 		pfd[0].fd = request_pipe[0];
@@ -217,9 +278,6 @@ Butler::thread_work ()
 		}
 
 
-		bytes = 0;
-		compute_io = true;
-
 restart:
 		disk_work_outstanding = false;
 
@@ -234,92 +292,39 @@ restart:
 		RouteList rl_with_auditioner = *rl;
 		rl_with_auditioner.push_back (_session.the_auditioner());
 
-//		for (i = dsl->begin(); i != dsl->end(); ++i) {
-//			cerr << "BEFORE " << (*i)->name() << ": pb = " << (*i)->playback_buffer_load() << " cp = " << (*i)->capture_buffer_load() << endl;
-//		}
-
-		for (i = rl_with_auditioner.begin(); !transport_work_requested() && should_run && i != rl_with_auditioner.end(); ++i) {
-
-			boost::shared_ptr<Track> tr = boost::dynamic_pointer_cast<Track> (*i);
+		/* note that we still try to flush diskstreams attached to
+		   inactive routes, and that the auditioner never records.
+		*/
 
-			if (!tr) {
-				continue;
-			}
+		queue_disk_work (*rl, rl_with_auditioner);
+		do_disk_work ();
 
-			boost::shared_ptr<IO> io = tr->input ();
+		end = get_microseconds();
 
-			if (io && !io->active()) {
-				/* don't read inactive tracks */
-				continue;
-			}
+		{
+			Glib::Mutex::Lock lm (disk_work_lock);
 
-			switch (tr->do_refill ()) {
-			case 0:
-				bytes += tr->read_data_count();
-				break;
-			case 1:
-				bytes += tr->read_data_count();
+			if (pass_work_outstanding) {
 				disk_work_outstanding = true;
-				break;
-
-			default:
-				compute_io = false;
-				error << string_compose(_("Butler read ahead failure on dstream %1"), (*i)->name()) << endmsg;
-				break;
 			}
 
-		}
+			err += pass_write_errors;
 
-		if (i != rl_with_auditioner.begin() && i != rl_with_auditioner.end()) {
-			/* we didn't get to all the streams */
-			disk_work_outstanding = true;
-		}
-
-		if (!err && transport_work_requested()) {
-			goto restart;
-		}
-
-		if (compute_io) {
-			end = get_microseconds();
-			if (end - begin > 0) {
-				_read_data_rate = (float) bytes / (float) (end - begin);
-			} else {
-				_read_data_rate = 0; // infinity better
-			}
-		}
-
-		bytes = 0;
-		compute_io = true;
-		begin = get_microseconds();
-
-		for (i = rl->begin(); !transport_work_requested() && should_run && i != rl->end(); ++i) {
-			// cerr << "write behind for " << (*i)->name () << endl;
-
-			boost::shared_ptr<Track> tr = boost::dynamic_pointer_cast<Track> (*i);
-
-			if (!tr) {
-				continue;
+			if (!pass_read_failed) {
+				if (end - begin > 0) {
+					_read_data_rate = (float) pass_bytes_read / (float) (end - begin);
+				} else {
+					_read_data_rate = 0; // infinity better
+				}
 			}
 
-			/* note that we still try to flush diskstreams attached to inactive routes
-			 */
-
-			switch (tr->do_flush (ButlerContext)) {
-			case 0:
-				bytes += tr->write_data_count();
-				break;
-			case 1:
-				bytes += tr->write_data_count();
-				disk_work_outstanding = true;
-				break;
-
-			default:
-				err++;
-				compute_io = false;
-				error << string_compose(_("Butler write-behind failure on dstream %1"), (*i)->name()) << endmsg;
-				/* don't break - try to flush all streams in case they
-				   are split across disks.
-				*/
+			if (!pass_write_errors) {
+				// there are no apparent users for this calculation?
+				if (end - begin > 0) {
+					_write_data_rate = (float) pass_bytes_written / (float) (end - begin);
+				} else {
+					_write_data_rate = 0; // Well, infinity would be better
+				}
 			}
 		}
 
@@ -330,25 +335,10 @@ restart:
 			_session.request_stop ();
 		}
 
-		if (i != rl->begin() && i != rl->end()) {
-			/* we didn't get to all the streams */
-			disk_work_outstanding = true;
-		}
-
 		if (!err && transport_work_requested()) {
 			goto restart;
 		}
 
-		if (compute_io) {
-			// there are no apparent users for this calculation?
-			end = get_microseconds();
-			if (end - begin > 0) {
-				_write_data_rate = (float) bytes / (float) (end - begin);
-			} else {
-				_write_data_rate = 0; // Well, infinity would be better
-			}
-		}
-
 		if (!disk_work_outstanding) {
 			_session.refresh_disk_space ();
 		}
@@ -376,6 +366,220 @@ restart:
 	return (0);
 }
 
+/** Queue up one pass of disk work: a flush for every track, and a
+ *  refill for every active track.  Each queue is sorted so that the
+ *  emptiest playback buffers and the fullest capture buffers are
+ *  served first.
+ */
+void
+Butler::queue_disk_work (RouteList const & flush_routes, RouteList const & refill_routes)
+{
+	Glib::Mutex::Lock lm (disk_work_lock);
+
+	pass_bytes_read = 0;
+	pass_bytes_written = 0;
+	pass_write_errors = 0;
+	pass_read_failed = false;
+	pass_work_outstanding = false;
+
+	flush_queue.clear ();
+	refill_queue.clear ();
+
+	for (RouteList::const_iterator i = flush_routes.begin(); i != flush_routes.end(); ++i) {
+		boost::shared_ptr<Track> tr = boost::dynamic_pointer_cast<Track> (*i);
+
+		if (tr) {
+			flush_queue.push_back (DiskJob (tr, tr->capture_buffer_load(), true));
+		}
+	}
+
+	for (RouteList::const_iterator i = refill_routes.begin(); i != refill_routes.end(); ++i) {
+		boost::shared_ptr<Track> tr = boost::dynamic_pointer_cast<Track> (*i);
+
+		if (!tr) {
+			continue;
+		}
+
+		boost::shared_ptr<IO> io = tr->input ();
+
+		if (io && !io->active()) {
+			/* don't read inactive tracks */
+			continue;
+		}
+
+		refill_queue.push_back (DiskJob (tr, tr->playback_buffer_load(), false));
+	}
+
+	std::stable_sort (flush_queue.begin(), flush_queue.end());
+	std::stable_sort (refill_queue.begin(), refill_queue.end());
+}
+
+/** Called with disk_work_lock held: if the butler has been asked to do
+ *  transport work or to pause, drop the rest of this pass.
+ */
+void
+Butler::abandon_disk_work_if_interrupted ()
+{
+	if (!transport_work_requested() && should_run) {
+		return;
+	}
+
+	if (!flush_queue.empty() || !refill_queue.empty()) {
+		/* we didn't get to all the streams */
+		pass_work_outstanding = true;
+		flush_queue.clear ();
+		refill_queue.clear ();
+	}
+}
+
+/** Called with disk_work_lock held.  Capture flushes always take
+ *  precedence over playback refills, so that they never wait behind
+ *  slow reads.
+ */
+bool
+Butler::next_disk_job (DiskJob& job)
+{
+	abandon_disk_work_if_interrupted ();
+
+	return take_disk_job (flush_queue, job) || take_disk_job (refill_queue, job);
+}
+
+/** Called with disk_work_lock held: take the most urgent job in @a queue
+ *  whose track has no other job in progress, since a track's flush and
+ *  refill share its diskstream's state and must not run at once.
+ */
+bool
+Butler::take_disk_job (std::deque<DiskJob>& queue, DiskJob& job)
+{
+	for (std::deque<DiskJob>::iterator i = queue.begin(); i != queue.end(); ++i) {
+		if (busy_tracks.find (i->track.get()) == busy_tracks.end()) {
+			job = *i;
+			queue.erase (i);
+			busy_tracks.insert (job.track.get());
+			++disk_jobs_in_progress;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/** Called with disk_work_lock held once a job has been run */
+void
+Butler::finish_disk_job (DiskJob const & job)
+{
+	busy_tracks.erase (job.track.get());
+	--disk_jobs_in_progress;
+
+	/* a job held back for this track may now be taken, and the
+	   butler may be waiting for the pass to end.
+	*/
+	disk_work_available.broadcast ();
+	disk_work_done.signal ();
+}
+
+void
+Butler::run_disk_job (DiskJob const & job)
+{
+	if (job.flush) {
+
+		int const r = job.track->do_flush (ButlerContext);
+
+		Glib::Mutex::Lock lm (disk_work_lock);
+
+		switch (r) {
+		case 0:
+			pass_bytes_written += job.track->write_data_count();
+			break;
+		case 1:
+			pass_bytes_written += job.track->write_data_count();
+			pass_work_outstanding = true;
+			break;
+
+		default:
+			pass_write_errors++;
+			error << string_compose(_("Butler write-behind failure on dstream %1"), job.track->name()) << endmsg;
+			break;
+		}
+
+	} else {
+
+		int const r = job.track->do_refill ();
+
+		Glib::Mutex::Lock lm (disk_work_lock);
+
+		switch (r) {
+		case 0:
+			pass_bytes_read += job.track->read_data_count();
+			break;
+		case 1:
+			pass_bytes_read += job.track->read_data_count();
+			pass_work_outstanding = true;
+			break;
+
+		default:
+			pass_read_failed = true;
+			error << string_compose(_("Butler read ahead failure on dstream %1"), job.track->name()) << endmsg;
+			break;
+		}
+	}
+}
+
+/** Run the queued disk work on the butler thread, alongside any extra
+ *  disk workers, and return when all of it is finished.
+ */
+void
+Butler::do_disk_work ()
+{
+	Glib::Mutex::Lock lm (disk_work_lock);
+	DiskJob job;
+
+	disk_work_available.broadcast ();
+
+	while (true) {
+		if (next_disk_job (job)) {
+			lm.release ();
+			run_disk_job (job);
+			lm.acquire ();
+			finish_disk_job (job);
+			job = DiskJob ();
+			continue;
+		}
+
+		if (disk_jobs_in_progress == 0) {
+			/* so nothing is held back, and the queues are empty */
+			break;
+		}
+
+		disk_work_done.wait (disk_work_lock);
+	}
+}
+
+void *
+Butler::disk_worker_work ()
+{
+	Glib::Mutex::Lock lm (disk_work_lock);
+	DiskJob job;
+
+	while (!disk_workers_should_quit) {
+		if (next_disk_job (job)) {
+			lm.release ();
+			/* (re)size our buffers, in case the sizes have changed */
+			AudioDiskstream::allocate_thread_working_buffers ();
+			Crossfade::allocate_thread_buffers ();
+			run_disk_job (job);
+			lm.acquire ();
+			finish_disk_job (job);
+			job = DiskJob ();
+			continue;
+		}
+
+		disk_work_available.wait (disk_work_lock);
+	}
+
+	return 0;
+}
+
 void
 Butler::schedule_transport_work ()
 {
@@ -36,13 +36,34 @@ using namespace PBD;
 
 framecnt_t Crossfade::_short_xfade_length = 0;
 
-/* XXX if and when we ever implement parallel processing of the process()
-   callback, these will need to be handled on a per-thread basis.
+/* these are used by the butler thread; any other thread that reads
+   crossfades (e.g. extra butler disk threads) must first call
+   allocate_thread_buffers() to get its own, and call it again
+   whenever the buffer size may have changed.
 */
 
+framecnt_t Crossfade::_buffer_size = 0;
 Sample* Crossfade::crossfade_buffer_out = 0;
 Sample* Crossfade::crossfade_buffer_in = 0;
 
+struct ThreadCrossfadeBuffers {
+	ThreadCrossfadeBuffers (framecnt_t sz)
+		: size (sz)
+		, out (new Sample[sz])
+		, in (new Sample[sz]) {}
+
+	~ThreadCrossfadeBuffers () {
+		delete [] out;
+		delete [] in;
+	}
+
+	framecnt_t size;
+	Sample*    out;
+	Sample*    in;
+};
+
+static Glib::StaticPrivate<ThreadCrossfadeBuffers> thread_crossfade_buffers = GLIBMM_STATIC_PRIVATE_INIT;
+
 
 #define CROSSFADE_DEFAULT_PROPERTIES \
 	_active (Properties::active, _session.config.get_xfades_active ()) \
@@ -75,6 +96,19 @@ Crossfade::set_buffer_size (framecnt_t sz)
 		crossfade_buffer_out = new Sample[sz];
 		crossfade_buffer_in = new Sample[sz];
 	}
+
+	_buffer_size = sz;
+}
+
+void
+Crossfade::allocate_thread_buffers ()
+{
+	ThreadCrossfadeBuffers* tcb = thread_crossfade_buffers.get ();
+
+	if (tcb == 0 || tcb->size != _buffer_size) {
+		/* this deletes any old buffers */
+		thread_crossfade_buffers.set (_buffer_size ? new ThreadCrossfadeBuffers (_buffer_size) : 0);
+	}
 }
 
 bool
@@ -360,15 +394,24 @@ Crossfade::read_at (Sample *buf, Sample *mixdown_buffer,
 
 	offset = start - _position;
 
+	Sample* buffer_out = crossfade_buffer_out;
+	Sample* buffer_in = crossfade_buffer_in;
+	ThreadCrossfadeBuffers* tcb = thread_crossfade_buffers.get ();
+
+	if (tcb) {
+		buffer_out = tcb->out;
+		buffer_in = tcb->in;
+	}
+
 	/* Prevent data from piling up inthe crossfade buffers when reading a transparent region */
 	if (!(_out->opaque())) {
-		memset (crossfade_buffer_out, 0, sizeof (Sample) * to_write);
+		memset (buffer_out, 0, sizeof (Sample) * to_write);
 	} else if (!(_in->opaque())) {
-		memset (crossfade_buffer_in, 0, sizeof (Sample) * to_write);
+		memset (buffer_in, 0, sizeof (Sample) * to_write);
 	}
 
-	_out->read_at (crossfade_buffer_out, mixdown_buffer, gain_buffer, start, to_write, chan_n);
-	_in->read_at (crossfade_buffer_in, mixdown_buffer, gain_buffer, start, to_write, chan_n);
+	_out->read_at (buffer_out, mixdown_buffer, gain_buffer, start, to_write, chan_n);
+	_in->read_at (buffer_in, mixdown_buffer, gain_buffer, start, to_write, chan_n);
 
 	float* fiv = new float[to_write];
 	float* fov = new float[to_write];
@@ -383,7 +426,7 @@ Crossfade::read_at (Sample *buf, Sample *mixdown_buffer,
 	*/
 
 	for (framecnt_t n = 0; n < to_write; ++n) {
-		buf[n] = (crossfade_buffer_out[n] * fov[n]) + (crossfade_buffer_in[n] * fiv[n]);
+		buf[n] = (buffer_out[n] * fov[n]) + (buffer_in[n] * fiv[n]);
 	}
 
 	delete [] fov;
@@ -0,0 +1,286 @@
+/*
+    Copyright (C) 2011 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <algorithm>
+#include <cstring>
+
+#include <glibmm/timer.h>
+#include <boost/bind.hpp>
+
+#include "pbd/pthread_utils.h"
+
+#include "ardour/cycle_timer.h"
+#include "ardour/dsp_profiler.h"
+
+#include "i18n.h"
+
+using namespace std;
+using namespace ARDOUR;
+
+const uint32_t DSPProfiler::histogram_buckets;
+
+DSPProfiler::DSPProfiler ()
+	: _enabled (0)
+	, _dropped (0)
+	, _cycles_per_usec (0)
+	, _collector_thread (0)
+	, _collector_exit (0)
+{
+	pthread_key_create (&_thread_key, 0);
+}
+
+DSPProfiler::~DSPProfiler ()
+{
+	set_enabled (false);
+
+	for (list<ThreadBuffer*>::iterator i = _buffers.begin(); i != _buffers.end(); ++i) {
+		delete *i;
+	}
+
+	pthread_key_delete (_thread_key);
+}
+
+void
+DSPProfiler::set_enabled (bool yn)
+{
+	if (yn == enabled()) {
+		return;
+	}
+
+	if (yn) {
+		if (_cycles_per_usec == 0) {
+			_cycles_per_usec = CycleTimer::get_mhz ();
+		}
+		start_collector_thread ();
+		g_atomic_int_set (&_enabled, 1);
+	} else {
+		g_atomic_int_set (&_enabled, 0);
+		stop_collector_thread ();
+		/* pick up whatever was recorded since the last pass */
+		collect ();
+	}
+}
+
+void
+DSPProfiler::register_thread ()
+{
+	ThreadBuffer* tb = new ThreadBuffer;
+
+	{
+		Glib::Mutex::Lock lm (_buffers_lock);
+		_buffers.push_back (tb);
+	}
+
+	pthread_setspecific (_thread_key, tb);
+}
+
+void
+DSPProfiler::unregister_thread ()
+{
+	ThreadBuffer* tb = (ThreadBuffer*) pthread_getspecific (_thread_key);
+
+	if (!tb) {
+		return;
+	}
+
+	pthread_setspecific (_thread_key, 0);
+
+	/* the next collect() will drain it and delete it */
+
+	Glib::Mutex::Lock lm (_buffers_lock);
+	tb->retired = true;
+}
+
+void
+DSPProfiler::start_collector_thread ()
+{
+	if (_collector_thread == 0) {
+		g_atomic_int_set (&_collector_exit, 0);
+		_collector_thread = Glib::Thread::create (boost::bind (&DSPProfiler::collector_thread, this),
+							  500000, true, true, Glib::THREAD_PRIORITY_NORMAL);
+	}
+}
+
+void
+DSPProfiler::stop_collector_thread ()
+{
+	if (_collector_thread) {
+		g_atomic_int_set (&_collector_exit, 1);
+		_collector_thread->join ();
+		_collector_thread = 0;
+	}
+}
+
+void
+DSPProfiler::collector_thread ()
+{
+	pthread_set_name (X_("dsp profiler"));
+
+	while (true) {
+		Glib::usleep (100000); /* 1/10th sec interval */
+		if (g_atomic_int_get (&_collector_exit)) {
+			break;
+		}
+		collect ();
+	}
+}
+
+/** Drain all the thread buffers into the accumulators.  The buffers
+ *  are single-reader, so this holds _buffers_lock throughout.
+ */
+void
+DSPProfiler::collect ()
+{
+	Glib::Mutex::Lock lm (_buffers_lock);
+	Measurement measurements[1024];
+
+	for (list<ThreadBuffer*>::iterator i = _buffers.begin(); i != _buffers.end(); ) {
+
+		guint n;
+
+		while ((n = (*i)->measurements.read (measurements, 1024)) > 0) {
+			Glib::Mutex::Lock sm (_stats_lock);
+			for (guint m = 0; m < n; ++m) {
+				_stats[measurements[m].who].add (measurements[m].cycles);
+			}
+		}
+
+		if ((*i)->retired) {
+			delete *i;
+			i = _buffers.erase (i);
+		} else {
+			++i;
+		}
+	}
+}
+
+bool
+DSPProfiler::get_stats (void const * who, DSPStats& stats)
+{
+	Glib::Mutex::Lock lm (_stats_lock);
+	Accumulators::const_iterator i = _stats.find (who);
+
+	if (i == _stats.end() || i->second.count == 0 || _cycles_per_usec == 0) {
+		return false;
+	}
+
+	Accumulator const & a (i->second);
+
+	stats.count = a.count;
+	stats.min = a.min / _cycles_per_usec;
+	stats.max = a.max / _cycles_per_usec;
+	stats.avg = (a.total / a.count) / _cycles_per_usec;
+	stats.p50 = a.percentile (0.50) / _cycles_per_usec;
+	stats.p95 = a.percentile (0.95) / _cycles_per_usec;
+	stats.p99 = a.percentile (0.99) / _cycles_per_usec;
+
+	return true;
+}
+
+/** Drop the statistics for an object that is going away, so that
+ *  another object allocated at the same address starts afresh.
+ *  Measurements of @a who still in the thread buffers are drained
+ *  first, so that they are not credited to such a successor.
+ */
+void
+DSPProfiler::forget (void const * who)
+{
+	collect ();
+
+	Glib::Mutex::Lock lm (_stats_lock);
+	_stats.erase (who);
+}
+
+void
+DSPProfiler::reset ()
+{
+	collect ();
+
+	Glib::Mutex::Lock lm (_stats_lock);
+	_stats.clear ();
+	g_atomic_int_set (&_dropped, 0);
+}
+
+uint32_t
+DSPProfiler::bucket_for (cycles_t c)
+{
+	if (c == 0) {
+		return 0;
+	}
+
+	uint32_t octave = 0;
+	for (cycles_t v = c; v > 1; v >>= 1) {
+		++octave;
+	}
+
+	/* next two bits below the leading one pick the quarter-octave */
+	uint32_t const sub = (octave >= 2) ? ((c >> (octave - 2)) & 0x3) : ((c << (2 - octave)) & 0x3);
+
+	return min (octave * 4 + sub, histogram_buckets - 1);
+}
+
+cycles_t
+DSPProfiler::bucket_value (uint32_t b)
+{
+	uint32_t const octave = b / 4;
+	uint32_t const sub = b % 4;
+
+	return ((cycles_t) (4 + sub) << octave) >> 2;
+}
+
+DSPProfiler::Accumulator::Accumulator ()
+	: count (0)
+	, min (0)
+	, max (0)
+	, total (0)
+{
+	memset (histogram, 0, sizeof (histogram));
+}
+
+void
+DSPProfiler::Accumulator::add (cycles_t c)
+{
+	if (count == 0 || c < min) {
+		min = c;
+	}
+
+	if (c > max) {
+		max = c;
+	}
+
+	++count;
+	total += c;
+	++histogram[bucket_for (c)];
+}
+
+cycles_t
+DSPProfiler::Accumulator::percentile (double p) const
+{
+	uint64_t const target = (uint64_t) (p * count);
+	uint64_t seen = 0;
+
+	for (uint32_t b = 0; b < histogram_buckets; ++b) {
+		seen += histogram[b];
+		if (seen > target) {
+			return std::max (min, std::min (max, bucket_value (b)));
+		}
+	}
+
+	return max;
+}
@@ -0,0 +1,1078 @@
+/*
+    Copyright (C) 2011 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+
+#include <sys/time.h>
+#include <regex.h>
+
+#include <glibmm/timer.h>
+
+#include <sndfile.h>
+
+#include "pbd/compose.h"
+#include "pbd/error.h"
+#include "pbd/malign.h"
+
+#include "ardour/audioengine.h"
+#include "ardour/dummy_audio_backend.h"
+#include "ardour/runtime_functions.h"
+
+#include "i18n.h"
+
+using namespace std;
+using namespace ARDOUR;
+using namespace PBD;
+
+namespace ARDOUR {
+
+struct DummyPort {
+	DummyPort (string const & n, DataType t, uint32_t f)
+		: name (n)
+		, type (t)
+		, flags (f)
+		, buffer (0)
+		, monitor_requests (0)
+		, channel (0)
+		, phase (0)
+		, seed (1)
+		, file_position (0)
+	{
+		capture_latency.min = capture_latency.max = 0;
+		playback_latency.min = playback_latency.max = 0;
+	}
+
+	~DummyPort () {
+		free (buffer);
+	}
+
+	string name;
+	DataType type;
+	uint32_t flags;
+	set<DummyPort*> connections;
+	/** Sample[buffer_size] for audio, a DummyMidiHeader and its events for MIDI */
+	void* buffer;
+	int monitor_requests;
+	jack_latency_range_t capture_latency;
+	jack_latency_range_t playback_latency;
+
+	/* signal generator state, for physical capture ports */
+	uint32_t channel;
+	double phase;
+	uint32_t seed;
+	framecnt_t file_position;
+};
+
+}
+
+namespace {
+
+/** Size of the event area of a MIDI port buffer, as JACK's default */
+size_t const midi_buffer_capacity = 32768;
+
+struct DummyMidiHeader {
+	uint32_t count;
+	uint32_t used;      ///< bytes of event data in use
+	pframes_t last_time;
+	/* where the last midi_event_get() left off, so that reading all
+	   the events in order does not rescan the buffer each time.
+	*/
+	uint32_t cursor_index;
+	uint32_t cursor_offset;
+};
+
+/** Each event is one of these followed by its data, padded to 4 bytes */
+struct DummyMidiEvent {
+	pframes_t time;
+	uint32_t size;
+};
+
+inline DummyMidiHeader*
+midi_header (void* buf)
+{
+	return reinterpret_cast<DummyMidiHeader*> (buf);
+}
+
+inline uint8_t*
+midi_data (void* buf)
+{
+	return reinterpret_cast<uint8_t*> (buf) + sizeof (DummyMidiHeader);
+}
+
+inline uint32_t
+midi_event_stride (size_t size)
+{
+	return (sizeof (DummyMidiEvent) + size + 3) & ~3;
+}
+
+int64_t
+get_microseconds ()
+{
+	struct timeval tv;
+	gettimeofday (&tv, 0);
+	return (int64_t) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+}
+
+DummyAudioBackend::DummyAudioBackend (framecnt_t sample_rate, pframes_t buffer_size, Mode mode)
+	: _sample_rate (sample_rate)
+	, _buffer_size (buffer_size)
+	, _mode (mode)
+	, _connected (false)
+	, _n_audio_capture (8)
+	, _n_audio_playback (8)
+	, _n_midi_capture (1)
+	, _n_midi_playback (1)
+	, _input_signal (Silence)
+	, _input_file_channels (0)
+	, _process_thread (0)
+	, _freewheeling (false)
+	, _frame_time (0)
+	, _cycle_start_usecs (0)
+	, _cpu_load (0)
+	, _cycles (0)
+	, _xruns (0)
+	, _process_usecs (0)
+{
+	g_atomic_int_set (&_running, 0);
+	g_atomic_int_set (&_freewheel_requested, 0);
+	g_atomic_int_set (&_pending_buffer_size, 0);
+}
+
+DummyAudioBackend::~DummyAudioBackend ()
+{
+	close ();
+}
+
+void
+DummyAudioBackend::set_physical_ports (uint32_t audio_capture, uint32_t audio_playback, uint32_t midi_capture, uint32_t midi_playback)
+{
+	_n_audio_capture = audio_capture;
+	_n_audio_playback = audio_playback;
+	_n_midi_capture = midi_capture;
+	_n_midi_playback = midi_playback;
+}
+
+void
+DummyAudioBackend::set_input_signal (InputSignal s)
+{
+	Glib::RecMutex::Lock lm (_port_lock);
+	_input_signal = s;
+}
+
+int
+DummyAudioBackend::set_input_file (string const & path)
+{
+	SF_INFO info;
+	memset (&info, 0, sizeof (info));
+
+	SNDFILE* sf = sf_open (path.c_str (), SFM_READ, &info);
+
+	if (!sf) {
+		error << string_compose (_("Dummy backend: cannot open input file %1 (%2)"), path, sf_strerror (0)) << endmsg;
+		return -1;
+	}
+
+	vector<float> data (info.frames * info.channels);
+	sf_count_t const n = data.empty () ? 0 : sf_readf_float (sf, &data[0], info.frames);
+	sf_close (sf);
+
+	if (n <= 0) {
+		error << string_compose (_("Dummy backend: input file %1 contains no audio"), path) << endmsg;
+		return -1;
+	}
+
+	data.resize (n * info.channels);
+
+	Glib::RecMutex::Lock lm (_port_lock);
+
+	_input_file_data.swap (data);
+	_input_file_channels = info.channels;
+	_input_signal = File;
+
+	for (vector<DummyPort*>::iterator i = _ports.begin (); i != _ports.end (); ++i) {
+		(*i)->file_position = 0;
+	}
+
+	return 0;
+}
+
+int
+DummyAudioBackend::open (string const & client_name, string const & /*session_uuid*/)
+{
+	if (_connected) {
+		return 0;
+	}
+
+	_client_name = client_name;
+	create_physical_ports ();
+	_connected = true;
+
+	return 0;
+}
+
+int
+DummyAudioBackend::close ()
+{
+	stop ();
+
+	Glib::RecMutex::Lock lm (_port_lock);
+
+	for (vector<DummyPort*>::iterator i = _ports.begin (); i != _ports.end (); ++i) {
+		delete *i;
+	}
+
+	_ports.clear ();
+	_connected = false;
+
+	return 0;
+}
+
+void
+DummyAudioBackend::create_physical_ports ()
+{
+	Glib::RecMutex::Lock lm (_port_lock);
+
+	uint32_t const capture = JackPortIsOutput | JackPortIsPhysical | JackPortIsTerminal;
+	uint32_t const playback = JackPortIsInput | JackPortIsPhysical | JackPortIsTerminal;
+
+	for (uint32_t n = 0; n < _n_audio_capture; ++n) {
+		DummyPort* p = new DummyPort (string_compose ("system:capture_%1", n + 1), DataType::AUDIO, capture);
+		p->channel = n;
+		p->seed = 1 + n * 7919;
+		allocate_buffer (p);
+		_ports.push_back (p);
+	}
+
+	for (uint32_t n = 0; n < _n_audio_playback; ++n) {
+		DummyPort* p = new DummyPort (string_compose ("system:playback_%1", n + 1), DataType::AUDIO, playback);
+		allocate_buffer (p);
+		_ports.push_back (p);
+	}
+
+	for (uint32_t n = 0; n < _n_midi_capture; ++n) {
+		DummyPort* p = new DummyPort (string_compose ("system:midi_capture_%1", n + 1), DataType::MIDI, capture);
+		allocate_buffer (p);
+		_ports.push_back (p);
+	}
+
+	for (uint32_t n = 0; n < _n_midi_playback; ++n) {
+		DummyPort* p = new DummyPort (string_compose ("system:midi_playback_%1", n + 1), DataType::MIDI, playback);
+		allocate_buffer (p);
+		_ports.push_back (p);
+	}
+}
+
+void
+DummyAudioBackend::allocate_buffer (DummyPort* p)
+{
+	free (p->buffer);
+	p->buffer = 0;
+
+	if (p->type == DataType::AUDIO) {
+		cache_aligned_malloc (&p->buffer, _buffer_size * sizeof (Sample));
+		memset (p->buffer, 0, _buffer_size * sizeof (Sample));
+	} else {
+		cache_aligned_malloc (&p->buffer, sizeof (DummyMidiHeader) + midi_buffer_capacity);
+		midi_clear (p->buffer);
+	}
+}
+
+int
+DummyAudioBackend::start ()
+{
+	if (!_connected) {
+		return -1;
+	}
+
+	if (g_atomic_int_get (&_running)) {
+		return 0;
+	}
+
+	_engine->sample_rate_callback (_sample_rate);
+	_engine->buffer_size_callback (_buffer_size);
+
+	_cycles = 0;
+	_xruns = 0;
+	_process_usecs = 0;
+	_cpu_load = 0;
+
+	g_atomic_int_set (&_running, 1);
+
+	if (pthread_create (&_process_thread, 0, _process_thread_entry, this)) {
+		g_atomic_int_set (&_running, 0);
+		error << _("Dummy backend: cannot create process thread") << endmsg;
+		return -1;
+	}
+
+	return 0;
+}
+
+int
+DummyAudioBackend::stop ()
+{
+	if (!g_atomic_int_get (&_running)) {
+		return 0;
+	}
+
+	g_atomic_int_set (&_running, 0);
+	pthread_join (_process_thread, 0);
+
+	return 0;
+}
+
+void*
+DummyAudioBackend::_process_thread_entry (void* arg)
+{
+	return static_cast<DummyAudioBackend*> (arg)->process_thread ();
+}
+
+void*
+DummyAudioBackend::process_thread ()
+{
+	_engine->process_thread_init ();
+
+	double deadline = get_microseconds ();
+
+	while (g_atomic_int_get (&_running)) {
+
+		bool const fw = g_atomic_int_get (&_freewheel_requested);
+
+		if (fw != _freewheeling) {
+			_freewheeling = fw;
+			_engine->freewheel_callback (fw);
+		}
+
+		pframes_t const new_size = g_atomic_int_get (&_pending_buffer_size);
+
+		if (new_size) {
+			g_atomic_int_set (&_pending_buffer_size, 0);
+			apply_buffer_size (new_size);
+			_engine->buffer_size_callback (new_size);
+		}
+
+		pframes_t const nframes = _buffer_size;
+		double const period = 1e6 * nframes / _sample_rate;
+		int64_t const start = get_microseconds ();
+		bool ran = false;
+
+		{
+			/* if ports are being added, removed or connected, skip
+			   this cycle rather than wait, as JACK would.
+			*/
+			Glib::RecMutex::Lock lm (_port_lock, Glib::TRY_LOCK);
+
+			if (lm.locked ()) {
+				_cycle_start_usecs = start;
+				fill_capture_buffers (nframes);
+
+				if (_engine->process_callback (nframes)) {
+					g_atomic_int_set (&_running, 0);
+					break;
+				}
+
+				ran = true;
+			}
+		}
+
+		int64_t const end = get_microseconds ();
+
+		_frame_time += nframes;
+
+		if (ran) {
+			_cycles = _cycles + 1;
+			_process_usecs = _process_usecs + (end - start);
+			float const load = 100.0 * (end - start) / period;
+			_cpu_load = _cpu_load + 0.1 * (load - _cpu_load);
+		}
+
+		if (_mode == Realtime && !_freewheeling) {
+			deadline += period;
+			double const wait = deadline - get_microseconds ();
+			if (wait > 0) {
+				Glib::usleep ((unsigned long) wait);
+			} else {
+				_xruns = _xruns + 1;
+				_engine->xrun_callback ();
+				deadline = get_microseconds ();
+			}
+		} else if (!ran) {
+			/* don't spin on the port lock */
+			Glib::usleep (100);
+		}
+	}
+
+	return 0;
+}
+
+void
+DummyAudioBackend::fill_capture_buffers (pframes_t nframes)
+{
+	for (vector<DummyPort*>::iterator i = _ports.begin (); i != _ports.end (); ++i) {
+
+		DummyPort* p = *i;
+
+		if ((p->flags & (JackPortIsPhysical | JackPortIsOutput)) != (JackPortIsPhysical | JackPortIsOutput)) {
+			continue;
+		}
+
+		if (p->type == DataType::MIDI) {
+			midi_clear (p->buffer);
+			continue;
+		}
+
+		Sample* buf = static_cast<Sample*> (p->buffer);
+
+		switch (_input_signal) {
+		case Sine:
+		{
+			double const increment = 2.0 * M_PI * 440.0 * (p->channel + 1) / _sample_rate;
+			for (pframes_t n = 0; n < nframes; ++n) {
+				buf[n] = 0.5 * sin (p->phase);
+				p->phase += increment;
+			}
+			p->phase = fmod (p->phase, 2.0 * M_PI);
+			break;
+		}
+
+		case Noise:
+			for (pframes_t n = 0; n < nframes; ++n) {
+				p->seed = p->seed * 1103515245 + 12345;
+				buf[n] = ((p->seed >> 8) / 8388608.0f) - 1.0f;
+			}
+			break;
+
+		case File:
+			if (_input_file_channels) {
+				framecnt_t const length = _input_file_data.size () / _input_file_channels;
+				uint32_t const channel = p->channel % _input_file_channels;
+				for (pframes_t n = 0; n < nframes; ++n) {
+					buf[n] = _input_file_data[p->file_position * _input_file_channels + channel];
+					if (++p->file_position == length) {
+						p->file_position = 0;
+					}
+				}
+				break;
+			}
+			/* fallthrough */
+
+		case Silence:
+			memset (buf, 0, nframes * sizeof (Sample));
+			break;
+		}
+	}
+}
+
+int
+DummyAudioBackend::create_process_thread (boost::function<void()> f, pthread_t* thread, size_t stacksize)
+{
+	pthread_attr_t attr;
+	ThreadData* td = new ThreadData (f);
+
+	pthread_attr_init (&attr);
+	pthread_attr_setstacksize (&attr, stacksize);
+
+	int const r = pthread_create (thread, &attr, _start_process_thread, td);
+
+	pthread_attr_destroy (&attr);
+
+	if (r) {
+		delete td;
+		return -1;
+	}
+
+	return 0;
+}
+
+void*
+DummyAudioBackend::_start_process_thread (void* arg)
+{
+	ThreadData* td = reinterpret_cast<ThreadData*> (arg);
+	boost::function<void()> f = td->f;
+	delete td;
+
+	f ();
+
+	return 0;
+}
+
+int
+DummyAudioBackend::set_buffer_size (pframes_t nframes)
+{
+	if (nframes == 0) {
+		return -1;
+	}
+
+	if (g_atomic_int_get (&_running)) {
+		/* the process thread will change over between cycles */
+		g_atomic_int_set (&_pending_buffer_size, nframes);
+	} else {
+		apply_buffer_size (nframes);
+	}
+
+	return 0;
+}
+
+void
+DummyAudioBackend::apply_buffer_size (pframes_t nframes)
+{
+	Glib::RecMutex::Lock lm (_port_lock);
+
+	_buffer_size = nframes;
+
+	for (vector<DummyPort*>::iterator i = _ports.begin (); i != _ports.end (); ++i) {
+		if ((*i)->type == DataType::AUDIO) {
+			allocate_buffer (*i);
+		}
+	}
+}
+
+size_t
+DummyAudioBackend::raw_buffer_size (DataType t) const
+{
+	if (t == DataType::AUDIO) {
+		return _buffer_size * sizeof (Sample);
+	}
+
+	return midi_buffer_capacity;
+}
+
+pframes_t
+DummyAudioBackend::frames_since_cycle_start () const
+{
+	int64_t const elapsed = get_microseconds () - _cycle_start_usecs;
+	int64_t const frames = elapsed * _sample_rate / 1000000;
+
+	if (frames < 0) {
+		return 0;
+	}
+
+	return min ((int64_t) _buffer_size, frames);
+}
+
+pframes_t
+DummyAudioBackend::frame_time () const
+{
+	return _frame_time + frames_since_cycle_start ();
+}
+
+int
+DummyAudioBackend::freewheel (bool onoff)
+{
+	g_atomic_int_set (&_freewheel_requested, onoff);
+	return 0;
+}
+
+/* Ports.
+ *
+ * Anything which changes the set of ports or their connections takes
+ * _port_lock, which the process thread holds for each cycle.  Queries
+ * do not, since they may be made from the process thread and from the
+ * session's graph threads while it is held.
+ */
+
+DummyPort*
+DummyAudioBackend::find_port (string const & name) const
+{
+	for (vector<DummyPort*>::const_iterator i = _ports.begin (); i != _ports.end (); ++i) {
+		if ((*i)->name == name) {
+			return *i;
+		}
+	}
+
+	return 0;
+}
+
+AudioBackend::PortHandle
+DummyAudioBackend::register_port (string const & shortname, DataType type, uint32_t flags)
+{
+	if (!_connected) {
+		return 0;
+	}
+
+	DummyPort* p = 0;
+
+	{
+		Glib::RecMutex::Lock lm (_port_lock);
+
+		string const name = _client_name + ':' + shortname;
+
+		if (find_port (name)) {
+			return 0;
+		}
+
+		p = new DummyPort (name, type, flags);
+		allocate_buffer (p);
+		_ports.push_back (p);
+	}
+
+	_engine->port_registration_callback ();
+
+	return p;
+}
+
+void
+DummyAudioBackend::unregister_port (PortHandle port)
+{
+	DummyPort* p = static_cast<DummyPort*> (port);
+
+	{
+		Glib::RecMutex::Lock lm (_port_lock);
+
+		vector<DummyPort*>::iterator i = find (_ports.begin (), _ports.end (), p);
+
+		if (i == _ports.end ()) {
+			return;
+		}
+
+		for (set<DummyPort*>::iterator c = p->connections.begin (); c != p->connections.end (); ++c) {
+			(*c)->connections.erase (p);
+		}
+
+		_ports.erase (i);
+		delete p;
+	}
+
+	_engine->port_registration_callback ();
+}
+
+int
+DummyAudioBackend::set_port_name (PortHandle port, string const & shortname)
+{
+	Glib::RecMutex::Lock lm (_port_lock);
+
+	string const name = _client_name + ':' + shortname;
+
+	if (find_port (name)) {
+		return -1;
+	}
+
+	static_cast<DummyPort*> (port)->name = name;
+
+	return 0;
+}
+
+AudioBackend::PortHandle
+DummyAudioBackend::get_port_by_name (string const & name) const
+{
+	return find_port (name);
+}
+
+uint32_t
+DummyAudioBackend::port_flags (PortHandle port) const
+{
+	return static_cast<DummyPort*> (port)->flags;
+}
+
+DataType
+DummyAudioBackend::port_data_type (PortHandle port) const
+{
+	return static_cast<DummyPort*> (port)->type;
+}
+
+const char**
+DummyAudioBackend::get_ports (string const & port_name_pattern, string const & type_name_pattern, uint32_t flags) const
+{
+	regex_t port_regex;
+	regex_t type_regex;
+	bool const match_port = !port_name_pattern.empty ();
+	bool const match_type = !type_name_pattern.empty ();
+
+	if (match_port && regcomp (&port_regex, port_name_pattern.c_str (), REG_EXTENDED | REG_NOSUB)) {
+		return 0;
+	}
+
+	if (match_type && regcomp (&type_regex, type_name_pattern.c_str (), REG_EXTENDED | REG_NOSUB)) {
+		if (match_port) {
+			regfree (&port_regex);
+		}
+		return 0;
+	}
+
+	vector<DummyPort*> matches;
+	size_t name_bytes = 0;
+
+	Glib::RecMutex::Lock lm (_port_lock);
+
+	for (vector<DummyPort*>::const_iterator i = _ports.begin (); i != _ports.end (); ++i) {
+
+		DummyPort* p = *i;
+
+		if ((p->flags & flags) != flags) {
+			continue;
+		}
+
+		if (match_port && regexec (&port_regex, p->name.c_str (), 0, 0, 0)) {
+			continue;
+		}
+
+		if (match_type && regexec (&type_regex, p->type.to_jack_type (), 0, 0, 0)) {
+			continue;
+		}
+
+		matches.push_back (p);
+		name_bytes += p->name.length () + 1;
+	}
+
+	if (match_port) {
+		regfree (&port_regex);
+	}
+
+	if (match_type) {
+		regfree (&type_regex);
+	}
+
+	if (matches.empty ()) {
+		return 0;
+	}
+
+	/* one block holding both the pointers and the strings, so that
+	   the caller can release it all with a single free(), as with
+	   jack_get_ports().
+	*/
+
+	size_t const table_bytes = (matches.size () + 1) * sizeof (char*);
+	char** ports = static_cast<char**> (malloc (table_bytes + name_bytes));
+	char* s = reinterpret_cast<char*> (ports) + table_bytes;
+
+	for (size_t n = 0; n < matches.size (); ++n) {
+		size_t const len = matches[n]->name.length () + 1;
+		memcpy (s, matches[n]->name.c_str (), len);
+		ports[n] = s;
+		s += len;
+	}
+
+	ports[matches.size ()] = 0;
+
+	return const_cast<const char**> (ports);
+}
+
+int
+DummyAudioBackend::connect (string const & src, string const & dst)
+{
+	{
+		Glib::RecMutex::Lock lm (_port_lock);
+
+		DummyPort* s = find_port (src);
+		DummyPort* d = find_port (dst);
+
+		if (!s || !d || s->type != d->type || !(s->flags & JackPortIsOutput) || !(d->flags & JackPortIsInput)) {
+			return -1;
+		}
+
+		if (s->connections.find (d) != s->connections.end ()) {
+			return EEXIST;
+		}
+
+		s->connections.insert (d);
+		d->connections.insert (s);
+	}
+
+	_engine->port_connect_callback (src, dst, true);
+
+	return 0;
+}
+
+int
+DummyAudioBackend::disconnect (string const & src, string const & dst)
+{
+	{
+		Glib::RecMutex::Lock lm (_port_lock);
+
+		DummyPort* s = find_port (src);
+		DummyPort* d = find_port (dst);
+
+		if (!s || !d || s->connections.erase (d) == 0) {
+			return -1;
+		}
+
+		d->connections.erase (s);
+	}
+
+	_engine->port_connect_callback (src, dst, false);
+
+	return 0;
+}
+
+int
+DummyAudioBackend::disconnect_all (PortHandle port)
+{
+	DummyPort* p = static_cast<DummyPort*> (port);
+	vector<pair<string, string> > gone;
+
+	{
+		Glib::RecMutex::Lock lm (_port_lock);
+
+		for (set<DummyPort*>::iterator c = p->connections.begin (); c != p->connections.end (); ++c) {
+			(*c)->connections.erase (p);
+			if (p->flags & JackPortIsOutput) {
+				gone.push_back (make_pair (p->name, (*c)->name));
+			} else {
+				gone.push_back (make_pair ((*c)->name, p->name));
+			}
+		}
+
+		p->connections.clear ();
+	}
+
+	for (vector<pair<string, string> >::iterator i = gone.begin (); i != gone.end (); ++i) {
+		_engine->port_connect_callback (i->first, i->second, false);
+	}
+
+	return 0;
+}
+
+bool
+DummyAudioBackend::connected (PortHandle port) const
+{
+	return !static_cast<DummyPort*> (port)->connections.empty ();
+}
+
+bool
+DummyAudioBackend::connected_to (PortHandle port, string const & other) const
+{
+	DummyPort* p = static_cast<DummyPort*> (port);
+
+	for (set<DummyPort*>::const_iterator c = p->connections.begin (); c != p->connections.end (); ++c) {
+		if ((*c)->name == other) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int
+DummyAudioBackend::get_connections (PortHandle port, vector<string>& c) const
+{
+	DummyPort* p = static_cast<DummyPort*> (port);
+
+	for (set<DummyPort*>::const_iterator i = p->connections.begin (); i != p->connections.end (); ++i) {
+		c.push_back ((*i)->name);
+	}
+
+	return p->connections.size ();
+}
+
+int
+DummyAudioBackend::ensure_monitor_input (PortHandle port, bool yn)
+{
+	DummyPort* p = static_cast<DummyPort*> (port);
+
+	if (yn) {
+		p->monitor_requests = max (1, p->monitor_requests);
+	} else {
+		p->monitor_requests = 0;
+	}
+
+	return 0;
+}
+
+int
+DummyAudioBackend::request_monitor_input (PortHandle port, bool yn)
+{
+	DummyPort* p = static_cast<DummyPort*> (port);
+
+	if (yn) {
+		++p->monitor_requests;
+	} else if (p->monitor_requests) {
+		--p->monitor_requests;
+	}
+
+	return 0;
+}
+
+bool
+DummyAudioBackend::monitoring_input (PortHandle port) const
+{
+	return static_cast<DummyPort*> (port)->monitor_requests > 0;
+}
+
+void
+DummyAudioBackend::set_latency_range (PortHandle port, bool playback, jack_latency_range_t r)
+{
+	DummyPort* p = static_cast<DummyPort*> (port);
+
+	if (playback) {
+		p->playback_latency = r;
+	} else {
+		p->capture_latency = r;
+	}
+}
+
+jack_latency_range_t
+DummyAudioBackend::get_latency_range (PortHandle port, bool playback) const
+{
+	DummyPort* p = static_cast<DummyPort*> (port);
+	return playback ? p->playback_latency : p->capture_latency;
+}
+
+void*
+DummyAudioBackend::get_buffer (PortHandle port, pframes_t /*nframes*/)
+{
+	DummyPort* p = static_cast<DummyPort*> (port);
+
+	if (p->flags & JackPortIsOutput) {
+		return p->buffer;
+	}
+
+	if (p->connections.empty ()) {
+		if (p->type == DataType::AUDIO) {
+			memset (p->buffer, 0, _buffer_size * sizeof (Sample));
+		} else {
+			midi_clear (p->buffer);
+		}
+		return p->buffer;
+	}
+
+	set<DummyPort*>::const_iterator c = p->connections.begin ();
+
+	if (p->type == DataType::AUDIO) {
+
+		if (p->connections.size () == 1) {
+			/* no need to copy */
+			return (*c)->buffer;
+		}
+
+		Sample* buf = static_cast<Sample*> (p->buffer);
+		memcpy (buf, (*c)->buffer, _buffer_size * sizeof (Sample));
+
+		for (++c; c != p->connections.end (); ++c) {
+			mix_buffers_no_gain (buf, static_cast<Sample const*> ((*c)->buffer), _buffer_size);
+		}
+
+		return buf;
+	}
+
+	/* MIDI: merge the events from all the sources in time order */
+
+	midi_clear (p->buffer);
+
+	vector<void*> sources;
+	vector<uint32_t> next;
+
+	for (; c != p->connections.end (); ++c) {
+		sources.push_back ((*c)->buffer);
+		next.push_back (0);
+	}
+
+	while (true) {
+		int earliest = -1;
+		pframes_t earliest_time = 0;
+		pframes_t time;
+		size_t size;
+		uint8_t const* data;
+
+		for (size_t s = 0; s < sources.size (); ++s) {
+			if (next[s] < midi_event_count (sources[s])) {
+				midi_event_get (time, size, &data, sources[s], next[s]);
+				if (earliest < 0 || time < earliest_time) {
+					earliest = s;
+					earliest_time = time;
+				}
+			}
+		}
+
+		if (earliest < 0) {
+			break;
+		}
+
+		midi_event_get (time, size, &data, sources[earliest], next[earliest]++);
+		midi_event_put (p->buffer, time, data, size);
+	}
+
+	return p->buffer;
+}
+
+uint32_t
+DummyAudioBackend::midi_event_count (void* buf) const
+{
+	return midi_header (buf)->count;
+}
+
+int
+DummyAudioBackend::midi_event_get (pframes_t& timestamp, size_t& size, uint8_t const** data, void* buf, uint32_t index) const
+{
+	DummyMidiHeader* h = midi_header (buf);
+
+	if (index >= h->count) {
+		return -1;
+	}
+
+	if (index < h->cursor_index) {
+		h->cursor_index = 0;
+		h->cursor_offset = 0;
+	}
+
+	while (h->cursor_index < index) {
+		DummyMidiEvent const* ev = reinterpret_cast<DummyMidiEvent const*> (midi_data (buf) + h->cursor_offset);
+		h->cursor_offset += midi_event_stride (ev->size);
+		++h->cursor_index;
+	}
+
+	DummyMidiEvent const* ev = reinterpret_cast<DummyMidiEvent const*> (midi_data (buf) + h->cursor_offset);
+
+	timestamp = ev->time;
+	size = ev->size;
+	*data = reinterpret_cast<uint8_t const*> (ev + 1);
+
+	return 0;
+}
+
+int
+DummyAudioBackend::midi_event_put (void* buf, pframes_t timestamp, uint8_t const* data, size_t size)
+{
+	DummyMidiHeader* h = midi_header (buf);
+	uint32_t const stride = midi_event_stride (size);
+
+	/* as JACK, events must be added in time order */
+
+	if (timestamp >= _buffer_size || (h->count && timestamp < h->last_time) || h->used + stride > midi_buffer_capacity) {
+		return ENOBUFS;
+	}
+
+	DummyMidiEvent* ev = reinterpret_cast<DummyMidiEvent*> (midi_data (buf) + h->used);
+	ev->time = timestamp;
+	ev->size = size;
+	memcpy (ev + 1, data, size);
+
+	h->used += stride;
+	h->last_time = timestamp;
+	++h->count;
+
+	return 0;
+}
+
+void
+DummyAudioBackend::midi_clear (void* buf)
+{
+	DummyMidiHeader* h = midi_header (buf);
+
+	h->count = 0;
+	h->used = 0;
+	h->last_time = 0;
+	h->cursor_index = 0;
+	h->cursor_offset = 0;
+}
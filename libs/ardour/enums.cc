@@ -70,6 +70,7 @@ setup_enum_writer ()
 	AFLPosition _AFLPosition;
 	RemoteModel _RemoteModel;
 	DenormalModel _DenormalModel;
+	ProcessorScheduling _ProcessorScheduling;
 	CrossfadeModel _CrossfadeModel;
 	LayerModel _LayerModel;
 	InsertMergePolicy _InsertMergePolicy;
@@ -242,6 +243,10 @@ setup_enum_writer ()
 	REGISTER_ENUM (DenormalFTZDAZ);
 	REGISTER (_DenormalModel);
 
+	REGISTER_ENUM (SharedQueueScheduling);
+	REGISTER_ENUM (WorkStealingScheduling);
+	REGISTER (_ProcessorScheduling);
+
 	REGISTER_ENUM (UserOrdered);
 	REGISTER_ENUM (MixerOrdered);
 	REGISTER_ENUM (EditorOrdered);
@@ -802,6 +807,19 @@ std::ostream& operator<<(std::ostream& o, const DenormalModel& var)
 	std::string s = enum_2_string (var);
 	return o << s;
 }
+std::istream& operator>>(std::istream& o, ProcessorScheduling& var)
+{
+	std::string s;
+	o >> s;
+	var = (ProcessorScheduling) string_2_enum (s, var);
+	return o;
+}
+
+std::ostream& operator<<(std::ostream& o, const ProcessorScheduling& var)
+{
+	std::string s = enum_2_string (var);
+	return o << s;
+}
 std::istream& operator>>(std::istream& o, WaveformScale& var)
 {
 	std::string s;
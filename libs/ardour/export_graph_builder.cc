@@ -1,5 +1,7 @@
 #include "ardour/export_graph_builder.h"
 
+#include <algorithm>
+
 #include "audiographer/process_context.h"
 #include "audiographer/general/interleaver.h"
 #include "audiographer/general/normalizer.h"
@@ -20,7 +22,6 @@
 #include "ardour/utils.h"
 
 #include "pbd/filesystem.h"
-#include "pbd/cpus.h"
 
 using namespace AudioGrapher;
 using std::string;
@@ -29,7 +30,6 @@ namespace ARDOUR {
 
 ExportGraphBuilder::ExportGraphBuilder (Session const & session)
   : session (session)
-  , thread_pool (hardware_concurrency())
 {
 	process_buffer_frames = session.engine().frames_per_cycle();
 }
@@ -39,16 +39,37 @@ ExportGraphBuilder::~ExportGraphBuilder ()
 }
 
 int
-ExportGraphBuilder::process (framecnt_t frames, bool last_cycle)
+ExportGraphBuilder::process (framecnt_t frames, framepos_t position)
 {
 	assert(frames <= process_buffer_frames);
 
-	for (ChannelMap::iterator it = channels.begin(); it != channels.end(); ++it) {
+	framepos_t const block_end = position + frames;
+
+	for (ChannelOutputMap::iterator it = channels.begin(); it != channels.end(); ++it) {
 		Sample const * process_buffer = 0;
 		it->first->read (process_buffer, frames);
-		ConstProcessContext<Sample> context(process_buffer, frames, 1);
-		if (last_cycle) { context().set_flag (ProcessContext<Sample>::EndOfInput); }
-		it->second->process (context);
+
+		for (std::list<ChannelOutput>::iterator o = it->second.begin(); o != it->second.end(); ++o) {
+			ExportTimespan const & span = *o->timespan->span;
+
+			framepos_t const start = std::max (position, span.get_start());
+			framepos_t const end = std::min (block_end, span.get_end());
+			bool const last_cycle = (end == span.get_end());
+
+			if (o->timespan->finished || start > end || (start == end && !last_cycle)) {
+				continue;
+			}
+
+			ConstProcessContext<Sample> context(process_buffer + (start - position), end - start, 1);
+			if (last_cycle) { context().set_flag (ProcessContext<Sample>::EndOfInput); }
+			o->vertex->process (context);
+		}
+	}
+
+	for (boost::ptr_list<Timespan>::iterator it = timespans.begin(); it != timespans.end(); ++it) {
+		if (it->span->get_end() <= block_end) {
+			it->finished = true;
+		}
 	}
 
 	return 0;
@@ -72,8 +93,8 @@ void
 ExportGraphBuilder::reset ()
 {
 	timespan.reset();
-	channel_configs.clear ();
 	channels.clear ();
+	timespans.clear ();
 	normalizers.clear ();
 }
 
@@ -81,6 +102,14 @@ void
 ExportGraphBuilder::set_current_timespan (boost::shared_ptr<ExportTimespan> span)
 {
 	timespan = span;
+
+	for (boost::ptr_list<Timespan>::iterator it = timespans.begin(); it != timespans.end(); ++it) {
+		if (it->span == span) {
+			return;
+		}
+	}
+
+	timespans.push_back (new Timespan (span));
 }
 
 void
@@ -105,6 +134,7 @@ ExportGraphBuilder::add_config (FileSpec const & config)
 
 	if (!new_config.channel_config->get_split ()) {
 		add_split_config (new_config);
+		map_channels ();
 		return;
 	}
 
@@ -125,12 +155,21 @@ ExportGraphBuilder::add_config (FileSpec const & config)
 
 		add_split_config (copy);
 	}
+
+	map_channels ();
 }
 
 void
 ExportGraphBuilder::add_split_config (FileSpec const & config)
 {
-	for (ChannelConfigList::iterator it = channel_configs.begin(); it != channel_configs.end(); ++it) {
+	assert (timespan);
+
+	boost::ptr_list<Timespan>::iterator t = timespans.begin();
+	while (t->span != timespan) {
+		++t;
+	}
+
+	for (ChannelConfigList::iterator it = t->channel_configs.begin(); it != t->channel_configs.end(); ++it) {
 		if (*it == config) {
 			it->add_child (config);
 			return;
@@ -138,7 +177,20 @@ ExportGraphBuilder::add_split_config (FileSpec const & config)
 	}
 
 	// No duplicate channel config found, create new one
-	channel_configs.push_back (new ChannelConfig (*this, config, channels));
+	t->channel_configs.push_back (new ChannelConfig (*this, config, t->channels));
+}
+
+/** Collect the inputs of all timespans for each export channel */
+void
+ExportGraphBuilder::map_channels ()
+{
+	channels.clear ();
+
+	for (boost::ptr_list<Timespan>::iterator t = timespans.begin(); t != timespans.end(); ++t) {
+		for (ChannelMap::iterator it = t->channels.begin(); it != t->channels.end(); ++it) {
+			channels[it->first].push_back (ChannelOutput (&*t, it->second));
+		}
+	}
 }
 
 /* Encoder */
@@ -288,7 +340,7 @@ ExportGraphBuilder::Normalizer::Normalizer (ExportGraphBuilder & parent, FileSpe
 	buffer.reset (new AllocatingProcessContext<Sample> (max_frames_out, config.channel_config->get_n_chans()));
 	peak_reader.reset (new PeakReader ());
 	normalizer.reset (new AudioGrapher::Normalizer (config.format->normalize_target()));
-	threader.reset (new Threader<Sample> (parent.thread_pool));
+	threader.reset (new Threader<Sample> ());
 
 	normalizer->alloc_buffer (max_frames_out);
 	normalizer->add_output (threader);
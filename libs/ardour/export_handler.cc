@@ -20,6 +20,9 @@
 
 #include "ardour/export_handler.h"
 
+#include <algorithm>
+#include <vector>
+
 #include <glibmm.h>
 
 #include "pbd/convert.h"
@@ -107,6 +110,8 @@ ExportHandler::ExportHandler (Session & session)
   , export_status (session.get_export_status ())
   , realtime (false)
   , normalizing (false)
+  , pass_end (0)
+  , timespans_done (0)
   , cue_tracknum (0)
   , cue_indexnum (0)
 {
@@ -137,47 +142,77 @@ ExportHandler::do_export (bool rt)
 	export_status->init();
 	std::set<ExportTimespanPtr> timespan_set;
 	for (ConfigMap::iterator it = config_map.begin(); it != config_map.end(); ++it) {
-		timespan_set.insert (it->first);
-		export_status->total_frames += it->first->get_length();
+		if (timespan_set.insert (it->first).second) {
+			export_status->total_frames += it->first->get_length();
+		}
 	}
 	export_status->total_timespans = timespan_set.size();
+	timespans_done = 0;
 
 	/* Start export */
 
 	realtime = rt;
-	start_timespan ();
+	start_pass ();
 }
 
+struct TimespanSortByStart {
+	bool operator() (ExportTimespanPtr a, ExportTimespanPtr b) {
+		return a->get_start() < b->get_start();
+	}
+};
+
 void
-ExportHandler::start_timespan ()
+ExportHandler::start_pass ()
 {
-	export_status->timespan++;
-
 	if (config_map.empty()) {
 		// freewheeling has to be stopped from outside the process cycle
 		export_status->running = false;
 		return;
 	}
 
-	current_timespan = config_map.begin()->first;
+	/* Find the earliest timespan, and everything which overlaps it,
+	   directly or through other timespans.  These are all rendered
+	   in one pass, so that no part of the session is run more than once.
+	*/
+
+	std::vector<ExportTimespanPtr> timespans;
+	for (ConfigMap::iterator it = config_map.begin(); it != config_map.end(); it = config_map.upper_bound (it->first)) {
+		timespans.push_back (it->first);
+	}
+	std::sort (timespans.begin(), timespans.end(), TimespanSortByStart());
+
+	pass_timespans.clear ();
+	pass_end = timespans.front()->get_end();
+	for (std::vector<ExportTimespanPtr>::iterator it = timespans.begin(); it != timespans.end(); ++it) {
+		if (it != timespans.begin() && (*it)->get_start() > pass_end) {
+			break;
+		}
+		pass_end = std::max (pass_end, (*it)->get_end());
+		pass_timespans.push_back (*it);
+	}
 
 	/* Register file configurations to graph builder */
 
-	timespan_bounds = config_map.equal_range (current_timespan);
 	graph_builder->reset ();
-	graph_builder->set_current_timespan (current_timespan);
-	for (ConfigMap::iterator it = timespan_bounds.first; it != timespan_bounds.second; ++it) {
-		// Filenames can be shared across timespans
-		FileSpec & spec = it->second;
-		spec.filename->set_timespan (it->first);
-		graph_builder->add_config (spec);
+	for (TimespanList::iterator t = pass_timespans.begin(); t != pass_timespans.end(); ++t) {
+		graph_builder->set_current_timespan (*t);
+
+		std::pair<ConfigMap::iterator, ConfigMap::iterator> bounds = config_map.equal_range (*t);
+		for (ConfigMap::iterator it = bounds.first; it != bounds.second; ++it) {
+			// Filenames can be shared across timespans, which are now
+			// all set up before any file is written, so give each its own
+			FileSpec spec = it->second;
+			spec.filename.reset (new ExportFilename (*spec.filename));
+			spec.filename->set_timespan (it->first);
+			graph_builder->add_config (spec);
+		}
 	}
 
 	/* start export */
 
 	normalizing = false;
 	session.ProcessExport.connect_same_thread (process_connection, boost::bind (&ExportHandler::process, this, _1));
-	process_position = current_timespan->get_start();
+	process_position = pass_timespans.front()->get_start();
 	session.start_audio_export (process_position, realtime);
 }
 
@@ -189,22 +224,22 @@ ExportHandler::process (framecnt_t frames)
 	} else if (normalizing) {
 		return process_normalize ();
 	} else {
-		return process_timespan (frames);
+		return process_pass (frames);
 	}
 }
 
 int
-ExportHandler::process_timespan (framecnt_t frames)
+ExportHandler::process_pass (framecnt_t frames)
 {
 	/* update position */
 
 	framecnt_t frames_to_read = 0;
-	framepos_t const end = current_timespan->get_end();
+	framepos_t const position = process_position;
 
-	bool const last_cycle = (process_position + frames >= end);
+	bool const last_cycle = (process_position + frames >= pass_end);
 
 	if (last_cycle) {
-		frames_to_read = end - process_position;
+		frames_to_read = pass_end - process_position;
 		export_status->stop = true;
 		normalizing = true;
 	} else {
@@ -212,19 +247,34 @@ ExportHandler::process_timespan (framecnt_t frames)
 	}
 
 	process_position += frames_to_read;
-	export_status->processed_frames += frames_to_read;
+
+	/* Progress counts each timespan's frames, so overlapping parts count once for each */
+
+	uint32_t started = 0;
+	for (TimespanList::iterator it = pass_timespans.begin(); it != pass_timespans.end(); ++it) {
+		framepos_t const start = std::max (position, (*it)->get_start());
+		framepos_t const end = std::min (process_position, (*it)->get_end());
+		if (end > start) {
+			export_status->processed_frames += end - start;
+		}
+		if ((*it)->get_start() < process_position) {
+			++started;
+		}
+	}
+
+	export_status->timespan = timespans_done + started;
 	export_status->progress = (float) export_status->processed_frames / export_status->total_frames;
 
 	/* Do actual processing */
 
-	return graph_builder->process (frames_to_read, last_cycle);
+	return graph_builder->process (frames_to_read, position);
 }
 
 int
 ExportHandler::process_normalize ()
 {
 	if (graph_builder->process_normalize ()) {
-		finish_timespan ();
+		finish_pass ();
 		export_status->normalizing = false;
 	} else {
 		export_status->normalizing = true;
@@ -234,13 +284,16 @@ ExportHandler::process_normalize ()
 }
 
 void
-ExportHandler::finish_timespan ()
+ExportHandler::finish_pass ()
 {
-	while (config_map.begin() != timespan_bounds.second) {
-		config_map.erase (config_map.begin());
+	for (TimespanList::iterator it = pass_timespans.begin(); it != pass_timespans.end(); ++it) {
+		config_map.erase (*it);
 	}
 
-	start_timespan ();
+	timespans_done += pass_timespans.size();
+	pass_timespans.clear ();
+
+	start_pass ();
 }
 
 /*** CD Marker sutff ***/
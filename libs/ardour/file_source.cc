@@ -222,6 +222,7 @@ FileSource::move_to_trash (const string& trash_dir_name)
 
 	/* file can not be removed twice, since the operation is not idempotent */
 	_flags = Flag (_flags & ~(RemoveAtDestroy|Removable|RemovableIfEmpty));
+	StateChanged (); /* EMIT SIGNAL */
 
 	return 0;
 }
@@ -512,6 +513,7 @@ FileSource::set_source_name (const string& newname, bool destructive)
 
 	_name = Glib::path_get_basename (newpath);
 	_path = newpath;
+	StateChanged (); /* EMIT SIGNAL */
 
 	return 0;
 }
@@ -522,6 +524,7 @@ FileSource::mark_immutable ()
 	/* destructive sources stay writable, and their other flags don't change.  */
 	if (!(_flags & Destructive)) {
 		_flags = Flag (_flags & ~(Writable|Removable|RemovableIfEmpty|RemoveAtDestroy|CanRename));
+		StateChanged (); /* EMIT SIGNAL */
 	}
 }
 
@@ -529,6 +532,7 @@ void
 FileSource::mark_nonremovable ()
 {
         _flags = Flag (_flags & ~(Removable|RemovableIfEmpty|RemoveAtDestroy));
+	StateChanged (); /* EMIT SIGNAL */
 }
 
 void
@@ -57,17 +57,18 @@
 #include "midi++/manager.h"
 #include "midi++/mmc.h"
 
-#include "ardour/analyser.h"
 #include "ardour/ardour.h"
 #include "ardour/audio_library.h"
 #include "ardour/audioengine.h"
 #include "ardour/audioregion.h"
 #include "ardour/audiosource.h"
+#include "ardour/automation_list.h"
 #include "ardour/buffer_manager.h"
 #include "ardour/control_protocol_manager.h"
 #include "ardour/dB.h"
 #include "ardour/debug.h"
 #include "ardour/filesystem_paths.h"
+#include "ardour/location.h"
 #include "ardour/midi_region.h"
 #include "ardour/mix.h"
 #include "ardour/audioplaylist.h"
@@ -82,6 +83,8 @@
 #include "ardour/session.h"
 #include "ardour/session_event.h"
 #include "ardour/source_factory.h"
+#include "ardour/source_work_pool.h"
+#include "ardour/tempo.h"
 #include "ardour/utils.h"
 
 #include "audiographer/routines.h"
@@ -105,6 +108,8 @@ find_peaks_t            ARDOUR::find_peaks = 0;
 apply_gain_to_buffer_t  ARDOUR::apply_gain_to_buffer = 0;
 mix_buffers_with_gain_t ARDOUR::mix_buffers_with_gain = 0;
 mix_buffers_no_gain_t   ARDOUR::mix_buffers_no_gain = 0;
+apply_gain_vector_to_buffer_t  ARDOUR::apply_gain_vector_to_buffer = 0;
+mix_buffers_with_gain_vector_t ARDOUR::mix_buffers_with_gain_vector = 0;
 
 PBD::Signal1<void,std::string> ARDOUR::BootMessage;
 
@@ -154,7 +159,45 @@ setup_hardware_optimization (bool try_optimization)
 
 #if defined (ARCH_X86) && defined (BUILD_SSE_OPTIMIZATIONS)
 
-		if (fpu.has_sse()) {
+		/* widest first: the AVX kernels are only built if the compiler
+		   supports them, and only used if the CPU and the OS both do.
+		*/
+
+#ifdef HAVE_AVX512F_INTRINSICS
+		if (generic_mix_functions && fpu.has_avx512f()) {
+
+			info << "Using AVX-512 optimized routines" << endmsg;
+
+			compute_peak          = x86_avx512f_compute_peak;
+			find_peaks            = x86_avx512f_find_peaks;
+			apply_gain_to_buffer  = x86_avx512f_apply_gain_to_buffer;
+			mix_buffers_with_gain = x86_avx512f_mix_buffers_with_gain;
+			mix_buffers_no_gain   = x86_avx512f_mix_buffers_no_gain;
+			apply_gain_vector_to_buffer  = x86_avx512f_apply_gain_vector_to_buffer;
+			mix_buffers_with_gain_vector = x86_avx512f_mix_buffers_with_gain_vector;
+
+			generic_mix_functions = false;
+		}
+#endif
+
+#ifdef HAVE_AVX_INTRINSICS
+		if (generic_mix_functions && fpu.has_avx()) {
+
+			info << "Using AVX optimized routines" << endmsg;
+
+			compute_peak          = x86_avx_compute_peak;
+			find_peaks            = x86_avx_find_peaks;
+			apply_gain_to_buffer  = x86_avx_apply_gain_to_buffer;
+			mix_buffers_with_gain = x86_avx_mix_buffers_with_gain;
+			mix_buffers_no_gain   = x86_avx_mix_buffers_no_gain;
+			apply_gain_vector_to_buffer  = x86_avx_apply_gain_vector_to_buffer;
+			mix_buffers_with_gain_vector = x86_avx_mix_buffers_with_gain_vector;
+
+			generic_mix_functions = false;
+		}
+#endif
+
+		if (generic_mix_functions && fpu.has_sse()) {
 
 			info << "Using SSE optimized routines" << endmsg;
 
@@ -162,9 +205,11 @@ setup_hardware_optimization (bool try_optimization)
 			compute_peak          = x86_sse_compute_peak;
 			find_peaks            = x86_sse_find_peaks;
 			apply_gain_to_buffer  = x86_sse_apply_gain_to_buffer;
-			// mix_buffers_with_gain = x86_sse_mix_buffers_with_gain;
-			mix_buffers_with_gain = default_mix_buffers_with_gain;
+			// x86_sse_mix_buffers_with_gain is not used
+			mix_buffers_with_gain = x86_sse_xmm_mix_buffers_with_gain;
 			mix_buffers_no_gain   = x86_sse_mix_buffers_no_gain;
+			apply_gain_vector_to_buffer  = x86_sse_apply_gain_vector_to_buffer;
+			mix_buffers_with_gain_vector = x86_sse_mix_buffers_with_gain_vector;
 
 			generic_mix_functions = false;
 
@@ -182,11 +227,27 @@ setup_hardware_optimization (bool try_optimization)
 			apply_gain_to_buffer   = veclib_apply_gain_to_buffer;
 			mix_buffers_with_gain  = veclib_mix_buffers_with_gain;
 			mix_buffers_no_gain    = veclib_mix_buffers_no_gain;
+			apply_gain_vector_to_buffer  = default_apply_gain_vector_to_buffer;
+			mix_buffers_with_gain_vector = default_mix_buffers_with_gain_vector;
 
 			generic_mix_functions = false;
 
 			info << "Apple VecLib H/W specific optimizations in use" << endmsg;
 		}
+
+#elif defined (BUILD_NEON_OPTIMIZATIONS) && (defined (__ARM_NEON__) || defined (__ARM_NEON))
+
+		info << "Using NEON optimized routines" << endmsg;
+
+		compute_peak          = arm_neon_compute_peak;
+		find_peaks            = arm_neon_find_peaks;
+		apply_gain_to_buffer  = arm_neon_apply_gain_to_buffer;
+		mix_buffers_with_gain = arm_neon_mix_buffers_with_gain;
+		mix_buffers_no_gain   = arm_neon_mix_buffers_no_gain;
+		apply_gain_vector_to_buffer  = arm_neon_apply_gain_vector_to_buffer;
+		mix_buffers_with_gain_vector = arm_neon_mix_buffers_with_gain_vector;
+
+		generic_mix_functions = false;
 #endif
 
 		/* consider FPU denormal handling to be "h/w optimization" */
@@ -201,6 +262,8 @@ setup_hardware_optimization (bool try_optimization)
 		apply_gain_to_buffer  = default_apply_gain_to_buffer;
 		mix_buffers_with_gain = default_mix_buffers_with_gain;
 		mix_buffers_no_gain   = default_mix_buffers_no_gain;
+		apply_gain_vector_to_buffer  = default_apply_gain_vector_to_buffer;
+		mix_buffers_with_gain_vector = default_mix_buffers_with_gain_vector;
 
 		info << "No H/W specific optimizations in use" << endmsg;
 	}
@@ -256,6 +319,9 @@ ARDOUR::init (bool use_vst, bool try_optimization)
 	RouteGroup::make_property_quarks ();
         Playlist::make_property_quarks ();
         AudioPlaylist::make_property_quarks ();
+	AutomationList::make_property_quarks ();
+	Locations::make_property_quarks ();
+	TempoMap::make_property_quarks ();
 
 	/* this is a useful ready to use PropertyChange that many
 	   things need to check. This avoids having to compose
@@ -317,8 +383,7 @@ ARDOUR::init (bool use_vst, bool try_optimization)
 
 	setup_hardware_optimization (try_optimization);
 
-	SourceFactory::init ();
-	Analyser::init ();
+	SourceWorkPool::init ();
 
 	/* singleton - first object is "it" */
 	new PluginManager ();
@@ -19,6 +19,7 @@
 */
 #include <stdio.h>
 #include <cmath>
+#include <algorithm>
 
 #include "pbd/compose.h"
 #include "pbd/debug_rt_alloc.h"
@@ -30,8 +31,8 @@
 #include "ardour/route.h"
 #include "ardour/process_thread.h"
 #include "ardour/audioengine.h"
+#include "ardour/rc_configuration.h"
 
-#include <jack/thread.h>
 
 #include "i18n.h"
 
@@ -39,6 +40,11 @@ using namespace ARDOUR;
 using namespace PBD;
 using namespace std;
 
+/** number of times an idle DSP thread looks for work before going
+    to sleep, when using WorkStealingScheduling.
+*/
+static const uint32_t graph_spin_count = 2048;
+
 #ifdef DEBUG_RT_ALLOC
 static Graph* graph = 0;
 
@@ -61,13 +67,16 @@ Graph::Graph (Session & session)
 	, _cleanup_sem ("graph_cleanup", 0)
 {
         pthread_mutex_init( &_trigger_mutex, NULL);
+        pthread_key_create (&_worker_key, 0);
 
-	/* XXX: rather hacky `fix' to stop _trigger_queue.push_back() allocating
+	/* XXX: rather hacky `fix' to stop _trigger_queue.insert() allocating
 	   memory in the RT thread.
 	*/
 	_trigger_queue.reserve (8192);
 
         _execution_tokens = 0;
+        _shared_queue_size = 0;
+        _work_stealing = false;
 
         _current_chain = 0;
         _pending_chain = 0;
@@ -77,6 +86,8 @@ Graph::Graph (Session & session)
 
         reset_thread_list ();
 
+        _dsp_profiler.set_enabled (Config->get_dsp_profiling ());
+
         Config->ParameterChanged.connect_same_thread (processor_usage_connection, boost::bind (&Graph::parameter_changed, this, _1));
 
 #ifdef DEBUG_RT_ALLOC
@@ -88,8 +99,10 @@ Graph::Graph (Session & session)
 void
 Graph::parameter_changed (std::string param)
 {
-        if (param == X_("processor-usage")) {
+        if (param == X_("processor-usage") || param == X_("processor-scheduling")) {
                 reset_thread_list ();
+        } else if (param == X_("dsp-profiling")) {
+                _dsp_profiler.set_enabled (Config->get_dsp_profiling ());
         }
 }
 
@@ -97,12 +110,13 @@ void
 Graph::reset_thread_list ()
 {
         uint32_t num_threads = how_many_dsp_threads ();
+        bool work_stealing = (Config->get_processor_scheduling() == WorkStealingScheduling);
 
         /* don't bother doing anything here if we already have the right
-           number of threads.
+           number of threads, scheduled the right way.
         */
 
-        if (_thread_list.size() == num_threads) {
+        if (_thread_list.size() == num_threads && _work_stealing == work_stealing) {
                 return;
         }
 
@@ -113,6 +127,19 @@ Graph::reset_thread_list ()
                 drop_threads ();
         }
 
+        for (vector<Worker*>::iterator i = _workers.begin(); i != _workers.end(); ++i) {
+                delete *i;
+        }
+        _workers.clear ();
+
+        _work_stealing = work_stealing;
+
+        if (_work_stealing) {
+                for (uint32_t i = 0; i < num_threads; ++i) {
+                        _workers.push_back (new Worker (i));
+                }
+        }
+
 #if 0
         /* XXX this only makes sense when we can use just the AudioEngine thread
            and still keep the graph current with the route list
@@ -128,7 +155,7 @@ Graph::reset_thread_list ()
 	}
 
         for (uint32_t i = 1; i < num_threads; ++i) {
-		if (AudioEngine::instance()->create_process_thread (boost::bind (&Graph::helper_thread, this), &a_thread, 100000) == 0) {
+		if (AudioEngine::instance()->create_process_thread (boost::bind (&Graph::helper_thread, this, i), &a_thread, 100000) == 0) {
 			_thread_list.push_back (a_thread);
 		}
         }
@@ -139,6 +166,11 @@ Graph::session_going_away()
 {
         drop_threads ();
 
+        for (vector<Worker*>::iterator i = _workers.begin(); i != _workers.end(); ++i) {
+                delete *i;
+        }
+        _workers.clear ();
+
         // now drop all references on the nodes.
         _nodes_rt[0].clear();
         _nodes_rt[1].clear();
@@ -166,6 +198,11 @@ Graph::drop_threads ()
         _thread_list.clear ();
 
 	_execution_tokens = 0;
+	_shared_queue_size = 0;
+
+        for (vector<Worker*>::iterator i = _workers.begin(); i != _workers.end(); ++i) {
+                (*i)->queue.reset ();
+        }
 
         _quit_threads = false;
 }
@@ -228,11 +265,72 @@ Graph::prep()
 void
 Graph::trigger (GraphNode* n)
 {
+        if (_work_stealing) {
+                Worker* self = (Worker*) pthread_getspecific (_worker_key);
+
+                /* nodes are only ever triggered from DSP threads, so
+                   this thread owns a queue; push to the shared queue
+                   only if that queue is somehow full.
+                */
+
+                if (self && self->queue.push (n)) {
+                        if (claim_execution_token ()) {
+                                _execution_sem.signal ();
+                        }
+                        return;
+                }
+
+                pthread_mutex_lock (&_trigger_mutex);
+                queue_ready_node (n);
+                g_atomic_int_inc (&_shared_queue_size);
+                pthread_mutex_unlock (&_trigger_mutex);
+
+                if (claim_execution_token ()) {
+                        _execution_sem.signal ();
+                }
+                return;
+        }
+
         pthread_mutex_lock (&_trigger_mutex);
-        _trigger_queue.push_back (n);
+        queue_ready_node (n);
         pthread_mutex_unlock (&_trigger_mutex);
 }
 
+/** Add a node to _trigger_queue, which is kept sorted so that the
+ *  node with the longest critical path is at the back, and therefore
+ *  runs next.  Caller must hold _trigger_mutex.
+ */
+void
+Graph::queue_ready_node (GraphNode* n)
+{
+        int const chain = _current_chain;
+        cycles_t const cp = n->_critical_path[chain];
+        vector<GraphNode*>::iterator i = _trigger_queue.end();
+
+        /* ready nodes usually arrive in roughly increasing order,
+           so search from the back.
+        */
+        while (i != _trigger_queue.begin() && (*(i - 1))->_critical_path[chain] > cp) {
+                --i;
+        }
+
+        _trigger_queue.insert (i, n);
+}
+
+/** Run a node, keeping track of how long it takes so that rechain()
+ *  can find the critical path through the graph.
+ */
+void
+Graph::run_node (GraphNode* n)
+{
+        cycles_t const start = get_cycles ();
+        n->process ();
+        cycles_t const cost = get_cycles () - start;
+        n->add_cost_sample (cost);
+        _dsp_profiler.record (n, cost);
+        n->finish (_current_chain);
+}
+
 void
 Graph::dec_ref()
 {
@@ -296,6 +394,12 @@ is_feedback (boost::shared_ptr<RouteList> routelist, boost::shared_ptr<Route> fr
         return false;
 }
 
+bool
+Graph::CriticalPathSorter::operator() (node_ptr_t const & a, node_ptr_t const & b) const
+{
+        return a->critical_path (chain) < b->critical_path (chain);
+}
+
 void
 Graph::rechain (boost::shared_ptr<RouteList> routelist)
 {
@@ -357,12 +461,48 @@ Graph::rechain (boost::shared_ptr<RouteList> routelist)
                         _init_finished_refcount[chain] += 1;
         }
 
+        /* compute the critical path from each node to the end of the
+           graph. non-feedback connections always go from an earlier
+           route in the list to a later one, so walking backwards sees
+           every node after all the nodes it activates.
+
+           unmeasured nodes (new routes) cost 1 cycle, so that until
+           we have timings the ordering falls back to downstream depth.
+        */
+
+        for (node_list_t::reverse_iterator rni = _nodes_rt[chain].rbegin(); rni != _nodes_rt[chain].rend(); ++rni) {
+                cycles_t downstream = 0;
+
+                for (node_set_t::iterator ai = (*rni)->_activation_set[chain].begin(); ai != (*rni)->_activation_set[chain].end(); ++ai) {
+                        downstream = max (downstream, (*ai)->_critical_path[chain]);
+                }
+
+                (*rni)->_critical_path[chain] = max ((*rni)->cost(), (cycles_t) 1) + downstream;
+        }
+
+        /* prep() triggers these in order; with a shared queue they are
+           sorted on the way in, but a work-stealing thread runs the last
+           one it pushed first, so put the longest chain last.
+        */
+
+        _init_trigger_list[chain].sort (CriticalPathSorter (chain));
+
         _pending_chain = chain;
         dump(chain);
 }
 
 bool
 Graph::run_one()
+{
+        if (_work_stealing) {
+                return run_one_stealing ();
+        }
+
+        return run_one_shared ();
+}
+
+bool
+Graph::run_one_shared()
 {
         GraphNode* to_run;
 
@@ -403,21 +543,140 @@ Graph::run_one()
         }
         pthread_mutex_unlock (&_trigger_mutex);
 
-        to_run->process();
-        to_run->finish (_current_chain);
+        run_node (to_run);
 
         DEBUG_TRACE(DEBUG::ProcessThreads, string_compose ("%1 has finished run_one()\n", pthread_self()));
 
         return false;
 }
 
-static void get_rt()
+/** Take one of the tokens left by threads going to sleep in
+ *  run_one_stealing().  @return true if we got one, in which case
+ *  the caller must wake a thread.
+ */
+bool
+Graph::claim_execution_token ()
 {
-        if (!jack_is_realtime (AudioEngine::instance()->jack())) {
-                return;
+        gint et;
+
+        while ((et = g_atomic_int_get (&_execution_tokens)) > 0) {
+                if (g_atomic_int_compare_and_exchange (&_execution_tokens, et, et - 1)) {
+                        return true;
+                }
         }
 
-        int priority = jack_client_real_time_priority (AudioEngine::instance()->jack());
+        return false;
+}
+
+bool
+Graph::work_available () const
+{
+        if (g_atomic_int_get (&_shared_queue_size) > 0) {
+                return true;
+        }
+
+        for (vector<Worker*>::const_iterator i = _workers.begin(); i != _workers.end(); ++i) {
+                if (!(*i)->queue.empty()) {
+                        return true;
+                }
+        }
+
+        return false;
+}
+
+/** Look for a node to run: first the most recently readied node in our
+ *  own queue, then the oldest node in each of the other threads' queues,
+ *  and finally the shared overflow queue.
+ */
+GraphNode*
+Graph::find_work (Worker* self)
+{
+        GraphNode* n;
+
+        if ((n = self->queue.pop ()) != 0) {
+                return n;
+        }
+
+        uint32_t const nworkers = _workers.size ();
+
+        for (uint32_t i = 1; i < nworkers; ++i) {
+                if ((n = _workers[(self->id + i) % nworkers]->queue.steal ()) != 0) {
+                        return n;
+                }
+        }
+
+        if (g_atomic_int_get (&_shared_queue_size) > 0) {
+                pthread_mutex_lock (&_trigger_mutex);
+                if (!_trigger_queue.empty()) {
+                        n = _trigger_queue.back ();
+                        _trigger_queue.pop_back ();
+                        g_atomic_int_add (&_shared_queue_size, -1);
+                }
+                pthread_mutex_unlock (&_trigger_mutex);
+        }
+
+        return n;
+}
+
+bool
+Graph::run_one_stealing ()
+{
+        Worker* self = (Worker*) pthread_getspecific (_worker_key);
+        GraphNode* to_run;
+        uint32_t spins = 0;
+
+        assert (self);
+
+        while ((to_run = find_work (self)) == 0) {
+
+                if (_quit_threads) {
+                        return true;
+                }
+
+                /* spin for a while: at small buffer sizes the next node
+                   is usually only microseconds away, much less than the
+                   cost of a trip through the scheduler.
+                */
+
+                if (++spins < graph_spin_count) {
+                        continue;
+                }
+
+                spins = 0;
+
+                /* park. leave a token so that the next trigger() wakes us,
+                   then look again in case a node was pushed before the
+                   token became visible.
+                */
+
+                g_atomic_int_inc (&_execution_tokens);
+
+                if (work_available () && claim_execution_token ()) {
+                        continue;
+                }
+
+                /* either there is no work, or somebody already took our
+                   token and will signal (or has signalled) the semaphore.
+                */
+
+                DEBUG_TRACE (DEBUG::ProcessThreads, string_compose ("%1 goes to sleep\n", pthread_self()));
+                _execution_sem.wait ();
+
+                if (_quit_threads) {
+                        return true;
+                }
+
+                DEBUG_TRACE (DEBUG::ProcessThreads, string_compose ("%1 is awake\n", pthread_self()));
+        }
+
+        run_node (to_run);
+
+        return false;
+}
+
+static void get_rt()
+{
+        int priority = AudioEngine::instance()->client_real_time_priority ();
 
         if (priority) {
                 struct sched_param rtparam;
@@ -430,14 +689,25 @@ static void get_rt()
 }
 
 void
-Graph::helper_thread()
+Graph::start_worker (uint32_t id)
+{
+        if (_work_stealing) {
+                assert (id < _workers.size());
+                pthread_setspecific (_worker_key, _workers[id]);
+        }
+}
+
+void
+Graph::helper_thread(uint32_t id)
 {
 	suspend_rt_malloc_checks ();
 	ProcessThread* pt = new ProcessThread ();
+        _dsp_profiler.register_thread ();
 	resume_rt_malloc_checks ();
 
         pt->get_buffers();
         get_rt();
+        start_worker (id);
 
         while(1) {
                 if (run_one()) {
@@ -446,6 +716,7 @@ Graph::helper_thread()
         }
 
         pt->drop_buffers();
+        _dsp_profiler.unregister_thread ();
 }
 
 void
@@ -453,16 +724,19 @@ Graph::main_thread()
 {
 	suspend_rt_malloc_checks ();
 	ProcessThread* pt = new ProcessThread ();
+        _dsp_profiler.register_thread ();
 	resume_rt_malloc_checks ();
 
         pt->get_buffers();
         get_rt();
+        start_worker (0);
 
   again:
         _callback_start_sem.wait ();
 	DEBUG_TRACE(DEBUG::ProcessThreads, "main thread is awake\n");
 
         if (_quit_threads) {
+                _dsp_profiler.unregister_thread ();
                 return;
         }
 
@@ -482,6 +756,7 @@ Graph::main_thread()
         }
 
         pt->drop_buffers();
+        _dsp_profiler.unregister_thread ();
 }
 
 void
@@ -496,7 +771,8 @@ Graph::dump (int chain)
         DEBUG_TRACE (DEBUG::Graph, "--------------------------------------------Graph dump:\n");
         for (ni=_nodes_rt[chain].begin(); ni!=_nodes_rt[chain].end(); ni++) {
                 boost::shared_ptr<Route> rp = boost::dynamic_pointer_cast<Route>( *ni);
-                DEBUG_TRACE (DEBUG::Graph, string_compose ("GraphNode: %1  refcount: %2\n", rp->name().c_str(), (*ni)->_init_refcount[chain]));
+                DEBUG_TRACE (DEBUG::Graph, string_compose ("GraphNode: %1  refcount: %2 cost: %3 critical path: %4\n", rp->name().c_str(), (*ni)->_init_refcount[chain],
+                                                           (*ni)->cost(), (*ni)->_critical_path[chain]));
                 for (ai=(*ni)->_activation_set[chain].begin(); ai!=(*ni)->_activation_set[chain].end(); ai++) {
                         DEBUG_TRACE (DEBUG::Graph, string_compose ("  triggers: %1\n", boost::dynamic_pointer_cast<Route>(*ai)->name().c_str()));
                 }
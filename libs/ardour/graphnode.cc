@@ -26,11 +26,21 @@ using namespace ARDOUR;
 
 GraphNode::GraphNode (graph_ptr_t graph)
         : _graph(graph)
+        , _cost (0)
 {
+        _critical_path[0] = 0;
+        _critical_path[1] = 0;
 }
 
 GraphNode::~GraphNode()
 {
+        _graph->dsp_profiler().forget (this);
+}
+
+DSPProfiler&
+GraphNode::dsp_profiler () const
+{
+        return _graph->dsp_profiler ();
 }
 
 void
@@ -63,6 +73,20 @@ GraphNode::finish (int chain)
 }
 
 
+void
+GraphNode::add_cost_sample (cycles_t c)
+{
+        if (_cost == 0) {
+                _cost = c;
+        } else {
+                /* running average over roughly the last 8 cycles; big
+                   enough to ignore the odd page fault, small enough to
+                   follow plugins being added or bypassed.
+                */
+                _cost = _cost - (_cost >> 3) + (c >> 3);
+        }
+}
+
 void
 GraphNode::process()
 {
@@ -24,6 +24,8 @@
 #include <cstdio>
 #include <cstdlib>
 #include <string>
+#include <set>
+#include <list>
 #include <climits>
 #include <cerrno>
 #include <unistd.h>
@@ -36,11 +38,12 @@
 
 #include <glibmm.h>
 
+#include <boost/ptr_container/ptr_vector.hpp>
 #include <boost/scoped_array.hpp>
-#include <boost/shared_array.hpp>
 
 #include "pbd/basename.h"
 #include "pbd/convert.h"
+#include "pbd/cpus.h"
 
 #include "evoral/SMF.hpp"
 
@@ -115,8 +118,10 @@ open_importable_source (const string& path, framecnt_t samplerate, ARDOUR::SrcQu
 	}
 }
 
+/** @param taken paths which have been chosen for other new sources, but which may not exist yet */
 static std::string
-get_non_existent_filename (HeaderFormat hf, DataType type, const bool allow_replacing, const std::string& destdir, const std::string& basename, uint channel, uint channels)
+get_non_existent_filename (HeaderFormat hf, DataType type, const bool allow_replacing, const std::string& destdir, const std::string& basename, uint channel, uint channels,
+                           const set<string>& taken)
 {
 	char buf[PATH_MAX+1];
 	bool goodfile = false;
@@ -156,7 +161,7 @@ get_non_existent_filename (HeaderFormat hf, DataType type, const bool allow_repl
 
 		string tempname = destdir + "/" + buf;
 
-		if (!allow_replacing && Glib::file_test (tempname, Glib::FILE_TEST_EXISTS)) {
+		if (!allow_replacing && (taken.find (tempname) != taken.end() || Glib::file_test (tempname, Glib::FILE_TEST_EXISTS))) {
 
 			cnt++;
 
@@ -170,8 +175,12 @@ get_non_existent_filename (HeaderFormat hf, DataType type, const bool allow_repl
 	return buf;
 }
 
+/** @param taken paths chosen by earlier calls, which have been added to it, as files are not
+ *  created until they are written to.
+ */
 static vector<string>
-get_paths_for_new_sources (HeaderFormat hf, const bool allow_replacing, const string& import_file_path, const string& session_dir, uint channels)
+get_paths_for_new_sources (HeaderFormat hf, const bool allow_replacing, const string& import_file_path, const string& session_dir, uint channels,
+                           set<string>& taken)
 {
 	vector<string> new_paths;
 	const string basename = basename_nosuffix (import_file_path);
@@ -185,8 +194,10 @@ get_paths_for_new_sources (HeaderFormat hf, const bool allow_replacing, const st
 		std::string filepath = (type == DataType::MIDI)
 			? sdir.midi_path().to_string() : sdir.sound_path().to_string();
 
-		filepath = Glib::build_filename (filepath,
-		                                 get_non_existent_filename (hf, type, allow_replacing, filepath, basename, n, channels));
+		const string name = get_non_existent_filename (hf, type, allow_replacing, filepath, basename, n, channels, taken);
+		taken.insert (filepath + "/" + name);
+
+		filepath = Glib::build_filename (filepath, name);
 		new_paths.push_back (filepath);
 	}
 
@@ -269,27 +280,140 @@ compose_status_message (const string& path,
 	return string_compose (_("Copying %1"), Glib::path_get_basename (path));
 }
 
+/** Reads blocks of interleaved data from an ImportableSource in a thread of
+ *  its own, a few blocks ahead of the writer, so that decoding and resampling
+ *  overlap with writing to the new files.
+ */
+class ImportReader
+{
+  public:
+	/** @param gain gain to apply to the data */
+	ImportReader (ImportableSource* source, ImportStatus const & status, float gain)
+		: _source (source)
+		, _status (status)
+		, _gain (gain)
+		, _block_size (ResampledImportableSource::blocksize)
+		, _data (new Sample[blocks * _block_size])
+		, _read (0)
+		, _released (0)
+		, _quit (false)
+	{
+		_thread = Glib::Thread::create (sigc::mem_fun (*this, &ImportReader::run), true);
+	}
+
+	~ImportReader ()
+	{
+		{
+			Glib::Mutex::Lock lm (_lock);
+			_quit = true;
+			_cond.signal ();
+		}
+
+		_thread->join ();
+	}
+
+	/** @param nread Filled in with the number of samples in the block.
+	 *  @return The next block, which must be passed back with release(), or 0 at the end of the data.
+	 */
+	Sample* next (framecnt_t& nread)
+	{
+		Glib::Mutex::Lock lm (_lock);
+
+		while (_read == _released) {
+			_cond.wait (_lock);
+		}
+
+		nread = _length[_released % blocks];
+		return nread ? block (_released) : 0;
+	}
+
+	/** Finish with the block returned by the last call to next() */
+	void release ()
+	{
+		Glib::Mutex::Lock lm (_lock);
+		++_released;
+		_cond.signal ();
+	}
+
+  private:
+	static const uint32_t blocks = 4;
+
+	Sample* block (uint32_t n) {
+		return _data.get() + (n % blocks) * _block_size;
+	}
+
+	void run ()
+	{
+		while (true) {
+
+			{
+				Glib::Mutex::Lock lm (_lock);
+
+				while (_read - _released == blocks && !_quit) {
+					_cond.wait (_lock);
+				}
+
+				if (_quit) {
+					break;
+				}
+			}
+
+			/* only this thread changes _read, and the writer does not use the block until it does */
+
+			Sample* data = block (_read);
+			framecnt_t const nread = _status.cancel ? 0 : _source->read (data, _block_size);
+
+			if (nread && _gain != 1) {
+				/* here is the gain fix for out-of-range sample values */
+				apply_gain_to_buffer (data, nread, _gain);
+			}
+
+			Glib::Mutex::Lock lm (_lock);
+			_length[_read % blocks] = nread;
+			++_read;
+			_cond.signal ();
+
+			if (nread == 0) {
+				break;
+			}
+		}
+	}
+
+	ImportableSource*          _source;
+	ImportStatus const &       _status;
+	float                      _gain;
+	framecnt_t                 _block_size; ///< in samples
+	boost::scoped_array<Sample> _data;
+	framecnt_t                 _length[blocks]; ///< samples in each block
+	uint32_t                   _read;     ///< blocks read
+	uint32_t                   _released; ///< blocks finished with by the writer
+	bool                       _quit;
+	Glib::Mutex                _lock;
+	Glib::Cond                 _cond;
+	Glib::Thread*              _thread;
+};
+
 static void
-write_audio_data_to_new_files (ImportableSource* source, ImportStatus& status,
+write_audio_data_to_new_files (ImportableSource* source, ImportStatus& status, volatile float& progress,
                                vector<boost::shared_ptr<Source> >& newfiles)
 {
 	const framecnt_t nframes = ResampledImportableSource::blocksize;
-	boost::shared_ptr<AudioFileSource> afs;
 	uint channels = source->channels();
 
-	boost::scoped_array<float> data(new float[nframes * channels]);
-	vector<boost::shared_array<Sample> > channel_data;
+	vector<boost::shared_ptr<AudioFileSource> > afs;
 
 	for (uint n = 0; n < channels; ++n) {
-		channel_data.push_back(boost::shared_array<Sample>(new Sample[nframes]));
+		afs.push_back (boost::dynamic_pointer_cast<AudioFileSource> (newfiles[n]));
 	}
 
+	boost::scoped_array<Sample> channel_data (new Sample[nframes]);
+
 	float gain = 1;
 
 	boost::shared_ptr<AudioSource> s = boost::dynamic_pointer_cast<AudioSource> (newfiles[0]);
 	assert (s);
 
-	status.progress = 0.0f;
+	progress = 0.0f;
 	float progress_multiplier = 1;
 	float progress_base = 0;
 
@@ -300,6 +424,7 @@ write_audio_data_to_new_files (ImportableSource* source, ImportStatus& status,
 		   factor required to normalize the input sources to have a magnitude of less than 1.
 		*/
 
+		boost::scoped_array<float> data (new float[nframes]);
 		float peak = 0;
 		uint read_count = 0;
 
@@ -312,7 +437,7 @@ write_audio_data_to_new_files (ImportableSource* source, ImportStatus& status,
 			peak = compute_peak (data.get(), nread, peak);
 
 			read_count += nread;
-			status.progress = 0.5 * read_count / (source->ratio() * source->length() * channels);
+			progress = 0.5 * read_count / (source->ratio() * source->length() * channels);
 		}
 
 		if (peak >= 1) {
@@ -325,56 +450,60 @@ write_audio_data_to_new_files (ImportableSource* source, ImportStatus& status,
 		progress_base = 0.5;
 	}
 
+	ImportReader reader (source, status, gain);
 	uint read_count = 0;
 
 	while (!status.cancel) {
 
-		framecnt_t nread, nfread;
-		uint x;
-		uint chn;
+		framecnt_t nread;
+		Sample* data = reader.next (nread);
 
-		if ((nread = source->read (data.get(), nframes)) == 0) {
+		if (data == 0) {
 			break;
 		}
 
-		if (gain != 1) {
-			/* here is the gain fix for out-of-range sample values that we computed earlier */
-			apply_gain_to_buffer (data.get(), nread, gain);
-		}
+		framecnt_t const nfread = nread / channels;
 
-		nfread = nread / channels;
+		if (channels == 1) {
 
-		/* de-interleave */
+			if (afs[0]) {
+				afs[0]->write (data, nfread);
+			}
 
-		for (chn = 0; chn < channels; ++chn) {
+		} else {
 
-			framecnt_t n;
-			for (x = chn, n = 0; n < nfread; x += channels, ++n) {
-				channel_data[chn][n] = (Sample) data[x];
-			}
-		}
+			for (uint chn = 0; chn < channels; ++chn) {
 
-		/* flush to disk */
+				/* de-interleave */
 
-		for (chn = 0; chn < channels; ++chn) {
-			if ((afs = boost::dynamic_pointer_cast<AudioFileSource>(newfiles[chn])) != 0) {
-				afs->write (channel_data[chn].get(), nfread);
+				Sample const * in = data + chn;
+				for (framecnt_t n = 0; n < nfread; ++n, in += channels) {
+					channel_data[n] = *in;
+				}
+
+				/* flush to disk */
+
+				if (afs[chn]) {
+					afs[chn]->write (channel_data.get(), nfread);
+				}
 			}
 		}
 
+		reader.release ();
+
 		read_count += nread;
-		status.progress = progress_base + progress_multiplier * read_count / (source->ratio () * source->length() * channels);
+		progress = progress_base + progress_multiplier * read_count / (source->ratio () * source->length() * channels);
 	}
 }
 
 static void
-write_midi_data_to_new_files (Evoral::SMF* source, ImportStatus& status,
+write_midi_data_to_new_files (Evoral::SMF* source, ImportStatus& status, volatile float& progress,
                               vector<boost::shared_ptr<Source> >& newfiles)
 {
 	uint32_t buf_size = 4;
 	uint8_t* buf      = (uint8_t*) malloc (buf_size);
 
-	status.progress = 0.0f;
+	progress = 0.0f;
 
 	assert (newfiles.size() == source->num_tracks());
 
@@ -424,8 +553,8 @@ write_midi_data_to_new_files (Evoral::SMF* source, ImportStatus& status,
 				                                                        size,
 				                                                        buf));
 
-				if (status.progress < 0.99) {
-					status.progress += 0.01;
+				if (progress < 0.99) {
+					progress += 0.01;
 				}
 			}
 
@@ -468,6 +597,156 @@ remove_file_source (boost::shared_ptr<Source> source)
 	}
 }
 
+/** A file being imported */
+struct ImportJob
+{
+	ImportJob (string const & p) : path (p), progress (0) {}
+
+	string                              path;
+	boost::shared_ptr<ImportableSource> source;     ///< for audio files
+	std::auto_ptr<Evoral::SMF>          smf_reader; ///< for MIDI files
+	vector<boost::shared_ptr<Source> >  newfiles;
+	string                              doing_what;
+	volatile float                      progress;
+};
+
+/** Threads which import a file each.  Jobs are queued by the import thread,
+ *  which creates the new sources for them, as creating a source may emit
+ *  signals which other threads have to be able to deliver to the GUI.
+ */
+class ImportWorkers
+{
+  public:
+	ImportWorkers (ImportStatus& status, uint32_t threads)
+		: _status (status)
+		, _first (status.current)
+		, _finished (0)
+		, _quit (false)
+	{
+		for (uint32_t i = 0; i < threads; ++i) {
+			_threads.push_back (Glib::Thread::create (sigc::mem_fun (*this, &ImportWorkers::work), true));
+		}
+	}
+
+	~ImportWorkers ()
+	{
+		wait ();
+	}
+
+	/** Queue a job, then wait until there are no more queued than we have threads
+	 *  to take them, so that we don't open more files than we can keep busy.
+	 */
+	void queue (ImportJob* job)
+	{
+		Glib::Mutex::Lock lm (_lock);
+
+		_queue.push_back (job);
+		_cond.broadcast ();
+
+		while (_queue.size() > _threads.size()) {
+			wait_and_update_status ();
+		}
+	}
+
+	/** Wait for all queued jobs to finish, and stop the threads */
+	void wait ()
+	{
+		{
+			Glib::Mutex::Lock lm (_lock);
+
+			_quit = true;
+			_cond.broadcast ();
+
+			while (!_queue.empty() || !_running.empty()) {
+				wait_and_update_status ();
+			}
+		}
+
+		for (vector<Glib::Thread*>::iterator i = _threads.begin(); i != _threads.end(); ++i) {
+			(*i)->join ();
+		}
+
+		_threads.clear ();
+	}
+
+  private:
+	/** Wait for a change, or for long enough that progress should be shown;
+	 *  caller must hold _lock.
+	 */
+	void wait_and_update_status ()
+	{
+		Glib::TimeVal t;
+		t.assign_current_time ();
+		t.add_milliseconds (100);
+		_cond.timed_wait (_lock, t);
+
+		float progress = 0;
+		for (list<ImportJob*>::const_iterator i = _running.begin(); i != _running.end(); ++i) {
+			progress += (*i)->progress;
+		}
+
+		_status.current = _first + _finished;
+		_status.progress = progress;
+
+		if (!_running.empty()) {
+			_status.doing_what = _running.back()->doing_what;
+		}
+	}
+
+	void work ()
+	{
+		Glib::Mutex::Lock lm (_lock);
+
+		while (true) {
+
+			if (_queue.empty()) {
+				if (_quit) {
+					break;
+				}
+				_cond.wait (_lock);
+				continue;
+			}
+
+			ImportJob* job = _queue.front ();
+			_queue.pop_front ();
+			_running.push_back (job);
+			_cond.broadcast ();
+
+			lm.release ();
+			run (job);
+			lm.acquire ();
+
+			_running.remove (job);
+			++_finished;
+			_cond.broadcast ();
+		}
+	}
+
+	void run (ImportJob* job)
+	{
+		if (job->source) {
+			write_audio_data_to_new_files (job->source.get(), _status, job->progress, job->newfiles);
+		} else if (job->smf_reader.get()) {
+			write_midi_data_to_new_files (job->smf_reader.get(), _status, job->progress, job->newfiles);
+		}
+
+		/* close the file we imported from */
+
+		job->source.reset ();
+		job->smf_reader.reset ();
+	}
+
+	ImportStatus&          _status;
+	uint32_t               _first;    ///< value of _status.current when we started
+	uint32_t               _finished; ///< jobs finished
+	bool                   _quit;
+	list<ImportJob*>       _queue;
+	list<ImportJob*>       _running;
+	vector<Glib::Thread*>  _threads;
+	Glib::Mutex            _lock;
+	Glib::Cond             _cond;
+};
+
 // This function is still unable to cleanly update an existing source, even though
 // it is possible to set the ImportStatus flag accordingly. The functinality
 // is disabled at the GUI until the Source implementations are able to provide
@@ -476,84 +755,90 @@ void
 Session::import_audiofiles (ImportStatus& status)
 {
 	typedef vector<boost::shared_ptr<Source> > Sources;
-	Sources all_new_sources;
+	boost::ptr_vector<ImportJob> jobs;
+	set<string> new_paths_taken;
 	boost::shared_ptr<AudioFileSource> afs;
 	boost::shared_ptr<SMFSource> smfs;
 	uint channels = 0;
 
 	status.sources.clear ();
+	status.path_sources.clear ();
+
+	/* import a file per thread; the reads, resampling and writes for each
+	   file are spread over two threads as well
+	*/
+
+	ImportWorkers workers (status, max ((uint32_t) 1, min (hardware_concurrency (), (uint32_t) status.paths.size ())));
 
 	for (vector<string>::iterator p = status.paths.begin();
 	     p != status.paths.end() && !status.cancel;
 	     ++p)
 	{
-		boost::shared_ptr<ImportableSource> source;
-		std::auto_ptr<Evoral::SMF>          smf_reader;
+		ImportJob* job = new ImportJob (*p);
+		jobs.push_back (job);
+
 		const DataType type = SMFSource::safe_midi_file_extension (*p) ? DataType::MIDI : DataType::AUDIO;
 
 		if (type == DataType::AUDIO) {
 			try {
-				source = open_importable_source (*p, frame_rate(), status.quality);
-				channels = source->channels();
+				job->source = open_importable_source (*p, frame_rate(), status.quality);
+				channels = job->source->channels();
 			} catch (const failed_constructor& err) {
 				error << string_compose(_("Import: cannot open input sound file \"%1\""), (*p)) << endmsg;
-				status.done = status.cancel = true;
-				return;
+				status.cancel = true;
+				break;
 			}
 
 		} else {
 			try {
-				smf_reader = std::auto_ptr<Evoral::SMF>(new Evoral::SMF());
-				smf_reader->open(*p);
-				channels = smf_reader->num_tracks();
+				job->smf_reader = std::auto_ptr<Evoral::SMF>(new Evoral::SMF());
+				job->smf_reader->open(*p);
+				channels = job->smf_reader->num_tracks();
 			} catch (...) {
 				error << _("Import: error opening MIDI file") << endmsg;
-				status.done = status.cancel = true;
-				return;
+				status.cancel = true;
+				break;
 			}
 		}
 
 		vector<string> new_paths = get_paths_for_new_sources (config.get_native_file_header_format(),
 		                                                      status.replace_existing_source, *p,
 		                                                      get_best_session_directory_for_new_source (),
-		                                                      channels);
-		Sources newfiles;
-		framepos_t natural_position = source ? source->natural_position() : 0;
+		                                                      channels, new_paths_taken);
+		framepos_t natural_position = job->source ? job->source->natural_position() : 0;
 
+		/* any files that are created will be removed below on cancel/failure */
 
 		if (status.replace_existing_source) {
 			fatal << "THIS IS NOT IMPLEMENTED YET, IT SHOULD NEVER GET CALLED!!! DYING!" << endmsg;
-			status.cancel = !map_existing_mono_sources (new_paths, *this, frame_rate(), newfiles, this);
+			status.cancel = !map_existing_mono_sources (new_paths, *this, frame_rate(), job->newfiles, this);
 		} else {
-			status.cancel = !create_mono_sources_for_writing (*p, new_paths, *this, frame_rate(), newfiles, natural_position);
+			status.cancel = !create_mono_sources_for_writing (*p, new_paths, *this, frame_rate(), job->newfiles, natural_position);
 		}
 
-		// copy on cancel/failure so that any files that were created will be removed below
-		std::copy (newfiles.begin(), newfiles.end(), std::back_inserter(all_new_sources));
-
 		if (status.cancel) {
 			break;
 		}
 
-		for (Sources::iterator i = newfiles.begin(); i != newfiles.end(); ++i) {
+		for (Sources::iterator i = job->newfiles.begin(); i != job->newfiles.end(); ++i) {
 			if ((afs = boost::dynamic_pointer_cast<AudioFileSource>(*i)) != 0) {
 				afs->prepare_for_peakfile_writes ();
 			}
 		}
 
-		if (source) { // audio
-			status.doing_what = compose_status_message (*p, source->samplerate(),
-			                                            frame_rate(), status.current, status.total);
-			write_audio_data_to_new_files (source.get(), status, newfiles);
-		} else if (smf_reader.get()) { // midi
-			status.doing_what = string_compose(_("Loading MIDI file %1"), *p);
-			write_midi_data_to_new_files (smf_reader.get(), status, newfiles);
+		if (job->source) { // audio
+			job->doing_what = compose_status_message (*p, job->source->samplerate(),
+			                                          frame_rate(), status.current, status.total);
+		} else { // midi
+			job->doing_what = string_compose(_("Loading MIDI file %1"), *p);
 		}
 
-		++status.current;
-		status.progress = 0;
+		workers.queue (job);
 	}
 
+	workers.wait ();
+	status.progress = 0;
+
 	if (!status.cancel) {
 		struct tm* now;
 		time_t xnow;
@@ -561,37 +846,45 @@ Session::import_audiofiles (ImportStatus& status)
 		now = localtime (&xnow);
 		status.freeze = true;
 
-		/* flush the final length(s) to the header(s) */
+		for (boost::ptr_vector<ImportJob>::iterator j = jobs.begin(); j != jobs.end(); ++j) {
+
+			SourceList sources;
 
-		for (Sources::iterator x = all_new_sources.begin(); x != all_new_sources.end(); ) {
-			if ((afs = boost::dynamic_pointer_cast<AudioFileSource>(*x)) != 0) {
-				afs->update_header((*x)->natural_position(), *now, xnow);
-				afs->done_with_peakfile_writes ();
+			for (Sources::iterator x = j->newfiles.begin(); x != j->newfiles.end(); ++x) {
 
-				/* now that there is data there, requeue the file for analysis */
+				/* flush the final length(s) to the header(s) */
 
-				if (Config->get_auto_analyse_audio()) {
-					Analyser::queue_source_for_analysis (boost::static_pointer_cast<Source>(*x), false);
+				if ((afs = boost::dynamic_pointer_cast<AudioFileSource>(*x)) != 0) {
+					afs->update_header((*x)->natural_position(), *now, xnow);
+					afs->done_with_peakfile_writes ();
+
+					/* now that there is data there, requeue the file for analysis */
+
+					if (Config->get_auto_analyse_audio()) {
+						Analyser::queue_source_for_analysis (boost::static_pointer_cast<Source>(*x), false);
+					}
 				}
-			}
 
-			/* don't create tracks for empty MIDI sources (channels) */
+				/* don't create tracks for empty MIDI sources (channels) */
 
-			if ((smfs = boost::dynamic_pointer_cast<SMFSource>(*x)) != 0 && smfs->is_empty()) {
-				x = all_new_sources.erase(x);
-			} else {
-				++x;
+				if ((smfs = boost::dynamic_pointer_cast<SMFSource>(*x)) == 0 || !smfs->is_empty()) {
+					sources.push_back (*x);
+				}
 			}
+
+			std::copy (sources.begin(), sources.end(), std::back_inserter(status.sources));
+			status.path_sources.push_back (sources);
 		}
 
 		/* save state so that we don't lose these new Sources */
 
 		save_state (_name);
 
-		std::copy (all_new_sources.begin(), all_new_sources.end(), std::back_inserter(status.sources));
 	} else {
-		// this can throw...but it seems very unlikely
-		std::for_each (all_new_sources.begin(), all_new_sources.end(), remove_file_source);
+		for (boost::ptr_vector<ImportJob>::iterator j = jobs.begin(); j != jobs.end(); ++j) {
+			// this can throw...but it seems very unlikely
+			std::for_each (j->newfiles.begin(), j->newfiles.end(), remove_file_source);
+		}
 	}
 
 	status.done = true;
@@ -0,0 +1,773 @@
+/*
+    Copyright (C) 2002-2011 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <cstring>
+#include <cstdlib>
+
+#include <boost/scoped_ptr.hpp>
+
+#include <jack/weakjack.h> // so that we can test for new functions at runtime
+#include <jack/jack.h>
+#include <jack/thread.h>
+#include <jack/midiport.h>
+
+#include "pbd/epa.h"
+#include "pbd/error.h"
+
+#include "ardour/audioengine.h"
+#include "ardour/jack_audio_backend.h"
+#include "ardour/session.h"
+
+#include "i18n.h"
+
+using namespace std;
+using namespace ARDOUR;
+using namespace PBD;
+
+#define GET_PRIVATE_JACK_POINTER(j)  jack_client_t* _priv_jack = (jack_client_t*) (j); if (!_priv_jack) { return; }
+#define GET_PRIVATE_JACK_POINTER_RET(j,r) jack_client_t* _priv_jack = (jack_client_t*) (j); if (!_priv_jack) { return r; }
+
+JACKAudioBackend::JACKAudioBackend ()
+	: _jack (0)
+{
+}
+
+JACKAudioBackend::~JACKAudioBackend ()
+{
+	close ();
+}
+
+static void
+ardour_jack_error (const char* msg)
+{
+	error << "JACK: " << msg << endmsg;
+}
+
+int
+JACKAudioBackend::open (string const & client_name, string const & session_uuid)
+{
+        EnvironmentalProtectionAgency* global_epa = EnvironmentalProtectionAgency::get_global_epa ();
+        boost::scoped_ptr<EnvironmentalProtectionAgency> current_epa;
+	jack_options_t options = JackNullOption;
+	jack_status_t status;
+	const char *server_name = NULL;
+
+        /* revert all environment settings back to whatever they were when ardour started
+         */
+
+        if (global_epa) {
+                current_epa.reset (new EnvironmentalProtectionAgency(true)); /* will restore settings when we leave scope */
+                global_epa->restore ();
+        }
+
+	_client_name = client_name; /* might be reset below */
+#ifdef HAVE_JACK_SESSION
+	if (! session_uuid.empty())
+	    _jack = jack_client_open (_client_name.c_str(), JackSessionID, &status, session_uuid.c_str());
+	else
+#endif
+	    _jack = jack_client_open (_client_name.c_str(), options, &status, server_name);
+
+	if (_jack == NULL) {
+		// error message is not useful here
+		return -1;
+	}
+
+	GET_PRIVATE_JACK_POINTER_RET (_jack, -1);
+
+	if (status & JackNameNotUnique) {
+		_client_name = jack_get_client_name (_priv_jack);
+	}
+
+	return 0;
+}
+
+int
+JACKAudioBackend::close ()
+{
+	GET_PRIVATE_JACK_POINTER_RET (_jack, 0);
+
+	jack_client_close (_priv_jack);
+	_jack = 0;
+
+	return 0;
+}
+
+void
+JACKAudioBackend::set_jack_callbacks ()
+{
+	GET_PRIVATE_JACK_POINTER (_jack);
+
+        if (jack_on_info_shutdown) {
+                jack_on_info_shutdown (_priv_jack, _halted_info, this);
+        } else {
+                jack_on_shutdown (_priv_jack, _halted, this);
+        }
+
+        jack_set_thread_init_callback (_priv_jack, _thread_init_callback, this);
+        jack_set_process_thread (_priv_jack, _process_thread, this);
+        jack_set_sample_rate_callback (_priv_jack, _sample_rate_callback, this);
+        jack_set_buffer_size_callback (_priv_jack, _bufsize_callback, this);
+        jack_set_graph_order_callback (_priv_jack, _graph_order_callback, this);
+        jack_set_port_registration_callback (_priv_jack, _registration_callback, this);
+        jack_set_port_connect_callback (_priv_jack, _connect_callback, this);
+        jack_set_xrun_callback (_priv_jack, _xrun_callback, this);
+        jack_set_sync_callback (_priv_jack, _jack_sync_callback, this);
+        jack_set_freewheel_callback (_priv_jack, _freewheel_callback, this);
+
+        if (_engine->session() && _engine->session()->config.get_jack_time_master()) {
+                jack_set_timebase_callback (_priv_jack, 0, _jack_timebase_callback, this);
+        }
+
+#ifdef HAVE_JACK_SESSION
+        if( jack_set_session_callback)
+                jack_set_session_callback (_priv_jack, _session_callback, this);
+#endif
+
+        if (jack_set_latency_callback) {
+                jack_set_latency_callback (_priv_jack, _latency_callback, this);
+        }
+
+        jack_set_error_function (ardour_jack_error);
+}
+
+int
+JACKAudioBackend::start ()
+{
+	GET_PRIVATE_JACK_POINTER_RET (_jack, -1);
+
+	if (!jack_port_type_get_buffer_size) {
+		warning << _("This version of JACK is old - you should upgrade to a newer version that supports jack_port_type_get_buffer_size()") << endmsg;
+
+		/* a proxy for whether jack_activate() will definitely call the buffer size
+		 * callback. with older versions of JACK, this function symbol will be null.
+		 * this is reliable, but not clean.
+		 */
+
+		_engine->buffer_size_callback (jack_get_buffer_size (_priv_jack));
+	}
+
+	set_jack_callbacks ();
+
+	if (jack_activate (_priv_jack) != 0) {
+		// error << _("cannot activate JACK client") << endmsg;
+		return -1;
+	}
+
+	return 0;
+}
+
+int
+JACKAudioBackend::stop ()
+{
+	GET_PRIVATE_JACK_POINTER_RET (_jack, -1);
+	return jack_deactivate (_priv_jack);
+}
+
+void
+JACKAudioBackend::_thread_init_callback (void * /*arg*/)
+{
+	AudioEngine::thread_init_callback ();
+}
+
+void*
+JACKAudioBackend::_process_thread (void *arg)
+{
+	return static_cast<JACKAudioBackend *> (arg)->process_thread ();
+}
+
+void*
+JACKAudioBackend::process_thread ()
+{
+        /* JACK doesn't do this for us when we use the wait API
+         */
+
+        _engine->process_thread_init ();
+
+        while (1) {
+                GET_PRIVATE_JACK_POINTER_RET(_jack,0);
+
+                pframes_t nframes = jack_cycle_wait (_priv_jack);
+
+                if (_engine->process_callback (nframes)) {
+                        return 0;
+                }
+
+		jack_cycle_signal (_priv_jack, 0);
+        }
+
+        return 0;
+}
+
+int
+JACKAudioBackend::_xrun_callback (void *arg)
+{
+	JACKAudioBackend* jab = static_cast<JACKAudioBackend*> (arg);
+	if (jab->connected()) {
+		jab->_engine->xrun_callback ();
+	}
+	return 0;
+}
+
+#ifdef HAVE_JACK_SESSION
+void
+JACKAudioBackend::_session_callback (jack_session_event_t *event, void *arg)
+{
+	JACKAudioBackend* jab = static_cast<JACKAudioBackend*> (arg);
+	if (jab->connected()) {
+		jab->_engine->JackSessionEvent ( event ); /* EMIT SIGNAL */
+	}
+}
+#endif
+
+int
+JACKAudioBackend::_graph_order_callback (void *arg)
+{
+	JACKAudioBackend* jab = static_cast<JACKAudioBackend*> (arg);
+	if (jab->connected()) {
+		jab->_engine->graph_order_callback ();
+	}
+	return 0;
+}
+
+int
+JACKAudioBackend::_sample_rate_callback (pframes_t nframes, void *arg)
+{
+	return static_cast<JACKAudioBackend *> (arg)->_engine->sample_rate_callback (nframes);
+}
+
+int
+JACKAudioBackend::_bufsize_callback (pframes_t nframes, void *arg)
+{
+	return static_cast<JACKAudioBackend *> (arg)->_engine->buffer_size_callback (nframes);
+}
+
+void
+JACKAudioBackend::_jack_timebase_callback (jack_transport_state_t state, pframes_t nframes,
+					   jack_position_t* pos, int new_position, void *arg)
+{
+	JACKAudioBackend* jab = static_cast<JACKAudioBackend*> (arg);
+	Session* s = jab->_engine->session ();
+
+	if (jab->_jack && s && s->synced_to_jack()) {
+		s->jack_timebase_callback (state, nframes, pos, new_position);
+	}
+}
+
+int
+JACKAudioBackend::_jack_sync_callback (jack_transport_state_t state, jack_position_t* pos, void* arg)
+{
+	JACKAudioBackend* jab = static_cast<JACKAudioBackend*> (arg);
+	Session* s = jab->_engine->session ();
+
+	if (jab->_jack && s) {
+		return s->jack_sync_callback (state, pos);
+	}
+
+	return true;
+}
+
+void
+JACKAudioBackend::_freewheel_callback (int onoff, void *arg)
+{
+	static_cast<JACKAudioBackend*>(arg)->_engine->freewheel_callback (onoff);
+}
+
+void
+JACKAudioBackend::_registration_callback (jack_port_id_t /*id*/, int /*reg*/, void* arg)
+{
+	static_cast<JACKAudioBackend*> (arg)->_engine->port_registration_callback ();
+}
+
+void
+JACKAudioBackend::_connect_callback (jack_port_id_t id_a, jack_port_id_t id_b, int conn, void* arg)
+{
+	JACKAudioBackend* jab = static_cast<JACKAudioBackend*> (arg);
+
+	GET_PRIVATE_JACK_POINTER (jab->_jack);
+
+	jack_port_t* jack_port_a = jack_port_by_id (_priv_jack, id_a);
+	jack_port_t* jack_port_b = jack_port_by_id (_priv_jack, id_b);
+
+	if (!jack_port_a || !jack_port_b) {
+		return;
+	}
+
+	jab->_engine->port_connect_callback (jack_port_name (jack_port_a), jack_port_name (jack_port_b), conn != 0);
+}
+
+void
+JACKAudioBackend::_latency_callback (jack_latency_callback_mode_t mode, void* arg)
+{
+	static_cast<JACKAudioBackend *> (arg)->_engine->latency_callback (mode == JackPlaybackLatency);
+}
+
+void
+JACKAudioBackend::_halted_info (jack_status_t code, const char* reason, void *arg)
+{
+        /* called from jack shutdown handler  */
+
+	JACKAudioBackend* jab = static_cast<JACKAudioBackend*> (arg);
+
+	jab->_jack = 0;
+
+#ifdef HAVE_JACK_ON_INFO_SHUTDOWN
+	switch (code) {
+	case JackBackendError:
+		jab->_engine->halted_callback (reason);
+		break;
+	default:
+		jab->_engine->halted_callback ("");
+	}
+#else
+	jab->_engine->halted_callback ("");
+#endif
+}
+
+void
+JACKAudioBackend::_halted (void *arg)
+{
+        cerr << "HALTED by JACK\n";
+
+        /* called from jack shutdown handler  */
+
+	JACKAudioBackend* jab = static_cast<JACKAudioBackend*> (arg);
+
+	jab->_jack = 0;
+	jab->_engine->halted_callback ("");
+}
+
+bool
+JACKAudioBackend::is_realtime () const
+{
+	GET_PRIVATE_JACK_POINTER_RET (_jack,false);
+	return jack_is_realtime (_priv_jack);
+}
+
+int
+JACKAudioBackend::client_real_time_priority ()
+{
+	GET_PRIVATE_JACK_POINTER_RET (_jack, 0);
+
+	if (!jack_is_realtime (_priv_jack)) {
+		return 0;
+	}
+
+	return jack_client_real_time_priority (_priv_jack);
+}
+
+int
+JACKAudioBackend::create_process_thread (boost::function<void()> f, pthread_t* thread, size_t /*stacksize*/)
+{
+        GET_PRIVATE_JACK_POINTER_RET (_jack, 0);
+        ThreadData* td = new ThreadData (f);
+
+        if (jack_client_create_thread (_priv_jack, thread, jack_client_real_time_priority (_priv_jack),
+                                       jack_is_realtime (_priv_jack), _start_process_thread, td)) {
+                return -1;
+        }
+
+        return 0;
+}
+
+void*
+JACKAudioBackend::_start_process_thread (void* arg)
+{
+        ThreadData* td = reinterpret_cast<ThreadData*> (arg);
+        boost::function<void()> f = td->f;
+        delete td;
+
+        f ();
+
+        return 0;
+}
+
+framecnt_t
+JACKAudioBackend::sample_rate () const
+{
+	GET_PRIVATE_JACK_POINTER_RET (_jack, 0);
+	return jack_get_sample_rate (_priv_jack);
+}
+
+pframes_t
+JACKAudioBackend::buffer_size () const
+{
+	GET_PRIVATE_JACK_POINTER_RET (_jack, 0);
+	return jack_get_buffer_size (_priv_jack);
+}
+
+int
+JACKAudioBackend::set_buffer_size (pframes_t nframes)
+{
+	GET_PRIVATE_JACK_POINTER_RET (_jack, -1);
+
+	if (nframes == jack_get_buffer_size (_priv_jack)) {
+                return 0;
+	}
+
+	return jack_set_buffer_size (_priv_jack, nframes);
+}
+
+size_t
+JACKAudioBackend::raw_buffer_size (DataType t) const
+{
+	GET_PRIVATE_JACK_POINTER_RET (_jack, 0);
+
+        if (jack_port_type_get_buffer_size) {
+		return jack_port_type_get_buffer_size (_priv_jack, t.to_jack_type ());
+	}
+
+	/* Old version of JACK.
+
+	   These are crude guesses.  Note that our guess for MIDI
+	   deliberately tries to overestimate by a little; it would be
+	   nicer if we could get the actual size from a port, but we have
+	   to use this estimate in the event that there are no MIDI ports
+	   currently.
+	*/
+
+	pframes_t const nframes = jack_get_buffer_size (_priv_jack);
+
+	if (t == DataType::AUDIO) {
+		return nframes * sizeof (Sample);
+	}
+
+	return nframes * 4 - (nframes/2);
+}
+
+pframes_t
+JACKAudioBackend::frames_since_cycle_start () const
+{
+	GET_PRIVATE_JACK_POINTER_RET (_jack, 0);
+	return jack_frames_since_cycle_start (_priv_jack);
+}
+
+pframes_t
+JACKAudioBackend::frame_time () const
+{
+	GET_PRIVATE_JACK_POINTER_RET (_jack, 0);
+	return jack_frame_time (_priv_jack);
+}
+
+pframes_t
+JACKAudioBackend::frame_time_at_cycle_start () const
+{
+	GET_PRIVATE_JACK_POINTER_RET (_jack, 0);
+	return jack_last_frame_time (_priv_jack);
+}
+
+float
+JACKAudioBackend::cpu_load () const
+{
+	GET_PRIVATE_JACK_POINTER_RET (_jack, 0);
+	return jack_cpu_load (_priv_jack);
+}
+
+int
+JACKAudioBackend::freewheel (bool onoff)
+{
+	GET_PRIVATE_JACK_POINTER_RET (_jack, -1);
+	return jack_set_freewheel (_priv_jack, onoff);
+}
+
+void
+JACKAudioBackend::transport_stop ()
+{
+	GET_PRIVATE_JACK_POINTER (_jack);
+	jack_transport_stop (_priv_jack);
+}
+
+void
+JACKAudioBackend::transport_start ()
+{
+	GET_PRIVATE_JACK_POINTER (_jack);
+	jack_transport_start (_priv_jack);
+}
+
+void
+JACKAudioBackend::transport_locate (framepos_t where)
+{
+	GET_PRIVATE_JACK_POINTER (_jack);
+	jack_transport_locate (_priv_jack, where);
+}
+
+jack_transport_state_t
+JACKAudioBackend::transport_state () const
+{
+	GET_PRIVATE_JACK_POINTER_RET (_jack, JackTransportStopped);
+	jack_position_t pos;
+	return jack_transport_query (_priv_jack, &pos);
+}
+
+framepos_t
+JACKAudioBackend::transport_frame () const
+{
+	GET_PRIVATE_JACK_POINTER_RET (_jack, 0);
+	return jack_get_current_transport_frame (_priv_jack);
+}
+
+int
+JACKAudioBackend::reset_timebase ()
+{
+	GET_PRIVATE_JACK_POINTER_RET (_jack, -1);
+
+	Session* s = _engine->session ();
+
+	if (s) {
+		if (s->config.get_jack_time_master()) {
+			return jack_set_timebase_callback (_priv_jack, 0, _jack_timebase_callback, this);
+		} else {
+			return jack_release_timebase (_priv_jack);
+		}
+	}
+	return 0;
+}
+
+bool
+JACKAudioBackend::get_sync_offset (pframes_t& offset) const
+{
+
+#ifdef HAVE_JACK_VIDEO_SUPPORT
+
+	GET_PRIVATE_JACK_POINTER_RET (_jack, false);
+
+	jack_position_t pos;
+
+	if (_priv_jack) {
+		(void) jack_transport_query (_priv_jack, &pos);
+
+		if (pos.valid & JackVideoFrameOffset) {
+			offset = pos.video_offset;
+			return true;
+		}
+	}
+#else
+	/* keep gcc happy */
+	offset = 0;
+#endif
+
+	return false;
+}
+
+void
+JACKAudioBackend::update_total_latencies ()
+{
+	GET_PRIVATE_JACK_POINTER (_jack);
+	jack_recompute_total_latencies (_priv_jack);
+}
+
+AudioBackend::PortHandle
+JACKAudioBackend::register_port (string const & shortname, DataType type, uint32_t flags)
+{
+	GET_PRIVATE_JACK_POINTER_RET (_jack, 0);
+	return jack_port_register (_priv_jack, shortname.c_str (), type.to_jack_type (), flags, 0);
+}
+
+void
+JACKAudioBackend::unregister_port (PortHandle port)
+{
+	GET_PRIVATE_JACK_POINTER (_jack);
+	jack_port_unregister (_priv_jack, (jack_port_t*) port);
+}
+
+int
+JACKAudioBackend::set_port_name (PortHandle port, string const & shortname)
+{
+	return jack_port_set_name ((jack_port_t*) port, shortname.c_str ());
+}
+
+AudioBackend::PortHandle
+JACKAudioBackend::get_port_by_name (string const & name) const
+{
+	GET_PRIVATE_JACK_POINTER_RET (_jack, 0);
+	return jack_port_by_name (_priv_jack, name.c_str ());
+}
+
+uint32_t
+JACKAudioBackend::port_flags (PortHandle port) const
+{
+	return jack_port_flags ((jack_port_t*) port);
+}
+
+DataType
+JACKAudioBackend::port_data_type (PortHandle port) const
+{
+	return DataType (jack_port_type ((jack_port_t*) port));
+}
+
+const char**
+JACKAudioBackend::get_ports (string const & port_name_pattern, string const & type_name_pattern, uint32_t flags) const
+{
+	GET_PRIVATE_JACK_POINTER_RET (_jack, 0);
+	return jack_get_ports (_priv_jack, port_name_pattern.c_str(), type_name_pattern.c_str(), flags);
+}
+
+int
+JACKAudioBackend::connect (string const & src, string const & dst)
+{
+	GET_PRIVATE_JACK_POINTER_RET (_jack, -1);
+	return jack_connect (_priv_jack, src.c_str (), dst.c_str ());
+}
+
+int
+JACKAudioBackend::disconnect (string const & src, string const & dst)
+{
+	GET_PRIVATE_JACK_POINTER_RET (_jack, -1);
+	return jack_disconnect (_priv_jack, src.c_str (), dst.c_str ());
+}
+
+int
+JACKAudioBackend::disconnect_all (PortHandle port)
+{
+	GET_PRIVATE_JACK_POINTER_RET (_jack, -1);
+	return jack_port_disconnect (_priv_jack, (jack_port_t*) port);
+}
+
+bool
+JACKAudioBackend::connected (PortHandle port) const
+{
+	return jack_port_connected ((jack_port_t*) port) != 0;
+}
+
+bool
+JACKAudioBackend::connected_to (PortHandle port, string const & other) const
+{
+	return jack_port_connected_to ((jack_port_t*) port, other.c_str ());
+}
+
+int
+JACKAudioBackend::get_connections (PortHandle port, vector<string>& c) const
+{
+	int n = 0;
+
+	const char** jc = jack_port_get_connections ((jack_port_t*) port);
+
+	if (jc) {
+		for (int i = 0; jc[i]; ++i) {
+			c.push_back (jc[i]);
+			++n;
+		}
+
+		if (jack_free) {
+			jack_free (jc);
+		} else {
+			free (jc);
+		}
+	}
+
+	return n;
+}
+
+bool
+JACKAudioBackend::can_monitor_input () const
+{
+	GET_PRIVATE_JACK_POINTER_RET (_jack,false);
+	const char ** ports;
+
+	if ((ports = jack_get_ports (_priv_jack, NULL, JACK_DEFAULT_AUDIO_TYPE, JackPortCanMonitor)) == 0) {
+		return false;
+	}
+
+	free (ports);
+
+	return true;
+}
+
+int
+JACKAudioBackend::ensure_monitor_input (PortHandle port, bool yn)
+{
+	return jack_port_ensure_monitor ((jack_port_t*) port, yn);
+}
+
+int
+JACKAudioBackend::request_monitor_input (PortHandle port, bool yn)
+{
+	return jack_port_request_monitor ((jack_port_t*) port, yn);
+}
+
+bool
+JACKAudioBackend::monitoring_input (PortHandle port) const
+{
+	return jack_port_monitoring_input ((jack_port_t*) port);
+}
+
+void
+JACKAudioBackend::set_latency_range (PortHandle port, bool playback, jack_latency_range_t range)
+{
+	if (!jack_port_set_latency_range) {
+		return;
+	}
+
+	jack_port_set_latency_range ((jack_port_t*) port, (playback ? JackPlaybackLatency : JackCaptureLatency), &range);
+}
+
+jack_latency_range_t
+JACKAudioBackend::get_latency_range (PortHandle port, bool playback) const
+{
+	jack_latency_range_t r;
+
+	if (!jack_port_get_latency_range) {
+		r.min = 0;
+		r.max = 0;
+		return r;
+	}
+
+	jack_port_get_latency_range ((jack_port_t*) port, (playback ? JackPlaybackLatency : JackCaptureLatency), &r);
+	return r;
+}
+
+void*
+JACKAudioBackend::get_buffer (PortHandle port, pframes_t nframes)
+{
+	return jack_port_get_buffer ((jack_port_t*) port, nframes);
+}
+
+uint32_t
+JACKAudioBackend::midi_event_count (void* buf) const
+{
+	return jack_midi_get_event_count (buf);
+}
+
+int
+JACKAudioBackend::midi_event_get (pframes_t& timestamp, size_t& size, uint8_t const** data, void* buf, uint32_t index) const
+{
+	jack_midi_event_t ev;
+
+	int const r = jack_midi_event_get (&ev, buf, index);
+
+	if (r == 0) {
+		timestamp = ev.time;
+		size = ev.size;
+		*data = ev.buffer;
+	}
+
+	return r;
+}
+
+int
+JACKAudioBackend::midi_event_put (void* buf, pframes_t timestamp, uint8_t const* data, size_t size)
+{
+	return jack_midi_event_write (buf, timestamp, data, size);
+}
+
+void
+JACKAudioBackend::midi_clear (void* buf)
+{
+	jack_midi_clear_buffer (buf);
+}
@@ -28,7 +28,9 @@
 #include "pbd/stl_delete.h"
 #include "pbd/xml++.h"
 #include "pbd/enumwriter.h"
+#include "pbd/compose.h"
 
+#include "ardour/debug.h"
 #include "ardour/location.h"
 #include "ardour/session.h"
 #include "ardour/audiofilesource.h"
@@ -552,10 +554,25 @@ Location::unlock ()
 
 /*---------------------------------------------------------------------- */
 
+namespace ARDOUR {
+	namespace Properties {
+		PBD::PropertyDescriptor<bool> locations;
+	}
+}
+
+void
+Locations::make_property_quarks ()
+{
+	Properties::locations.property_id = g_quark_from_static_string (X_("locations"));
+	DEBUG_TRACE (DEBUG::Properties, string_compose ("quark for locations = %1\n", Properties::locations.property_id));
+}
+
 Locations::Locations (Session& s)
 	: SessionHandleRef (s)
+	, _locations_property (Properties::locations.property_id, *this)
 {
 	current_location = 0;
+	add_property (_locations_property);
 }
 
 Locations::~Locations ()
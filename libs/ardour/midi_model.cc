@@ -556,6 +556,17 @@ MidiModel::NoteDiffCommand::unmarshal_note (XMLNode *xml_note)
 		velocity = 127;
 	}
 
+	/* if the note is in the model, use that, so that undo and redo act on
+	   the note that is actually there, as they did before the history was saved
+	*/
+
+	if (id >= 0) {
+		NotePtr existing = _model->find_note (id);
+		if (existing) {
+			return existing;
+		}
+	}
+
 	NotePtr note_ptr(new Evoral::Note<TimeType>(channel, time, length, note, velocity));
 	note_ptr->set_id (id);
 
@@ -1187,7 +1198,7 @@ MidiModel::PatchChangePtr
 MidiModel::PatchChangeDiffCommand::unmarshal_patch_change (XMLNode* n)
 {
 	XMLProperty* prop;
-	Evoral::event_id_t id;
+	Evoral::event_id_t id = -1;
 	Evoral::MusicalTime time = 0;
 	uint8_t channel = 0;
 	uint8_t program = 0;
@@ -1218,6 +1229,15 @@ MidiModel::PatchChangeDiffCommand::unmarshal_patch_change (XMLNode* n)
 		s >> bank;
 	}
 
+	/* as for notes, use the patch change in the model if it is there */
+
+	if (id >= 0) {
+		PatchChangePtr existing = _model->find_patch_change (id);
+		if (existing) {
+			return existing;
+		}
+	}
+
 	PatchChangePtr p (new Evoral::PatchChange<TimeType> (time, channel, program, bank));
 	p->set_id (id);
 	return p;
@@ -1501,45 +1521,19 @@ MidiModel::find_note (NotePtr other)
 Evoral::Sequence<MidiModel::TimeType>::NotePtr
 MidiModel::find_note (gint note_id)
 {
-	/* used only for looking up notes when reloading history from disk,
-	   so we don't care about performance *too* much.
-	*/
-
-	for (Notes::iterator l = notes().begin(); l != notes().end(); ++l) {
-		if ((*l)->id() == note_id) {
-			return *l;
-		}
-	}
-
-	return NotePtr();
+	return note_by_id (note_id);
 }
 
 MidiModel::PatchChangePtr
 MidiModel::find_patch_change (Evoral::event_id_t id)
 {
-	for (PatchChanges::iterator i = patch_changes().begin(); i != patch_changes().end(); ++i) {
-		if ((*i)->id() == id) {
-			return *i;
-		}
-	}
-
-	return PatchChangePtr ();
+	return patch_change_by_id (id);
 }
 
 boost::shared_ptr<Evoral::Event<MidiModel::TimeType> >
 MidiModel::find_sysex (gint sysex_id)
 {
-	/* used only for looking up notes when reloading history from disk,
-	   so we don't care about performance *too* much.
-	*/
-
-	for (SysExes::iterator l = sysexes().begin(); l != sysexes().end(); ++l) {
-		if ((*l)->id() == sysex_id) {
-			return *l;
-		}
-	}
-
-	return boost::shared_ptr<Evoral::Event<TimeType> > ();
+	return sysex_by_id (sysex_id);
 }
 
 /** Lock and invalidate the source.
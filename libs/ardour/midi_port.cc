@@ -50,7 +50,8 @@ MidiPort::cycle_start (pframes_t nframes)
 	assert (_buffer->size () == 0);
 
 	if (sends_output ()) {
-		jack_midi_clear_buffer (jack_port_get_buffer (_jack_port, nframes));
+		AudioBackend* backend = _engine->backend ();
+		backend->midi_clear (backend->get_buffer (_port_handle, nframes));
 	}
 }
 
@@ -65,33 +66,38 @@ MidiPort::get_midi_buffer (pframes_t nframes)
 
 		if (_input_active) {
 
-			void* jack_buffer = jack_port_get_buffer (_jack_port, nframes);
-			const pframes_t event_count = jack_midi_get_event_count (jack_buffer);
+			AudioBackend* backend = _engine->backend ();
+			void* port_buffer = backend->get_buffer (_port_handle, nframes);
+			const pframes_t event_count = backend->midi_event_count (port_buffer);
 			
 			assert (event_count < _buffer->capacity());
 			
-			/* suck all relevant MIDI events from the JACK MIDI port buffer
+			/* suck all relevant MIDI events from the backend's MIDI port buffer
 			   into our MidiBuffer
 			*/
 			
 			for (pframes_t i = 0; i < event_count; ++i) {
 				
-				jack_midi_event_t ev;
+				pframes_t timestamp;
+				size_t size;
+				uint8_t const * data;
 				
-				jack_midi_event_get (&ev, jack_buffer, i);
+				if (backend->midi_event_get (timestamp, size, &data, port_buffer, i)) {
+					continue;
+				}
 				
-				if (ev.buffer[0] == 0xfe) {
+				if (data[0] == 0xfe) {
 					/* throw away active sensing */
 					continue;
 				}
 				
 				/* check that the event is in the acceptable time range */
 				
-				if ((ev.time >= (_global_port_buffer_offset + _port_buffer_offset)) &&
-				    (ev.time < (_global_port_buffer_offset + _port_buffer_offset + nframes))) {
-					_buffer->push_back (ev);
+				if ((timestamp >= (_global_port_buffer_offset + _port_buffer_offset)) &&
+				    (timestamp < (_global_port_buffer_offset + _port_buffer_offset + nframes))) {
+					_buffer->push_back (timestamp, size, data);
 				} else {
-					cerr << "Dropping incoming MIDI at time " << ev.time << "; offset="
+					cerr << "Dropping incoming MIDI at time " << timestamp << "; offset="
 					     << _global_port_buffer_offset << " limit="
 					     << (_global_port_buffer_offset + _port_buffer_offset + nframes) << "\n";
 				}
@@ -126,7 +132,7 @@ MidiPort::cycle_split ()
 }
 
 void
-MidiPort::resolve_notes (void* jack_buffer, MidiBuffer::TimeType when)
+MidiPort::resolve_notes (void* port_buffer, MidiBuffer::TimeType when)
 {
 	uint8_t ev[3];
 
@@ -142,13 +148,13 @@ MidiPort::resolve_notes (void* jack_buffer, MidiBuffer::TimeType when)
 
 		ev[1] = MIDI_CTL_SUSTAIN;
 
-		if (jack_midi_event_write (jack_buffer, when, ev, 3) != 0) {
+		if (_engine->backend()->midi_event_put (port_buffer, when, ev, 3) != 0) {
 			cerr << "failed to deliver sustain-zero on channel " << channel << " on port " << name() << endl;
 		}
 
 		ev[1] = MIDI_CTL_ALL_NOTES_OFF;
 
-		if (jack_midi_event_write (jack_buffer, 0, ev, 3) != 0) {
+		if (_engine->backend()->midi_event_put (port_buffer, 0, ev, 3) != 0) {
 			cerr << "failed to deliver ALL NOTES OFF on channel " << channel << " on port " << name() << endl;
 		}
 	}
@@ -159,11 +165,12 @@ MidiPort::flush_buffers (pframes_t nframes, framepos_t time)
 {
 	if (sends_output ()) {
 
-		void* jack_buffer = jack_port_get_buffer (_jack_port, nframes);
+		AudioBackend* backend = _engine->backend ();
+		void* port_buffer = backend->get_buffer (_port_handle, nframes);
 
 		if (_resolve_required) {
 			/* resolve all notes at the start of the buffer */
-			resolve_notes (jack_buffer, 0);
+			resolve_notes (port_buffer, 0);
 			_resolve_required= false;
 		}
 
@@ -176,12 +183,12 @@ MidiPort::flush_buffers (pframes_t nframes, framepos_t time)
 			assert (ev.time() < (nframes + _global_port_buffer_offset + _port_buffer_offset));
 
 			if (ev.event_type() == LoopEventType) {
-				resolve_notes (jack_buffer, ev.time());
+				resolve_notes (port_buffer, ev.time());
 				continue;
 			}
 
 			if (ev.time() >= _global_port_buffer_offset + _port_buffer_offset) {
-				if (jack_midi_event_write (jack_buffer, (jack_nframes_t) ev.time(), ev.buffer(), ev.size()) != 0) {
+				if (backend->midi_event_put (port_buffer, (pframes_t) ev.time(), ev.buffer(), ev.size()) != 0) {
 					cerr << "write failed, drop flushed note off on the floor, time "
 					     << ev.time() << " > " << _global_port_buffer_offset + _port_buffer_offset << endl;
 				}
@@ -517,6 +517,7 @@ void
 MidiSource::copy_interpolation_from (MidiSource* s)
 {
 	_interpolation_style = s->_interpolation_style;
+	StateChanged (); /* EMIT SIGNAL */
 
 	/* XXX: should probably emit signals here */
 }
@@ -525,6 +526,7 @@ void
 MidiSource::copy_automation_state_from (MidiSource* s)
 {
 	_automation_state = s->_automation_state;
+	StateChanged (); /* EMIT SIGNAL */
 
 	/* XXX: should probably emit signals here */
 }
@@ -134,6 +134,22 @@ default_mix_buffers_no_gain (ARDOUR::Sample * dst, const ARDOUR::Sample * src, p
 	}
 }
 
+void
+default_apply_gain_vector_to_buffer (ARDOUR::Sample * buf, const ARDOUR::gain_t * gain, pframes_t nframes, float scale)
+{
+	for (pframes_t i = 0; i < nframes; i++) {
+		buf[i] *= gain[i] * scale;
+	}
+}
+
+void
+default_mix_buffers_with_gain_vector (ARDOUR::Sample * dst, const ARDOUR::Sample * src, const ARDOUR::gain_t * gain, pframes_t nframes, float scale)
+{
+	for (pframes_t i = 0; i < nframes; i++) {
+		dst[i] += src[i] * (gain[i] * scale);
+	}
+}
+
 #if defined (__APPLE__) && defined (BUILD_VECLIB_OPTIMIZATIONS)
 #include <Accelerate/Accelerate.h>
 
@@ -793,6 +793,7 @@ Playlist::flush_notifications (bool from_undo)
 
 	 regions.insert (upper_bound (regions.begin(), regions.end(), region, cmp), region);
 	 all_regions.insert (region);
+	 index_region (region);
 
 	 possibly_splice_unlocked (position, region->length(), region);
 
@@ -867,6 +868,7 @@ Playlist::flush_notifications (bool from_undo)
 			 framecnt_t distance = (*i)->length();
 
 			 regions.erase (i);
+			 unindex_region (region);
 
 			 possibly_splice_unlocked (pos, -distance);
 
@@ -1600,6 +1602,19 @@ Playlist::flush_notifications (bool from_undo)
 		 return;
 	 }
 
+	 if (what_changed.contains (Properties::position) ||
+	     what_changed.contains (Properties::length) ||
+	     what_changed.contains (Properties::start) ||
+	     what_changed.contains (Properties::sync_position)) {
+		 /* this happens even while splicing, nudging etc., when
+		    region_bounds_changed() ignores the change.
+		 */
+		 RegionLock rlock (this, false);
+		 if (unindex_region (region)) {
+			 index_region (region);
+		 }
+	 }
+
 	 /* this makes a virtual call to the right kind of playlist ... */
 
 	 region_changed (what_changed, region);
@@ -1662,6 +1677,7 @@ Playlist::flush_notifications (bool from_undo)
 	 RegionLock rl (this);
 	 regions.clear ();
 	 all_regions.clear ();
+	 clear_region_index ();
  }
 
  void
@@ -1689,6 +1705,7 @@ Playlist::flush_notifications (bool from_undo)
 		 }
 
 		 regions.clear ();
+		 clear_region_index ();
 
 		 for (set<boost::shared_ptr<Region> >::iterator s = pending_removes.begin(); s != pending_removes.end(); ++s) {
 			 remove_dependents (*s);
@@ -1727,8 +1744,11 @@ Playlist::flush_notifications (bool from_undo)
  {
 	 RegionLock rlock (const_cast<Playlist*>(this));
 	 uint32_t cnt = 0;
+	 vector<boost::shared_ptr<Region> > candidates;
+
+	 _region_extents.overlapping (frame, frame, candidates);
 
-	 for (RegionList::const_iterator i = regions.begin(); i != regions.end(); ++i) {
+	 for (vector<boost::shared_ptr<Region> >::const_iterator i = candidates.begin(); i != candidates.end(); ++i) {
 		 if ((*i)->covers (frame)) {
 			 cnt++;
 		 }
@@ -1794,13 +1814,16 @@ Playlist::flush_notifications (bool from_undo)
 	 RegionList covering;
 	 set<framepos_t> to_check;
 	 set<boost::shared_ptr<Region> > unique;
+	 vector<boost::shared_ptr<Region> > candidates;
 
 	 to_check.insert (start);
 	 to_check.insert (end);
 
 	 DEBUG_TRACE (DEBUG::AudioPlayback, ">>>>> REGIONS TO READ\n");
 
-	 for (RegionList::iterator i = regions.begin(); i != regions.end(); ++i) {
+	 _region_extents.overlapping (start, end, candidates);
+
+	 for (vector<boost::shared_ptr<Region> >::iterator i = candidates.begin(); i != candidates.end(); ++i) {
 
 		 /* find all/any regions that span start+end */
 
@@ -1927,8 +1950,11 @@ Playlist::flush_notifications (bool from_undo)
 	 /* Caller must hold lock */
 
 	 RegionList *rlist = new RegionList;
+	 vector<boost::shared_ptr<Region> > candidates;
 
-	 for (RegionList::iterator i = regions.begin(); i != regions.end(); ++i) {
+	 _region_extents.overlapping (frame, frame, candidates);
+
+	 for (vector<boost::shared_ptr<Region> >::iterator i = candidates.begin(); i != candidates.end(); ++i) {
 		 if ((*i)->covers (frame)) {
 			 rlist->push_back (*i);
 		 }
@@ -1942,8 +1968,11 @@ Playlist::flush_notifications (bool from_undo)
  {
 	 RegionLock rlock (this);
 	 RegionList *rlist = new RegionList;
+	 vector<boost::shared_ptr<Region> > candidates;
 
-	 for (RegionList::iterator i = regions.begin(); i != regions.end(); ++i) {
+	 _region_extents.overlapping (start, end, candidates);
+
+	 for (vector<boost::shared_ptr<Region> >::iterator i = candidates.begin(); i != candidates.end(); ++i) {
 		 if ((*i)->coverage (start, end) != OverlapNone) {
 			 rlist->push_back (*i);
 		 }
@@ -2016,58 +2045,26 @@ Playlist::flush_notifications (bool from_undo)
  Playlist::find_next_region (framepos_t frame, RegionPoint point, int dir)
  {
 	 RegionLock rlock (this);
+	 PositionIndex<boost::shared_ptr<Region> > const * points = 0;
 	 boost::shared_ptr<Region> ret;
-	 framepos_t closest = max_framepos;
-
-	 bool end_iter = false;
-
-	 for (RegionList::iterator i = regions.begin(); i != regions.end(); ++i) {
-
-		 if(end_iter) break;
-
-		 frameoffset_t distance;
-		 boost::shared_ptr<Region> r = (*i);
-		 framepos_t pos = 0;
-
-		 switch (point) {
-		 case Start:
-			 pos = r->first_frame ();
-			 break;
-		 case End:
-			 pos = r->last_frame ();
-			 break;
-		 case SyncPoint:
-			 pos = r->sync_position ();
-			 break;
-		 }
-
-		 switch (dir) {
-		 case 1: /* forwards */
-
-			 if (pos > frame) {
-				 if ((distance = pos - frame) < closest) {
-					 closest = distance;
-					 ret = r;
-					 end_iter = true;
-				 }
-			 }
-
-			 break;
-
-		 default: /* backwards */
-
-			 if (pos < frame) {
-				 if ((distance = frame - pos) < closest) {
-					 closest = distance;
-					 ret = r;
-				 }
-			 }
-			 else {
-				 end_iter = true;
-			 }
-
-			 break;
-		 }
+	 framepos_t pos;
+
+	 switch (point) {
+	 case Start:
+		 points = &_region_starts;
+		 break;
+	 case End:
+		 points = &_region_ends;
+		 break;
+	 case SyncPoint:
+		 points = &_region_sync_points;
+		 break;
+	 }
+
+	 if (dir == 1) {
+		 points->next_after (frame, pos, ret);
+	 } else {
+		 points->previous_before (frame, pos, ret);
 	 }
 
 	 return ret;
@@ -2077,70 +2074,66 @@ Playlist::flush_notifications (bool from_undo)
  Playlist::find_next_region_boundary (framepos_t frame, int dir)
  {
 	 RegionLock rlock (this);
-
-	 framepos_t closest = max_framepos;
-	 framepos_t ret = -1;
+	 boost::shared_ptr<Region> r;
+	 framepos_t start;
+	 framepos_t end;
+	 bool have_start;
+	 bool have_end;
 
 	 if (dir > 0) {
-
-		 for (RegionList::iterator i = regions.begin(); i != regions.end(); ++i) {
-
-			 boost::shared_ptr<Region> r = (*i);
-			 frameoffset_t distance;
-
-			 if (r->first_frame() > frame) {
-
-				 distance = r->first_frame() - frame;
-
-				 if (distance < closest) {
-					 ret = r->first_frame();
-					 closest = distance;
-				 }
-			 }
-
-			 if (r->last_frame () > frame) {
-
-				 distance = r->last_frame () - frame;
-
-				 if (distance < closest) {
-					 ret = r->last_frame ();
-					 closest = distance;
-				 }
-			 }
-		 }
-
+		 have_start = _region_starts.next_after (frame, start, r);
+		 have_end = _region_ends.next_after (frame, end, r);
 	 } else {
+		 have_start = _region_starts.previous_before (frame, start, r);
+		 have_end = _region_ends.previous_before (frame, end, r);
+	 }
 
-		 for (RegionList::reverse_iterator i = regions.rbegin(); i != regions.rend(); ++i) {
-
-			 boost::shared_ptr<Region> r = (*i);
-			 frameoffset_t distance;
-
-			 if (r->last_frame() < frame) {
-
-				 distance = frame - r->last_frame();
-
-				 if (distance < closest) {
-					 ret = r->last_frame();
-					 closest = distance;
-				 }
-			 }
+	 if (have_start && have_end) {
+		 return (dir > 0) ? min (start, end) : max (start, end);
+	 } else if (have_start) {
+		 return start;
+	 } else if (have_end) {
+		 return end;
+	 }
 
-			 if (r->first_frame() < frame) {
+	 return -1;
+ }
 
-				 distance = frame - r->first_frame();
+ /** Add a region to the indices; caller must hold lock */
+ void
+ Playlist::index_region (boost::shared_ptr<Region> region)
+ {
+	 _region_extents.add (region->first_frame(), region->last_frame(), region);
+	 _region_starts.add (region->first_frame(), region);
+	 _region_ends.add (region->last_frame(), region);
+	 _region_sync_points.add (region->sync_position(), region);
+ }
 
-				 if (distance < closest) {
-					 ret = r->first_frame();
-					 closest = distance;
-				 }
-			 }
-		 }
+ /** Remove a region from the indices; caller must hold lock.
+  *  @return true if it was there.
+  */
+ bool
+ Playlist::unindex_region (boost::shared_ptr<Region> region)
+ {
+	 if (!_region_extents.remove (region)) {
+		 return false;
 	 }
 
-	 return ret;
+	 _region_starts.remove (region);
+	 _region_ends.remove (region);
+	 _region_sync_points.remove (region);
+	 return true;
  }
 
+ /** Caller must hold lock */
+ void
+ Playlist::clear_region_index ()
+ {
+	 _region_extents.clear ();
+	 _region_starts.clear ();
+	 _region_ends.clear ();
+	 _region_sync_points.clear ();
+ }
 
  /***********************************************************************/
 
@@ -2832,6 +2825,7 @@ void
 Playlist::set_frozen (bool yn)
 {
 	_frozen = yn;
+	StateChanged (); /* EMIT SIGNAL */
 }
 
 void
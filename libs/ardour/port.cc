@@ -23,8 +23,6 @@
 
 #include <stdexcept>
 
-#include <jack/weakjack.h> // so that we can test for new functions at runtime
-
 #include "pbd/error.h"
 #include "pbd/compose.h"
 
@@ -57,7 +55,7 @@ Port::Port (std::string const & n, DataType t, Flags f)
 	_private_capture_latency.max = 0;
 
 	/* Unfortunately we have to pass the DataType into this constructor so that
-	   we can create the right kind of JACK port; aside from this we'll use the
+	   we can create the right kind of backend port; aside from this we'll use the
 	   virtual function type () to establish type.
 	*/
 
@@ -67,8 +65,8 @@ Port::Port (std::string const & n, DataType t, Flags f)
 		throw failed_constructor ();
 	}
 
-	if ((_jack_port = jack_port_register (_engine->jack (), _name.c_str (), t.to_jack_type (), _flags, 0)) == 0) {
-		cerr << "Failed to register JACK port, reason is unknown from here\n";
+	if ((_port_handle = _engine->backend()->register_port (_name, t, _flags)) == 0) {
+		cerr << "Failed to register port with " << _engine->backend()->name() << ", reason is unknown from here\n";
 		throw failed_constructor ();
 	}
 }
@@ -76,8 +74,8 @@ Port::Port (std::string const & n, DataType t, Flags f)
 /** Port destructor */
 Port::~Port ()
 {
-	if (_engine->jack ()) {
-		jack_port_unregister (_engine->jack (), _jack_port);
+	if (_engine->connected ()) {
+		_engine->backend()->unregister_port (_port_handle);
 	}
 }
 
@@ -85,13 +83,13 @@ Port::~Port ()
 bool
 Port::connected () const
 {
-	return (jack_port_connected (_jack_port) != 0);
+	return _engine->backend()->connected (_port_handle);
 }
 
 int
 Port::disconnect_all ()
 {
-	jack_port_disconnect (_engine->jack(), _jack_port);
+	_engine->backend()->disconnect_all (_port_handle);
 	_connections.clear ();
 
 	return 0;
@@ -106,38 +104,23 @@ Port::connected_to (std::string const & o) const
 	if (!_engine->connected()) {
 		/* in some senses, this answer isn't the right one all the time,
 		   because we know about our connections and will re-establish
-		   them when we reconnect to JACK.
+		   them when we reconnect to the backend.
 		*/
 		return false;
 	}
 
-	return jack_port_connected_to (_jack_port,
-	                               _engine->make_port_name_non_relative(o).c_str ());
+	return _engine->backend()->connected_to (_port_handle, _engine->make_port_name_non_relative (o));
 }
 
 /** @param o Filled in with port full names of ports that we are connected to */
 int
 Port::get_connections (std::vector<std::string> & c) const
 {
-	int n = 0;
-
-	if (_engine->connected()) {
-		const char** jc = jack_port_get_connections (_jack_port);
-		if (jc) {
-			for (int i = 0; jc[i]; ++i) {
-				c.push_back (jc[i]);
-				++n;
-			}
-
-                        if (jack_free) {
-                                jack_free (jc);
-                        } else {
-                                free (jc);
-                        }
-		}
+	if (!_engine->connected()) {
+		return 0;
 	}
 
-	return n;
+	return _engine->backend()->get_connections (_port_handle, c);
 }
 
 int
@@ -153,9 +136,9 @@ Port::connect (std::string const & other)
 	}
 
 	if (sends_output ()) {
-		r = jack_connect (_engine->jack (), this_shrt.c_str (), other_shrt.c_str ());
+		r = _engine->backend()->connect (this_shrt, other_shrt);
 	} else {
-		r = jack_connect (_engine->jack (), other_shrt.c_str (), this_shrt.c_str());
+		r = _engine->backend()->connect (other_shrt, this_shrt);
 	}
 
 	if (r == 0) {
@@ -174,9 +157,9 @@ Port::disconnect (std::string const & other)
 	int r = 0;
 
 	if (sends_output ()) {
-		r = jack_disconnect (_engine->jack (), this_shrt.c_str (), other_shrt.c_str ());
+		r = _engine->backend()->disconnect (this_shrt, other_shrt);
 	} else {
-		r = jack_disconnect (_engine->jack (), other_shrt.c_str (), this_shrt.c_str ());
+		r = _engine->backend()->disconnect (other_shrt, this_shrt);
 	}
 
 	if (r == 0) {
@@ -214,13 +197,13 @@ Port::set_engine (AudioEngine* e)
 void
 Port::ensure_monitor_input (bool yn)
 {
-	jack_port_ensure_monitor (_jack_port, yn);
+	_engine->backend()->ensure_monitor_input (_port_handle, yn);
 }
 
 bool
 Port::monitoring_input () const
 {
-	return jack_port_monitoring_input (_jack_port);
+	return _engine->backend()->monitoring_input (_port_handle);
 }
 
 void
@@ -244,22 +227,16 @@ Port::increment_port_buffer_offset (pframes_t nframes)
 void
 Port::set_public_latency_range (jack_latency_range_t& range, bool playback) const
 {
-	/* this sets the visible latency that the rest of JACK sees. because we do latency
+	/* this sets the visible latency that the rest of the backend sees. because we do latency
 	   compensation, all (most) of our visible port latency values are identical.
 	*/
 
-	if (!jack_port_set_latency_range) {
-		return;
-	}
-
 	DEBUG_TRACE (DEBUG::Latency,
 	             string_compose ("SET PORT %1 %4 PUBLIC latency now [%2 - %3]\n",
 	                             name(), range.min, range.max,
 	                             (playback ? "PLAYBACK" : "CAPTURE")));;
 
-	jack_port_set_latency_range (_jack_port,
-	                             (playback ? JackPlaybackLatency : JackCaptureLatency),
-	                             &range);
+	_engine->backend()->set_latency_range (_port_handle, playback, range);
 }
 
 void
@@ -281,7 +258,7 @@ Port::set_private_latency_range (jack_latency_range_t& range, bool playback)
 			             _private_capture_latency.max));
 	}
 
-	/* push to public (JACK) location so that everyone else can see it */
+	/* push to public (backend) location so that everyone else can see it */
 
 	set_public_latency_range (range, playback);
 }
@@ -309,11 +286,8 @@ Port::private_latency_range (bool playback) const
 jack_latency_range_t
 Port::public_latency_range (bool playback) const
 {
-	jack_latency_range_t r;
+	jack_latency_range_t r = _engine->backend()->get_latency_range (_port_handle, sends_output());
 
-	jack_port_get_latency_range (_jack_port,
-	                             sends_output() ? JackPlaybackLatency : JackCaptureLatency,
-	                             &r);
 	DEBUG_TRACE (DEBUG::Latency, string_compose (
 		             "GET PORT %1: %4 PUBLIC latency range %2 .. %3\n",
 		             name(), r.min, r.max,
@@ -324,17 +298,13 @@ Port::public_latency_range (bool playback) const
 void
 Port::get_connected_latency_range (jack_latency_range_t& range, bool playback) const
 {
-	if (!jack_port_get_latency_range) {
-		return;
-	}
-
 	vector<string> connections;
-	jack_client_t* jack = _engine->jack();
+	AudioBackend* backend = _engine->backend ();
 
-	if (!jack) {
+	if (!backend->connected ()) {
 		range.min = 0;
 		range.max = 0;
-		PBD::warning << _("get_connected_latency_range() called while disconnected from JACK") << endmsg;
+		PBD::warning << string_compose (_("get_connected_latency_range() called while disconnected from %1"), backend->name ()) << endmsg;
 		return;
 	}
 
@@ -354,17 +324,14 @@ Port::get_connected_latency_range (jack_latency_range_t& range, bool playback) c
 
                         if (!AudioEngine::instance()->port_is_mine (*c)) {
 
-                                /* port belongs to some other JACK client, use
-                                 * JACK to lookup its latency information.
+                                /* port belongs to some other client, use
+                                 * the backend to lookup its latency information.
                                  */
 
-                                jack_port_t* remote_port = jack_port_by_name (_engine->jack(), (*c).c_str());
+                                AudioBackend::PortHandle remote_port = backend->get_port_by_name (*c);
 
                                 if (remote_port) {
-                                        jack_port_get_latency_range (
-                                                remote_port,
-                                                (playback ? JackPlaybackLatency : JackCaptureLatency),
-                                                &lr);
+                                        lr = backend->get_latency_range (remote_port, playback);
 
                                         DEBUG_TRACE (DEBUG::Latency, string_compose (
                                                              "\t%1 <-> %2 : latter has latency range %3 .. %4\n",
@@ -408,15 +375,13 @@ Port::get_connected_latency_range (jack_latency_range_t& range, bool playback) c
 int
 Port::reestablish ()
 {
-	jack_client_t* jack = _engine->jack();
-
-	if (!jack) {
+	if (!_engine->connected ()) {
 		return -1;
 	}
 
-	_jack_port = jack_port_register (jack, _name.c_str(), type().to_jack_type(), _flags, 0);
+	_port_handle = _engine->backend()->register_port (_name, type(), _flags);
 
-	if (_jack_port == 0) {
+	if (_port_handle == 0) {
 		PBD::error << string_compose (_("could not reregister %1"), _name) << endmsg;
 		return -1;
 	}
@@ -449,9 +414,10 @@ Port::set_name (std::string const & n)
 		return 0;
 	}
 
-	int const r = jack_port_set_name (_jack_port, n.c_str());
+	int const r = _engine->backend()->set_port_name (_port_handle, n);
 
 	if (r == 0) {
+		_engine->port_renamed (_name, n);
 		_name = n;
 	}
 
@@ -461,35 +427,25 @@ Port::set_name (std::string const & n)
 void
 Port::request_monitor_input (bool yn)
 {
-	jack_port_request_monitor (_jack_port, yn);
+	_engine->backend()->request_monitor_input (_port_handle, yn);
 }
 
 bool
 Port::physically_connected () const
 {
-	const char** jc = jack_port_get_connections (_jack_port);
+	AudioBackend* backend = _engine->backend ();
+	vector<string> c;
 
-	if (jc) {
-		for (int i = 0; jc[i]; ++i) {
+	backend->get_connections (_port_handle, c);
 
-			jack_port_t* port = jack_port_by_name (_engine->jack(), jc[i]);
+	for (vector<string>::const_iterator i = c.begin(); i != c.end(); ++i) {
 
-			if (port && (jack_port_flags (port) & JackPortIsPhysical)) {
-                                if (jack_free) {
-                                        jack_free (jc);
-                                } else {
-                                        free (jc);
-                                }
-				return true;
-			}
+		AudioBackend::PortHandle port = backend->get_port_by_name (*i);
+
+		if (port && (backend->port_flags (port) & JackPortIsPhysical)) {
+			return true;
 		}
-                if (jack_free) {
-                        jack_free (jc);
-                } else {
-                        free (jc);
-                }
 	}
 
 	return false;
 }
-
@@ -201,6 +201,7 @@ Route::~Route ()
 
 	Glib::RWLock::WriterLock lm (_processor_lock);
 	for (ProcessorList::iterator i = _processors.begin(); i != _processors.end(); ++i) {
+		dsp_profiler().forget (i->get());
 		(*i)->drop_references ();
 	}
 
@@ -482,6 +483,9 @@ Route::process_output_buffers (BufferSet& bufs,
 	   and go ....
 	   ----------------------------------------------------------------------------------------- */
 
+	DSPProfiler& profiler (dsp_profiler ());
+	bool const profile = profiler.enabled ();
+
 	for (ProcessorList::iterator i = _processors.begin(); i != _processors.end(); ++i) {
 
 		if (boost::dynamic_pointer_cast<UnknownProcessor> (*i)) {
@@ -503,8 +507,14 @@ Route::process_output_buffers (BufferSet& bufs,
 		   do we catch route != active somewhere higher?
 		*/
 
+		cycles_t const start = profile ? get_cycles () : 0;
+
 		(*i)->run (bufs, start_frame, end_frame, nframes, *i != _processors.back());
 		bufs.set_count ((*i)->output_streams());
+
+		if (profile) {
+			profiler.record (i->get(), get_cycles () - start);
+		}
 	}
 }
 
@@ -1374,6 +1384,7 @@ Route::remove_processor (boost::shared_ptr<Processor> processor, ProcessorStream
 		}
 	}
 
+	dsp_profiler().forget (processor.get());
 	processor->drop_references ();
 	processors_changed (RouteProcessorChange ()); /* EMIT SIGNAL */
 	set_processor_positions ();
@@ -1467,6 +1478,7 @@ Route::remove_processors (const ProcessorList& to_be_deleted, ProcessorStreams*
 	/* now try to do what we need to so that those that were removed will be deleted */
 
 	for (ProcessorList::iterator i = deleted.begin(); i != deleted.end(); ++i) {
+		dsp_profiler().forget (i->get());
 		(*i)->drop_references ();
 	}
 
@@ -96,6 +96,8 @@
 #include "ardour/slave.h"
 #include "ardour/smf_source.h"
 #include "ardour/source_factory.h"
+#include "ardour/state_cache.h"
+#include "ardour/state_writer.h"
 #include "ardour/tape_file_matcher.h"
 #include "ardour/tempo.h"
 #include "ardour/utils.h"
@@ -142,6 +144,8 @@ Session::Session (AudioEngine &eng,
 	, _requested_return_frame (-1)
 	, _session_dir (new SessionDirectory(fullpath))
 	, state_tree (0)
+	, _state_writer (new StateWriter)
+	, _state_cache (new StateCache)
 	, _state_of_the_state (Clean)
 	, _butler (new Butler (*this))
 	, _post_transport_work (0)
@@ -243,6 +247,11 @@ Session::destroy ()
 
 	Stateful::loading_state_version = 0;
 
+	/* remove_pending_capture_state() has waited for any background saves */
+
+	delete _state_writer;
+	delete _state_cache;
+
 	_butler->drop_references ();
 	delete _butler;
 	delete midi_control_ui;
@@ -358,6 +367,11 @@ Session::when_engine_running ()
 
 	_clicking = false;
 
+	/* more than enough for the beats in any process cycle, so that
+	   click() does not allocate
+	*/
+	click_points.reserve (64);
+
 	try {
 		XMLNode* child = 0;
 
@@ -3871,6 +3885,25 @@ Session::get_silent_buffers (ChanCount count)
 	return ProcessThread::get_silent_buffers (count);
 }
 
+bool
+Session::route_dsp_stats (boost::shared_ptr<Route> route, DSPStats& stats) const
+{
+	GraphNode* node = route.get();
+	return route_graph->dsp_profiler().get_stats (node, stats);
+}
+
+bool
+Session::processor_dsp_stats (boost::shared_ptr<Processor> processor, DSPStats& stats) const
+{
+	return route_graph->dsp_profiler().get_stats (processor.get(), stats);
+}
+
+void
+Session::reset_dsp_stats ()
+{
+	route_graph->dsp_profiler().reset ();
+}
+
 BufferSet&
 Session::get_scratch_buffers (ChanCount count)
 {
@@ -35,6 +35,7 @@
 #include "ardour/region_factory.h"
 #include "ardour/midi_automation_list_binder.h"
 #include "ardour/crossfade.h"
+#include "ardour/location.h"
 #include "pbd/error.h"
 #include "pbd/id.h"
 #include "pbd/statefuldestructible.h"
@@ -179,7 +180,16 @@ Session::stateful_diff_command_factory (XMLNode* n)
                 } else {
                         cerr << "Playlist with ID = " << id << " not found\n";
                 }
-        }
+        } else if (obj_T == "ARDOUR::AutomationList") {
+		std::map<PBD::ID, AutomationList*>::iterator i = automation_lists.find (id);
+		if (i != automation_lists.end()) {
+			return new StatefulDiffCommand (*i->second, *n);
+		}
+	} else if (obj_T == "ARDOUR::Locations") {
+		return new StatefulDiffCommand (*_locations, *n);
+	} else if (obj_T == "ARDOUR::TempoMap") {
+		return new StatefulDiffCommand (*_tempo_map, *n);
+	}
 
 	/* we failed */
 
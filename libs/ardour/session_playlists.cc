@@ -27,6 +27,7 @@
 #include "ardour/playlist_factory.h"
 #include "ardour/session.h"
 #include "ardour/source.h"
+#include "ardour/state_cache.h"
 #include "i18n.h"
 
 using namespace std;
@@ -291,13 +292,16 @@ SessionPlaylists::update_after_tempo_map_change ()
 	}
 }
 
+/** @param cache Cache to get the playlists' state from, or 0 */
 void
-SessionPlaylists::add_state (XMLNode* node, bool full_state)
+SessionPlaylists::add_state (XMLNode* node, bool full_state, StateCache* cache)
 {
 	XMLNode* child = node->add_child ("Playlists");
 	for (List::iterator i = playlists.begin(); i != playlists.end(); ++i) {
 		if (!(*i)->hidden()) {
-                        if (full_state) {
+                        if (cache) {
+                                child->add_child_nocopy (cache->state (*i));
+                        } else if (full_state) {
                                 child->add_child_nocopy ((*i)->get_state());
                         } else {
                                 child->add_child_nocopy ((*i)->get_template());
@@ -309,7 +313,9 @@ SessionPlaylists::add_state (XMLNode* node, bool full_state)
 	for (List::iterator i = unused_playlists.begin(); i != unused_playlists.end(); ++i) {
 		if (!(*i)->hidden()) {
 			if (!(*i)->empty()) {
-				if (full_state) {
+				if (cache) {
+					child->add_child_nocopy (cache->state (*i));
+				} else if (full_state) {
 					child->add_child_nocopy ((*i)->get_state());
 				} else {
 					child->add_child_nocopy ((*i)->get_template());
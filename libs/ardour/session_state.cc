@@ -68,6 +68,7 @@
 #include "pbd/stacktrace.h"
 #include "pbd/convert.h"
 #include "pbd/clear_dir.h"
+#include "pbd/cpus.h"
 
 #include "ardour/amp.h"
 #include "ardour/audio_diskstream.h"
@@ -85,6 +86,7 @@
 #include "ardour/control_protocol_manager.h"
 #include "ardour/crossfade.h"
 #include "ardour/cycle_timer.h"
+#include "ardour/debug.h"
 #include "ardour/directory_names.h"
 #include "ardour/filename_extensions.h"
 #include "ardour/io_processor.h"
@@ -116,6 +118,8 @@
 #include "ardour/sndfile_helpers.h"
 #include "ardour/sndfilesource.h"
 #include "ardour/source_factory.h"
+#include "ardour/state_cache.h"
+#include "ardour/state_writer.h"
 #include "ardour/template_utils.h"
 #include "ardour/tempo.h"
 #include "ardour/ticker.h"
@@ -638,6 +642,9 @@ Session::remove_pending_capture_state ()
 
 	pending_state_file_path /= legalize_for_path (_current_snapshot_name) + pending_suffix;
 
+	/* don't let a background save put the file back afterwards */
+	_state_writer->wait ();
+
 	try
 	{
 		sys::remove (pending_state_file_path);
@@ -756,11 +763,15 @@ Session::jack_session_event (jack_session_event_t * event)
 }
 #endif
 
-/** @param snapshot_name Name to save under, without .ardour / .pending prefix */
+/** Save the session's state.  The state is collected in the calling thread; pending
+ *  state, which is saved often and only to recover from a crash, is then written in
+ *  the background, whereas proper saves wait for the state to reach the disk.
+ *  @param snapshot_name Name to save under, without .ardour / .pending prefix
+ *  @return 0 on success (or, for pending state, on the state being collected).
+ */
 int
 Session::save_state (string snapshot_name, bool pending, bool switch_to_snapshot)
 {
-	XMLTree tree;
 	sys::path xml_path(_session_dir->root_path());
 
 	if (!_writable || (_state_of_the_state & CannotSave)) {
@@ -780,7 +791,11 @@ Session::save_state (string snapshot_name, bool pending, bool switch_to_snapshot
 		i->second->session_saved();
         }
 
-	tree.set_root (&get_state());
+	/* pending saves are frequent, and only for recovering from a crash, so they
+	   may reuse the state of objects that haven't signalled a change.
+	*/
+
+	XMLNode* state = &this->state (true, pending);
 
 	if (snapshot_name.empty()) {
 		snapshot_name = _current_snapshot_name;
@@ -798,6 +813,7 @@ Session::save_state (string snapshot_name, bool pending, bool switch_to_snapshot
 
 		if (sys::exists(xml_path) && !create_backup_file (xml_path)) {
 			// create_backup_file will log the error
+			delete state;
 			return -1;
 		}
 
@@ -813,19 +829,13 @@ Session::save_state (string snapshot_name, bool pending, bool switch_to_snapshot
 
 	// cerr << "actually writing state to " << xml_path.to_string() << endl;
 
-	if (!tree.write (tmp_path.to_string())) {
-		error << string_compose (_("state could not be saved to %1"), tmp_path.to_string()) << endmsg;
-		sys::remove (tmp_path);
-		return -1;
+	_state_writer->set_incremental (Config->get_incremental_state_save ());
 
-	} else {
-
-		if (::rename (tmp_path.to_string().c_str(), xml_path.to_string().c_str()) != 0) {
-			error << string_compose (_("could not rename temporary session file %1 to %2"),
-					tmp_path.to_string(), xml_path.to_string()) << endmsg;
-			sys::remove (tmp_path);
-			return -1;
-		}
+	if (pending) {
+		_state_writer->write_in_background (state, xml_path.to_string(), tmp_path.to_string());
+	} else if (_state_writer->write (state, xml_path.to_string(), tmp_path.to_string())) {
+		/* the writer will have logged the error */
+		return -1;
 	}
 
 	if (!pending) {
@@ -899,6 +909,8 @@ Session::load_state (string snapshot_name)
 
 	_writable = exists_and_writable (xmlpath);
 
+	microseconds_t const parse_start = get_microseconds ();
+
 	if (!state_tree->read (xmlpath.to_string())) {
 		error << string_compose(_("Could not understand ardour file %1"), xmlpath.to_string()) << endmsg;
 		delete state_tree;
@@ -906,6 +918,8 @@ Session::load_state (string snapshot_name)
 		return -1;
 	}
 
+	DEBUG_TRACE (DEBUG::SessionLoad, string_compose ("parsing %1 took %2 ms\n", xmlpath.to_string(), (get_microseconds () - parse_start) / 1000));
+
 	XMLNode& root (*state_tree->root());
 
 	if (root.name() != X_("Session")) {
@@ -988,10 +1002,16 @@ Session::get_template()
 }
 
 XMLNode&
-Session::state(bool full_state)
+Session::state(bool full_state, bool reuse_cached_state)
 {
 	XMLNode* node = new XMLNode("Session");
 	XMLNode* child;
+	StateCache* cache = 0;
+
+	if (full_state && Config->get_incremental_state_save ()) {
+		cache = _state_cache;
+		cache->start (reuse_cached_state);
+	}
 
 	// store libardour version, just in case
 	char buf[16];
@@ -1074,7 +1094,11 @@ Session::state(bool full_state)
 					}
 				}
 
-				child->add_child_nocopy (siter->second->get_state());
+				if (cache) {
+					child->add_child_nocopy (cache->state (siter->second));
+				} else {
+					child->add_child_nocopy (siter->second->get_state());
+				}
 			}
 		}
 	}
@@ -1148,7 +1172,9 @@ Session::state(bool full_state)
 
 		for (RouteList::iterator i = public_order.begin(); i != public_order.end(); ++i) {
 			if (!(*i)->is_hidden()) {
-				if (full_state) {
+				if (cache) {
+					child->add_child_nocopy (cache->state (*i));
+				} else if (full_state) {
 					child->add_child_nocopy ((*i)->get_state());
 				} else {
 					child->add_child_nocopy ((*i)->get_template());
@@ -1157,7 +1183,7 @@ Session::state(bool full_state)
 		}
 	}
 
-	playlists->add_state (node, full_state);
+	playlists->add_state (node, full_state, cache);
 
 	child = node->add_child ("RouteGroups");
 	for (list<RouteGroup *>::iterator i = _route_groups.begin(); i != _route_groups.end(); ++i) {
@@ -1186,6 +1212,10 @@ Session::state(bool full_state)
 		node->add_child_copy (*_extra_xml);
 	}
 
+	if (cache) {
+		cache->finish ();
+	}
+
 	return *node;
 }
 
@@ -1196,6 +1226,15 @@ Session::get_control_protocol_state ()
 	return cpm.get_state();
 }
 
+/** Note the time taken by one phase of loading a session, and start timing the next */
+static void
+load_phase_done (char const * phase, microseconds_t& start)
+{
+	microseconds_t const now = get_microseconds ();
+	DEBUG_TRACE (DEBUG::SessionLoad, string_compose ("%1 took %2 ms\n", phase, (now - start) / 1000));
+	start = now;
+}
+
 int
 Session::set_state (const XMLNode& node, int version)
 {
@@ -1203,6 +1242,7 @@ Session::set_state (const XMLNode& node, int version)
 	XMLNode* child;
 	const XMLProperty* prop;
 	int ret = -1;
+	microseconds_t phase_start = get_microseconds ();
 
 	_state_of_the_state = StateOfTheState (_state_of_the_state|CannotSave);
 
@@ -1301,6 +1341,8 @@ Session::set_state (const XMLNode& node, int version)
 		AudioFileSource::set_header_position_offset (_session_range_location->start());
 	}
 
+	load_phase_done (X_("options and locations"), phase_start);
+
 	if ((child = find_named_node (node, "Sources")) == 0) {
 		error << _("Session: XML state has no sources section") << endmsg;
 		goto out;
@@ -1308,6 +1350,8 @@ Session::set_state (const XMLNode& node, int version)
 		goto out;
 	}
 
+	load_phase_done (X_("sources"), phase_start);
+
 	if ((child = find_named_node (node, "TempoMap")) == 0) {
 		error << _("Session: XML state has no Tempo Map section") << endmsg;
 		goto out;
@@ -1315,6 +1359,8 @@ Session::set_state (const XMLNode& node, int version)
 		goto out;
 	}
 
+	load_phase_done (X_("tempo map"), phase_start);
+
 	if ((child = find_named_node (node, "Regions")) == 0) {
 		error << _("Session: XML state has no Regions section") << endmsg;
 		goto out;
@@ -1322,6 +1368,8 @@ Session::set_state (const XMLNode& node, int version)
 		goto out;
 	}
 
+	load_phase_done (X_("regions"), phase_start);
+
 	if ((child = find_named_node (node, "Playlists")) == 0) {
 		error << _("Session: XML state has no playlists section") << endmsg;
 		goto out;
@@ -1341,6 +1389,8 @@ Session::set_state (const XMLNode& node, int version)
 		}
 	}
 
+	load_phase_done (X_("playlists"), phase_start);
+
 	if ((child = find_named_node (node, "NamedSelections")) != 0) {
 		if (load_named_selections (*child)) {
 			goto out;
@@ -1375,6 +1425,8 @@ Session::set_state (const XMLNode& node, int version)
 		goto out;
 	}
 
+	load_phase_done (X_("routes"), phase_start);
+
 	/* our diskstreams list is no longer needed as they are now all owned by their Route */
 	_diskstreams_2X.clear ();
 
@@ -1414,6 +1466,8 @@ Session::set_state (const XMLNode& node, int version)
 		ControlProtocolManager::instance().set_protocol_states (*child);
 	}
 
+	load_phase_done (X_("route groups and control protocols"), phase_start);
+
 	/* here beginneth the second phase ... */
 
 	StateReady (); /* EMIT SIGNAL */
@@ -1945,59 +1999,178 @@ Session::path_from_region_name (DataType type, string name, string identifier)
 }
 
 
+/** The result of opening one source in a source loading thread */
+struct SourceLoad {
+	SourceLoad (XMLNode const * n) : node (n), opened (false), missing (false), unusable (false) {}
+
+	XMLNode const * node;
+	boost::shared_ptr<Source> source;
+	bool opened;   ///< true if the thread tried to open this source
+	bool missing;  ///< true if the source's file could not be found
+	bool unusable; ///< true if the source's file could not be opened
+};
+
+/** Open sources from a list shared with other threads, until none are left.
+ *  Nothing is announced or reported here; that is left to the thread which
+ *  is loading the session, so that it happens in the same order as the
+ *  sources are listed in the state.
+ */
+static void
+load_sources_thread (Session* session, vector<SourceLoad>* loads, gint* next)
+{
+	pthread_set_name (X_("source loader"));
+
+	while (true) {
+
+		gint const n = g_atomic_int_exchange_and_add (next, 1);
+
+		if (n >= (gint) loads->size()) {
+			break;
+		}
+
+		SourceLoad& load ((*loads)[n]);
+
+		try {
+			/* do peak building in another thread when loading session state */
+			load.source = SourceFactory::create (*session, *load.node, true, false);
+		}
+
+		catch (MissingSource&) {
+			load.missing = true;
+		}
+
+		catch (failed_constructor&) {
+			load.unusable = true;
+		}
+
+		load.opened = true;
+	}
+}
+
+/** Load sources from XML.  Sources whose files must be opened are opened
+ *  by a few threads at once, since each open has to wait on the disk; they
+ *  are then added to the session, and any problems reported, one at a
+ *  time and in order.  Nested sources refer to other sources, so they are
+ *  always created after those.
+ */
 int
 Session::load_sources (const XMLNode& node)
 {
 	XMLNodeList nlist;
 	XMLNodeConstIterator niter;
-	boost::shared_ptr<Source> source;
+	vector<SourceLoad> loads;
 
 	nlist = node.children();
 
 	set_dirty();
 
 	for (niter = nlist.begin(); niter != nlist.end(); ++niter) {
-          retry:
-		try {
-			if ((source = XMLSourceFactory (**niter)) == 0) {
-				error << _("Session: cannot create Source from XML description.") << endmsg;
+		loads.push_back (SourceLoad (*niter));
+	}
+
+	uint32_t const n_threads = min (hardware_concurrency (), min ((uint32_t) loads.size() / 8, (uint32_t) 8));
+
+	if (n_threads > 1) {
+
+		vector<SourceLoad> files;
+
+		for (vector<SourceLoad>::iterator i = loads.begin(); i != loads.end(); ++i) {
+			if (i->node->name() == X_("Source") && i->node->property (X_("playlist")) == 0) {
+				files.push_back (*i);
 			}
+		}
+
+		gint next = 0;
+		list<Glib::Thread*> threads;
 
-		} catch (MissingSource& err) {
+		for (uint32_t n = 0; n < n_threads; ++n) {
+			threads.push_back (Glib::Thread::create (boost::bind (load_sources_thread, this, &files, &next),
+								 500000, true, true, Glib::THREAD_PRIORITY_NORMAL));
+		}
 
-                        int user_choice;
+		for (list<Glib::Thread*>::iterator i = threads.begin(); i != threads.end(); ++i) {
+			(*i)->join ();
+		}
 
-                        if (!no_questions_about_missing_files) {
-                                user_choice = MissingFile (this, err.path, err.type).get_value_or (-1);
-                        } else {
-                                user_choice = -2;
-                        }
+		DEBUG_TRACE (DEBUG::SessionLoad, string_compose ("opened %1 sources in %2 threads\n", files.size(), n_threads));
+
+		vector<SourceLoad>::iterator f = files.begin();
 
-                        switch (user_choice) {
-                        case 0:
-                                /* user added a new search location, so try again */
-                                goto retry;
+		for (vector<SourceLoad>::iterator i = loads.begin(); i != loads.end() && f != files.end(); ++i) {
+			if (i->node == f->node) {
+				*i = *f++;
+			}
+		}
+	}
 
+	for (vector<SourceLoad>::iterator i = loads.begin(); i != loads.end(); ++i) {
 
-                        case 1:
-                                /* user asked to quit the entire session load
-                                 */
-                                return -1;
+		if (!i->opened || i->missing) {
+			/* nested, or missing, in which case the user may be able to help */
+			if (load_source (*i->node)) {
+				return -1;
+			}
+		} else if (i->unusable) {
+			error << string_compose (_("Found a sound file that cannot be used by %1. Talk to the progammers."), PROGRAM_NAME) << endmsg;
+			error << _("Session: cannot create Source from XML description.") << endmsg;
+		} else if (i->source) {
+			SourceFactory::SourceCreated (i->source); /* EMIT SIGNAL */
+		} else {
+			error << _("Session: cannot create Source from XML description.") << endmsg;
+		}
+	}
+
+	return 0;
+}
 
-                        case 2:
-                                no_questions_about_missing_files = true;
-                                goto retry;
+/** Load a source from XML, asking the user what to do if its file is missing.
+ *  @return 0, or -1 if the user asked for the session load to be abandoned.
+ */
+int
+Session::load_source (const XMLNode& node)
+{
+	boost::shared_ptr<Source> source;
 
-                        case 3:
-                                no_questions_about_missing_files = true;
-                                /* fallthru */
+  retry:
+	try {
+		if ((source = XMLSourceFactory (node)) == 0) {
+			error << _("Session: cannot create Source from XML description.") << endmsg;
+		}
 
-                        case -1:
-                        default:
-                                warning << _("A sound file is missing. It will be replaced by silence.") << endmsg;
-                                source = SourceFactory::createSilent (*this, **niter, max_framecnt, _current_frame_rate);
-                                break;
-                        }
+	} catch (MissingSource& err) {
+
+		int user_choice;
+
+		if (!no_questions_about_missing_files) {
+			user_choice = MissingFile (this, err.path, err.type).get_value_or (-1);
+		} else {
+			user_choice = -2;
+		}
+
+		switch (user_choice) {
+		case 0:
+			/* user added a new search location, so try again */
+			goto retry;
+
+
+		case 1:
+			/* user asked to quit the entire session load
+			 */
+			return -1;
+
+		case 2:
+			no_questions_about_missing_files = true;
+			goto retry;
+
+		case 3:
+			no_questions_about_missing_files = true;
+			/* fallthru */
+
+		case -1:
+		default:
+			warning << _("A sound file is missing. It will be replaced by silence.") << endmsg;
+			source = SourceFactory::createSilent (*this, node, max_framecnt, _current_frame_rate);
+			break;
 		}
 	}
 
@@ -2948,7 +3121,7 @@ Session::cleanup_sources (CleanupReport& rep)
 		string peakpath = peak_path (base);
 
 		if (Glib::file_test (peakpath.c_str(), Glib::FILE_TEST_EXISTS)) {
-			if (::unlink (peakpath.c_str()) != 0) {
+			if (AudioSource::remove_peakfile (peakpath) != 0) {
 				error << string_compose (_("cannot remove peakfile %1 for %2 (%3)"),
                                                          peakpath, _path, strerror (errno))
 				      << endmsg;
@@ -3057,7 +3230,7 @@ struct null_deleter { void operator()(void const *) const {} };
 void
 Session::remove_controllable (Controllable* c)
 {
-	if (_state_of_the_state | Deletion) {
+	if (_state_of_the_state & Deletion) {
 		return;
 	}
 
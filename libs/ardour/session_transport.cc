@@ -1325,6 +1325,11 @@ Session::switch_to_sync_source (SyncSource src)
 			return;
 		}
 
+		if (!_engine.jack ()) {
+			/* the engine is not using JACK, so there is no JACK transport to follow */
+			return;
+		}
+
 		new_slave = new JACK_Slave (_engine.jack());
 		break;
 
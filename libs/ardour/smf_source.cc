@@ -144,17 +144,11 @@ SMFSource::read_unlocked (Evoral::EventSink<framepos_t>& destination, framepos_t
 
 	if (_smf_last_read_end == 0 || start != _smf_last_read_end) {
 		DEBUG_TRACE (DEBUG::MidiSourceIO, string_compose ("SMF read_unlocked: seek to %1\n", start));
-		Evoral::SMF::seek_to_start();
-		while (time < start_ticks) {
-			gint ignored;
-
-			ret = read_event(&ev_delta_t, &ev_size, &ev_buffer, &ignored);
-			if (ret == -1) { // EOF
-				_smf_last_read_end = start + duration;
-				return duration;
-			}
-			time += ev_delta_t; // accumulate delta time
-		}
+		/* go straight to the first event at or after start_ticks; time is
+		   then the time of the event before it, which the next delta is
+		   relative to.
+		*/
+		time = Evoral::SMF::seek_to_time (start_ticks);
 	} else {
 		DEBUG_TRACE (DEBUG::MidiSourceIO, string_compose ("SMF read_unlocked: set time to %1\n", _smf_last_read_time));
 		time = _smf_last_read_time;
@@ -223,6 +223,7 @@ SndFileSource::open ()
 		delete _broadcast_info;
 		_broadcast_info = 0;
 		_flags = Flag (_flags & ~Broadcast);
+		StateChanged (); /* EMIT SIGNAL */
 	}
 
 	if (writable()) {
@@ -244,6 +245,7 @@ SndFileSource::open ()
                                 _flags = Flag (_flags & ~Broadcast);
                                 delete _broadcast_info;
                                 _broadcast_info = 0;
+                                StateChanged (); /* EMIT SIGNAL */
                         }
                 }
         }
@@ -268,15 +270,27 @@ SndFileSource::sample_rate () const
 
 framecnt_t
 SndFileSource::read_unlocked (Sample *dst, framepos_t start, framecnt_t cnt) const
+{
+	uint16_t const chn = _channel;
+	return read_channels_unlocked (&dst, &chn, 1, start, cnt);
+}
+
+/** Read from the file once and deliver each of the @a n channels in @a chans
+ *  to the matching entry of @a dst, so that sources for the other channels of
+ *  an interleaved file do not each have to decode it again.
+ */
+framecnt_t
+SndFileSource::read_channels_unlocked (Sample** dst, uint16_t const * chans, uint32_t n, framepos_t start, framecnt_t cnt) const
 {
 	int32_t nread;
-	float *ptr;
 	uint32_t real_cnt;
 	framepos_t file_cnt;
 
         if (writable() && !_open) {
                 /* file has not been opened yet - nothing written to it */
-                memset (dst, 0, sizeof (Sample) * cnt);
+		for (uint32_t c = 0; c < n; ++c) {
+			memset (dst[c], 0, sizeof (Sample) * cnt);
+		}
                 return cnt;
         }
 
@@ -308,7 +322,9 @@ SndFileSource::read_unlocked (Sample *dst, framepos_t start, framecnt_t cnt) con
 
 	if (file_cnt != cnt) {
 		framepos_t delta = cnt - file_cnt;
-		memset (dst+file_cnt, 0, sizeof (Sample) * delta);
+		for (uint32_t c = 0; c < n; ++c) {
+			memset (dst[c]+file_cnt, 0, sizeof (Sample) * delta);
+		}
 	}
 
 	if (file_cnt) {
@@ -322,13 +338,17 @@ SndFileSource::read_unlocked (Sample *dst, framepos_t start, framecnt_t cnt) con
 		}
 
 		if (_info.channels == 1) {
-			framecnt_t ret = sf_read_float (sf, dst, file_cnt);
+			framecnt_t ret = sf_read_float (sf, dst[0], file_cnt);
 			_read_data_count = ret * sizeof(float);
 			if (ret != file_cnt) {
 				char errbuf[256];
 				sf_error_str (0, errbuf, sizeof (errbuf) - 1);
 				error << string_compose(_("SndFileSource: @ %1 could not read %2 within %3 (%4) (len = %5)"), start, file_cnt, _name.val().substr (1), errbuf, _length) << endl;
 			}
+			/* a mono file can only be asked for its one channel */
+			for (uint32_t c = 1; c < n; ++c) {
+				memcpy (dst[c], dst[0], sizeof (Sample) * ret);
+			}
 			_descriptor->release ();
 			return ret;
 		}
@@ -339,17 +359,22 @@ SndFileSource::read_unlocked (Sample *dst, framepos_t start, framecnt_t cnt) con
 	Sample* interleave_buf = get_interleave_buffer (real_cnt);
 
 	nread = sf_read_float (sf, interleave_buf, real_cnt);
-	ptr = interleave_buf + _channel;
 	nread /= _info.channels;
 
-	/* stride through the interleaved data */
+	/* stride through the interleaved data, once per requested channel */
+
+	for (uint32_t c = 0; c < n; ++c) {
+
+		float const * ptr = interleave_buf + chans[c];
+		Sample* d = dst[c];
 
-	for (int32_t n = 0; n < nread; ++n) {
-		dst[n] = *ptr;
-		ptr += _info.channels;
+		for (int32_t f = 0; f < nread; ++f) {
+			d[f] = *ptr;
+			ptr += _info.channels;
+		}
 	}
 
-	_read_data_count = cnt * sizeof(float);
+	_read_data_count = cnt * sizeof(float) * n;
 
 	_descriptor->release ();
 	return nread;
@@ -563,6 +588,7 @@ SndFileSource::setup_broadcast_info (framepos_t /*when*/, struct tm& now, time_t
 		_flags = Flag (_flags & ~Broadcast);
 		delete _broadcast_info;
 		_broadcast_info = 0;
+		StateChanged (); /* EMIT SIGNAL */
 	}
 
 	_descriptor->release ();
@@ -587,6 +613,7 @@ SndFileSource::set_header_timeline_position ()
 		_flags = Flag (_flags & ~Broadcast);
 		delete _broadcast_info;
 		_broadcast_info = 0;
+		StateChanged (); /* EMIT SIGNAL */
 	}
 
 	_descriptor->release ();
@@ -636,6 +663,8 @@ SndFileSource::set_destructive (bool yn)
 		/* leave xfade buf alone in case we need it again later */
 	}
 
+	StateChanged (); /* EMIT SIGNAL */
+
 	return true;
 }
 
@@ -886,6 +915,24 @@ SndFileSource::one_of_several_channels () const
 	return _info.channels > 1;
 }
 
+bool
+SndFileSource::shares_file_with (AudioSource const & other) const
+{
+	SndFileSource const * sfs = dynamic_cast<SndFileSource const *> (&other);
+
+	if (!sfs || sfs == this || _info.channels < 2) {
+		return false;
+	}
+
+	/* sources still being written may not have a complete file yet */
+
+	if (writable() || sfs->writable()) {
+		return false;
+	}
+
+	return sfs->_path == _path && sfs->_info.channels == _info.channels;
+}
+
 bool
 SndFileSource::clamped_at_unity () const
 {
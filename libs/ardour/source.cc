@@ -262,6 +262,7 @@ Source::mark_for_remove ()
 	}
 
 	_flags = Flag (_flags | Removable | RemoveAtDestroy);
+	StateChanged (); /* EMIT SIGNAL */
 }
 
 void
@@ -282,6 +283,8 @@ Source::set_allow_remove_if_empty (bool yn)
 	} else {
 		_flags = Flag (_flags & ~RemovableIfEmpty);
 	}
+
+	StateChanged (); /* EMIT SIGNAL */
 }
 
 void
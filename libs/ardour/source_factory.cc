@@ -33,6 +33,7 @@
 #include "ardour/midi_playlist.h"
 #include "ardour/midi_playlist_source.h"
 #include "ardour/source_factory.h"
+#include "ardour/source_work_pool.h"
 #include "ardour/sndfilesource.h"
 #include "ardour/silentfilesource.h"
 #include "ardour/rc_configuration.h"
@@ -55,50 +56,6 @@ using namespace std;
 using namespace PBD;
 
 PBD::Signal1<void,boost::shared_ptr<Source> > SourceFactory::SourceCreated;
-Glib::Cond* SourceFactory::PeaksToBuild;
-Glib::StaticMutex SourceFactory::peak_building_lock = GLIBMM_STATIC_MUTEX_INIT;
-std::list<boost::weak_ptr<AudioSource> > SourceFactory::files_with_peaks;
-
-static void
-peak_thread_work ()
-{
-	SessionEvent::create_per_thread_pool (X_("PeakFile Builder "), 64);
-
-	while (true) {
-
-		SourceFactory::peak_building_lock.lock ();
-
-	  wait:
-		if (SourceFactory::files_with_peaks.empty()) {
-			SourceFactory::PeaksToBuild->wait (SourceFactory::peak_building_lock);
-		}
-
-		if (SourceFactory::files_with_peaks.empty()) {
-			goto wait;
-		}
-
-		boost::shared_ptr<AudioSource> as (SourceFactory::files_with_peaks.front().lock());
-		SourceFactory::files_with_peaks.pop_front ();
-		SourceFactory::peak_building_lock.unlock ();
-
-		if (!as) {
-			continue;
-		}
-
-		as->setup_peakfile ();
-	}
-}
-
-void
-SourceFactory::init ()
-{
-	PeaksToBuild = new Glib::Cond();
-
-	for (int n = 0; n < 2; ++n) {
-		Glib::Thread::create (sigc::ptr_fun (::peak_thread_work), false);
-	}
-}
-
 int
 SourceFactory::setup_peakfile (boost::shared_ptr<Source> s, bool async)
 {
@@ -108,9 +65,7 @@ SourceFactory::setup_peakfile (boost::shared_ptr<Source> s, bool async)
 
 		if (async) {
 
-			Glib::Mutex::Lock lm (peak_building_lock);
-			files_with_peaks.push_back (boost::weak_ptr<AudioSource> (as));
-			PeaksToBuild->broadcast ();
+			SourceWorkPool::queue (as, SourceWorkPool::BuildPeaks);
 
 		} else {
 
@@ -138,7 +93,7 @@ SourceFactory::createSilent (Session& s, const XMLNode& node, framecnt_t nframes
 }
 
 boost::shared_ptr<Source>
-SourceFactory::create (Session& s, const XMLNode& node, bool defer_peaks)
+SourceFactory::create (Session& s, const XMLNode& node, bool defer_peaks, bool announce)
 {
 	DataType type = DataType::AUDIO;
 	const XMLProperty* prop = node.property("type");
@@ -162,7 +117,9 @@ SourceFactory::create (Session& s, const XMLNode& node, bool defer_peaks)
 
 				ap->check_for_analysis_data_on_disk ();
 
-				SourceCreated (ap);
+				if (announce) {
+					SourceCreated (ap);
+				}
 				return ap;
 
 			} catch (failed_constructor&) {
@@ -182,7 +139,9 @@ SourceFactory::create (Session& s, const XMLNode& node, bool defer_peaks)
 					return boost::shared_ptr<Source>();
 				}
 				ret->check_for_analysis_data_on_disk ();
-				SourceCreated (ret);
+				if (announce) {
+					SourceCreated (ret);
+				}
 				return ret;
 			}
 
@@ -203,7 +162,9 @@ SourceFactory::create (Session& s, const XMLNode& node, bool defer_peaks)
 				}
 
 				ret->check_for_analysis_data_on_disk ();
-				SourceCreated (ret);
+				if (announce) {
+					SourceCreated (ret);
+				}
 				return ret;
 #else
 				throw; // rethrow
@@ -217,7 +178,9 @@ SourceFactory::create (Session& s, const XMLNode& node, bool defer_peaks)
 		// boost_debug_shared_ptr_mark_interesting (src, "Source");
 #endif
 		src->check_for_analysis_data_on_disk ();
-		SourceCreated (src);
+		if (announce) {
+			SourceCreated (src);
+		}
 		return src;
 	}
 
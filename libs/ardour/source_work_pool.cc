@@ -0,0 +1,218 @@
+/*
+    Copyright (C) 2011 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <algorithm>
+
+#include "pbd/compose.h"
+#include "pbd/cpus.h"
+#include "pbd/error.h"
+#include "pbd/pthread_utils.h"
+
+#include "ardour/analyser.h"
+#include "ardour/audiosource.h"
+#include "ardour/session_event.h"
+#include "ardour/source_work_pool.h"
+
+#include "i18n.h"
+
+using namespace std;
+using namespace ARDOUR;
+using namespace PBD;
+
+PBD::Signal2<void,uint32_t,uint32_t> SourceWorkPool::Progress;
+Glib::StaticMutex SourceWorkPool::_lock = GLIBMM_STATIC_MUTEX_INIT;
+Glib::Cond* SourceWorkPool::_work_to_do = 0;
+list<SourceWorkPool::Item> SourceWorkPool::_queue;
+uint32_t SourceWorkPool::_running = 0;
+bool SourceWorkPool::_analysing = false;
+uint32_t SourceWorkPool::_done = 0;
+uint32_t SourceWorkPool::_total = 0;
+
+void
+SourceWorkPool::init ()
+{
+	_work_to_do = new Glib::Cond ();
+
+	/* the jobs mostly wait for the disk, so more threads than
+	   this would just have them competing for it
+	*/
+
+	uint32_t const n = max ((uint32_t) 2, min (hardware_concurrency (), (uint32_t) 4));
+
+	for (uint32_t i = 0; i < n; ++i) {
+		Glib::Thread::create (sigc::ptr_fun (&SourceWorkPool::work), false);
+	}
+}
+
+void
+SourceWorkPool::queue (boost::shared_ptr<Source> src, Job job)
+{
+	uint32_t done;
+	uint32_t total;
+
+	{
+		Glib::Mutex::Lock lm (_lock);
+
+		for (list<Item>::const_iterator i = _queue.begin(); i != _queue.end(); ++i) {
+			if (i->key == src.get() && i->job == job && !i->source.expired()) {
+				return;
+			}
+		}
+
+		_queue.push_back (Item (src, job));
+		++_total;
+
+		done = _done;
+		total = _total;
+
+		_work_to_do->signal ();
+	}
+
+	Progress (done, total); /* EMIT SIGNAL */
+}
+
+void
+SourceWorkPool::prioritise (boost::shared_ptr<Source> src)
+{
+	Glib::Mutex::Lock lm (_lock);
+
+	/* move the source's jobs to the front, keeping them in order */
+
+	list<Item>::iterator front = _queue.begin();
+
+	for (list<Item>::iterator i = _queue.begin(); i != _queue.end(); ) {
+		if (i->key == src.get()) {
+			list<Item>::iterator next = i;
+			++next;
+			if (i == front) {
+				++front;
+			} else {
+				_queue.splice (front, _queue, i);
+			}
+			i = next;
+		} else {
+			++i;
+		}
+	}
+}
+
+bool
+SourceWorkPool::empty ()
+{
+	Glib::Mutex::Lock lm (_lock);
+	return _queue.empty ();
+}
+
+void
+SourceWorkPool::progress (uint32_t& done, uint32_t& total)
+{
+	Glib::Mutex::Lock lm (_lock);
+	done = _done;
+	total = _total;
+}
+
+/** @return the first job in the queue that can be run now, or _queue.end().
+ *  Must be called with _lock held.
+ */
+list<SourceWorkPool::Item>::iterator
+SourceWorkPool::next_job ()
+{
+	list<Item>::iterator i = _queue.begin();
+
+	while (i != _queue.end() && i->job == Analyse && _analysing) {
+		++i;
+	}
+
+	return i;
+}
+
+void
+SourceWorkPool::work ()
+{
+	SessionEvent::create_per_thread_pool (X_("Source Worker"), 64);
+	pthread_set_name (X_("source worker"));
+
+	Glib::Mutex::Lock lm (_lock);
+
+	while (true) {
+
+		list<Item>::iterator next = next_job ();
+
+		if (next == _queue.end()) {
+			_work_to_do->wait (_lock);
+			continue;
+		}
+
+		Item item = *next;
+		_queue.erase (next);
+		++_running;
+
+		if (item.job == Analyse) {
+			_analysing = true;
+		}
+
+		lm.release ();
+		run (item);
+		lm.acquire ();
+
+		if (item.job == Analyse) {
+			_analysing = false;
+			/* another thread may be waiting to run the next analysis */
+			_work_to_do->signal ();
+		}
+
+		--_running;
+		++_done;
+
+		uint32_t const done = _done;
+		uint32_t const total = _total;
+
+		if (_queue.empty() && _running == 0) {
+			_done = _total = 0;
+		}
+
+		lm.release ();
+		Progress (done, total); /* EMIT SIGNAL */
+		lm.acquire ();
+	}
+}
+
+void
+SourceWorkPool::run (Item const & item)
+{
+	boost::shared_ptr<Source> src = item.source.lock ();
+
+	if (!src) {
+		return;
+	}
+
+	switch (item.job) {
+	case BuildPeaks:
+		if (boost::shared_ptr<AudioSource> as = boost::dynamic_pointer_cast<AudioSource> (src)) {
+			if (as->setup_peakfile ()) {
+				error << string_compose (_("could not set up peakfile for %1"), as->name()) << endmsg;
+			}
+		}
+		break;
+
+	case Analyse:
+		Analyser::analyse (src);
+		break;
+	}
+}
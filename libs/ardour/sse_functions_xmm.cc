@@ -114,3 +114,82 @@ x86_sse_find_peaks(const ARDOUR::Sample* buf, ARDOUR::pframes_t nframes, float *
 
 
 
+
+/* x86_sse_mix_buffers_with_gain in the assembler files is not used (see
+   setup_hardware_optimization()); this is a replacement that copes with
+   any relative alignment of src and dst.
+*/
+void
+x86_sse_xmm_mix_buffers_with_gain (ARDOUR::Sample* dst, const ARDOUR::Sample* src, ARDOUR::pframes_t nframes, float gain)
+{
+	__m128 const g = _mm_set1_ps (gain);
+
+	// Work input until "dst" reaches 16 byte alignment
+	while ( ((intptr_t)dst) % 16 != 0 && nframes > 0) {
+		*dst++ += *src++ * gain;
+		nframes--;
+	}
+
+	if (((intptr_t)src) % 16 == 0) {
+		while (nframes >= 4) {
+			_mm_store_ps (dst, _mm_add_ps (_mm_load_ps (dst), _mm_mul_ps (_mm_load_ps (src), g)));
+			dst+=4;
+			src+=4;
+			nframes-=4;
+		}
+	} else {
+		while (nframes >= 4) {
+			_mm_store_ps (dst, _mm_add_ps (_mm_load_ps (dst), _mm_mul_ps (_mm_loadu_ps (src), g)));
+			dst+=4;
+			src+=4;
+			nframes-=4;
+		}
+	}
+
+	// work through the rest < 4 samples
+	while (nframes > 0) {
+		*dst++ += *src++ * gain;
+		nframes--;
+	}
+}
+
+void
+x86_sse_apply_gain_vector_to_buffer (ARDOUR::Sample* buf, const ARDOUR::gain_t* gain, ARDOUR::pframes_t nframes, float scale)
+{
+	__m128 const s = _mm_set1_ps (scale);
+
+	/* gain buffers are not necessarily aligned like sample buffers */
+
+	while (nframes >= 4) {
+		__m128 const g = _mm_mul_ps (_mm_loadu_ps (gain), s);
+		_mm_storeu_ps (buf, _mm_mul_ps (_mm_loadu_ps (buf), g));
+		buf+=4;
+		gain+=4;
+		nframes-=4;
+	}
+
+	while (nframes > 0) {
+		*buf++ *= *gain++ * scale;
+		nframes--;
+	}
+}
+
+void
+x86_sse_mix_buffers_with_gain_vector (ARDOUR::Sample* dst, const ARDOUR::Sample* src, const ARDOUR::gain_t* gain, ARDOUR::pframes_t nframes, float scale)
+{
+	__m128 const s = _mm_set1_ps (scale);
+
+	while (nframes >= 4) {
+		__m128 const g = _mm_mul_ps (_mm_loadu_ps (gain), s);
+		_mm_storeu_ps (dst, _mm_add_ps (_mm_loadu_ps (dst), _mm_mul_ps (_mm_loadu_ps (src), g)));
+		dst+=4;
+		src+=4;
+		gain+=4;
+		nframes-=4;
+	}
+
+	while (nframes > 0) {
+		*dst++ += *src++ * (*gain++ * scale);
+		nframes--;
+	}
+}
@@ -0,0 +1,244 @@
+/*
+    Copyright (C) 2011 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <boost/bind.hpp>
+
+#include "pbd/xml++.h"
+
+#include "ardour/audioplaylist.h"
+#include "ardour/crossfade.h"
+#include "ardour/midi_source.h"
+#include "ardour/playlist.h"
+#include "ardour/playlist_source.h"
+#include "ardour/region.h"
+#include "ardour/route.h"
+#include "ardour/source.h"
+#include "ardour/state_cache.h"
+
+using namespace std;
+using namespace ARDOUR;
+
+/** Mark an entry as changed whenever @a signal is emitted */
+template<typename S>
+void
+StateCache::watch (Entry* e, S& signal)
+{
+	signal.connect_same_thread (e->connections, boost::bind (&StateCache::changed, e));
+}
+
+StateCache::Entry::~Entry ()
+{
+	delete node;
+}
+
+StateCache::StateCache ()
+	: _reuse (false)
+{
+
+}
+
+StateCache::~StateCache ()
+{
+	for (Entries::iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		delete i->second;
+	}
+}
+
+void
+StateCache::start (bool reuse)
+{
+	_reuse = reuse;
+}
+
+void
+StateCache::finish ()
+{
+	for (Entries::iterator i = _entries.begin(); i != _entries.end(); ) {
+		if (i->second->used) {
+			i->second->used = false;
+			++i;
+		} else {
+			delete i->second;
+			_entries.erase (i++);
+		}
+	}
+}
+
+void
+StateCache::invalidate ()
+{
+	for (Entries::iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		g_atomic_int_set (&i->second->changed, 1);
+	}
+}
+
+XMLNode&
+StateCache::state (boost::shared_ptr<Route> route)
+{
+	/* not all changes to a route's processors are signalled, so its
+	   state is always collected
+	*/
+	return collect (route->get_state ());
+}
+
+XMLNode&
+StateCache::state (boost::shared_ptr<Playlist> playlist)
+{
+	Playlist::RegionList const & regions (playlist->region_list().rlist ());
+
+	for (Playlist::RegionList::const_iterator i = regions.begin(); i != regions.end(); ++i) {
+		if ((*i)->max_source_level () > 0) {
+			/* compound region, whose nested sources are not watched */
+			return collect (playlist->get_state ());
+		}
+	}
+
+	Entry* e = entry (playlist->id ());
+
+	if (can_reuse (e)) {
+		return *new XMLNode (*e->node);
+	}
+
+	e->connections.drop_connections ();
+
+	watch (e, playlist->PropertyChanged);
+	watch (e, playlist->ExtraXMLChanged);
+	watch (e, playlist->StateChanged);
+	watch (e, playlist->ContentsChanged);
+	watch (e, playlist->RegionAdded);
+	watch (e, playlist->RegionRemoved);
+	watch (e, playlist->NameChanged);
+	watch (e, playlist->LengthChanged);
+	watch (e, playlist->LayeringChanged);
+
+	/* the playlist's state includes that of its regions */
+
+	for (Playlist::RegionList::const_iterator i = regions.begin(); i != regions.end(); ++i) {
+		watch (e, (*i)->PropertyChanged);
+		watch (e, (*i)->ExtraXMLChanged);
+	}
+
+	/* and an audio playlist's, that of its crossfades */
+
+	boost::shared_ptr<AudioPlaylist> ap = boost::dynamic_pointer_cast<AudioPlaylist> (playlist);
+
+	if (ap) {
+		watch (e, ap->NewCrossfade);
+		ap->foreach_crossfade (boost::bind (&StateCache::watch_crossfade, e, _1));
+	}
+
+	g_atomic_int_set (&e->changed, 0);
+	return store (e, playlist->get_state ());
+}
+
+XMLNode&
+StateCache::state (boost::shared_ptr<Source> source)
+{
+	if (boost::dynamic_pointer_cast<PlaylistSource> (source)) {
+		/* its state includes that of its playlist, which is not watched */
+		return collect (source->get_state ());
+	}
+
+	Entry* e = entry (source->id ());
+
+	if (can_reuse (e)) {
+		return *new XMLNode (*e->node);
+	}
+
+	e->connections.drop_connections ();
+
+	watch (e, source->PropertyChanged);
+	watch (e, source->ExtraXMLChanged);
+	watch (e, source->StateChanged);
+	watch (e, source->AnalysisChanged);
+
+	boost::shared_ptr<MidiSource> ms = boost::dynamic_pointer_cast<MidiSource> (source);
+
+	if (ms) {
+		watch (e, ms->InterpolationChanged);
+		watch (e, ms->AutomationStateChanged);
+	}
+
+	g_atomic_int_set (&e->changed, 0);
+	return store (e, source->get_state ());
+}
+
+/** @return the entry for an object, marked as used */
+StateCache::Entry*
+StateCache::entry (PBD::ID const & id)
+{
+	Entries::iterator i = _entries.find (id);
+
+	if (i == _entries.end ()) {
+		i = _entries.insert (make_pair (id, new Entry)).first;
+	}
+
+	i->second->used = true;
+	return i->second;
+}
+
+bool
+StateCache::can_reuse (Entry* e)
+{
+	if (_reuse && e->node && !g_atomic_int_get (&e->changed)) {
+		++_stats.reused;
+		return true;
+	}
+
+	return false;
+}
+
+/** Keep a copy of some state that has just been collected.
+ *  @return the state.
+ */
+XMLNode&
+StateCache::store (Entry* e, XMLNode& node)
+{
+	delete e->node;
+	e->node = new XMLNode (node);
+	++_stats.collected;
+	return node;
+}
+
+void
+StateCache::watch_crossfade (Entry* e, boost::shared_ptr<Crossfade> xfade)
+{
+	watch (e, xfade->PropertyChanged);
+	watch (e, xfade->ExtraXMLChanged);
+	watch (e, xfade->FadesChanged);
+	watch (e, xfade->Invalidated);
+	watch (e, xfade->fade_in().Dirty);
+	watch (e, xfade->fade_out().Dirty);
+}
+
+/** Count some state that has just been collected, and is not kept.
+ *  @return the state.
+ */
+XMLNode&
+StateCache::collect (XMLNode& node)
+{
+	++_stats.collected;
+	return node;
+}
+
+void
+StateCache::changed (Entry* e)
+{
+	g_atomic_int_set (&e->changed, 1);
+}
@@ -0,0 +1,357 @@
+/*
+    Copyright (C) 2011 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <glibmm/miscutils.h>
+#include <boost/bind.hpp>
+
+#include "pbd/compose.h"
+#include "pbd/error.h"
+#include "pbd/pthread_utils.h"
+#include "pbd/xml++.h"
+
+#include "ardour/state_writer.h"
+
+#include "i18n.h"
+
+using namespace std;
+using namespace ARDOUR;
+using namespace PBD;
+
+StateWriter::StateWriter ()
+	: _busy (false)
+	, _incremental (true)
+	, _quit (false)
+	, _thread (0)
+	, _last_root (0)
+{
+
+}
+
+/** Finish any queued writes, then stop our thread */
+StateWriter::~StateWriter ()
+{
+	{
+		Glib::Mutex::Lock lm (_queue_lock);
+		_quit = true;
+		_queue_cond.broadcast ();
+	}
+
+	if (_thread) {
+		_thread->join ();
+	}
+
+	delete _last_root;
+}
+
+void
+StateWriter::set_incremental (bool yn)
+{
+	Glib::Mutex::Lock lm (_queue_lock);
+	_incremental = yn;
+}
+
+int
+StateWriter::write (XMLNode* root, string const & path, string const & tmp_path)
+{
+	bool incremental;
+
+	{
+		Glib::Mutex::Lock lm (_queue_lock);
+
+		/* a queued write to the same file is older than this one, so
+		   it would overwrite the newer state if we let it run.  One
+		   which has already started will finish before do_write()
+		   gets _write_lock.
+		*/
+
+		for (list<Job>::iterator i = _queue.begin(); i != _queue.end(); ) {
+			if (i->path == path) {
+				delete i->root;
+				i = _queue.erase (i);
+			} else {
+				++i;
+			}
+		}
+
+		incremental = _incremental;
+	}
+
+	return do_write (Job (root, path, tmp_path, incremental));
+}
+
+void
+StateWriter::write_in_background (XMLNode* root, string const & path, string const & tmp_path)
+{
+	Glib::Mutex::Lock lm (_queue_lock);
+
+	for (list<Job>::iterator i = _queue.begin(); i != _queue.end(); ) {
+		if (i->path == path) {
+			delete i->root;
+			i = _queue.erase (i);
+		} else {
+			++i;
+		}
+	}
+
+	_queue.push_back (Job (root, path, tmp_path, _incremental));
+
+	if (_thread == 0) {
+		_thread = Glib::Thread::create (boost::bind (&StateWriter::thread_work, this),
+						500000, true, true, Glib::THREAD_PRIORITY_NORMAL);
+	}
+
+	/* wait() also waits on this condition, so wake everyone */
+	_queue_cond.broadcast ();
+}
+
+void
+StateWriter::wait ()
+{
+	Glib::Mutex::Lock lm (_queue_lock);
+
+	while (!_queue.empty() || _busy) {
+		_queue_cond.wait (_queue_lock);
+	}
+}
+
+StateWriter::Stats
+StateWriter::stats () const
+{
+	Glib::Mutex::Lock lm (_write_lock);
+	return _stats;
+}
+
+void
+StateWriter::thread_work ()
+{
+	pthread_set_name (X_("state writer"));
+
+	Glib::Mutex::Lock lm (_queue_lock);
+
+	while (true) {
+
+		if (_queue.empty()) {
+			if (_quit) {
+				break;
+			}
+			_queue_cond.wait (_queue_lock);
+			continue;
+		}
+
+		Job job = _queue.front ();
+		_queue.pop_front ();
+		_busy = true;
+
+		lm.release ();
+		do_write (job);
+		lm.acquire ();
+
+		_busy = false;
+		_queue_cond.broadcast ();
+	}
+}
+
+int
+StateWriter::do_write (Job const & job)
+{
+	Glib::Mutex::Lock lm (_write_lock);
+
+	string const text = serialise (*job.root, job.incremental);
+
+	/* the cache points into this state, so keep it until the next write */
+	delete _last_root;
+	_last_root = job.root;
+
+	++_stats.writes;
+
+	return write_file (text, job.path, job.tmp_path);
+}
+
+/** @return state as the text of an XML file */
+string
+StateWriter::serialise (XMLNode const & root, bool incremental)
+{
+	if (!incremental) {
+		_cache.clear ();
+	}
+
+	string text = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+	serialise_node (text, root, string (), 0, incremental);
+
+	/* forget objects which were not in this state */
+
+	for (Cache::iterator i = _cache.begin(); i != _cache.end(); ) {
+		if (i->second.used) {
+			i->second.used = false;
+			++i;
+		} else {
+			_cache.erase (i++);
+		}
+	}
+
+	return text;
+}
+
+/** Append a node to some text, indented for its depth and followed by a newline.
+ *  Nodes near the top of the tree are written a child at a time, so that the
+ *  objects below them can be cached.
+ *  @param parent Name of the node's parent.
+ */
+void
+StateWriter::serialise_node (string& text, XMLNode const & node, string const & parent, int level, bool incremental)
+{
+	text += string (level * 2, ' ');
+
+	if (level == 2) {
+
+		XMLProperty const * id = node.property (X_("id"));
+
+		if (incremental && id) {
+
+			CachedObject& c = _cache[parent + '/' + node.name() + ':' + id->value()];
+
+			if (!c.used) {
+				if (c.node && *c.node == node) {
+					++_stats.objects_reused;
+				} else {
+					c.text = XMLTree::write_node (node, level);
+					++_stats.objects_written;
+				}
+
+				c.node = &node;
+				c.used = true;
+				text += c.text;
+				text += '\n';
+				return;
+			}
+
+			/* otherwise the id is not unique, so don't cache this one */
+		}
+
+		text += XMLTree::write_node (node, level);
+		text += '\n';
+		++_stats.objects_written;
+		return;
+	}
+
+	XMLNodeList const & children = node.children ();
+	bool split = (level < 2 && !children.empty());
+
+	for (XMLNodeConstIterator i = children.begin(); i != children.end(); ++i) {
+		if ((*i)->is_content()) {
+			split = false;
+			break;
+		}
+	}
+
+	if (!split) {
+		text += XMLTree::write_node (node, level);
+		text += '\n';
+		return;
+	}
+
+	/* have libxml write our attributes, giving <name attributes/>,
+	   and turn that into a start tag
+	*/
+
+	XMLNode shallow (node.name ());
+	XMLPropertyList const & props = node.properties ();
+	for (XMLPropertyConstIterator i = props.begin(); i != props.end(); ++i) {
+		shallow.add_property ((*i)->name().c_str(), (*i)->value());
+	}
+
+	string tag = XMLTree::write_node (shallow, level);
+	tag.replace (tag.length() - 2, 2, ">");
+	text += tag;
+	text += '\n';
+
+	for (XMLNodeConstIterator i = children.begin(); i != children.end(); ++i) {
+		serialise_node (text, **i, node.name(), level + 1, incremental);
+	}
+
+	text += string (level * 2, ' ');
+	text += "</" + node.name() + ">\n";
+}
+
+/** Write text to a temporary file, sync it and rename it over the target,
+ *  so that the target is never left partly written.
+ *  @return 0 on success.
+ */
+int
+StateWriter::write_file (string const & text, string const & path, string const & tmp_path)
+{
+	int fd = ::open (tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+
+	if (fd < 0) {
+		error << string_compose (_("state could not be saved to %1"), tmp_path) << endmsg;
+		return -1;
+	}
+
+	char const * p = text.data ();
+	size_t left = text.length ();
+
+	while (left > 0) {
+		ssize_t const n = ::write (fd, p, left);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			break;
+		}
+		p += n;
+		left -= n;
+	}
+
+	/* the new file must be on disk before it replaces the old one */
+
+	if (left > 0 || ::fsync (fd) != 0) {
+		error << string_compose (_("state could not be saved to %1 (%2)"), tmp_path, strerror (errno)) << endmsg;
+		::close (fd);
+		::unlink (tmp_path.c_str());
+		return -1;
+	}
+
+	if (::close (fd) != 0) {
+		error << string_compose (_("state could not be saved to %1 (%2)"), tmp_path, strerror (errno)) << endmsg;
+		::unlink (tmp_path.c_str());
+		return -1;
+	}
+
+	if (::rename (tmp_path.c_str(), path.c_str()) != 0) {
+		error << string_compose (_("could not rename temporary session file %1 to %2"), tmp_path, path) << endmsg;
+		::unlink (tmp_path.c_str());
+		return -1;
+	}
+
+	/* and so must the rename */
+
+	int dfd = ::open (Glib::path_get_dirname (path).c_str(), O_RDONLY);
+	if (dfd >= 0) {
+		::fsync (dfd);
+		::close (dfd);
+	}
+
+	return 0;
+}
@@ -218,8 +218,25 @@ struct MetricSectionSorter {
     }
 };
 
+namespace ARDOUR {
+	namespace Properties {
+		PBD::PropertyDescriptor<bool> metrics;
+	}
+}
+
+void
+TempoMap::make_property_quarks ()
+{
+	Properties::metrics.property_id = g_quark_from_static_string (X_("metrics"));
+	DEBUG_TRACE (DEBUG::Properties, string_compose ("quark for metrics = %1\n", Properties::metrics.property_id));
+}
+
 TempoMap::TempoMap (framecnt_t fr)
+	: _index (new MetricIndex)
+	, _metrics_property (Properties::metrics.property_id, *this)
 {
+	add_property (_metrics_property);
+
 	metrics = new Metrics;
 	_frame_rate = fr;
 	last_bbt_valid = false;
@@ -239,6 +256,8 @@ TempoMap::TempoMap (framecnt_t fr)
 
 	metrics->push_back (t);
 	metrics->push_back (m);
+
+	rebuild_index ();
 }
 
 TempoMap::~TempoMap ()
@@ -281,6 +300,7 @@ TempoMap::move_metric_section (MetricSection& section, const BBT_Time& when)
 		timestamp_metrics (false);
 		// cerr << "new BBT time = " << section.start() << endl;
 		metrics->sort (cmp);
+		rebuild_index ();
 
 	} else {
 
@@ -331,6 +351,10 @@ TempoMap::remove_tempo (const TempoSection& tempo)
 				}
 			}
 		}
+
+		if (removed) {
+			rebuild_index ();
+		}
 	}
 
 	if (removed) {
@@ -358,6 +382,10 @@ TempoMap::remove_meter (const MeterSection& tempo)
 				}
 			}
 		}
+
+		if (removed) {
+			rebuild_index ();
+		}
 	}
 
 	if (removed) {
@@ -741,76 +769,119 @@ TempoMap::timestamp_metrics (bool use_bbt)
 	// dump (cerr);
 	// cerr << "###############################################\n\n\n" << endl;
 
+	rebuild_index ();
 }
 
-TempoMetric
-TempoMap::metric_at (framepos_t frame) const
+void
+TempoMap::rebuild_index ()
 {
-	TempoMetric m (first_meter(), first_tempo());
-	const Meter* meter;
-	const Tempo* tempo;
+	RCUWriter<MetricIndex> writer (_index);
+	boost::shared_ptr<MetricIndex> index = writer.get_copy ();
 
-	/* at this point, we are *guaranteed* to have m.meter and m.tempo pointing
-	   at something, because we insert the default tempo and meter during
-	   TempoMap construction.
+	index->points.clear ();
+	index->meters.clear ();
 
-	   now see if we can find better candidates.
-	*/
+	const MeterSection* meter = &first_meter ();
+	const TempoSection* tempo = &first_tempo ();
+	const MeterSection* m;
+	const TempoSection* t;
 
 	for (Metrics::const_iterator i = metrics->begin(); i != metrics->end(); ++i) {
 
-		if ((*i)->frame() > frame) {
-			break;
-		}
+		MetricPoint p;
+
+		p.new_meter = false;
 
-		if ((tempo = dynamic_cast<const TempoSection*>(*i)) != 0) {
-			m.set_tempo (*tempo);
-		} else if ((meter = dynamic_cast<const MeterSection*>(*i)) != 0) {
-			m.set_meter (*meter);
+		if ((t = dynamic_cast<const TempoSection*> (*i)) != 0) {
+			tempo = t;
+		} else if ((m = dynamic_cast<const MeterSection*> (*i)) != 0) {
+			meter = m;
+			p.new_meter = true;
+			index->meters.push_back (m);
 		}
 
-		m.set_frame ((*i)->frame ());
-		m.set_start ((*i)->start ());
-	}
+		p.frame = (*i)->frame ();
+		p.start = (*i)->start ();
+		p.meter = meter;
+		p.tempo = tempo;
 
-	return m;
+		index->points.push_back (p);
+	}
 }
 
-TempoMetric
-TempoMap::metric_at (BBT_Time bbt) const
+/** @return the position in index.points of the last point at or before frame, or -1 if there is none */
+int
+TempoMap::point_at (MetricIndex const & index, framepos_t frame)
 {
-	TempoMetric m (first_meter(), first_tempo());
-	const Meter* meter;
-	const Tempo* tempo;
-
-	/* at this point, we are *guaranteed* to have m.meter and m.tempo pointing
-	   at something, because we insert the default tempo and meter during
-	   TempoMap construction.
+	int lo = 0;
+	int hi = index.points.size ();
 
-	   now see if we can find better candidates.
-	*/
-
-	for (Metrics::const_iterator i = metrics->begin(); i != metrics->end(); ++i) {
+	while (lo < hi) {
+		int const mid = (lo + hi) / 2;
+		if (index.points[mid].frame > frame) {
+			hi = mid;
+		} else {
+			lo = mid + 1;
+		}
+	}
 
-		BBT_Time section_start ((*i)->start());
+	return lo - 1;
+}
 
-		if (section_start.bars > bbt.bars || (section_start.bars == bbt.bars && section_start.beats > bbt.beats)) {
-			break;
+/** @return the position in index.points of the last point at or before the bar and beat of bbt
+ *  (ignoring ticks), or -1 if there is none.
+ */
+int
+TempoMap::point_at (MetricIndex const & index, BBT_Time const & bbt)
+{
+	int lo = 0;
+	int hi = index.points.size ();
+
+	while (lo < hi) {
+		int const mid = (lo + hi) / 2;
+		BBT_Time const & start (index.points[mid].start);
+		if (start.bars > bbt.bars || (start.bars == bbt.bars && start.beats > bbt.beats)) {
+			hi = mid;
+		} else {
+			lo = mid + 1;
 		}
+	}
 
-		if ((tempo = dynamic_cast<const TempoSection*>(*i)) != 0) {
-			m.set_tempo (*tempo);
-		} else if ((meter = dynamic_cast<const MeterSection*>(*i)) != 0) {
-			m.set_meter (*meter);
-		}
+	return lo - 1;
+}
 
-		m.set_frame ((*i)->frame ());
-		m.set_start (section_start);
+TempoMetric
+TempoMap::metric_at_point (MetricIndex const & index, int n) const
+{
+	if (n < 0) {
+		/* before any section: use the first meter and tempo, at frame 0 and 1|1|0 */
+		MetricPoint const & p (index.points.front ());
+		return TempoMetric (*p.meter, *p.tempo);
 	}
 
+	MetricPoint const & p (index.points[n]);
+	TempoMetric m (*p.meter, *p.tempo);
+
+	m.set_frame (p.frame);
+	m.set_start (p.start);
+
 	return m;
 }
 
+TempoMetric
+TempoMap::metric_at (framepos_t frame) const
+{
+	boost::shared_ptr<MetricIndex> index = _index.reader ();
+	return metric_at_point (*index, point_at (*index, frame));
+}
+
+TempoMetric
+TempoMap::metric_at (BBT_Time bbt) const
+{
+	boost::shared_ptr<MetricIndex> index = _index.reader ();
+	return metric_at_point (*index, point_at (*index, bbt));
+}
+
 void
 TempoMap::bbt_time (framepos_t frame, BBT_Time& bbt) const
 {
@@ -1320,14 +1391,20 @@ TempoMap::round_to_type (framepos_t frame, int dir, BBTPointType type)
 TempoMap::BBTPointList *
 TempoMap::get_points (framepos_t lower, framepos_t upper) const
 {
+	BBTPointList* points = new BBTPointList;
+	get_points (*points, lower, upper);
+	return points;
+}
 
-	Metrics::const_iterator i;
-	BBTPointList *points;
+void
+TempoMap::get_points (BBTPointList& points, framepos_t lower, framepos_t upper) const
+{
+	boost::shared_ptr<MetricIndex> index = _index.reader ();
+	vector<MetricPoint> const & metric_points (index->points);
+	vector<MetricPoint>::size_type i;
 	double current;
 	const MeterSection* meter;
-	const MeterSection* m;
 	const TempoSection* tempo;
-	const TempoSection* t;
 	uint32_t bar;
 	uint32_t beat;
 	double beats_per_bar;
@@ -1339,29 +1416,22 @@ TempoMap::get_points (framepos_t lower, framepos_t upper) const
 	double dummy;
 	framepos_t limit;
 
-	meter = &first_meter ();
-	tempo = &first_tempo ();
+	points.clear ();
 
 	/* find the starting point */
 
-	for (i = metrics->begin(); i != metrics->end(); ++i) {
+	int const n = point_at (*index, lower);
+	MetricPoint const & start (metric_points[max (n, 0)]);
 
-		if ((*i)->frame() > lower) {
-			break;
-		}
-
-		if ((t = dynamic_cast<const TempoSection*>(*i)) != 0) {
-			tempo = t;
-		} else if ((m = dynamic_cast<const MeterSection*>(*i)) != 0) {
-			meter = m;
-		}
-	}
+	meter = start.meter;
+	tempo = start.tempo;
+	i = n + 1;
 
 	/* We now have:
 
 	   meter -> the Meter for "lower"
 	   tempo -> the Tempo for "lower"
-	   i     -> for first new metric after "lower", possibly metrics->end()
+	   i     -> for first new metric after "lower", possibly metric_points.size()
 
 	   Now start generating points.
 	*/
@@ -1393,16 +1463,14 @@ TempoMap::get_points (framepos_t lower, framepos_t upper) const
 	bar += (uint32_t) (floor(delta_bars));
 	beat += (uint32_t) (floor(delta_beats));
 
-	points = new BBTPointList;
-
 	do {
 
-		if (i == metrics->end()) {
+		if (i == metric_points.size()) {
 			limit = upper;
 			// cerr << "== limit set to end of request @ " << limit << endl;
 		} else {
-			// cerr << "== limit set to next metric @ " << (*i)->frame() << endl;
-			limit = (*i)->frame();
+			// cerr << "== limit set to next metric @ " << metric_points[i].frame << endl;
+			limit = metric_points[i].frame;
 		}
 
 		limit = min (limit, upper);
@@ -1414,7 +1482,7 @@ TempoMap::get_points (framepos_t lower, framepos_t upper) const
 			if (beat == 1) {
 				if (current >= lower) {
 					// cerr << "Add Bar at " << bar << "|1" << " @ " << current << endl;
-					points->push_back (BBTPoint (*meter, *tempo,(framepos_t)rint(current), Bar, bar, 1));
+					points.push_back (BBTPoint (*meter, *tempo,(framepos_t)rint(current), Bar, bar, 1));
 
 				}
 			}
@@ -1426,7 +1494,7 @@ TempoMap::get_points (framepos_t lower, framepos_t upper) const
 			while (beat <= ceil(beats_per_bar) && beat_frame < limit) {
 				if (beat_frame >= lower) {
 					// cerr << "Add Beat at " << bar << '|' << beat << " @ " << beat_frame << endl;
-					points->push_back (BBTPoint (*meter, *tempo, (framepos_t) rint(beat_frame), Beat, bar, beat));
+					points.push_back (BBTPoint (*meter, *tempo, (framepos_t) rint(beat_frame), Beat, bar, beat));
 				}
 				beat_frame += beat_frames;
 				current+= beat_frames;
@@ -1434,11 +1502,11 @@ TempoMap::get_points (framepos_t lower, framepos_t upper) const
 				beat++;
 			}
 
-			//  cerr << "out of beats, @ end ? " << (i == metrics->end()) << " out of bpb ? "
+			//  cerr << "out of beats, @ end ? " << (i == metric_points.size()) << " out of bpb ? "
 			// << (beat > ceil(beats_per_bar))
 			// << endl;
 
-			if (beat > ceil(beats_per_bar) || i != metrics->end()) {
+			if (beat > ceil(beats_per_bar) || i != metric_points.size()) {
 
 				/* we walked an entire bar. its
 				   important to move `current' forward
@@ -1481,17 +1549,17 @@ TempoMap::get_points (framepos_t lower, framepos_t upper) const
 		   if there is a next metric, move to it, and continue.
 		*/
 
-		if (i != metrics->end()) {
+		if (i != metric_points.size()) {
 
-			if ((t = dynamic_cast<const TempoSection*>(*i)) != 0) {
-				tempo = t;
-			} else if ((m = dynamic_cast<const MeterSection*>(*i)) != 0) {
-				meter = m;
+			tempo = metric_points[i].tempo;
+			meter = metric_points[i].meter;
+
+			if (metric_points[i].new_meter) {
 				/* new MeterSection, beat always returns to 1 */
 				beat = 1;
 			}
 
-			current = (*i)->frame ();
+			current = metric_points[i].frame;
 			// cerr << "loop around with current @ " << current << endl;
 
 			beats_per_bar = meter->beats_per_bar ();
@@ -1502,35 +1570,19 @@ TempoMap::get_points (framepos_t lower, framepos_t upper) const
 		}
 
 	} while (1);
-
-	return points;
 }
 
 const TempoSection&
 TempoMap::tempo_section_at (framepos_t frame) const
 {
-	Glib::RWLock::ReaderLock lm (lock);
-	Metrics::const_iterator i;
-	TempoSection* prev = 0;
-
-	for (i = metrics->begin(); i != metrics->end(); ++i) {
-		TempoSection* t;
-
-		if ((t = dynamic_cast<TempoSection*> (*i)) != 0) {
+	boost::shared_ptr<MetricIndex> index = _index.reader ();
+	int const n = point_at (*index, frame);
 
-			if ((*i)->frame() > frame) {
-				break;
-			}
-
-			prev = t;
-		}
-	}
-
-	if (prev == 0) {
+	if (n < 0) {
 		fatal << endmsg;
 	}
 
-	return *prev;
+	return *index->points[n].tempo;
 }
 
 const Tempo&
@@ -1612,6 +1664,8 @@ TempoMap::set_state (const XMLNode& node, int /*version*/)
 			MetricSectionSorter cmp;
 			metrics->sort (cmp);
 			timestamp_metrics (true);
+		} else {
+			rebuild_index ();
 		}
 	}
 
@@ -1712,18 +1766,12 @@ TempoMap::bbt_add (const BBT_Time& start, const BBT_Time& increment, const Tempo
 
 	/* grab all meter sections */
 
-	list<const MeterSection*> meter_sections;
-
-	for (Metrics::const_iterator x = metrics->begin(); x != metrics->end(); ++x) {
-		const MeterSection* ms;
-		if ((ms = dynamic_cast<const MeterSection*>(*x)) != 0) {
-			meter_sections.push_back (ms);
-		}
-	}
+	boost::shared_ptr<MetricIndex> index = _index.reader ();
+	vector<const MeterSection*> const & meter_sections (index->meters);
 
 	assert (!meter_sections.empty());
 
-	list<const MeterSection*>::const_iterator next_meter;
+	vector<const MeterSection*>::const_iterator next_meter;
 	const Meter* meter = 0;
 
 	/* go forwards through the meter sections till we get to the one
@@ -1813,14 +1861,8 @@ TempoMap::bbt_subtract (const BBT_Time& start, const BBT_Time& decrement) const
 
 	/* grab all meter sections */
 
-	list<const MeterSection*> meter_sections;
-
-	for (Metrics::const_iterator x = metrics->begin(); x != metrics->end(); ++x) {
-		const MeterSection* ms;
-		if ((ms = dynamic_cast<const MeterSection*>(*x)) != 0) {
-			meter_sections.push_back (ms);
-		}
-		}
+	boost::shared_ptr<MetricIndex> index = _index.reader ();
+	vector<const MeterSection*> const & meter_sections (index->meters);
 
 	assert (!meter_sections.empty());
 
@@ -1830,8 +1872,7 @@ TempoMap::bbt_subtract (const BBT_Time& start, const BBT_Time& decrement) const
 	*/
 
 	const MeterSection* meter = 0;
-	list<const MeterSection*>::reverse_iterator next_meter; // older versions of GCC don't
-	                                                        // support const_reverse_iterator::operator!=()
+	vector<const MeterSection*>::const_reverse_iterator next_meter;
 
 	for (next_meter = meter_sections.rbegin(); next_meter != meter_sections.rend(); ++next_meter) {
 
@@ -1901,6 +1942,19 @@ TempoMap::bbt_subtract (const BBT_Time& start, const BBT_Time& decrement) const
 	return result;
 }
 
+/** @return the number of steps of size step that it takes to get from pos
+ *  to or past frame, or 1 if one step is enough or step is not positive.
+ */
+static framecnt_t
+steps_to_reach (framepos_t pos, framepos_t frame, framecnt_t step)
+{
+	if (step <= 0 || frame <= pos + step) {
+		return 1;
+	}
+
+	return (frame - pos + step - 1) / step;
+}
+
 /** Add the BBT interval op to pos and return the result */
 framepos_t
 TempoMap::framepos_plus_bbt (framepos_t pos, BBT_Time op) const
@@ -1911,95 +1965,79 @@ TempoMap::framepos_plus_bbt (framepos_t pos, BBT_Time op) const
 	   by op.ticks' integer nature.
 	*/
 
-	Metrics::const_iterator i;
+	boost::shared_ptr<MetricIndex> index = _index.reader ();
+	vector<MetricPoint> const & points (index->points);
+	vector<MetricPoint>::size_type i;
 	const MeterSection* meter;
-	const MeterSection* m;
 	const TempoSection* tempo;
-	const TempoSection* t;
 	framecnt_t frames_per_beat;
 
-	meter = &first_meter ();
-	tempo = &first_tempo ();
-
-	assert (meter);
-	assert (tempo);
-
 	/* find the starting metrics for tempo & meter */
 
-	for (i = metrics->begin(); i != metrics->end(); ++i) {
-
-		if ((*i)->frame() > pos) {
-			break;
-		}
+	int const n = point_at (*index, pos);
 
-		if ((t = dynamic_cast<const TempoSection*>(*i)) != 0) {
-			tempo = t;
-		} else if ((m = dynamic_cast<const MeterSection*>(*i)) != 0) {
-			meter = m;
-		}
-	}
+	meter = points[max (n, 0)].meter;
+	tempo = points[max (n, 0)].tempo;
+	i = n + 1;
 
 	/* We now have:
 
 	   meter -> the Meter for "pos"
 	   tempo -> the Tempo for "pos"
-	   i     -> for first new metric after "pos", possibly metrics->end()
+	   i     -> for first new metric after "pos", possibly points.size()
 	*/
 
-	/* now comes the complicated part. we have to add one beat a time,
-	   checking for a new metric on every beat.
+	/* now comes the complicated part.  we add whole bars, and then whole
+	   beats, switching to a new metric section as soon as a bar or beat
+	   takes us to or after its start.  Rather than step one at a time,
+	   we work out how many steps it takes to reach the next section and
+	   take them all at once.
 	*/
 
 	frames_per_beat = tempo->frames_per_beat (_frame_rate, *meter);
 
 	while (op.bars) {
 
-		pos += llrint (frames_per_beat * meter->beats_per_bar());
-		op.bars--;
+		framecnt_t const bar_frames = llrint (frames_per_beat * meter->beats_per_bar());
 
-		/* check if we need to use a new metric section: has adding frames moved us
-		   to or after the start of the next metric section? in which case, use it.
-		*/
+		if (i != points.size()) {
+			framecnt_t const steps = steps_to_reach (pos, points[i].frame, bar_frames);
 
-		if (i != metrics->end()) {
-			if ((*i)->frame() <= pos) {
+			if (steps <= op.bars) {
+				pos += steps * bar_frames;
+				op.bars -= steps;
 
-				if ((t = dynamic_cast<const TempoSection*>(*i)) != 0) {
-					tempo = t;
-				} else if ((m = dynamic_cast<const MeterSection*>(*i)) != 0) {
-					meter = m;
-				}
+				tempo = points[i].tempo;
+				meter = points[i].meter;
 				++i;
 				frames_per_beat = tempo->frames_per_beat (_frame_rate, *meter);
-
+				continue;
 			}
 		}
 
+		pos += op.bars * bar_frames;
+		op.bars = 0;
 	}
 
 	while (op.beats) {
 
-		/* given the current meter, have we gone past the end of the bar ? */
-
-		pos += frames_per_beat;
-		op.beats--;
-
-		/* check if we need to use a new metric section: has adding frames moved us
-		   to or after the start of the next metric section? in which case, use it.
-		*/
+		if (i != points.size()) {
+			framecnt_t const steps = steps_to_reach (pos, points[i].frame, frames_per_beat);
 
-		if (i != metrics->end()) {
-			if ((*i)->frame() <= pos) {
+			if (steps <= op.beats) {
+				pos += steps * frames_per_beat;
+				op.beats -= steps;
 
-				if ((t = dynamic_cast<const TempoSection*>(*i)) != 0) {
-					tempo = t;
-				} else if ((m = dynamic_cast<const MeterSection*>(*i)) != 0) {
-					meter = m;
-				}
+				tempo = points[i].tempo;
+				meter = points[i].meter;
 				++i;
 				frames_per_beat = tempo->frames_per_beat (_frame_rate, *meter);
+				continue;
 			}
 		}
+
+		pos += op.beats * frames_per_beat;
+		op.beats = 0;
 	}
 
 	if (op.ticks) {
@@ -2018,47 +2056,35 @@ TempoMap::framepos_plus_bbt (framepos_t pos, BBT_Time op) const
 double
 TempoMap::framewalk_to_beats (framepos_t pos, framecnt_t distance) const
 {
-	Metrics::const_iterator i;
+	boost::shared_ptr<MetricIndex> index = _index.reader ();
+	vector<MetricPoint> const & points (index->points);
+	vector<MetricPoint>::size_type i;
 	double beats = 0;
 	const MeterSection* meter;
-	const MeterSection* m;
 	const TempoSection* tempo;
-	const TempoSection* t;
 	double frames_per_beat;
 
 	double ddist = distance;
 	double dpos = pos;
 
-	meter = &first_meter ();
-	tempo = &first_tempo ();
-
-	assert (meter);
-	assert (tempo);
-
 	/* find the starting metrics for tempo & meter */
 
-	for (i = metrics->begin(); i != metrics->end(); ++i) {
+	int const n = point_at (*index, pos);
 
-		if ((*i)->frame() > pos) {
-			break;
-		}
-
-		if ((t = dynamic_cast<const TempoSection*>(*i)) != 0) {
-			tempo = t;
-		} else if ((m = dynamic_cast<const MeterSection*>(*i)) != 0) {
-			meter = m;
-		}
-	}
+	meter = points[max (n, 0)].meter;
+	tempo = points[max (n, 0)].tempo;
+	i = n + 1;
 
 	/* We now have:
 
 	   meter -> the Meter for "pos"
 	   tempo -> the Tempo for "pos"
-	   i     -> for first new metric after "pos", possibly metrics->end()
+	   i     -> for first new metric after "pos", possibly points.size()
 	*/
 
-	/* now comes the complicated part. we have to add one beat a time,
-	   checking for a new metric on every beat.
+	/* now comes the complicated part.  we walk whole beats, switching to
+	   a new metric section as soon as a beat takes us to or after its
+	   start, as framepos_plus_bbt() does.
 	*/
 
 	frames_per_beat = tempo->frames_per_beat (_frame_rate, *meter);
@@ -2074,29 +2100,34 @@ TempoMap::framewalk_to_beats (framepos_t pos, framecnt_t distance) const
 			break;
 		}
 
-		/* walk one beat */
+		double const whole_beats = floor (ddist / frames_per_beat);
 
-		ddist -= frames_per_beat;
-		dpos += frames_per_beat;
-		beats += 1.0;
+		if (i != points.size()) {
 
-		/* check if we need to use a new metric section: has adding frames moved us
-		   to or after the start of the next metric section? in which case, use it.
-		*/
+			/* beats to walk before we reach the next section */
 
-		if (i != metrics->end()) {
-			if ((*i)->frame() <= (framepos_t) dpos) {
+			double steps = 1;
 
-				if ((t = dynamic_cast<const TempoSection*>(*i)) != 0) {
-					tempo = t;
-				} else if ((m = dynamic_cast<const MeterSection*>(*i)) != 0) {
-					meter = m;
-				}
+			if (points[i].frame > dpos + frames_per_beat) {
+				steps = ceil ((points[i].frame - dpos) / frames_per_beat);
+			}
+
+			if (steps <= whole_beats) {
+				ddist -= steps * frames_per_beat;
+				dpos += steps * frames_per_beat;
+				beats += steps;
+
+				tempo = points[i].tempo;
+				meter = points[i].meter;
 				++i;
 				frames_per_beat = tempo->frames_per_beat (_frame_rate, *meter);
+				continue;
 			}
 		}
 
+		ddist -= whole_beats * frames_per_beat;
+		dpos += whole_beats * frames_per_beat;
+		beats += whole_beats;
 	}
 
 	return beats;
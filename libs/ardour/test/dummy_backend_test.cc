@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <string>
+#include <glibmm/timer.h>
+#include "ardour/audioengine.h"
+#include "ardour/dummy_audio_backend.h"
+#include "ardour/port.h"
+#include "dummy_backend_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (DummyBackendTest);
+
+using namespace std;
+using namespace ARDOUR;
+
+void
+DummyBackendTest::testRun ()
+{
+	DummyAudioBackend* backend = new DummyAudioBackend (48000, 256, DummyAudioBackend::FreeRunning);
+	AudioEngine engine ("test", "", backend);
+
+	CPPUNIT_ASSERT (engine.connected ());
+	CPPUNIT_ASSERT (engine.start () == 0);
+	CPPUNIT_ASSERT_EQUAL ((framecnt_t) 48000, engine.frame_rate ());
+	CPPUNIT_ASSERT_EQUAL ((pframes_t) 256, engine.frames_per_cycle ());
+
+	for (int n = 0; n < 1000 && engine.processed_frames () < 256 * 16; ++n) {
+		Glib::usleep (1000);
+	}
+
+	engine.stop ();
+
+	CPPUNIT_ASSERT (engine.processed_frames () >= 256 * 16);
+	CPPUNIT_ASSERT (backend->cycles () >= 16);
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) 0, backend->xruns ());
+}
+
+void
+DummyBackendTest::testPorts ()
+{
+	DummyAudioBackend* backend = new DummyAudioBackend (48000, 256, DummyAudioBackend::FreeRunning);
+	backend->set_physical_ports (2, 4, 1, 1);
+	backend->set_input_signal (DummyAudioBackend::Sine);
+
+	AudioEngine engine ("test", "", backend);
+
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) 2, engine.n_physical_outputs().n_audio ());
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) 4, engine.n_physical_inputs().n_audio ());
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) 1, engine.n_physical_outputs().n_midi ());
+
+	vector<string> ins;
+	engine.get_physical_inputs (DataType::AUDIO, ins);
+	CPPUNIT_ASSERT_EQUAL ((size_t) 2, ins.size ());
+	CPPUNIT_ASSERT_EQUAL (string ("system:capture_1"), ins[0]);
+
+	CPPUNIT_ASSERT (engine.start () == 0);
+
+	Port* port = engine.register_input_port (DataType::AUDIO, "in");
+	CPPUNIT_ASSERT (port);
+	CPPUNIT_ASSERT (port->connect ("system:capture_1") == 0);
+	CPPUNIT_ASSERT (port->connected_to ("system:capture_1"));
+	CPPUNIT_ASSERT (!port->connected_to ("system:capture_2"));
+
+	uint64_t const cycles = backend->cycles ();
+
+	for (int n = 0; n < 1000 && backend->cycles () < cycles + 4; ++n) {
+		Glib::usleep (1000);
+	}
+
+	engine.stop ();
+
+	/* the input should now be carrying the test signal */
+	Sample const* buf = static_cast<Sample const*> (backend->get_buffer (port->port_handle (), 256));
+	float peak = 0;
+	for (int n = 0; n < 256; ++n) {
+		peak = max (peak, fabsf (buf[n]));
+	}
+
+	CPPUNIT_ASSERT (peak > 0.4 && peak <= 0.5);
+
+	CPPUNIT_ASSERT (port->disconnect ("system:capture_1") == 0);
+	CPPUNIT_ASSERT (!port->connected ());
+}
@@ -0,0 +1,14 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class DummyBackendTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (DummyBackendTest);
+	CPPUNIT_TEST (testRun);
+	CPPUNIT_TEST (testPorts);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void testRun ();
+	void testPorts ();
+};
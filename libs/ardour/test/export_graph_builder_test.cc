@@ -0,0 +1,211 @@
+#include <algorithm>
+#include <vector>
+#include <sndfile.h>
+#include <glib/gstdio.h>
+#include <glibmm/miscutils.h>
+#include "midi++/manager.h"
+#include "pbd/compose.h"
+#include "ardour/audioengine.h"
+#include "ardour/export_channel.h"
+#include "ardour/export_channel_configuration.h"
+#include "ardour/export_filename.h"
+#include "ardour/export_format_specification.h"
+#include "ardour/export_graph_builder.h"
+#include "ardour/export_handler.h"
+#include "ardour/export_timespan.h"
+#include "ardour/session.h"
+#include "test/export_graph_builder_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (ExportGraphBuilderTest);
+
+using namespace std;
+using namespace ARDOUR;
+
+/** Export channel whose data is a function of the session position */
+class TestExportChannel : public ExportChannel
+{
+  public:
+	TestExportChannel (int n, framepos_t const & position)
+		: _n (n)
+		, _position (position)
+	{}
+
+	void set_max_buffer_size (framecnt_t frames) {
+		_buffer.resize (frames);
+	}
+
+	void read (Sample const *& data, framecnt_t frames) const {
+		CPPUNIT_ASSERT (frames <= (framecnt_t) _buffer.size ());
+
+		for (framecnt_t i = 0; i < frames; ++i) {
+			_buffer[i] = value (_n, _position + i);
+		}
+
+		data = &_buffer[0];
+	}
+
+	bool empty () const { return false; }
+	void get_state (XMLNode *) const {}
+	void set_state (XMLNode *, Session &) {}
+
+	bool operator< (ExportChannel const & other) const {
+		return this < &other;
+	}
+
+	static Sample value (int n, framepos_t position) {
+		return (Sample) ((position * (n + 1)) % 997) / 997 - 0.5;
+	}
+
+  private:
+	int _n;
+	framepos_t const & _position;
+	mutable vector<Sample> _buffer;
+};
+
+/** @return the contents of a mono or interleaved float file */
+static vector<float>
+read_file (string const & path, int channels)
+{
+	SF_INFO info;
+	info.format = 0;
+	SNDFILE* f = sf_open (path.c_str(), SFM_READ, &info);
+	CPPUNIT_ASSERT (f);
+	CPPUNIT_ASSERT_EQUAL (channels, info.channels);
+
+	vector<float> data (info.frames * info.channels);
+	CPPUNIT_ASSERT_EQUAL ((sf_count_t) info.frames, sf_readf_float (f, &data[0], info.frames));
+	sf_close (f);
+
+	return data;
+}
+
+/** Add a file for @a timespan to @a builder, labelled with how it was exported */
+static void
+add_file (ExportGraphBuilder & builder, ExportHandler & handler, string const & folder, string const & label,
+          ExportTimespanPtr timespan, ExportChannelConfigPtr channel_config, ExportFormatSpecPtr format)
+{
+	ExportFilenamePtr filename = handler.add_filename ();
+	filename->set_folder (folder);
+	filename->set_label (label);
+	filename->include_label = true;
+	filename->set_timespan (timespan);
+
+	builder.set_current_timespan (timespan);
+	builder.add_config (ExportHandler::FileSpec (channel_config, format, filename, BroadcastInfoPtr ()));
+}
+
+/** Run the session from @a start to @a end through @a builder, as the export handler does */
+static void
+run (ExportGraphBuilder & builder, framepos_t & position, framepos_t start, framepos_t end, framecnt_t block)
+{
+	for (position = start; position < end; position += block) {
+		framecnt_t const frames = min (block, end - position);
+		CPPUNIT_ASSERT_EQUAL (0, builder.process (frames, position));
+	}
+
+	while (!builder.process_normalize ()) {}
+}
+
+/** Export timespans that overlap each other, that lie inside others, that
+ *  start and end on block boundaries and that are disjoint from the rest,
+ *  all in one pass, and check that each file is the same as when its
+ *  timespan is exported on its own.
+ */
+void
+ExportGraphBuilderTest::testSinglePass ()
+{
+	AudioEngine engine ("test", "");
+	if (!MIDI::Manager::instance ()) {
+		MIDI::Manager::create (engine.jack ());
+	}
+	CPPUNIT_ASSERT (engine.start () == 0);
+
+	Session session (engine, "../../libs/ardour/test/data/mantis_3356", "mantis_3356");
+	engine.set_session (&session);
+
+	boost::shared_ptr<ExportHandler> handler = session.get_export_handler ();
+
+	string const folder = Glib::build_filename (Glib::get_tmp_dir (), "export_graph_builder_test");
+	g_mkdir_with_parents (folder.c_str(), 0755);
+
+	framecnt_t const block = engine.frames_per_cycle ();
+	framepos_t position = 0;
+
+	ExportChannelConfigPtr channel_config = handler->add_channel_config ();
+	for (int i = 0; i < 2; ++i) {
+		ExportChannelPtr channel (new TestExportChannel (i, position));
+		channel->set_max_buffer_size (block);
+		channel_config->register_channel (channel);
+	}
+
+	ExportFormatSpecPtr format = handler->add_format ();
+	format->set_type (ExportFormatBase::T_Sndfile);
+	format->set_format_id (ExportFormatBase::F_WAV);
+	format->set_sample_format (ExportFormatBase::SF_Float);
+	format->set_sample_rate ((ExportFormatBase::SampleRate) session.nominal_frame_rate ());
+	format->set_extension ("wav");
+
+	/* start and end of each timespan */
+	framepos_t const ranges[][2] = {
+		{ 1000, 9 * block + 17 },
+		{ 5 * block + 3, 15 * block },
+		{ 6 * block, 7 * block },
+		{ 2 * block, 2 * block + 1 },
+		{ 30 * block + 100, 32 * block - 100 }
+	};
+
+	int const n_timespans = sizeof (ranges) / sizeof (ranges[0]);
+
+	vector<ExportTimespanPtr> timespans;
+	for (int i = 0; i < n_timespans; ++i) {
+		ExportTimespanPtr t = handler->add_timespan ();
+		t->set_range (ranges[i][0], ranges[i][1]);
+		t->set_name (string_compose ("timespan%1", i));
+		timespans.push_back (t);
+	}
+
+	/* each timespan on its own */
+
+	for (int i = 0; i < n_timespans; ++i) {
+		ExportGraphBuilder builder (session);
+		add_file (builder, *handler, folder, "separate", timespans[i], channel_config, format);
+		run (builder, position, ranges[i][0], ranges[i][1], block);
+	}
+
+	/* all timespans in one pass */
+
+	{
+		ExportGraphBuilder builder (session);
+		framepos_t start = ranges[0][0];
+		framepos_t end = ranges[0][1];
+
+		for (int i = 0; i < n_timespans; ++i) {
+			add_file (builder, *handler, folder, "single", timespans[i], channel_config, format);
+			start = min (start, ranges[i][0]);
+			end = max (end, ranges[i][1]);
+		}
+
+		run (builder, position, start, end, block);
+	}
+
+	/* compare */
+
+	for (int i = 0; i < n_timespans; ++i) {
+		string const name = timespans[i]->name ();
+		vector<float> separate = read_file (Glib::build_filename (folder, "separate_" + name + ".wav"), 2);
+		vector<float> single = read_file (Glib::build_filename (folder, "single_" + name + ".wav"), 2);
+
+		CPPUNIT_ASSERT_EQUAL ((size_t) (ranges[i][1] - ranges[i][0]) * 2, separate.size ());
+		CPPUNIT_ASSERT (separate == single);
+
+		for (framepos_t f = 0; f < ranges[i][1] - ranges[i][0]; ++f) {
+			CPPUNIT_ASSERT_EQUAL (TestExportChannel::value (0, ranges[i][0] + f), single[f * 2]);
+			CPPUNIT_ASSERT_EQUAL (TestExportChannel::value (1, ranges[i][0] + f), single[f * 2 + 1]);
+		}
+
+		g_unlink (Glib::build_filename (folder, "separate_" + name + ".wav").c_str ());
+		g_unlink (Glib::build_filename (folder, "single_" + name + ".wav").c_str ());
+	}
+
+	g_rmdir (folder.c_str ());
+}
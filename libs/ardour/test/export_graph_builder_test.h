@@ -0,0 +1,15 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+/** Test that exporting several timespans in one pass gives the same files
+ *  as exporting each of them on its own.
+ */
+class ExportGraphBuilderTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (ExportGraphBuilderTest);
+	CPPUNIT_TEST (testSinglePass);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void testSinglePass ();
+};
@@ -0,0 +1,293 @@
+#include <iostream>
+#include <vector>
+#include <list>
+#include <cstdlib>
+#include <sys/time.h>
+#include "ardour/interval_index.h"
+#include "interval_index_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (IntervalIndexTest);
+
+using namespace std;
+using namespace ARDOUR;
+
+namespace {
+
+struct Interval {
+	Interval (framepos_t f, framepos_t l, int i) : first (f), last (l), id (i) {}
+	framepos_t first;
+	framepos_t last;
+	int id;
+};
+
+/* a random position in [0, span), for spans longer than RAND_MAX */
+framepos_t
+random_position (framepos_t span)
+{
+	return ((framepos_t (rand()) << 31) | rand()) % span;
+}
+
+/* intervals like the regions of a heavily comped playlist: mostly short,
+   often overlapping, with the odd long one (of up to longest) underneath.
+*/
+void
+make_intervals (vector<Interval>& v, int n, framepos_t span, framepos_t longest)
+{
+	srand (1234);
+
+	for (int i = 0; i < n; ++i) {
+		framepos_t const first = random_position (span);
+		framepos_t const length = (i % 50 == 0) ? (1 + rand() % longest) : (1 + rand() % 200000);
+		v.push_back (Interval (first, first + length - 1, i));
+	}
+}
+
+struct SortByFirst {
+	bool operator() (Interval const & a, Interval const & b) const {
+		return a.first < b.first;
+	}
+};
+
+}
+
+void
+IntervalIndexTest::overlapTest ()
+{
+	vector<Interval> v;
+	make_intervals (v, 3000, 10000000, 10000000 / 4);
+
+	IntervalIndex<int> index;
+	CPPUNIT_ASSERT (index.empty ());
+
+	for (vector<Interval>::iterator i = v.begin(); i != v.end(); ++i) {
+		index.add (i->first, i->last, i->id);
+	}
+
+	CPPUNIT_ASSERT_EQUAL (v.size(), index.size());
+
+	stable_sort (v.begin(), v.end(), SortByFirst());
+
+	for (int q = 0; q < 500; ++q) {
+
+		framepos_t const first = rand() % 11000000;
+		framepos_t const last = (q % 3 == 0) ? first : first + rand() % 500000;
+
+		vector<int> expected;
+
+		for (vector<Interval>::iterator i = v.begin(); i != v.end(); ++i) {
+			if (i->first <= last && i->last >= first) {
+				expected.push_back (i->id);
+			}
+		}
+
+		vector<int> found;
+		index.overlapping (first, last, found);
+
+		/* same intervals, in the same (start) order */
+		CPPUNIT_ASSERT (found == expected);
+		CPPUNIT_ASSERT_EQUAL (expected.size(), index.count_overlapping (first, last));
+	}
+
+	index.clear ();
+	vector<int> found;
+	index.overlapping (0, 10000000, found);
+	CPPUNIT_ASSERT (found.empty ());
+}
+
+void
+IntervalIndexTest::positionTest ()
+{
+	PositionIndex<int> index;
+	framepos_t pos;
+	int value;
+
+	CPPUNIT_ASSERT (!index.next_after (0, pos, value));
+	CPPUNIT_ASSERT (!index.previous_before (0, pos, value));
+
+	index.add (300, 3);
+	index.add (100, 1);
+	index.add (200, 2);
+	index.add (100, 4);
+	index.add (300, 5);
+
+	CPPUNIT_ASSERT (index.next_after (50, pos, value));
+	CPPUNIT_ASSERT_EQUAL (framepos_t (100), pos);
+	CPPUNIT_ASSERT_EQUAL (1, value);
+
+	CPPUNIT_ASSERT (index.next_after (100, pos, value));
+	CPPUNIT_ASSERT_EQUAL (2, value);
+
+	CPPUNIT_ASSERT (!index.next_after (300, pos, value));
+
+	/* of equal positions, the first added wins in both directions */
+	CPPUNIT_ASSERT (index.previous_before (1000, pos, value));
+	CPPUNIT_ASSERT_EQUAL (framepos_t (300), pos);
+	CPPUNIT_ASSERT_EQUAL (3, value);
+
+	CPPUNIT_ASSERT (index.previous_before (200, pos, value));
+	CPPUNIT_ASSERT_EQUAL (1, value);
+
+	CPPUNIT_ASSERT (!index.previous_before (100, pos, value));
+
+	/* removing a position leaves the others */
+	CPPUNIT_ASSERT (index.remove (1));
+	CPPUNIT_ASSERT (!index.remove (1));
+	CPPUNIT_ASSERT (index.next_after (50, pos, value));
+	CPPUNIT_ASSERT_EQUAL (4, value);
+
+	/* and moving it puts it after any others already there */
+	index.remove (5);
+	index.add (100, 5);
+	CPPUNIT_ASSERT (index.previous_before (1000, pos, value));
+	CPPUNIT_ASSERT_EQUAL (3, value);
+	CPPUNIT_ASSERT (index.previous_before (200, pos, value));
+	CPPUNIT_ASSERT_EQUAL (4, value);
+}
+
+/* Move intervals about, as a region drag does, and check that the index
+   follows them.
+*/
+void
+IntervalIndexTest::updateTest ()
+{
+	vector<Interval> v;
+	make_intervals (v, 2000, 10000000, 10000000 / 4);
+
+	IntervalIndex<int> index;
+
+	for (vector<Interval>::iterator i = v.begin(); i != v.end(); ++i) {
+		index.add (i->first, i->last, i->id);
+	}
+
+	for (int q = 0; q < 300; ++q) {
+
+		/* move one interval, and remove or re-add another; removed
+		   intervals have their ids stored as -1 - id
+		*/
+
+		Interval& m = v[rand() % v.size()];
+		framepos_t const length = m.last - m.first;
+		bool const present = m.id >= 0;
+		CPPUNIT_ASSERT_EQUAL (present, index.remove (m.id));
+		m.first = rand() % 10000000;
+		m.last = m.first + length;
+		if (present) {
+			index.add (m.first, m.last, m.id);
+		}
+
+		int const r = rand() % v.size();
+		if (v[r].id >= 0) {
+			CPPUNIT_ASSERT (index.remove (v[r].id));
+			v[r].id = -1 - v[r].id;
+		} else {
+			v[r].id = -1 - v[r].id;
+			index.add (v[r].first, v[r].last, v[r].id);
+		}
+
+		framepos_t const first = rand() % 11000000;
+		framepos_t const last = first + rand() % 500000;
+
+		vector<int> expected;
+
+		for (vector<Interval>::iterator i = v.begin(); i != v.end(); ++i) {
+			if (i->id >= 0 && i->first <= last && i->last >= first) {
+				expected.push_back (i->id);
+			}
+		}
+
+		vector<int> found;
+		index.overlapping (first, last, found);
+
+		sort (expected.begin(), expected.end());
+		sort (found.begin(), found.end());
+		CPPUNIT_ASSERT (found == expected);
+	}
+}
+
+/* Compare the index against the linear scan of a position-sorted list that
+   Playlist used to do, for playlists of 2000 to 200000 intervals spread at
+   the same density, and none longer than an hour, so that the number of
+   hits per query stays about the same.  Prints the mean query times, which for the index should grow only
+   with log n.
+*/
+void
+IntervalIndexTest::benchmark ()
+{
+	int const queries = 2000;
+
+	cerr << "\nintervals, build usecs, hits per query, usecs per query: linear scan, index, index after moving an interval\n";
+
+	for (int n = 2000; n <= 200000; n *= 10) {
+
+		framepos_t const span = 48000LL * 3600 * 4 * n / 20000;
+
+		vector<Interval> v;
+		make_intervals (v, n, span, 48000LL * 3600);
+		stable_sort (v.begin(), v.end(), SortByFirst());
+
+		list<Interval> l (v.begin(), v.end());
+
+		struct timeval a, b;
+
+		gettimeofday (&a, 0);
+
+		IntervalIndex<int> index;
+		for (vector<Interval>::iterator i = v.begin(); i != v.end(); ++i) {
+			index.add (i->first, i->last, i->id);
+		}
+
+		gettimeofday (&b, 0);
+
+		double const build = (b.tv_sec - a.tv_sec) * 1e6 + (b.tv_usec - a.tv_usec);
+
+		vector<framepos_t> starts;
+		for (int q = 0; q < queries; ++q) {
+			starts.push_back (random_position (span));
+		}
+
+		size_t linear_hits = 0;
+		gettimeofday (&a, 0);
+		for (int q = 0; q < queries; ++q) {
+			framepos_t const first = starts[q];
+			framepos_t const last = first + 8191;
+			for (list<Interval>::iterator i = l.begin(); i != l.end(); ++i) {
+				if (i->first <= last && i->last >= first) {
+					++linear_hits;
+				}
+			}
+		}
+		gettimeofday (&b, 0);
+
+		double const linear = ((b.tv_sec - a.tv_sec) * 1e6 + (b.tv_usec - a.tv_usec)) / queries;
+
+		size_t index_hits = 0;
+		vector<int> found;
+		gettimeofday (&a, 0);
+		for (int q = 0; q < queries; ++q) {
+			found.clear ();
+			index.overlapping (starts[q], starts[q] + 8191, found);
+			index_hits += found.size ();
+		}
+		gettimeofday (&b, 0);
+
+		double const indexed = ((b.tv_sec - a.tv_sec) * 1e6 + (b.tv_usec - a.tv_usec)) / queries;
+
+		CPPUNIT_ASSERT_EQUAL (linear_hits, index_hits);
+
+		/* moving one interval then querying, as during a region drag */
+		gettimeofday (&a, 0);
+		for (int q = 0; q < queries; ++q) {
+			Interval const & m = v[q * 7 % n];
+			index.remove (m.id);
+			index.add (m.first + q, m.last + q, m.id);
+			found.clear ();
+			index.overlapping (starts[q], starts[q] + 8191, found);
+		}
+		gettimeofday (&b, 0);
+
+		double const moved = ((b.tv_sec - a.tv_sec) * 1e6 + (b.tv_usec - a.tv_usec)) / queries;
+
+		cerr << n << " " << build << " " << (double) index_hits / queries << " "
+		     << linear << " " << indexed << " " << moved << "\n";
+	}
+}
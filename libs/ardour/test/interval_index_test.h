@@ -0,0 +1,18 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class IntervalIndexTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (IntervalIndexTest);
+	CPPUNIT_TEST (overlapTest);
+	CPPUNIT_TEST (positionTest);
+	CPPUNIT_TEST (updateTest);
+	CPPUNIT_TEST (benchmark);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void overlapTest ();
+	void positionTest ();
+	void updateTest ();
+	void benchmark ();
+};
@@ -0,0 +1,282 @@
+#include "libardour-config.h"
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <sys/time.h>
+
+#include "pbd/fpu.h"
+#include "ardour/mix.h"
+#include "ardour/runtime_functions.h"
+#include "mix_functions_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (MixFunctionsTest);
+
+using namespace std;
+using namespace ARDOUR;
+
+namespace {
+
+struct Kernels {
+	Kernels (string const & n, compute_peak_t cp, find_peaks_t fp, apply_gain_to_buffer_t ag,
+	         mix_buffers_with_gain_t mg, mix_buffers_no_gain_t mn,
+	         apply_gain_vector_to_buffer_t agv, mix_buffers_with_gain_vector_t mgv)
+		: name (n), compute_peak (cp), find_peaks (fp), apply_gain_to_buffer (ag)
+		, mix_buffers_with_gain (mg), mix_buffers_no_gain (mn)
+		, apply_gain_vector_to_buffer (agv), mix_buffers_with_gain_vector (mgv) {}
+
+	string name;
+	compute_peak_t compute_peak;
+	find_peaks_t find_peaks;
+	apply_gain_to_buffer_t apply_gain_to_buffer;
+	mix_buffers_with_gain_t mix_buffers_with_gain;
+	mix_buffers_no_gain_t mix_buffers_no_gain;
+	apply_gain_vector_to_buffer_t apply_gain_vector_to_buffer;
+	mix_buffers_with_gain_vector_t mix_buffers_with_gain_vector;
+};
+
+/** @return every set of kernels that this machine can run, default first */
+vector<Kernels>
+available_kernels ()
+{
+	vector<Kernels> k;
+
+	k.push_back (Kernels ("default", default_compute_peak, default_find_peaks, default_apply_gain_to_buffer,
+	                      default_mix_buffers_with_gain, default_mix_buffers_no_gain,
+	                      default_apply_gain_vector_to_buffer, default_mix_buffers_with_gain_vector));
+
+	PBD::FPU fpu;
+
+#if defined (ARCH_X86) && defined (BUILD_SSE_OPTIMIZATIONS)
+	if (fpu.has_sse ()) {
+		k.push_back (Kernels ("SSE", x86_sse_compute_peak, x86_sse_find_peaks, x86_sse_apply_gain_to_buffer,
+		                      x86_sse_xmm_mix_buffers_with_gain, x86_sse_mix_buffers_no_gain,
+		                      x86_sse_apply_gain_vector_to_buffer, x86_sse_mix_buffers_with_gain_vector));
+	}
+#ifdef HAVE_AVX_INTRINSICS
+	if (fpu.has_avx ()) {
+		k.push_back (Kernels ("AVX", x86_avx_compute_peak, x86_avx_find_peaks, x86_avx_apply_gain_to_buffer,
+		                      x86_avx_mix_buffers_with_gain, x86_avx_mix_buffers_no_gain,
+		                      x86_avx_apply_gain_vector_to_buffer, x86_avx_mix_buffers_with_gain_vector));
+	}
+#endif
+#ifdef HAVE_AVX512F_INTRINSICS
+	if (fpu.has_avx512f ()) {
+		k.push_back (Kernels ("AVX-512", x86_avx512f_compute_peak, x86_avx512f_find_peaks, x86_avx512f_apply_gain_to_buffer,
+		                      x86_avx512f_mix_buffers_with_gain, x86_avx512f_mix_buffers_no_gain,
+		                      x86_avx512f_apply_gain_vector_to_buffer, x86_avx512f_mix_buffers_with_gain_vector));
+	}
+#endif
+#endif
+
+#if defined (BUILD_NEON_OPTIMIZATIONS) && (defined (__ARM_NEON__) || defined (__ARM_NEON))
+	k.push_back (Kernels ("NEON", arm_neon_compute_peak, arm_neon_find_peaks, arm_neon_apply_gain_to_buffer,
+	                      arm_neon_mix_buffers_with_gain, arm_neon_mix_buffers_no_gain,
+	                      arm_neon_apply_gain_vector_to_buffer, arm_neon_mix_buffers_with_gain_vector));
+#endif
+
+	return k;
+}
+
+/** A buffer aligned the way Ardour's own buffers are, with some slack at the end */
+struct AlignedBuffer {
+	AlignedBuffer (size_t n) : size (n) {
+		if (posix_memalign ((void**) &data, 64, (n + 64) * sizeof (Sample))) {
+			data = 0;
+		}
+	}
+	~AlignedBuffer () { free (data); }
+
+	Sample* data;
+	size_t size;
+};
+
+void
+fill (Sample* buf, size_t n)
+{
+	for (size_t i = 0; i < n; ++i) {
+		buf[i] = (rand() / (float) RAND_MAX) * 2.0f - 1.0f;
+	}
+}
+
+double
+elapsed (struct timeval const & a, struct timeval const & b)
+{
+	return (b.tv_sec - a.tv_sec) * 1e6 + (b.tv_usec - a.tv_usec);
+}
+
+}
+
+/** Check every kernel against the default (scalar) one, for lengths that
+ *  exercise each kernel's vector loop and tail, starting at each offset
+ *  into a 64 byte aligned buffer that the kernel is meant to cope with.
+ *  (The SSE kernels need src and dst to have the same alignment, so the
+ *  offsets are the same for both.)
+ */
+void
+MixFunctionsTest::correctnessTest ()
+{
+	vector<Kernels> kernels = available_kernels ();
+	Kernels const & ref = kernels.front ();
+
+	size_t const max_length = 1100;
+	AlignedBuffer src (max_length + 16);
+	AlignedBuffer dst (max_length + 16);
+	AlignedBuffer expected (max_length + 16);
+	AlignedBuffer gain (max_length + 16);
+
+	srand (2718);
+	fill (src.data, src.size);
+	fill (gain.data, gain.size);
+
+	for (vector<Kernels>::iterator k = kernels.begin() + 1; k != kernels.end(); ++k) {
+
+		for (size_t offset = 0; offset < 16; offset += (k->name == "SSE" ? 4 : 1)) {
+
+			for (pframes_t n = 0; n < max_length; n += (n < 80 ? 1 : 97)) {
+
+				Sample const * s = src.data + offset;
+
+				/* compute_peak: the default uses an arithmetic max, so allow for its rounding */
+
+				float const peak = ref.compute_peak (s, n, 0.25f);
+				CPPUNIT_ASSERT_DOUBLES_EQUAL (peak, k->compute_peak (s, n, 0.25f), 1e-6);
+
+				/* find_peaks */
+
+				float ref_min = 0.1f;
+				float ref_max = -0.1f;
+				ref.find_peaks (s, n, &ref_min, &ref_max);
+
+				float min = 0.1f;
+				float max = -0.1f;
+				k->find_peaks (s, n, &min, &max);
+
+				CPPUNIT_ASSERT_EQUAL (ref_min, min);
+				CPPUNIT_ASSERT_EQUAL (ref_max, max);
+
+				/* apply_gain_to_buffer, which must not touch anything past n */
+
+				fill (dst.data, dst.size);
+				memcpy (expected.data, dst.data, dst.size * sizeof (Sample));
+
+				ref.apply_gain_to_buffer (expected.data + offset, n, 0.7f);
+				k->apply_gain_to_buffer (dst.data + offset, n, 0.7f);
+				CPPUNIT_ASSERT (memcmp (expected.data, dst.data, dst.size * sizeof (Sample)) == 0);
+
+				/* mix_buffers_with_gain */
+
+				ref.mix_buffers_with_gain (expected.data + offset, s, n, -0.3f);
+				k->mix_buffers_with_gain (dst.data + offset, s, n, -0.3f);
+				CPPUNIT_ASSERT (memcmp (expected.data, dst.data, dst.size * sizeof (Sample)) == 0);
+
+				/* mix_buffers_no_gain */
+
+				ref.mix_buffers_no_gain (expected.data + offset, s, n);
+				k->mix_buffers_no_gain (dst.data + offset, s, n);
+				CPPUNIT_ASSERT (memcmp (expected.data, dst.data, dst.size * sizeof (Sample)) == 0);
+
+				/* apply_gain_vector_to_buffer, with the gain vector at a different alignment */
+
+				ref.apply_gain_vector_to_buffer (expected.data + offset, gain.data + 1, n, 0.9f);
+				k->apply_gain_vector_to_buffer (dst.data + offset, gain.data + 1, n, 0.9f);
+				CPPUNIT_ASSERT (memcmp (expected.data, dst.data, dst.size * sizeof (Sample)) == 0);
+
+				/* mix_buffers_with_gain_vector */
+
+				ref.mix_buffers_with_gain_vector (expected.data + offset, s, gain.data + 3, n, 1.1f);
+				k->mix_buffers_with_gain_vector (dst.data + offset, s, gain.data + 3, n, 1.1f);
+				CPPUNIT_ASSERT (memcmp (expected.data, dst.data, dst.size * sizeof (Sample)) == 0);
+			}
+		}
+	}
+}
+
+void
+MixFunctionsTest::benchmark ()
+{
+	vector<Kernels> kernels = available_kernels ();
+
+	pframes_t const nframes = 1024;
+	int const iterations = 20000;
+
+	AlignedBuffer src (nframes);
+	AlignedBuffer dst (nframes);
+	AlignedBuffer gain (nframes);
+
+	srand (3141);
+	fill (src.data, nframes);
+	fill (dst.data, nframes);
+
+	for (pframes_t n = 0; n < nframes; ++n) {
+		gain.data[n] = 1.0f;
+	}
+
+	cerr << "\nusecs per " << nframes << " frames: compute_peak find_peaks apply_gain mix_with_gain mix_no_gain"
+	     << " apply_gain_vector mix_with_gain_vector\n";
+
+	for (vector<Kernels>::iterator k = kernels.begin(); k != kernels.end(); ++k) {
+
+		struct timeval a, b;
+		float peak = 0;
+		float min = 0;
+		float max = 0;
+
+		cerr << k->name << ":";
+
+		gettimeofday (&a, 0);
+		for (int i = 0; i < iterations; ++i) {
+			peak = k->compute_peak (src.data, nframes, peak);
+		}
+		gettimeofday (&b, 0);
+		cerr << " " << elapsed (a, b) / iterations;
+
+		gettimeofday (&a, 0);
+		for (int i = 0; i < iterations; ++i) {
+			k->find_peaks (src.data, nframes, &min, &max);
+		}
+		gettimeofday (&b, 0);
+		cerr << " " << elapsed (a, b) / iterations;
+
+		/* alternate gains so that the buffer neither overflows nor becomes denormal */
+
+		gettimeofday (&a, 0);
+		for (int i = 0; i < iterations; ++i) {
+			k->apply_gain_to_buffer (dst.data, nframes, (i & 1) ? 0.5f : 2.0f);
+		}
+		gettimeofday (&b, 0);
+		cerr << " " << elapsed (a, b) / iterations;
+
+		gettimeofday (&a, 0);
+		for (int i = 0; i < iterations; ++i) {
+			k->mix_buffers_with_gain (dst.data, src.data, nframes, (i & 1) ? 0.5f : -0.5f);
+		}
+		gettimeofday (&b, 0);
+		cerr << " " << elapsed (a, b) / iterations;
+
+		gettimeofday (&a, 0);
+		for (int i = 0; i < iterations; ++i) {
+			k->mix_buffers_no_gain (dst.data, src.data, nframes);
+		}
+		gettimeofday (&b, 0);
+		cerr << " " << elapsed (a, b) / iterations;
+
+		gettimeofday (&a, 0);
+		for (int i = 0; i < iterations; ++i) {
+			k->apply_gain_vector_to_buffer (dst.data, gain.data, nframes, (i & 1) ? 0.5f : 2.0f);
+		}
+		gettimeofday (&b, 0);
+		cerr << " " << elapsed (a, b) / iterations;
+
+		gettimeofday (&a, 0);
+		for (int i = 0; i < iterations; ++i) {
+			k->mix_buffers_with_gain_vector (dst.data, src.data, gain.data, nframes, (i & 1) ? 0.5f : -0.5f);
+		}
+		gettimeofday (&b, 0);
+		cerr << " " << elapsed (a, b) / iterations << "\n";
+
+		CPPUNIT_ASSERT (peak >= 0);
+	}
+}
@@ -0,0 +1,112 @@
+#include "midi++/manager.h"
+#include "pbd/xml++.h"
+#include "ardour/audioengine.h"
+#include "ardour/playlist.h"
+#include "ardour/region.h"
+#include "ardour/route.h"
+#include "ardour/session.h"
+#include "ardour/session_playlists.h"
+#include "ardour/source.h"
+#include "ardour/state_cache.h"
+#include "test/state_cache_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (StateCacheTest);
+
+using namespace std;
+using namespace ARDOUR;
+using namespace PBD;
+
+/** @return @a node written out as a string; @a node is deleted */
+static string
+xml_string (XMLNode& node)
+{
+	XMLTree tree;
+	tree.set_root (&node);
+	return tree.write_buffer ();
+}
+
+/** Collect the state of @a object using @a cache, check that it is the same as
+ *  its current state, and check whether it was reused.
+ */
+template<typename T>
+static void
+check (StateCache& cache, boost::shared_ptr<T> object, bool reused)
+{
+	StateCache::Stats const before = cache.stats ();
+
+	cache.start (true);
+	string const cached = xml_string (cache.state (object));
+	cache.finish ();
+
+	CPPUNIT_ASSERT_EQUAL (xml_string (object->get_state ()), cached);
+	CPPUNIT_ASSERT_EQUAL (before.reused + (reused ? 1 : 0), cache.stats().reused);
+	CPPUNIT_ASSERT_EQUAL (before.collected + (reused ? 0 : 1), cache.stats().collected);
+}
+
+/** Check that state is only reused when nothing in it has changed */
+void
+StateCacheTest::test ()
+{
+	AudioEngine engine ("test", "");
+	if (!MIDI::Manager::instance ()) {
+		MIDI::Manager::create (engine.jack ());
+	}
+	CPPUNIT_ASSERT (engine.start () == 0);
+
+	Session session (engine, "../../libs/ardour/test/data/mantis_3356", "mantis_3356");
+	engine.set_session (&session);
+
+	StateCache cache;
+
+	/* playlist */
+
+	boost::shared_ptr<Playlist> playlist = session.playlists->by_id (ID ("85"));
+	CPPUNIT_ASSERT (playlist);
+	boost::shared_ptr<Region> region = playlist->region_list().rlist().front ();
+
+	check (cache, playlist, false);
+	check (cache, playlist, true);
+
+	region->add_extra_xml (*new XMLNode ("Test"));
+	check (cache, playlist, false);
+	check (cache, playlist, true);
+
+	region->set_position (region->position() + 1000);
+	check (cache, playlist, false);
+
+	playlist->set_frozen (true);
+	check (cache, playlist, false);
+
+	playlist->add_extra_xml (*new XMLNode ("Test"));
+	check (cache, playlist, false);
+	check (cache, playlist, true);
+
+	/* source */
+
+	boost::shared_ptr<Source> source = session.source_by_id (ID ("87"));
+	CPPUNIT_ASSERT (source);
+
+	check (cache, source, false);
+	check (cache, source, true);
+
+	source->stamp (source->timestamp() + 1);
+	check (cache, source, false);
+
+	source->add_extra_xml (*new XMLNode ("Test"));
+	check (cache, source, false);
+	check (cache, source, true);
+
+	/* routes are never reused */
+
+	boost::shared_ptr<Route> route = session.route_by_id (ID ("69"));
+	CPPUNIT_ASSERT (route);
+
+	check (cache, route, false);
+	check (cache, route, false);
+
+	/* nor is anything after an invalidate */
+
+	cache.invalidate ();
+	check (cache, playlist, false);
+	check (cache, source, false);
+}
@@ -0,0 +1,12 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class StateCacheTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (StateCacheTest);
+	CPPUNIT_TEST (test);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void test ();
+};
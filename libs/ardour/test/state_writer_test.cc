@@ -0,0 +1,134 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <glibmm/fileutils.h>
+#include <glibmm/miscutils.h>
+#include "pbd/xml++.h"
+#include "ardour/state_writer.h"
+#include "state_writer_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (StateWriterTest);
+
+using namespace std;
+using namespace ARDOUR;
+
+/** @return a session-like state with some routes and playlists */
+static XMLNode*
+make_state (int routes, string const & changed_name = "")
+{
+	XMLNode* root = new XMLNode ("Session");
+	root->add_property ("name", "caf\xc3\xa9 & <friends>");
+	root->add_child ("Config")->add_property ("sample-rate", "48000");
+
+	XMLNode* r = root->add_child ("Routes");
+	XMLNode* p = root->add_child ("Playlists");
+
+	for (int i = 0; i < routes; ++i) {
+		char buf[32];
+		snprintf (buf, sizeof (buf), "%d", i);
+
+		XMLNode* route = r->add_child ("Route");
+		route->add_property ("id", buf);
+		route->add_property ("name", (i == 3 && !changed_name.empty()) ? changed_name : string ("Audio ") + buf);
+		route->add_child ("IO")->add_property ("direction", "Input");
+		route->add_child ("events")->add_content ("0 1\n48000 0.5\n");
+
+		XMLNode* playlist = p->add_child ("Playlist");
+		playlist->add_property ("id", string ("1000") + buf);
+	}
+
+	XMLNode* path = root->add_child ("Path");
+	path->add_content ("/tmp/a:/tmp/b");
+
+	return root;
+}
+
+static string
+file_contents (string const & path)
+{
+	ifstream f (path.c_str());
+	stringstream s;
+	s << f.rdbuf ();
+	return s.str ();
+}
+
+/** Writing should give the same file as XMLTree::write */
+void
+StateWriterTest::testWrite ()
+{
+	string const path = Glib::build_filename (Glib::get_tmp_dir (), "state_writer_test.ardour");
+	string const tmp_path = path + ".tmp";
+	string const ref_path = path + ".ref";
+
+	XMLTree ref;
+	ref.set_root (make_state (10));
+	CPPUNIT_ASSERT (ref.write (ref_path));
+
+	StateWriter writer;
+	writer.set_incremental (false);
+	CPPUNIT_ASSERT_EQUAL (0, writer.write (make_state (10), path, tmp_path));
+
+	CPPUNIT_ASSERT (file_contents (path) == file_contents (ref_path));
+	CPPUNIT_ASSERT (!Glib::file_test (tmp_path, Glib::FILE_TEST_EXISTS));
+
+	::unlink (path.c_str ());
+	::unlink (ref_path.c_str ());
+}
+
+/** Incremental writes should reuse unchanged objects and still give the same file */
+void
+StateWriterTest::testIncremental ()
+{
+	string const path = Glib::build_filename (Glib::get_tmp_dir (), "state_writer_test.ardour");
+	string const tmp_path = path + ".tmp";
+	string const ref_path = path + ".ref";
+
+	StateWriter writer;
+	writer.set_incremental (true);
+
+	CPPUNIT_ASSERT_EQUAL (0, writer.write (make_state (10), path, tmp_path));
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) 20, writer.stats().objects_written);
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) 0, writer.stats().objects_reused);
+
+	/* change one route and remove another, along with its playlist */
+	CPPUNIT_ASSERT_EQUAL (0, writer.write (make_state (9, "Renamed"), path, tmp_path));
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) 21, writer.stats().objects_written);
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) 17, writer.stats().objects_reused);
+
+	XMLTree ref;
+	ref.set_root (make_state (9, "Renamed"));
+	CPPUNIT_ASSERT (ref.write (ref_path));
+	CPPUNIT_ASSERT (file_contents (path) == file_contents (ref_path));
+
+	XMLTree back;
+	CPPUNIT_ASSERT (back.read (path));
+
+	::unlink (path.c_str ());
+	::unlink (ref_path.c_str ());
+}
+
+void
+StateWriterTest::testBackground ()
+{
+	string const path = Glib::build_filename (Glib::get_tmp_dir (), "state_writer_test.pending");
+	string const tmp_path = path + ".tmp";
+	string const ref_path = path + ".ref";
+
+	StateWriter writer;
+
+	for (int i = 1; i <= 20; ++i) {
+		writer.write_in_background (make_state (i), path, tmp_path);
+	}
+
+	writer.wait ();
+
+	/* the last write must have won */
+	XMLTree ref;
+	ref.set_root (make_state (20));
+	CPPUNIT_ASSERT (ref.write (ref_path));
+	CPPUNIT_ASSERT (file_contents (path) == file_contents (ref_path));
+
+	::unlink (path.c_str ());
+	::unlink (ref_path.c_str ());
+}
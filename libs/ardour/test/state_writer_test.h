@@ -0,0 +1,16 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class StateWriterTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (StateWriterTest);
+	CPPUNIT_TEST (testWrite);
+	CPPUNIT_TEST (testIncremental);
+	CPPUNIT_TEST (testBackground);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void testWrite ();
+	void testIncremental ();
+	void testBackground ();
+};
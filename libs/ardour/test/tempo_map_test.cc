@@ -0,0 +1,128 @@
+#include <iostream>
+#include <sys/time.h>
+#include "ardour/tempo.h"
+#include "tempo_map_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (TempoMapTest);
+
+using namespace std;
+using namespace ARDOUR;
+using Timecode::BBT_Time;
+
+/** Make a map with a tempo change on every nth bar, alternating between 120 and 90 bpm */
+static void
+add_tempos (TempoMap& map, int count, int n)
+{
+	for (int i = 1; i <= count; ++i) {
+		map.add_tempo (Tempo (i % 2 ? 90 : 120), BBT_Time (1 + i * n, 1, 0));
+	}
+}
+
+void
+TempoMapTest::metricTest ()
+{
+	TempoMap map (48000);
+	add_tempos (map, 100, 4);
+
+	CPPUNIT_ASSERT_EQUAL (101, map.n_tempos ());
+
+	/* 4 bars of 4/4 at 120bpm is 8 seconds, at 90bpm it is 10.667 seconds */
+	framepos_t const first = 8 * 48000;
+	framepos_t const second = first + (framepos_t) (4 * 4 * 60 * 48000 / 90.0);
+
+	CPPUNIT_ASSERT_EQUAL (120.0, map.tempo_at (first - 1).beats_per_minute ());
+	CPPUNIT_ASSERT_EQUAL (90.0, map.tempo_at (first).beats_per_minute ());
+	CPPUNIT_ASSERT_EQUAL (first, map.tempo_section_at (second - 1).frame ());
+	CPPUNIT_ASSERT_EQUAL (120.0, map.tempo_at (second).beats_per_minute ());
+
+	BBT_Time bbt;
+	map.bbt_time (second, bbt);
+	CPPUNIT_ASSERT (bbt == BBT_Time (9, 1, 0));
+	CPPUNIT_ASSERT_EQUAL (second, map.frame_time (BBT_Time (9, 1, 0)));
+
+	TempoMetric m = map.metric_at (BBT_Time (8, 3, 0));
+	CPPUNIT_ASSERT_EQUAL (first, m.frame ());
+	CPPUNIT_ASSERT (m.start () == BBT_Time (5, 1, 0));
+}
+
+void
+TempoMapTest::pointsTest ()
+{
+	TempoMap map (48000);
+	add_tempos (map, 20, 2);
+
+	TempoMap::BBTPointList* points = map.get_points (12345, 48000 * 60);
+
+	/* filling a caller's list gives the same result, and reuses its storage */
+	TempoMap::BBTPointList mine;
+	mine.reserve (points->size ());
+	TempoMap::BBTPoint const * storage = &mine[0];
+
+	map.get_points (mine, 12345, 48000 * 60);
+	CPPUNIT_ASSERT_EQUAL (points->size (), mine.size ());
+	CPPUNIT_ASSERT_EQUAL (storage, (TempoMap::BBTPoint const *) &mine[0]);
+
+	for (size_t i = 0; i < mine.size (); ++i) {
+		CPPUNIT_ASSERT_EQUAL ((*points)[i].frame, mine[i].frame);
+		CPPUNIT_ASSERT_EQUAL ((*points)[i].bar, mine[i].bar);
+		CPPUNIT_ASSERT_EQUAL ((*points)[i].beat, mine[i].beat);
+	}
+
+	/* and the list is cleared first */
+	map.get_points (mine, 0, 1);
+	CPPUNIT_ASSERT_EQUAL ((size_t) 2, mine.size ());
+
+	delete points;
+}
+
+void
+TempoMapTest::walkTest ()
+{
+	TempoMap map (48000);
+	add_tempos (map, 50, 1);
+
+	/* walking across many tempo changes gives the same answer as
+	   converting the endpoints
+	*/
+	for (uint32_t beats = 0; beats < 200; beats += 7) {
+		framepos_t const end = map.framepos_plus_bbt (0, BBT_Time (0, beats, 0));
+		CPPUNIT_ASSERT_EQUAL (end, map.frame_time (BBT_Time (1 + beats / 4, 1 + beats % 4, 0)));
+		CPPUNIT_ASSERT_DOUBLES_EQUAL ((double) beats, map.framewalk_to_beats (0, end), 1e-6);
+	}
+}
+
+void
+TempoMapTest::benchmark ()
+{
+	TempoMap map (48000);
+	add_tempos (map, 500, 2);
+
+	int const n = 20000;
+	double sum = 0;
+
+	struct timeval a, b;
+	gettimeofday (&a, 0);
+
+	for (int i = 0; i < n; ++i) {
+		BBT_Time bbt;
+		map.bbt_time ((i * 7919LL) % (48000LL * 1800), bbt);
+		sum += map.frame_time (bbt);
+	}
+
+	gettimeofday (&b, 0);
+	double const conversion = ((b.tv_sec - a.tv_sec) * 1e6 + (b.tv_usec - a.tv_usec)) / n;
+
+	gettimeofday (&a, 0);
+
+	for (int i = 0; i < n; ++i) {
+		sum += map.framewalk_to_beats ((i * 7919LL) % (48000LL * 1800), 48000);
+	}
+
+	gettimeofday (&b, 0);
+	double const walk = ((b.tv_sec - a.tv_sec) * 1e6 + (b.tv_usec - a.tv_usec)) / n;
+
+	cerr << "\nusecs per call with 500 tempo changes: bbt_time + frame_time " << conversion
+	     << ", framewalk_to_beats " << walk << "\n";
+
+	CPPUNIT_ASSERT (sum > 0);
+}
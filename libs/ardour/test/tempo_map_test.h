@@ -0,0 +1,18 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class TempoMapTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (TempoMapTest);
+	CPPUNIT_TEST (metricTest);
+	CPPUNIT_TEST (pointsTest);
+	CPPUNIT_TEST (walkTest);
+	CPPUNIT_TEST (benchmark);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void metricTest ();
+	void pointsTest ();
+	void walkTest ();
+	void benchmark ();
+};
@@ -0,0 +1,195 @@
+/*
+    Copyright (C) 2011 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+/* This file is compiled with -mavx, and nothing in it may be called
+   unless PBD::FPU::has_avx() says so.
+
+   Buffers are only guaranteed to be 16 byte aligned, so all loads and
+   stores are unaligned ones; on AVX hardware these cost nothing extra
+   when the data happen to be aligned.  Products and sums are computed
+   separately rather than fused (and the file is built with
+   -ffp-contract=off so that the compiler does not fuse them either),
+   so that the results are bit-for-bit those of the default_* functions.
+*/
+
+#include <cmath>
+#include <immintrin.h>
+
+#include "ardour/mix.h"
+
+using namespace ARDOUR;
+
+static inline float
+hmax (__m256 v)
+{
+	__m128 m = _mm_max_ps (_mm256_castps256_ps128 (v), _mm256_extractf128_ps (v, 1));
+	m = _mm_max_ps (m, _mm_movehl_ps (m, m));
+	m = _mm_max_ss (m, _mm_shuffle_ps (m, m, _MM_SHUFFLE (1, 1, 1, 1)));
+	return _mm_cvtss_f32 (m);
+}
+
+static inline float
+hmin (__m256 v)
+{
+	__m128 m = _mm_min_ps (_mm256_castps256_ps128 (v), _mm256_extractf128_ps (v, 1));
+	m = _mm_min_ps (m, _mm_movehl_ps (m, m));
+	m = _mm_min_ss (m, _mm_shuffle_ps (m, m, _MM_SHUFFLE (1, 1, 1, 1)));
+	return _mm_cvtss_f32 (m);
+}
+
+float
+x86_avx_compute_peak (const Sample * buf, pframes_t nsamples, float current)
+{
+	__m256 const abs_mask = _mm256_castsi256_ps (_mm256_set1_epi32 (0x7fffffff));
+	__m256 peak0 = _mm256_set1_ps (current);
+	__m256 peak1 = peak0;
+
+	/* two accumulators to hide the latency of vmaxps */
+
+	for (; nsamples >= 16; nsamples -= 16, buf += 16) {
+		peak0 = _mm256_max_ps (peak0, _mm256_and_ps (_mm256_loadu_ps (buf), abs_mask));
+		peak1 = _mm256_max_ps (peak1, _mm256_and_ps (_mm256_loadu_ps (buf + 8), abs_mask));
+	}
+
+	if (nsamples >= 8) {
+		peak0 = _mm256_max_ps (peak0, _mm256_and_ps (_mm256_loadu_ps (buf), abs_mask));
+		nsamples -= 8;
+		buf += 8;
+	}
+
+	current = hmax (_mm256_max_ps (peak0, peak1));
+
+	for (; nsamples > 0; --nsamples, ++buf) {
+		float const a = fabsf (*buf);
+		if (a > current) {
+			current = a;
+		}
+	}
+
+	return current;
+}
+
+void
+x86_avx_find_peaks (const Sample * buf, pframes_t nframes, float *min, float *max)
+{
+	__m256 vmin = _mm256_set1_ps (*min);
+	__m256 vmax = _mm256_set1_ps (*max);
+
+	for (; nframes >= 16; nframes -= 16, buf += 16) {
+		__m256 const a = _mm256_loadu_ps (buf);
+		__m256 const b = _mm256_loadu_ps (buf + 8);
+		vmin = _mm256_min_ps (vmin, _mm256_min_ps (a, b));
+		vmax = _mm256_max_ps (vmax, _mm256_max_ps (a, b));
+	}
+
+	if (nframes >= 8) {
+		__m256 const a = _mm256_loadu_ps (buf);
+		vmin = _mm256_min_ps (vmin, a);
+		vmax = _mm256_max_ps (vmax, a);
+		nframes -= 8;
+		buf += 8;
+	}
+
+	float lo = hmin (vmin);
+	float hi = hmax (vmax);
+
+	for (; nframes > 0; --nframes, ++buf) {
+		if (*buf < lo) {
+			lo = *buf;
+		}
+		if (*buf > hi) {
+			hi = *buf;
+		}
+	}
+
+	*min = lo;
+	*max = hi;
+}
+
+void
+x86_avx_apply_gain_to_buffer (Sample * buf, pframes_t nframes, float gain)
+{
+	__m256 const g = _mm256_set1_ps (gain);
+
+	for (; nframes >= 8; nframes -= 8, buf += 8) {
+		_mm256_storeu_ps (buf, _mm256_mul_ps (_mm256_loadu_ps (buf), g));
+	}
+
+	for (; nframes > 0; --nframes, ++buf) {
+		*buf *= gain;
+	}
+}
+
+void
+x86_avx_mix_buffers_with_gain (Sample * dst, const Sample * src, pframes_t nframes, float gain)
+{
+	__m256 const g = _mm256_set1_ps (gain);
+
+	for (; nframes >= 8; nframes -= 8, dst += 8, src += 8) {
+		__m256 const s = _mm256_mul_ps (_mm256_loadu_ps (src), g);
+		_mm256_storeu_ps (dst, _mm256_add_ps (_mm256_loadu_ps (dst), s));
+	}
+
+	for (; nframes > 0; --nframes, ++dst, ++src) {
+		*dst += *src * gain;
+	}
+}
+
+void
+x86_avx_mix_buffers_no_gain (Sample * dst, const Sample * src, pframes_t nframes)
+{
+	for (; nframes >= 8; nframes -= 8, dst += 8, src += 8) {
+		_mm256_storeu_ps (dst, _mm256_add_ps (_mm256_loadu_ps (dst), _mm256_loadu_ps (src)));
+	}
+
+	for (; nframes > 0; --nframes, ++dst, ++src) {
+		*dst += *src;
+	}
+}
+
+void
+x86_avx_apply_gain_vector_to_buffer (Sample * buf, const gain_t * gain, pframes_t nframes, float scale)
+{
+	__m256 const s = _mm256_set1_ps (scale);
+
+	for (; nframes >= 8; nframes -= 8, buf += 8, gain += 8) {
+		__m256 const g = _mm256_mul_ps (_mm256_loadu_ps (gain), s);
+		_mm256_storeu_ps (buf, _mm256_mul_ps (_mm256_loadu_ps (buf), g));
+	}
+
+	for (; nframes > 0; --nframes, ++buf, ++gain) {
+		*buf *= *gain * scale;
+	}
+}
+
+void
+x86_avx_mix_buffers_with_gain_vector (Sample * dst, const Sample * src, const gain_t * gain, pframes_t nframes, float scale)
+{
+	__m256 const s = _mm256_set1_ps (scale);
+
+	for (; nframes >= 8; nframes -= 8, dst += 8, src += 8, gain += 8) {
+		__m256 const g = _mm256_mul_ps (_mm256_loadu_ps (gain), s);
+		__m256 const x = _mm256_mul_ps (_mm256_loadu_ps (src), g);
+		_mm256_storeu_ps (dst, _mm256_add_ps (_mm256_loadu_ps (dst), x));
+	}
+
+	for (; nframes > 0; --nframes, ++dst, ++src, ++gain) {
+		*dst += *src * (*gain * scale);
+	}
+}
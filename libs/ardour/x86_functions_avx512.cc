@@ -0,0 +1,204 @@
+/*
+    Copyright (C) 2011 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+/* This file is compiled with -mavx512f, and nothing in it may be called
+   unless PBD::FPU::has_avx512f() says so.
+
+   As in x86_functions_avx.cc, loads and stores are unaligned and
+   products are not fused, which matters here since AVX-512F has FMA.
+   The last partial vector of each buffer is handled with a masked
+   load/store rather than a scalar loop.
+*/
+
+#include <immintrin.h>
+
+#include "ardour/mix.h"
+
+using namespace ARDOUR;
+
+static inline __mmask16
+tail_mask (pframes_t n)
+{
+	return (__mmask16) ((1U << n) - 1);
+}
+
+static inline float
+hmax (__m512 v)
+{
+	float f[16];
+	_mm512_storeu_ps (f, v);
+
+	float m = f[0];
+	for (int i = 1; i < 16; ++i) {
+		if (f[i] > m) {
+			m = f[i];
+		}
+	}
+	return m;
+}
+
+static inline float
+hmin (__m512 v)
+{
+	float f[16];
+	_mm512_storeu_ps (f, v);
+
+	float m = f[0];
+	for (int i = 1; i < 16; ++i) {
+		if (f[i] < m) {
+			m = f[i];
+		}
+	}
+	return m;
+}
+
+static inline __m512
+abs_ps (__m512 v)
+{
+	return _mm512_castsi512_ps (_mm512_and_epi32 (_mm512_castps_si512 (v), _mm512_set1_epi32 (0x7fffffff)));
+}
+
+float
+x86_avx512f_compute_peak (const Sample * buf, pframes_t nsamples, float current)
+{
+	__m512 peak0 = _mm512_set1_ps (current);
+	__m512 peak1 = peak0;
+
+	for (; nsamples >= 32; nsamples -= 32, buf += 32) {
+		peak0 = _mm512_max_ps (peak0, abs_ps (_mm512_loadu_ps (buf)));
+		peak1 = _mm512_max_ps (peak1, abs_ps (_mm512_loadu_ps (buf + 16)));
+	}
+
+	if (nsamples >= 16) {
+		peak0 = _mm512_max_ps (peak0, abs_ps (_mm512_loadu_ps (buf)));
+		nsamples -= 16;
+		buf += 16;
+	}
+
+	if (nsamples) {
+		/* masked-off lanes keep their previous value */
+		peak1 = _mm512_mask_max_ps (peak1, tail_mask (nsamples), peak1, abs_ps (_mm512_maskz_loadu_ps (tail_mask (nsamples), buf)));
+	}
+
+	return hmax (_mm512_max_ps (peak0, peak1));
+}
+
+void
+x86_avx512f_find_peaks (const Sample * buf, pframes_t nframes, float *min, float *max)
+{
+	__m512 vmin = _mm512_set1_ps (*min);
+	__m512 vmax = _mm512_set1_ps (*max);
+
+	for (; nframes >= 16; nframes -= 16, buf += 16) {
+		__m512 const a = _mm512_loadu_ps (buf);
+		vmin = _mm512_min_ps (vmin, a);
+		vmax = _mm512_max_ps (vmax, a);
+	}
+
+	if (nframes) {
+		__mmask16 const m = tail_mask (nframes);
+		__m512 const a = _mm512_maskz_loadu_ps (m, buf);
+		vmin = _mm512_mask_min_ps (vmin, m, vmin, a);
+		vmax = _mm512_mask_max_ps (vmax, m, vmax, a);
+	}
+
+	*min = hmin (vmin);
+	*max = hmax (vmax);
+}
+
+void
+x86_avx512f_apply_gain_to_buffer (Sample * buf, pframes_t nframes, float gain)
+{
+	__m512 const g = _mm512_set1_ps (gain);
+
+	for (; nframes >= 16; nframes -= 16, buf += 16) {
+		_mm512_storeu_ps (buf, _mm512_mul_ps (_mm512_loadu_ps (buf), g));
+	}
+
+	if (nframes) {
+		__mmask16 const m = tail_mask (nframes);
+		_mm512_mask_storeu_ps (buf, m, _mm512_mul_ps (_mm512_maskz_loadu_ps (m, buf), g));
+	}
+}
+
+void
+x86_avx512f_mix_buffers_with_gain (Sample * dst, const Sample * src, pframes_t nframes, float gain)
+{
+	__m512 const g = _mm512_set1_ps (gain);
+
+	for (; nframes >= 16; nframes -= 16, dst += 16, src += 16) {
+		__m512 const s = _mm512_mul_ps (_mm512_loadu_ps (src), g);
+		_mm512_storeu_ps (dst, _mm512_add_ps (_mm512_loadu_ps (dst), s));
+	}
+
+	if (nframes) {
+		__mmask16 const m = tail_mask (nframes);
+		__m512 const s = _mm512_mul_ps (_mm512_maskz_loadu_ps (m, src), g);
+		_mm512_mask_storeu_ps (dst, m, _mm512_add_ps (_mm512_maskz_loadu_ps (m, dst), s));
+	}
+}
+
+void
+x86_avx512f_mix_buffers_no_gain (Sample * dst, const Sample * src, pframes_t nframes)
+{
+	for (; nframes >= 16; nframes -= 16, dst += 16, src += 16) {
+		_mm512_storeu_ps (dst, _mm512_add_ps (_mm512_loadu_ps (dst), _mm512_loadu_ps (src)));
+	}
+
+	if (nframes) {
+		__mmask16 const m = tail_mask (nframes);
+		_mm512_mask_storeu_ps (dst, m, _mm512_add_ps (_mm512_maskz_loadu_ps (m, dst), _mm512_maskz_loadu_ps (m, src)));
+	}
+}
+
+void
+x86_avx512f_apply_gain_vector_to_buffer (Sample * buf, const gain_t * gain, pframes_t nframes, float scale)
+{
+	__m512 const s = _mm512_set1_ps (scale);
+
+	for (; nframes >= 16; nframes -= 16, buf += 16, gain += 16) {
+		__m512 const g = _mm512_mul_ps (_mm512_loadu_ps (gain), s);
+		_mm512_storeu_ps (buf, _mm512_mul_ps (_mm512_loadu_ps (buf), g));
+	}
+
+	if (nframes) {
+		__mmask16 const m = tail_mask (nframes);
+		__m512 const g = _mm512_mul_ps (_mm512_maskz_loadu_ps (m, gain), s);
+		_mm512_mask_storeu_ps (buf, m, _mm512_mul_ps (_mm512_maskz_loadu_ps (m, buf), g));
+	}
+}
+
+void
+x86_avx512f_mix_buffers_with_gain_vector (Sample * dst, const Sample * src, const gain_t * gain, pframes_t nframes, float scale)
+{
+	__m512 const s = _mm512_set1_ps (scale);
+
+	for (; nframes >= 16; nframes -= 16, dst += 16, src += 16, gain += 16) {
+		__m512 const g = _mm512_mul_ps (_mm512_loadu_ps (gain), s);
+		__m512 const x = _mm512_mul_ps (_mm512_loadu_ps (src), g);
+		_mm512_storeu_ps (dst, _mm512_add_ps (_mm512_loadu_ps (dst), x));
+	}
+
+	if (nframes) {
+		__mmask16 const m = tail_mask (nframes);
+		__m512 const g = _mm512_mul_ps (_mm512_maskz_loadu_ps (m, gain), s);
+		__m512 const x = _mm512_mul_ps (_mm512_maskz_loadu_ps (m, src), g);
+		_mm512_mask_storeu_ps (dst, m, _mm512_add_ps (_mm512_maskz_loadu_ps (m, dst), x));
+	}
+}
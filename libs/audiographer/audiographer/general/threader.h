@@ -1,13 +1,14 @@
 #ifndef AUDIOGRAPHER_THREADER_H
 #define AUDIOGRAPHER_THREADER_H
 
-#include <glibmm/threadpool.h>
-#include <sigc++/slot.h>
+#include <glibmm/thread.h>
+#include <sigc++/bind.h>
 #include <boost/format.hpp>
 
 #include <glib.h>
 #include <vector>
 #include <algorithm>
+#include <cstring>
 
 #include "audiographer/source.h"
 #include "audiographer/sink.h"
@@ -29,100 +30,295 @@ class ThreaderException : public Exception
 	{ }
 };
 
-/// Class for distributing processing across several threads
+/** Class for distributing processing across several threads.
+  * Each output is processed in a thread of its own, which runs for as long as
+  * the output is connected. Processed data is copied to a ring of chunks, which
+  * every output's thread reads at its own pace, so process() only waits if the
+  * slowest output falls a whole ring behind, or at the end of input.
+  */
 template <typename T = DefaultSampleType>
 class Threader : public Source<T>, public Sink<T>
 {
   private:
-	typedef std::vector<typename Source<T>::SinkPtr> OutputVec;
+	class Branch;
+	typedef std::vector<Branch *> BranchVec;
 
   public:
-	
+
 	/** Constructor
-	  * \n RT safe
-	  * \param thread_pool a thread pool from which all tasks are scheduled
-	  * \param wait_timeout_milliseconds maximum time allowed for threads to use in processing
+	  * \n Not RT safe
+	  * \param queue_size number of chunks an output may be behind before process() waits for it
+	  * \param wait_timeout_milliseconds maximum time allowed for the outputs to make progress while process() waits
 	  */
-	Threader (Glib::ThreadPool & thread_pool, long wait_timeout_milliseconds = 1000)
-	  : thread_pool (thread_pool)
-	  , readers (0)
+	Threader (unsigned int queue_size = 8, long wait_timeout_milliseconds = 1000)
+	  : chunks (std::max (queue_size, 1U))
+	  , write_position (0)
+	  , readers_waiting (0)
+	  , writer_waiting (0)
 	  , wait_timeout (wait_timeout_milliseconds)
 	{ }
-	
-	virtual ~Threader () {}
-	
-	/// Adds output \n RT safe
-	void add_output (typename Source<T>::SinkPtr output) { outputs.push_back (output); }
-	
-	/// Clears outputs \n RT safe
-	void clear_outputs () { outputs.clear (); }
-	
-	/// Removes a specific output \n RT safe
-	void remove_output (typename Source<T>::SinkPtr output) {
-		typename OutputVec::iterator new_end = std::remove(outputs.begin(), outputs.end(), output);
-		outputs.erase (new_end, outputs.end());
+
+	/// Waits for the outputs to process everything, and stops their threads
+	virtual ~Threader ()
+	{
+		for (typename BranchVec::iterator it = branches.begin(); it != branches.end(); ++it) {
+			stop (*it);
+		}
+	}
+
+	/// Adds output and starts a thread for it \n Not RT safe
+	void add_output (typename Source<T>::SinkPtr output)
+	{
+		wait_until_queued (0);
+		branches.push_back (new Branch (*this, output));
+	}
+
+	/// Clears outputs, after they have processed everything \n Not RT safe
+	void clear_outputs ()
+	{
+		wait_until_queued (0);
+		for (typename BranchVec::iterator it = branches.begin(); it != branches.end(); ++it) {
+			stop (*it);
+		}
+		branches.clear ();
+	}
+
+	/// Removes a specific output, after it has processed everything \n Not RT safe
+	void remove_output (typename Source<T>::SinkPtr output)
+	{
+		wait_until_queued (0);
+		for (typename BranchVec::iterator it = branches.begin(); it != branches.end(); ) {
+			if ((*it)->output == output) {
+				stop (*it);
+				it = branches.erase (it);
+			} else {
+				++it;
+			}
+		}
 	}
-	
-	/// Processes context concurrently by scheduling each output separately to the given thread pool
+
+	/** Passes context to all outputs, to be processed concurrently in their own threads.
+	  * Returns once the data has been copied, unless the context has the EndOfInput flag,
+	  * in which case it returns when all outputs have processed it.
+	  * Exceptions thrown by outputs are passed on by the following call of process() or wait().
+	  */
 	void process (ProcessContext<T> const & c)
 	{
-		wait_mutex.lock();
-		
-		exception.reset();
-		
-		unsigned int outs = outputs.size();
-		g_atomic_int_add (&readers, outs);
-		for (unsigned int i = 0; i < outs; ++i) {
-			thread_pool.push (sigc::bind (sigc::mem_fun (this, &Threader::process_output), c, i));
-		}
-		
-		wait();
+		throw_exception ();
+
+		if (branches.empty()) {
+			return;
+		}
+
+		/* wait until the chunk we are about to write has been processed by every output */
+
+		wait_until_queued (chunks.size() - 1);
+
+		Chunk & chunk = chunks[(guint) write_position % chunks.size()];
+		chunk.assign (c);
+
+		g_atomic_int_inc (&write_position);
+
+		if (g_atomic_int_get (&readers_waiting)) {
+			Glib::Mutex::Lock lm (wait_mutex);
+			data_cond.broadcast ();
+		}
+
+		if (c.has_flag (ProcessContext<T>::EndOfInput)) {
+			wait ();
+		}
 	}
-	
+
 	using Sink<T>::process;
-	
+
+	/// Waits until all outputs have processed everything passed so far
+	void wait ()
+	{
+		wait_until_queued (0);
+		throw_exception ();
+	}
+
   private:
 
-	void wait()
+	/// A copy of a processed context
+	struct Chunk
+	{
+		Chunk () : data (0), capacity (0), frames (0), channels (1) {}
+		~Chunk () { delete [] data; }
+
+		void assign (ProcessContext<T> const & c)
+		{
+			if (capacity < c.frames()) {
+				delete [] data;
+				data = new T[c.frames()];
+				capacity = c.frames();
+			}
+			memcpy (data, c.data(), c.frames() * sizeof (T));
+			frames = c.frames();
+			channels = c.channels();
+			flags = c.flags();
+		}
+
+		T *          data;
+		framecnt_t   capacity;
+		framecnt_t   frames;
+		ChannelCount channels;
+		FlagField    flags;
+	};
+
+	/// An output, and the thread which processes it
+	class Branch
+	{
+	  public:
+		Branch (Threader & parent, typename Source<T>::SinkPtr output)
+		  : output (output)
+		  , read_position (g_atomic_int_get (&parent.write_position))
+		  , quit (false)
+		{
+			thread = Glib::Thread::create (sigc::bind (sigc::mem_fun (parent, &Threader::run), this), true);
+		}
+
+		typename Source<T>::SinkPtr output;
+		Glib::Thread * thread;
+		gint           read_position; ///< number of chunks processed
+		bool           quit;          ///< protected by wait_mutex
+	};
+
+	/// Number of chunks which \a branch has still to process
+	guint queued (Branch const * branch) const
+	{
+		return (guint) g_atomic_int_get (&write_position) - (guint) g_atomic_int_get (&branch->read_position);
+	}
+
+	/// Number of chunks which the slowest output has still to process
+	guint max_queued () const
 	{
-		Glib::TimeVal wait_time;
-		wait_time.assign_current_time();
-		wait_time.add_milliseconds(wait_timeout);
-		
-		wait_cond.timed_wait(wait_mutex, wait_time);
-		bool timed_out = (g_atomic_int_get (&readers) != 0);
-		wait_mutex.unlock();
+		guint ret = 0;
+		for (typename BranchVec::const_iterator it = branches.begin(); it != branches.end(); ++it) {
+			ret = std::max (ret, queued (*it));
+		}
+		return ret;
+	}
+
+	/// Waits until the slowest output has at most \a chunks_queued chunks to process
+	void wait_until_queued (guint chunks_queued)
+	{
+		if (max_queued () <= chunks_queued) {
+			return;
+		}
+
+		Glib::Mutex::Lock lm (wait_mutex);
+		g_atomic_int_inc (&writer_waiting);
+
+		// Look again now that the outputs can see we are waiting;
+		// one which caught up before that would not have woken us
+
+		guint left = max_queued ();
+
+		bool timed_out = false;
+		while (!timed_out && left > chunks_queued) {
+
+			// The timeout only applies while the outputs make no progress
+
+			Glib::TimeVal wait_time;
+			wait_time.assign_current_time();
+			wait_time.add_milliseconds(wait_timeout);
+
+			guint const before = left;
+			while (left == before) {
+				if (!space_cond.timed_wait (wait_mutex, wait_time)) {
+					timed_out = ((left = max_queued ()) == before);
+					break;
+				}
+				left = max_queued ();
+			}
+		}
+
+		g_atomic_int_add (&writer_waiting, -1);
+
 		if (timed_out) { throw Exception (*this, "wait timed out"); }
-		
-		if (exception) {
-			throw *exception;
+	}
+
+	void run (Branch * branch)
+	{
+		while (true) {
+
+			if (queued (branch) == 0) {
+				Glib::Mutex::Lock lm (wait_mutex);
+				g_atomic_int_inc (&readers_waiting);
+				while (queued (branch) == 0 && !branch->quit) {
+					data_cond.wait (wait_mutex);
+				}
+				g_atomic_int_add (&readers_waiting, -1);
+				if (queued (branch) == 0) {
+					break;
+				}
+			}
+
+			Chunk const & chunk = chunks[(guint) g_atomic_int_get (&branch->read_position) % chunks.size()];
+			process_output (branch, chunk);
+
+			g_atomic_int_inc (&branch->read_position);
+
+			if (g_atomic_int_get (&writer_waiting)) {
+				Glib::Mutex::Lock lm (wait_mutex);
+				space_cond.broadcast ();
+			}
 		}
 	}
-	
-	void process_output(ProcessContext<T> const & c, unsigned int output)
+
+	void process_output (Branch * branch, Chunk const & chunk)
 	{
+		ProcessContext<T> c (chunk.data, chunk.frames, chunk.channels);
+		for (FlagField::iterator it = chunk.flags.begin(); it < chunk.flags.end(); ++it) {
+			c.set_flag (*it);
+		}
+
 		try {
-			outputs[output]->process (c);
+			branch->output->process (static_cast<ProcessContext<T> const &> (c));
 		} catch (std::exception const & e) {
 			// Only first exception will be passed on
 			exception_mutex.lock();
 			if(!exception) { exception.reset (new ThreaderException (*this, e)); }
 			exception_mutex.unlock();
 		}
-		
-		if (g_atomic_int_dec_and_test (&readers)) {
-			wait_cond.signal();
+	}
+
+	/// Lets \a branch finish what it has queued, then joins its thread and deletes it
+	void stop (Branch * branch)
+	{
+		{
+			Glib::Mutex::Lock lm (wait_mutex);
+			branch->quit = true;
+			data_cond.broadcast ();
+		}
+		branch->thread->join ();
+		delete branch;
+	}
+
+	void throw_exception ()
+	{
+		exception_mutex.lock();
+		boost::shared_ptr<ThreaderException> e = exception;
+		exception.reset();
+		exception_mutex.unlock();
+
+		if (e) {
+			throw *e;
 		}
 	}
 
-	OutputVec outputs;
+	BranchVec          branches;
+	std::vector<Chunk> chunks;
+	gint               write_position; ///< number of chunks written
 
-	Glib::ThreadPool & thread_pool;
 	Glib::Mutex wait_mutex;
-	Glib::Cond  wait_cond;
-	gint        readers;
+	Glib::Cond  data_cond;       ///< signalled when a chunk has been written
+	Glib::Cond  space_cond;      ///< signalled when a chunk has been processed
+	gint        readers_waiting; ///< branches waiting on data_cond
+	gint        writer_waiting;  ///< non-zero while process() waits on space_cond
 	long        wait_timeout;
-	
+
 	Glib::Mutex exception_mutex;
 	boost::shared_ptr<ThreaderException> exception;
 
@@ -130,4 +326,4 @@ class Threader : public Source<T>, public Sink<T>
 
 } // namespace
 
-#endif //AUDIOGRAPHER_THREADER_H
\ No newline at end of file
+#endif //AUDIOGRAPHER_THREADER_H
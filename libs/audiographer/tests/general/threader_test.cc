@@ -11,6 +11,7 @@ class ThreaderTest : public CppUnit::TestFixture
   CPPUNIT_TEST (testRemoveOutput);
   CPPUNIT_TEST (testClearOutputs);
   CPPUNIT_TEST (testExceptions);
+  CPPUNIT_TEST (testEndOfInput);
   CPPUNIT_TEST_SUITE_END ();
 
   public:
@@ -22,8 +23,7 @@ class ThreaderTest : public CppUnit::TestFixture
 		zero_data = new float[frames];
 		memset (zero_data, 0, frames * sizeof(float));
 		
-		thread_pool = new Glib::ThreadPool (3);
-		threader.reset (new Threader<float> (*thread_pool));
+		threader.reset (new Threader<float> ());
 		
 		sink_a.reset (new VectorSink<float>());
 		sink_b.reset (new VectorSink<float>());
@@ -40,8 +40,7 @@ class ThreaderTest : public CppUnit::TestFixture
 		delete [] random_data;
 		delete [] zero_data;
 		
-		thread_pool->shutdown();
-		delete thread_pool;
+		threader.reset ();
 	}
 
 	void testProcess()
@@ -55,6 +54,7 @@ class ThreaderTest : public CppUnit::TestFixture
 		
 		ProcessContext<float> c (random_data, frames, 1);
 		threader->process (c);
+		threader->wait ();
 		
 		CPPUNIT_ASSERT (TestUtils::array_equals(random_data, sink_a->get_array(), frames));
 		CPPUNIT_ASSERT (TestUtils::array_equals(random_data, sink_b->get_array(), frames));
@@ -83,6 +83,7 @@ class ThreaderTest : public CppUnit::TestFixture
 		
 		ProcessContext<float> zc (zero_data, frames, 1);
 		threader->process (zc);
+		threader->wait ();
 		
 		CPPUNIT_ASSERT (TestUtils::array_equals(random_data, sink_a->get_array(), frames));
 		CPPUNIT_ASSERT (TestUtils::array_equals(random_data, sink_b->get_array(), frames));
@@ -107,6 +108,7 @@ class ThreaderTest : public CppUnit::TestFixture
 		threader->clear_outputs();
 		ProcessContext<float> zc (zero_data, frames, 1);
 		threader->process (zc);
+		threader->wait ();
 		
 		CPPUNIT_ASSERT (TestUtils::array_equals(random_data, sink_a->get_array(), frames));
 		CPPUNIT_ASSERT (TestUtils::array_equals(random_data, sink_b->get_array(), frames));
@@ -126,17 +128,42 @@ class ThreaderTest : public CppUnit::TestFixture
 		threader->add_output (throwing_sink);
 		
 		ProcessContext<float> c (random_data, frames, 1);
-		CPPUNIT_ASSERT_THROW (threader->process (c), Exception);
+		threader->process (c);
+		CPPUNIT_ASSERT_THROW (threader->wait (), Exception);
 		
 		CPPUNIT_ASSERT (TestUtils::array_equals(random_data, sink_a->get_array(), frames));
 		CPPUNIT_ASSERT (TestUtils::array_equals(random_data, sink_b->get_array(), frames));
 		CPPUNIT_ASSERT (TestUtils::array_equals(random_data, sink_c->get_array(), frames));
 		CPPUNIT_ASSERT (TestUtils::array_equals(random_data, sink_e->get_array(), frames));
 	}
+	
+	void testEndOfInput()
+	{
+		// Queue fewer chunks than are processed, so that process() has to wait
+		threader.reset (new Threader<float> (2));
+		
+		boost::shared_ptr<AppendingVectorSink<float> > sink_1 (new AppendingVectorSink<float>());
+		boost::shared_ptr<AppendingVectorSink<float> > sink_2 (new AppendingVectorSink<float>());
+		sink_1->reset ();
+		sink_2->reset ();
+		threader->add_output (sink_1);
+		threader->add_output (sink_2);
+		
+		framecnt_t const chunk = frames / 8;
+		for (framecnt_t i = 0; i < frames; i += chunk) {
+			ProcessContext<float> c (random_data + i, chunk, 1);
+			if (i + chunk == frames) { c.set_flag (ProcessContext<float>::EndOfInput); }
+			threader->process (c);
+		}
+		
+		// All data has been processed once the last chunk has been
+		CPPUNIT_ASSERT_EQUAL (frames, (framecnt_t) sink_1->get_data().size());
+		CPPUNIT_ASSERT_EQUAL (frames, (framecnt_t) sink_2->get_data().size());
+		CPPUNIT_ASSERT (TestUtils::array_equals(random_data, sink_1->get_array(), frames));
+		CPPUNIT_ASSERT (TestUtils::array_equals(random_data, sink_2->get_array(), frames));
+	}
 
   private:
-	Glib::ThreadPool * thread_pool;
-	
 	boost::shared_ptr<Threader<float> > threader;
 	boost::shared_ptr<VectorSink<float> > sink_a;
 	boost::shared_ptr<VectorSink<float> > sink_b;
@@ -21,6 +21,7 @@
 
 #include <cassert>
 #include <list>
+#include <vector>
 #include <boost/pool/pool.hpp>
 #include <boost/pool/pool_alloc.hpp>
 #include <glibmm/thread.h>
@@ -76,6 +77,10 @@ typedef boost::fast_pool_allocator<
 
 
 /** A list (sequence) of time-stamped values for a control
+ *
+ * Events are kept in a std::list, so iterators to them stay valid as the
+ * list is edited.  Lookups by time go through an index of those iterators,
+ * which is rebuilt on the first lookup after the list changes.
  */
 class ControlList
 {
@@ -208,6 +213,13 @@ public:
 	LookupCache& lookup_cache() const { return _lookup_cache; }
 	SearchCache& search_cache() const { return _search_cache; }
 
+	/* Lookups by time using the index; these must be called with the lock held */
+	const_iterator unlocked_lower_bound (double when) const;
+	const_iterator unlocked_upper_bound (double when) const;
+	iterator       unlocked_lower_bound (double when);
+	iterator       unlocked_upper_bound (double when);
+	EventList::size_type unlocked_size () const;
+
 	/** Called by locked entry point and various private
 	 * locations where we already hold the lock.
 	 *
@@ -253,6 +265,7 @@ protected:
 	double multipoint_eval (double x) const;
 
 	void build_search_cache_if_necessary (double start) const;
+	void build_index_if_necessary () const;
 
 	boost::shared_ptr<ControlList> cut_copy_clear (double, double, int op);
 	bool erase_range_internal (double start, double end, EventList &);
@@ -264,6 +277,15 @@ protected:
 	mutable LookupCache   _lookup_cache;
 	mutable SearchCache   _search_cache;
 
+	/** iterators to each of _events, in the same order, for binary searches.
+	 *  Anything that adds, removes or reorders events sets _index_dirty, and
+	 *  mark_dirty() or thaw() then rebuild the index with the lock held, so
+	 *  lookups never need to.
+	 */
+	typedef std::vector<iterator> EventIndex;
+	mutable EventIndex    _index;
+	mutable bool          _index_dirty;
+
 	Parameter             _parameter;
 	InterpolationStyle    _interpolation;
 	EventList             _events;
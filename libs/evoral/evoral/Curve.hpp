@@ -40,7 +40,6 @@ public:
 
 private:
 	double unlocked_eval (double where);
-	double multipoint_eval (double x);
 
 	void _get_vector (double x0, double x1, float *arg, int32_t veclen);
 
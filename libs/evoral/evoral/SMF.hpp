@@ -50,7 +50,8 @@ public:
 
 	const std::string& file_path() const { return _file_path; };
 
-	void seek_to_start() const;
+	void     seek_to_start() const;
+	uint64_t seek_to_time(uint64_t ticks) const;
 	int  seek_to_track(int track);
 
 	int read_event(uint32_t* delta_t, uint32_t* size, uint8_t** buf, event_id_t* note_id) const;
@@ -25,6 +25,7 @@
 #include <list>
 #include <utility>
 #include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
 #include <glibmm/thread.h>
 #include "evoral/types.hpp"
 #include "evoral/Note.hpp"
@@ -198,6 +199,12 @@ public:
 	inline       PatchChanges& patch_changes ()       { return _patch_changes; }
 	inline const PatchChanges& patch_changes () const { return _patch_changes; }
 
+	/* look up events by ID; these return 0 if there is no such event */
+
+	NotePtr note_by_id (event_id_t) const;
+	PatchChangePtr patch_change_by_id (event_id_t) const;
+	boost::shared_ptr<Event<Time> > sysex_by_id (event_id_t) const;
+
         void dump (std::ostream&) const;
 
 private:
@@ -322,6 +329,18 @@ private:
 	SysExes      _sysexes;
 	PatchChanges _patch_changes;
 
+	/* events indexed by ID, so that undo history can find them quickly when it is loaded */
+
+	typedef boost::unordered_map<event_id_t, NotePtr>                         NotesByID;
+	typedef boost::unordered_map<event_id_t, PatchChangePtr>                  PatchChangesByID;
+	typedef boost::unordered_map<event_id_t, boost::shared_ptr<Event<Time> > > SysExesByID;
+
+	NotesByID        _notes_by_id;
+	PatchChangesByID _patch_changes_by_id;
+	SysExesByID      _sysexes_by_id;
+
+	void erase_note_id (const constNotePtr);
+
 	typedef std::multiset<NotePtr, EarlierNoteComparator> WriteNotes;
 	WriteNotes _write_notes[16];
 
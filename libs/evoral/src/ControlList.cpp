@@ -34,6 +34,17 @@ inline bool event_time_less_than (ControlEvent* a, ControlEvent* b)
 }
 
 
+/** Compares a time with an event in the index */
+struct IndexTimeComparator {
+	bool operator() (ControlList::iterator const & a, double b) const {
+		return (*a)->when < b;
+	}
+	bool operator() (double a, ControlList::iterator const & b) const {
+		return a < (*b)->when;
+	}
+};
+
+
 ControlList::ControlList (const Parameter& id)
 	: _parameter(id)
 	, _interpolation(Linear)
@@ -50,6 +61,7 @@ ControlList::ControlList (const Parameter& id)
 	_search_cache.left = -1;
 	_search_cache.first = _events.end();
 	_sort_pending = false;
+	_index_dirty = false;
 }
 
 ControlList::ControlList (const ControlList& other)
@@ -66,6 +78,7 @@ ControlList::ControlList (const ControlList& other)
 	_lookup_cache.range.first = _events.end();
 	_search_cache.first = _events.end();
 	_sort_pending = false;
+	_index_dirty = true;
 
 	for (const_iterator i = other._events.begin(); i != other._events.end(); ++i) {
 		_events.push_back (new ControlEvent (**i));
@@ -88,6 +101,7 @@ ControlList::ControlList (const ControlList& other, double start, double end)
 	_lookup_cache.range.first = _events.end();
 	_search_cache.first = _events.end();
 	_sort_pending = false;
+	_index_dirty = true;
 
 	/* now grab the relevant points, and shift them back if necessary */
 
@@ -141,6 +155,7 @@ ControlList::operator= (const ControlList& other)
 			_events.push_back (new ControlEvent (**i));
 		}
 
+		_index_dirty = true;
 		_min_yval = other._min_yval;
 		_max_yval = other._max_yval;
 		_max_xval = other._max_xval;
@@ -182,6 +197,7 @@ ControlList::clear ()
 	{
 		Glib::Mutex::Lock lm (_lock);
 		_events.clear ();
+		_index_dirty = true;
 		mark_dirty ();
 	}
 
@@ -359,6 +375,9 @@ ControlList::merge_nascent (double when)
                                 _events.erase (range_begin, range_end);
                         }
 
+                        /* later nascent ranges must not look things up in the old index */
+                        _index_dirty = true;
+
                         delete ninfo;
                 }
 
@@ -367,6 +386,9 @@ ControlList::merge_nascent (double when)
                 if (writing()) {
                         nascent.push_back (new NascentInfo ());
                 }
+
+                _index_dirty = true;
+                build_index_if_necessary ();
         }
 
         maybe_signal_changed ();
@@ -398,8 +420,12 @@ void
 ControlList::fast_simple_add (double when, double value)
 {
 	/* to be used only for loading pre-sorted data from saved state */
-	_events.insert (_events.end(), new ControlEvent (when, value));
+	iterator i = _events.insert (_events.end(), new ControlEvent (when, value));
 	assert(_events.back());
+
+	if (!_index_dirty) {
+		_index.push_back (i);
+	}
 }
 
 void
@@ -415,29 +441,20 @@ ControlList::add (double when, double value)
 
 	{
 		Glib::Mutex::Lock lm (_lock);
-		ControlEvent cp (when, 0.0f);
-		bool insert = true;
-		iterator insertion_point;
-
-		for (insertion_point = lower_bound (_events.begin(), _events.end(), &cp, time_comparator); insertion_point != _events.end(); ++insertion_point) {
 
-			/* only one point allowed per time point */
+		build_index_if_necessary ();
 
-			if ((*insertion_point)->when == when) {
-				(*insertion_point)->value = value;
-				insert = false;
-				break;
-			}
-
-			if ((*insertion_point)->when >= when) {
-				break;
-			}
-		}
-
-		if (insert) {
+		/* only one point allowed per time point; a new point goes into
+		   the index at its place, rather than having it rebuilt.
+		*/
 
-			_events.insert (insertion_point, new ControlEvent (when, value));
+		EventIndex::iterator i = lower_bound (_index.begin(), _index.end(), when, IndexTimeComparator ());
 
+		if (i != _index.end() && (**i)->when == when) {
+			(**i)->value = value;
+		} else {
+			iterator insertion_point = (i == _index.end()) ? _events.end() : *i;
+			_index.insert (i, _events.insert (insertion_point, new ControlEvent (when, value)));
 		}
 
 		mark_dirty ();
@@ -452,6 +469,7 @@ ControlList::erase (iterator i)
 	{
 		Glib::Mutex::Lock lm (_lock);
 		_events.erase (i);
+		_index_dirty = true;
 		mark_dirty ();
 	}
 	maybe_signal_changed ();
@@ -463,6 +481,7 @@ ControlList::erase (iterator start, iterator end)
 	{
 		Glib::Mutex::Lock lm (_lock);
 		_events.erase (start, end);
+		_index_dirty = true;
 		mark_dirty ();
 	}
 	maybe_signal_changed ();
@@ -482,6 +501,7 @@ ControlList::erase (double when, double value)
 
 		if (i != end ()) {
 			_events.erase (i);
+			_index_dirty = true;
 		}
 		
 		mark_dirty ();
@@ -497,14 +517,12 @@ ControlList::reset_range (double start, double endt)
 
 	{
 		Glib::Mutex::Lock lm (_lock);
-		ControlEvent cp (start, 0.0f);
 		iterator s;
 		iterator e;
 
-		if ((s = lower_bound (_events.begin(), _events.end(), &cp, time_comparator)) != _events.end()) {
+		if ((s = unlocked_lower_bound (start)) != _events.end()) {
 
-			cp.when = endt;
-			e = upper_bound (_events.begin(), _events.end(), &cp, time_comparator);
+			e = unlocked_upper_bound (endt);
 
 			for (iterator i = s; i != e; ++i) {
 				(*i)->value = _default_value;
@@ -531,6 +549,7 @@ ControlList::erase_range (double start, double endt)
 		erased = erase_range_internal (start, endt, _events);
 
 		if (erased) {
+			_index_dirty = true;
 			mark_dirty ();
 		}
 
@@ -551,9 +570,9 @@ ControlList::erase_range_internal (double start, double endt, EventList & events
 
 	if ((s = lower_bound (events.begin(), events.end(), &cp, time_comparator)) != events.end()) {
 		cp.when = endt;
-		e = upper_bound (events.begin(), events.end(), &cp, time_comparator);
-		events.erase (s, e);
+		e = upper_bound (s, events.end(), &cp, time_comparator);
 		if (s != e) {
+			events.erase (s, e);
 			erased = true;
 		}
 	}
@@ -624,6 +643,7 @@ ControlList::modify (iterator iter, double when, double val)
 			_sort_pending = true;
 		}
 
+		_index_dirty = true;
 		mark_dirty ();
 	}
 
@@ -635,13 +655,12 @@ ControlList::control_points_adjacent (double xval)
 {
 	Glib::Mutex::Lock lm (_lock);
 	iterator i;
-	ControlEvent cp (xval, 0.0f);
 	std::pair<iterator,iterator> ret;
 
 	ret.first = _events.end();
 	ret.second = _events.end();
 
-	for (i = lower_bound (_events.begin(), _events.end(), &cp, time_comparator); i != _events.end(); ++i) {
+	for (i = unlocked_lower_bound (xval); i != _events.end(); ++i) {
 
 		if (ret.first == _events.end()) {
 			if ((*i)->when >= xval) {
@@ -690,6 +709,8 @@ ControlList::thaw ()
 		if (_sort_pending) {
 			_events.sort (event_time_less_than);
 			_sort_pending = false;
+			_index_dirty = true;
+			build_index_if_necessary ();
 		}
 	}
 }
@@ -700,6 +721,8 @@ ControlList::mark_dirty () const
 	_lookup_cache.left = -1;
 	_search_cache.left = -1;
 
+	build_index_if_necessary ();
+
 	if (_curve) {
 		_curve->mark_dirty();
 	}
@@ -803,6 +826,7 @@ ControlList::truncate_end (double last_coordinate)
 			_events.back()->value = last_val;
 		}
 
+		_index_dirty = true;
 		mark_dirty();
 	}
 
@@ -902,6 +926,7 @@ ControlList::truncate_start (double overall_length)
 			_events.push_front (new ControlEvent (0, first_legal_value));
 		}
 
+		_index_dirty = true;
 		mark_dirty();
 	}
 
@@ -975,8 +1000,7 @@ ControlList::multipoint_eval (double x) const
 	/* "Stepped" lookup (no interpolation) */
 	/* FIXME: no cache.  significant? */
 	if (_interpolation == Discrete) {
-		const ControlEvent cp (x, 0);
-		EventList::const_iterator i = lower_bound (_events.begin(), _events.end(), &cp, time_comparator);
+		EventList::const_iterator i = unlocked_lower_bound (x);
 
 		// shouldn't have made it to multipoint_eval
 		assert(i != _events.end());
@@ -994,9 +1018,8 @@ ControlList::multipoint_eval (double x) const
 	     (_lookup_cache.range.first == _events.end()) ||
 	     ((*_lookup_cache.range.second)->when < x))) {
 
-		const ControlEvent cp (x, 0);
-
-		_lookup_cache.range = equal_range (_events.begin(), _events.end(), &cp, time_comparator);
+		_lookup_cache.range.first = unlocked_lower_bound (x);
+		_lookup_cache.range.second = unlocked_upper_bound (x);
 	}
 
 	pair<const_iterator,const_iterator> range = _lookup_cache.range;
@@ -1042,20 +1065,137 @@ ControlList::multipoint_eval (double x) const
 void
 ControlList::build_search_cache_if_necessary (double start) const
 {
+	if (_events.empty()) {
+		/* Empty, reset (the cached iterator may be to an event which has gone) */
+		_search_cache.first = _events.end();
+		_search_cache.left = -1;
+		return;
+	}
+
 	/* Only do the range lookup if x is in a different range than last time
 	 * this was called (or if the search cache has been marked "dirty" (left<0) */
-	if (!_events.empty() && ((_search_cache.left < 0) || (_search_cache.left > start))) {
-
-		const ControlEvent start_point (start, 0);
+	if ((_search_cache.left < 0) || (_search_cache.left > start)) {
 
 		//cerr << "REBUILD: (" << _search_cache.left << ".." << _search_cache.right << ") := ("
 		//	<< start << ".." << end << ")" << endl;
 
-		_search_cache.first = lower_bound (_events.begin(), _events.end(), &start_point, time_comparator);
+		_search_cache.first = unlocked_lower_bound (start);
 		_search_cache.left = start;
 	}
 }
 
+/** Rebuild the index if events have been added, removed or reordered
+ *  since it was last built.  This is done by whatever made the change,
+ *  with the lock held, so that lookups (which may be in the process
+ *  thread) never have to rebuild it or allocate.
+ */
+void
+ControlList::build_index_if_necessary () const
+{
+	if (!_index_dirty) {
+		return;
+	}
+
+	/* the index is only ever used to find events, but it holds
+	   non-const iterators so that the non-const lookups can use it
+	*/
+	EventList& events = const_cast<EventList&> (_events);
+
+	_index.clear ();
+	_index.reserve (events.size ());
+
+	for (iterator i = events.begin(); i != events.end(); ++i) {
+		_index.push_back (i);
+	}
+
+	_index_dirty = false;
+}
+
+/** @return the first event at or after \a when */
+ControlList::const_iterator
+ControlList::unlocked_lower_bound (double when) const
+{
+	if (_index_dirty) {
+		/* only if something changed the events without marking them dirty */
+		ControlEvent cp (when, 0);
+		return lower_bound (_events.begin(), _events.end(), &cp, time_comparator);
+	}
+
+	EventIndex::const_iterator i = lower_bound (_index.begin(), _index.end(), when, IndexTimeComparator ());
+
+	if (i == _index.end()) {
+		return _events.end();
+	}
+
+	return *i;
+}
+
+/** @return the first event after \a when */
+ControlList::const_iterator
+ControlList::unlocked_upper_bound (double when) const
+{
+	if (_index_dirty) {
+		/* only if something changed the events without marking them dirty */
+		ControlEvent cp (when, 0);
+		return upper_bound (_events.begin(), _events.end(), &cp, time_comparator);
+	}
+
+	EventIndex::const_iterator i = upper_bound (_index.begin(), _index.end(), when, IndexTimeComparator ());
+
+	if (i == _index.end()) {
+		return _events.end();
+	}
+
+	return *i;
+}
+
+ControlList::iterator
+ControlList::unlocked_lower_bound (double when)
+{
+	if (_index_dirty) {
+		/* only if something changed the events without marking them dirty */
+		ControlEvent cp (when, 0);
+		return lower_bound (_events.begin(), _events.end(), &cp, time_comparator);
+	}
+
+	EventIndex::const_iterator i = lower_bound (_index.begin(), _index.end(), when, IndexTimeComparator ());
+
+	if (i == _index.end()) {
+		return _events.end();
+	}
+
+	return *i;
+}
+
+ControlList::iterator
+ControlList::unlocked_upper_bound (double when)
+{
+	if (_index_dirty) {
+		/* only if something changed the events without marking them dirty */
+		ControlEvent cp (when, 0);
+		return upper_bound (_events.begin(), _events.end(), &cp, time_comparator);
+	}
+
+	EventIndex::const_iterator i = upper_bound (_index.begin(), _index.end(), when, IndexTimeComparator ());
+
+	if (i == _index.end()) {
+		return _events.end();
+	}
+
+	return *i;
+}
+
+/** @return the number of events, without walking the list */
+ControlList::EventList::size_type
+ControlList::unlocked_size () const
+{
+	if (_index_dirty) {
+		return _events.size ();
+	}
+
+	return _index.size ();
+}
+
 /** Get the earliest event after \a start using the current interpolation style.
  *
  * If an event is found, \a x and \a y are set to its coordinates.
@@ -1343,6 +1483,10 @@ ControlList::cut_copy_clear (double start, double end, int op)
                         }
 		}
 
+                nal->_index_dirty = true;
+                nal->build_index_if_necessary ();
+
+                _index_dirty = true;
                 mark_dirty ();
 	}
 
@@ -1412,6 +1556,7 @@ ControlList::paste (ControlList& alist, double pos, float /*times*/)
 			}
 		}
 
+		_index_dirty = true;
 		mark_dirty ();
 	}
 
@@ -1472,6 +1617,7 @@ ControlList::move_ranges (const list< RangeMove<double> >& movements)
 			_sort_pending = true;
 		}
 
+		_index_dirty = true;
 		mark_dirty ();
 	}
 
@@ -188,6 +188,25 @@ Curve::get_vector (double x0, double x1, float *vec, int32_t veclen)
 	_get_vector (x0, x1, vec, veclen);
 }
 
+/** Fill vec[0..n-1] with the cubic given by coeff, evaluated at x0, x0 + dx,
+ *  x0 + 2dx and so on.  Each x is computed from its index rather than by
+ *  accumulating dx, so that the loop has no carried dependency and the
+ *  compiler can vectorize it.
+ */
+static void
+render_segment (float* vec, int32_t n, double x0, double dx, double const * coeff)
+{
+	const double c0 = coeff[0];
+	const double c1 = coeff[1];
+	const double c2 = coeff[2];
+	const double c3 = coeff[3];
+
+	for (int32_t k = 0; k < n; ++k) {
+		const double x = x0 + k * dx;
+		vec[k] = c0 + x * (c1 + x * (c2 + x * c3));
+	}
+}
+
 void
 Curve::_get_vector (double x0, double x1, float *vec, int32_t veclen)
 {
@@ -196,7 +215,7 @@ Curve::_get_vector (double x0, double x1, float *vec, int32_t veclen)
 	int32_t original_veclen;
 	int32_t npoints;
 
-	if ((npoints = _list.events().size()) == 0) {
+	if ((npoints = _list.unlocked_size()) == 0) {
 		for (i = 0; i < veclen; ++i) {
 			vec[i] = _list.default_value();
 		}
@@ -305,88 +324,82 @@ Curve::_get_vector (double x0, double x1, float *vec, int32_t veclen)
 		solve ();
 	}
 
-	rx = lx;
-
 	if (veclen > 1) {
 		dx = (hx - lx) / (veclen - 1);
 	} else {
 		dx = 0;
 	}
 
-	for (i = 0; i < veclen; ++i, rx += dx) {
-		vec[i] = multipoint_eval (rx);
-	}
-}
-
-double
-Curve::unlocked_eval (double x)
-{
-	// I don't see the point of this...
-
-	if (_dirty) {
-		solve ();
-	}
-
-	return _list.unlocked_eval (x);
-}
-
-double
-Curve::multipoint_eval (double x)
-{
-	pair<ControlList::EventList::const_iterator,ControlList::EventList::const_iterator> range;
-
-	ControlList::LookupCache& lookup_cache = _list.lookup_cache();
-
-	if ((lookup_cache.left < 0) ||
-	    ((lookup_cache.left > x) ||
-	     (lookup_cache.range.first == _list.events().end()) ||
-	     ((*lookup_cache.range.second)->when < x))) {
+	/* Walk the control points once, rendering each run of samples that
+	   falls between two of them from that segment's polynomial.  next is
+	   the first point later than the current sample; since lx >= min_x,
+	   there is always a point before it.
+	*/
 
-		ControlEvent cp (x, 0.0);
+	ControlList::EventList const & events (_list.events());
+	ControlList::EventList::const_iterator next = _list.unlocked_upper_bound (lx);
 
-		lookup_cache.range = equal_range (_list.events().begin(), _list.events().end(), &cp, ControlList::time_comparator);
-	}
+	i = 0;
 
-	range = lookup_cache.range;
+	while (i < veclen) {
 
-	/* EITHER
+		rx = lx + i * dx;
 
-	   a) x is an existing control point, so first == existing point, second == next point
+		while (next != events.end() && (*next)->when <= rx) {
+			++next;
+		}
 
-	   OR
+		if (next == events.end()) {
+			/* at or after the last point */
+			const float val = events.back()->value;
+			for (; i < veclen; ++i) {
+				vec[i] = val;
+			}
+			break;
+		}
 
-	   b) x is between control points, so range is empty (first == second, points to where
-	       to insert x)
+		ControlList::EventList::const_iterator before = next;
+		--before;
+		const ControlEvent* const prev = *before;
+		const double when = (*next)->when;
 
-	*/
+		/* find the end of the run of samples before `next' */
 
-	if (range.first == range.second) {
+		int32_t n;
 
-		/* x does not exist within the list as a control point */
+		if (dx > 0) {
+			n = (int32_t) min ((double) veclen, ceil ((when - lx) / dx));
+			while (n > i + 1 && lx + (n - 1) * dx >= when) {
+				--n;
+			}
+			while (n < veclen && lx + n * dx < when) {
+				++n;
+			}
+		} else {
+			n = veclen;
+		}
 
-		lookup_cache.left = x;
+		render_segment (vec + i, n - i, rx, dx, (*next)->coeff);
 
-		if (range.first == _list.events().begin()) {
-			/* we're before the first point */
-			// return default_value;
-			_list.events().front()->value;
+		if (rx == prev->when) {
+			/* exactly on a control point */
+			vec[i] = prev->value;
 		}
 
-		if (range.second == _list.events().end()) {
-			/* we're after the last point */
-			return _list.events().back()->value;
-		}
+		i = n;
+	}
+}
 
-		double x2 = x * x;
-		ControlEvent* ev = *range.second;
+double
+Curve::unlocked_eval (double x)
+{
+	// I don't see the point of this...
 
-		return ev->coeff[0] + (ev->coeff[1] * x) + (ev->coeff[2] * x2) + (ev->coeff[3] * x2 * x);
+	if (_dirty) {
+		solve ();
 	}
 
-	/* x is a control point in the data */
-	/* invalidate the cached range because its not usable */
-	lookup_cache.left = -1;
-	return (*range.first)->value;
+	return _list.unlocked_eval (x);
 }
 
 } // namespace Evoral
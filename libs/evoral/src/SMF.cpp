@@ -183,6 +183,46 @@ SMF::seek_to_start() const
 	_smf_track->next_event_number = 1;
 }
 
+/** Seek to the first event at or after a given time.
+ *
+ * libsmf keeps every event of the track in memory along with its absolute
+ * time, so this is a binary search rather than a read through all the
+ * events before \a ticks.
+ *
+ * \return the time of the event before the new position (or 0 if there is
+ * none), which is the time that the delta time of the next event read is
+ * relative to.
+ */
+uint64_t
+SMF::seek_to_time(uint64_t ticks) const
+{
+	size_t lo = 1;
+	size_t hi = _smf_track->number_of_events + 1;
+
+	while (lo < hi) {
+		const size_t mid = lo + (hi - lo) / 2;
+		if (smf_track_get_event_by_number(_smf_track, mid)->time_pulses < ticks) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	if (lo > _smf_track->number_of_events) {
+		/* past the last event */
+		_smf_track->next_event_number = 0;
+	} else {
+		_smf_track->next_event_number = lo;
+		_smf_track->time_of_next_event = smf_track_get_event_by_number(_smf_track, lo)->time_pulses;
+	}
+
+	if (lo == 1) {
+		return 0;
+	}
+
+	return smf_track_get_event_by_number(_smf_track, lo - 1)->time_pulses;
+}
+
 /** Read an event from the current position in file.
  *
  * File position MUST be at the beginning of a delta time, or this will die very messily.
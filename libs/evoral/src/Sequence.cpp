@@ -487,16 +487,19 @@ Sequence<Time>::Sequence(const Sequence<Time>& other)
         for (typename Notes::const_iterator i = other._notes.begin(); i != other._notes.end(); ++i) {
                 NotePtr n (new Note<Time> (**i));
                 _notes.insert (n);
+                _notes_by_id[n->id()] = n;
         }
 
         for (typename SysExes::const_iterator i = other._sysexes.begin(); i != other._sysexes.end(); ++i) {
                 boost::shared_ptr<Event<Time> > n (new Event<Time> (**i, true));
                 _sysexes.push_back (n);
+                _sysexes_by_id.insert (std::make_pair (n->id(), n));
         }
 
 	for (typename PatchChanges::const_iterator i = other._patch_changes.begin(); i != other._patch_changes.end(); ++i) {
 		PatchChangePtr n (new PatchChange<Time> (**i));
 		_patch_changes.insert (n);
+		_patch_changes_by_id[n->id()] = n;
 	}
 
 	for (int i = 0; i < 16; ++i) {
@@ -592,6 +595,7 @@ Sequence<Time>::clear()
 {
 	WriteLock lock(write_lock());
 	_notes.clear();
+	_notes_by_id.clear();
 	for (Controls::iterator li = _controls.begin(); li != _controls.end(); ++li)
 		li->second->list()->clear();
 }
@@ -645,13 +649,15 @@ Sequence<Time>::end_write (StuckNoteOption option, Time when)
 					break;
 				case DeleteStuckNotes:
 					cerr << "WARNING: Stuck note lost: " << (*n)->note() << endl;
+					erase_note_id (*n);
 					_notes.erase(n);
 					break;
 				case ResolveStuckNotes:
 					if (when <= (*n)->time()) {
 						cerr << "WARNING: Stuck note resolution - end time @ " 
 						     << when << " is before note on: " << (**n) << endl;
-						_notes.erase (*n);
+						erase_note_id (*n);
+						_notes.erase (n);
 					} else {
 						(*n)->set_length (when - (*n)->time());
 						cerr << "WARNING: resolved note-on with no note-off to generate " << (**n) << endl;
@@ -696,6 +702,7 @@ Sequence<Time>::add_note_unlocked(const NotePtr note, void* arg)
 		_highest_note = note->note();
 
 	_notes.insert (note);
+	_notes_by_id[note->id()] = note;
         _pitches[note->channel()].insert (note);
  
 	_edited = true;
@@ -724,6 +731,7 @@ Sequence<Time>::remove_note_unlocked(const constNotePtr note)
 			NotePtr n = *i;
                         
                         DEBUG_TRACE (DEBUG::Sequence, string_compose ("%1\terasing note %2 @ %3\n", this, (int)(*i)->note(), (*i)->time()));
+			erase_note_id (n);
 			_notes.erase (i);
 
                         if (n->note() == _lowest_note || n->note() == _highest_note) {
@@ -771,10 +779,11 @@ template<typename Time>
 void
 Sequence<Time>::add_patch_change_unlocked (PatchChangePtr p)
 {
-	_patch_changes.insert (p);
 	if (p->id () < 0) {
 		p->set_id (Evoral::next_event_id ());
 	}
+	_patch_changes.insert (p);
+	_patch_changes_by_id[p->id()] = p;
 }
 
 template<typename Time>
@@ -788,6 +797,10 @@ Sequence<Time>::remove_patch_change_unlocked (const constPatchChangePtr p)
 		++tmp;
 
 		if (*i == p) {
+			typename PatchChangesByID::iterator j = _patch_changes_by_id.find (p->id());
+			if (j != _patch_changes_by_id.end() && j->second == p) {
+				_patch_changes_by_id.erase (j);
+			}
 			_patch_changes.erase (i);
 		}
 
@@ -977,6 +990,7 @@ Sequence<Time>::append_sysex_unlocked(const MIDIEvent<Time>& ev, event_id_t /* e
         boost::shared_ptr<MIDIEvent<Time> > event(new MIDIEvent<Time>(ev, true));
         /* XXX sysex events should use IDs */
         _sysexes.push_back(event);
+        _sysexes_by_id.insert (std::make_pair (event->id(), event));
 }
 
 template<typename Time>
@@ -990,6 +1004,7 @@ Sequence<Time>::append_patch_change_unlocked (const PatchChange<Time>& ev, event
 	}
 	
 	_patch_changes.insert (p);
+	_patch_changes_by_id[p->id()] = p;
 }
 
 template<typename Time>
@@ -1062,6 +1077,47 @@ void
 Sequence<Time>::set_notes (const Sequence<Time>::Notes& n)
 {
         _notes = n;
+
+        _notes_by_id.clear ();
+        for (typename Notes::const_iterator i = _notes.begin(); i != _notes.end(); ++i) {
+                _notes_by_id[(*i)->id()] = *i;
+        }
+}
+
+template<typename Time>
+typename Sequence<Time>::NotePtr
+Sequence<Time>::note_by_id (event_id_t id) const
+{
+	typename NotesByID::const_iterator i = _notes_by_id.find (id);
+	return i != _notes_by_id.end() ? i->second : NotePtr ();
+}
+
+template<typename Time>
+typename Sequence<Time>::PatchChangePtr
+Sequence<Time>::patch_change_by_id (event_id_t id) const
+{
+	typename PatchChangesByID::const_iterator i = _patch_changes_by_id.find (id);
+	return i != _patch_changes_by_id.end() ? i->second : PatchChangePtr ();
+}
+
+/** SysExes do not always have unique IDs, so this returns the first one added with a given ID */
+template<typename Time>
+boost::shared_ptr<Event<Time> >
+Sequence<Time>::sysex_by_id (event_id_t id) const
+{
+	typename SysExesByID::const_iterator i = _sysexes_by_id.find (id);
+	return i != _sysexes_by_id.end() ? i->second : boost::shared_ptr<Event<Time> > ();
+}
+
+/** Remove a note from the ID index, if it is the one indexed under its ID */
+template<typename Time>
+void
+Sequence<Time>::erase_note_id (const constNotePtr note)
+{
+	typename NotesByID::iterator i = _notes_by_id.find (note->id());
+	if (i != _notes_by_id.end() && i->second == note) {
+		_notes_by_id.erase (i);
+	}
 }
 
 /** Return the earliest note with time >= t */
@@ -0,0 +1,227 @@
+#include <iostream>
+#include <cstdlib>
+#include <sys/time.h>
+#include <boost/shared_ptr.hpp>
+#include "evoral/ControlList.hpp"
+#include "ControlListTest.hpp"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (ControlListTest);
+
+using namespace std;
+using namespace Evoral;
+
+static double
+elapsed (struct timeval const & a, struct timeval const & b)
+{
+	return (b.tv_sec - a.tv_sec) * 1e6 + (b.tv_usec - a.tv_usec);
+}
+
+/** Make a list of n points, 64 apart, with integer values in [0, 128) */
+static void
+fill (ControlList& l, int n)
+{
+	for (int i = 0; i < n; ++i) {
+		l.fast_simple_add (i * 64, (i * 7919) % 128);
+	}
+}
+
+void
+ControlListTest::evalTest ()
+{
+	ControlList l (Parameter (0));
+	fill (l, 1000);
+
+	/* on the points */
+	for (int i = 0; i < 1000; i += 37) {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL ((double) ((i * 7919) % 128), l.eval (i * 64), 1e-9);
+	}
+
+	/* between them */
+	for (int i = 0; i < 999; i += 41) {
+		double const a = (i * 7919) % 128;
+		double const b = ((i + 1) * 7919) % 128;
+		CPPUNIT_ASSERT_DOUBLES_EQUAL ((a + b) / 2, l.eval (i * 64 + 32), 1e-9);
+	}
+
+	/* outside them */
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (l.front()->value, l.eval (-100), 1e-9);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (l.back()->value, l.eval (1e9), 1e-9);
+
+	l.set_interpolation (ControlList::Discrete);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL ((double) ((10 * 7919) % 128), l.eval (10 * 64 + 32), 1e-9);
+}
+
+void
+ControlListTest::earliestEventTest ()
+{
+	ControlList l (Parameter (0));
+	l.set_interpolation (ControlList::Discrete);
+	fill (l, 1000);
+
+	srand (3141);
+
+	for (int i = 0; i < 200; ++i) {
+		double const start = rand () % (1000 * 64);
+		double x, y;
+
+		bool const found = l.rt_safe_earliest_event (start, x, y, true);
+
+		/* find the answer the slow way */
+		ControlList::const_iterator j = l.begin ();
+		while (j != l.end () && (*j)->when < start) {
+			++j;
+		}
+
+		CPPUNIT_ASSERT_EQUAL (j != l.end (), found);
+
+		if (found) {
+			CPPUNIT_ASSERT_EQUAL ((*j)->when, x);
+			CPPUNIT_ASSERT_EQUAL ((*j)->value, y);
+		}
+
+		/* make the next search start from scratch */
+		l.search_cache().left = -1;
+	}
+
+	/* an emptied list must not find anything */
+	l.clear ();
+	double x, y;
+	CPPUNIT_ASSERT (!l.rt_safe_earliest_event (0, x, y, true));
+}
+
+void
+ControlListTest::cutTest ()
+{
+	ControlList l (Parameter (0));
+	l.fast_simple_add (0, 0);
+	l.fast_simple_add (100, 100);
+	l.fast_simple_add (200, 0);
+	l.fast_simple_add (300, 100);
+
+	boost::shared_ptr<ControlList> c = l.cut (50, 250);
+
+	/* the cut section has a point at each end, relative to its start */
+	CPPUNIT_ASSERT_EQUAL ((ControlList::EventList::size_type) 4, c->size ());
+	CPPUNIT_ASSERT_EQUAL (0.0, c->front()->when);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (50.0, c->front()->value, 1e-9);
+	CPPUNIT_ASSERT_EQUAL (200.0, c->back()->when);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (50.0, c->back()->value, 1e-9);
+
+	/* and what is left keeps its shape outside the cut */
+	CPPUNIT_ASSERT_EQUAL ((ControlList::EventList::size_type) 4, l.size ());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (25.0, l.eval (25), 1e-9);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (75.0, l.eval (275), 1e-9);
+
+	/* pasting it back restores the original */
+	CPPUNIT_ASSERT (l.paste (*c, 50, 1));
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (100.0, l.eval (100), 1e-9);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (50.0, l.eval (150), 1e-9);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (0.0, l.eval (200), 1e-9);
+}
+
+/** Iterators are held by the GUI across edits, so they must keep
+ *  pointing at the same events.
+ */
+void
+ControlListTest::iteratorTest ()
+{
+	ControlList l (Parameter (0));
+	fill (l, 10);
+
+	ControlList::iterator third = l.begin ();
+	advance (third, 3);
+	ControlEvent* const e = *third;
+
+	/* moving an earlier point past it re-sorts the list */
+	l.modify (l.begin (), 4 * 64 + 1, 42);
+	CPPUNIT_ASSERT (*third == e);
+	CPPUNIT_ASSERT_EQUAL (42.0, l.eval (4 * 64 + 1));
+
+	/* and adding and removing other points leaves it alone */
+	l.add (3 * 64 + 1, 1);
+	l.erase (l.begin ());
+	CPPUNIT_ASSERT (*third == e);
+	CPPUNIT_ASSERT_EQUAL (3.0 * 64, (*third)->when);
+}
+
+/** Points added in any order end up sorted, and can be found by time
+ *  straight away.
+ */
+void
+ControlListTest::addTest ()
+{
+	ControlList l (Parameter (0));
+	l.set_interpolation (ControlList::Discrete);
+
+	srand (2718);
+
+	for (int i = 0; i < 2000; ++i) {
+		double const when = (rand () % 1000) * 64;
+		l.add (when, when / 64);
+
+		/* the new point is found by time, with nothing else in between */
+		double x, y;
+		l.search_cache().left = -1;
+		CPPUNIT_ASSERT (l.rt_safe_earliest_event (when, x, y, true));
+		CPPUNIT_ASSERT_EQUAL (when, x);
+		CPPUNIT_ASSERT_EQUAL (when / 64, y);
+	}
+
+	/* only one point at each time, in order */
+	ControlList::const_iterator i = l.begin ();
+	ControlList::const_iterator j = i;
+	for (++j; j != l.end (); ++i, ++j) {
+		CPPUNIT_ASSERT ((*i)->when < (*j)->when);
+	}
+}
+
+void
+ControlListTest::benchmark ()
+{
+	int const evals = 100000;
+	int const searches = 10000;
+
+	int const adds = 1000;
+
+	cerr << "\nusecs per call: points eval rt_safe_earliest_event add\n";
+
+	for (int n = 1000; n <= 100000; n *= 10) {
+
+		ControlList l (Parameter (0));
+		fill (l, n);
+
+		struct timeval a, b;
+		double sum = 0;
+
+		srand (3141);
+
+		/* random positions, so that the lookup cache does not help */
+		gettimeofday (&a, 0);
+		for (int i = 0; i < evals; ++i) {
+			sum += l.eval ((rand () % n) * 64.0 + 17);
+		}
+		gettimeofday (&b, 0);
+		cerr << n << " " << elapsed (a, b) / evals;
+
+		gettimeofday (&a, 0);
+		for (int i = 0; i < searches; ++i) {
+			double x, y;
+			l.search_cache().left = -1;
+			if (l.rt_safe_earliest_event ((rand () % n) * 64.0 + 1, x, y)) {
+				sum += x;
+			}
+		}
+		gettimeofday (&b, 0);
+		cerr << " " << elapsed (a, b) / searches;
+
+		/* between the existing points, so that each one is new */
+		gettimeofday (&a, 0);
+		for (int i = 0; i < adds; ++i) {
+			l.add ((rand () % n) * 64.0 + 1 + (i % 63), 64);
+		}
+		gettimeofday (&b, 0);
+		cerr << " " << elapsed (a, b) / adds << "\n";
+
+		CPPUNIT_ASSERT (sum > 0);
+	}
+}
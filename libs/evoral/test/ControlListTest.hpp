@@ -0,0 +1,22 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class ControlListTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (ControlListTest);
+	CPPUNIT_TEST (evalTest);
+	CPPUNIT_TEST (earliestEventTest);
+	CPPUNIT_TEST (cutTest);
+	CPPUNIT_TEST (iteratorTest);
+	CPPUNIT_TEST (addTest);
+	CPPUNIT_TEST (benchmark);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void evalTest ();
+	void earliestEventTest ();
+	void cutTest ();
+	void iteratorTest ();
+	void addTest ();
+	void benchmark ();
+};
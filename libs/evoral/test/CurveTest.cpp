@@ -0,0 +1,100 @@
+#include <iostream>
+#include <cstdlib>
+#include <sys/time.h>
+#include "evoral/ControlList.hpp"
+#include "evoral/Curve.hpp"
+#include "CurveTest.hpp"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (CurveTest);
+
+using namespace std;
+using namespace Evoral;
+
+/** Evaluate a solved curve at x the slow way, one point at a time */
+static double
+reference_eval (ControlList const & l, double x)
+{
+	if (x <= l.front()->when) {
+		return l.front()->value;
+	}
+
+	for (ControlList::const_iterator i = l.begin(); i != l.end(); ++i) {
+		if ((*i)->when == x) {
+			return (*i)->value;
+		} else if ((*i)->when > x) {
+			double const * c = (*i)->coeff;
+			return c[0] + c[1] * x + c[2] * x * x + c[3] * x * x * x;
+		}
+	}
+
+	return l.back()->value;
+}
+
+void
+CurveTest::getVectorTest ()
+{
+	srand (2718);
+
+	ControlList l (Parameter (0));
+	double t = 0;
+
+	/* close enough together that a 1024-sample block crosses several points */
+	for (int i = 0; i < 40; ++i) {
+		t += 1 + rand () % 300;
+		l.fast_simple_add (t, (rand () % 1000) / 1000.0);
+	}
+
+	l.create_curve ();
+
+	float vec[1024];
+
+	for (int k = 0; k < 100; ++k) {
+		double const x0 = rand () % (int) (t + 400) - 200;
+		int32_t const n = 2 + rand () % 1023;
+		double const x1 = x0 + n - 1;
+
+		l.curve().get_vector (x0, x1, vec, n);
+
+		for (int32_t i = 0; i < n; ++i) {
+			CPPUNIT_ASSERT_DOUBLES_EQUAL (reference_eval (l, x0 + i), vec[i], 1e-3);
+		}
+	}
+
+	/* a block which starts on a point has that point's exact value */
+	ControlList::const_iterator p = l.begin();
+	advance (p, 10);
+	l.curve().get_vector ((*p)->when, (*p)->when + 99, vec, 100);
+	CPPUNIT_ASSERT_EQUAL ((float) (*p)->value, vec[0]);
+}
+
+void
+CurveTest::benchmark ()
+{
+	ControlList l (Parameter (0));
+
+	for (int i = 0; i < 64; ++i) {
+		l.fast_simple_add (i * 4096, (i * 37 % 100) / 100.0);
+	}
+
+	l.create_curve ();
+
+	int const blocks = 20000;
+	float vec[1024];
+	double sum = 0;
+
+	struct timeval a, b;
+	gettimeofday (&a, 0);
+
+	for (int k = 0; k < blocks; ++k) {
+		double const x0 = (k % 256) * 1024;
+		l.curve().rt_safe_get_vector (x0, x0 + 1023, vec, 1024);
+		sum += vec[k % 1024];
+	}
+
+	gettimeofday (&b, 0);
+
+	cerr << "\nusecs per 1024-frame curve block: "
+	     << ((b.tv_sec - a.tv_sec) * 1e6 + (b.tv_usec - a.tv_usec)) / blocks << "\n";
+
+	CPPUNIT_ASSERT (sum > 0);
+}
@@ -0,0 +1,14 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class CurveTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (CurveTest);
+	CPPUNIT_TEST (getVectorTest);
+	CPPUNIT_TEST (benchmark);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void getVectorTest ();
+	void benchmark ();
+};
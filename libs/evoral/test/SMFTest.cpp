@@ -49,3 +49,62 @@ SMFTest::takeFiveTest ()
 	seq->end_write (Sequence<Time>::Relax, false);
 	CPPUNIT_ASSERT(!seq->empty());
 }
+
+void
+SMFTest::seekTest ()
+{
+	TestSMF smf;
+	smf.open("./test/testdata/TakeFive.mid");
+	CPPUNIT_ASSERT(!smf.is_empty());
+
+	uint32_t delta_t = 0;
+	uint32_t size    = 0;
+	uint8_t* buf     = NULL;
+
+	/* read the whole file, noting the time of every event */
+	vector<uint64_t> times;
+	uint64_t time = 0;
+
+	smf.seek_to_start();
+	while (smf.read_event(&delta_t, &size, &buf) >= 0) {
+		time += delta_t;
+		times.push_back(time);
+	}
+
+	CPPUNIT_ASSERT(!times.empty());
+
+	/* seeking to an event's time, or just before it, must land on the
+	   first event at that time, with the same time and the same number
+	   of events after it as when reading from the start
+	*/
+	for (size_t i = 0; i < times.size(); i += 3) {
+		for (int before = 0; before < 2; ++before) {
+
+			const uint64_t target = times[i] - (before && times[i] > 0 ? 1 : 0);
+
+			size_t first = 0;
+			while (times[first] < target) {
+				++first;
+			}
+
+			time = smf.seek_to_time(target);
+
+			size_t n = 0;
+			while (smf.read_event(&delta_t, &size, &buf) >= 0) {
+				time += delta_t;
+				if (n == 0) {
+					CPPUNIT_ASSERT_EQUAL(times[first], time);
+				}
+				++n;
+			}
+
+			CPPUNIT_ASSERT_EQUAL(times.size() - first, n);
+		}
+	}
+
+	/* seeking past the last event leaves nothing to read */
+	smf.seek_to_time(times.back() + 1);
+	CPPUNIT_ASSERT_EQUAL(-1, smf.read_event(&delta_t, &size, &buf));
+
+	free(buf);
+}
@@ -53,6 +53,7 @@ class SMFTest : public CppUnit::TestFixture
 	CPPUNIT_TEST_SUITE(SMFTest);
 	CPPUNIT_TEST(createNewFileTest);
 	CPPUNIT_TEST(takeFiveTest);
+	CPPUNIT_TEST(seekTest);
 	CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -72,6 +73,7 @@ public:
 
 	void createNewFileTest();
 	void takeFiveTest();
+	void seekTest();
 
 private:
 	DummyTypeMap*     type_map;
@@ -154,3 +154,23 @@ SequenceTest::controlInterpolationTest ()
 		last_value = i->second;
 	}
 }
+
+void
+SequenceTest::noteByIdTest ()
+{
+	for (Notes::const_iterator i = test_notes.begin(); i != test_notes.end(); ++i) {
+		seq->add_note_unlocked (*i);
+	}
+
+	for (Notes::const_iterator i = test_notes.begin(); i != test_notes.end(); ++i) {
+		CPPUNIT_ASSERT ((*i)->id() >= 0);
+		CPPUNIT_ASSERT (seq->note_by_id ((*i)->id()) == *i);
+	}
+
+	seq->remove_note_unlocked (test_notes[3]);
+	CPPUNIT_ASSERT (!seq->note_by_id (test_notes[3]->id()));
+	CPPUNIT_ASSERT (seq->note_by_id (test_notes[4]->id()) == test_notes[4]);
+
+	seq->clear ();
+	CPPUNIT_ASSERT (!seq->note_by_id (test_notes[4]->id()));
+}
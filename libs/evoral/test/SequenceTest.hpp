@@ -116,6 +116,7 @@ class SequenceTest : public CppUnit::TestFixture
 	CPPUNIT_TEST (preserveEventOrderingTest);
 	CPPUNIT_TEST (iteratorSeekTest);
 	CPPUNIT_TEST (controlInterpolationTest);
+	CPPUNIT_TEST (noteByIdTest);
 	CPPUNIT_TEST_SUITE_END ();
 
 public:
@@ -144,6 +145,7 @@ public:
 	void preserveEventOrderingTest ();
 	void iteratorSeekTest ();
 	void controlInterpolationTest ();
+	void noteByIdTest ();
 
 private:
 	DummyTypeMap*       type_map;
@@ -24,7 +24,8 @@
 #include <string>
 #include <gtkmm2ext/popup.h>
 #include <boost/shared_ptr.hpp>
-#include <boost/signals2.hpp>
+
+#include "pbd/signals.h"
 
 namespace PBD {
 	class Controllable;
@@ -50,7 +51,7 @@ class BindingProxy : public sigc::trackable
 	boost::shared_ptr<PBD::Controllable> controllable;
 	guint bind_button;
 	guint bind_statemask;
-	boost::signals2::scoped_connection learning_connection;
+	PBD::ScopedConnection learning_connection;
 	void learning_finished ();
 	bool prompter_hiding (GdkEventAny *);
 };
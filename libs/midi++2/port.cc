@@ -55,7 +55,6 @@ Port::Port (string const & name, Flags flags, jack_client_t* jack_client)
 	, input_fifo (1024)
 	, _flags (flags)
 {
-	assert (jack_client);
 	init (name, flags);
 }
 
@@ -69,8 +68,6 @@ Port::Port (const XMLNode& node, jack_client_t* jack_client)
 	, output_fifo (512)
 	, input_fifo (1024)
 {
-	assert (jack_client);
-	
 	Descriptor desc (node);
 
 	init (desc.tag, desc.flags);
@@ -175,8 +172,6 @@ Port::clock (timestamp_t timestamp)
 void
 Port::cycle_start (pframes_t nframes)
 {
-	assert (_jack_port);
-	
 	_currently_in_cycle = true;
 	_nframes_this_cycle = nframes;
 
@@ -184,6 +179,11 @@ Port::cycle_start (pframes_t nframes)
 	_last_read_index = 0;
 	_last_write_timestamp = 0;
 
+	if (!_jack_port) {
+		/* no JACK client (or it went away), so there is nothing to read or write */
+		return;
+	}
+
 	if (sends_output()) {
 		void *buffer = jack_port_get_buffer (_jack_port, nframes);
 		jack_midi_clear_buffer (buffer);
@@ -211,7 +211,7 @@ Port::cycle_start (pframes_t nframes)
 void
 Port::cycle_end ()
 {
-	if (sends_output()) {
+	if (sends_output() && _jack_port) {
 		flush (jack_port_get_buffer (_jack_port, _nframes_this_cycle));
 	}
 
@@ -309,7 +309,7 @@ Port::write(byte * msg, size_t msglen, timestamp_t timestamp)
 			std::cerr << "assertion timestamp < _nframes_this_cycle failed!" << std::endl;
 		}
 
-		if (_currently_in_cycle) {
+		if (_currently_in_cycle && _jack_port) {
 			if (timestamp == 0) {
 				timestamp = _last_write_timestamp;
 			} 
@@ -403,6 +403,10 @@ Port::read (byte *, size_t)
 int
 Port::create_port ()
 {
+	if (!_jack_client) {
+		return -1;
+	}
+
 	_jack_port = jack_port_register(_jack_client, _tagname.c_str(), JACK_DEFAULT_MIDI_TYPE, _flags, 0);
 	return _jack_port == 0 ? -1 : 0;
 }
@@ -479,7 +483,7 @@ Port::make_connections ()
 		vector<string> ports;
 		split (_connections, ports, ',');
 		for (vector<string>::iterator x = ports.begin(); x != ports.end(); ++x) {
-			if (_jack_client) {
+			if (_jack_client && _jack_port) {
 				if (receives_input()) {
 					jack_connect (_jack_client, (*x).c_str(), jack_port_name (_jack_port));
 				} else {
@@ -36,6 +36,8 @@ PBD::Signal1<void,Controllable*> Controllable::DeleteBinding;
 
 Glib::StaticRWLock Controllable::registry_lock = GLIBMM_STATIC_RW_LOCK_INIT;
 Controllable::Controllables Controllable::registry;
+Controllable::ControllablesByID Controllable::registry_by_id;
+Controllable::ControllablesByName Controllable::registry_by_name;
 PBD::ScopedConnectionList registry_connections;
 const std::string Controllable::xml_node_name = X_("Controllable");
 
@@ -54,6 +56,8 @@ Controllable::add (Controllable& ctl)
 
 	Glib::RWLock::WriterLock lm (registry_lock);
 	registry.insert (&ctl);
+	registry_by_id.insert (make_pair (ctl.id(), &ctl));
+	registry_by_name.insert (make_pair (ctl._name, &ctl));
 
 	/* Controllable::remove() is static - no need to manage this connection */
 
@@ -65,9 +69,29 @@ Controllable::remove (Controllable* ctl)
 {
 	Glib::RWLock::WriterLock lm (registry_lock);
 
-	for (Controllables::iterator i = registry.begin(); i != registry.end(); ++i) {
-		if ((*i) == ctl) {
-			registry.erase (i);
+	if (registry.erase (ctl) == 0) {
+		return;
+	}
+
+	unindex_id (ctl);
+
+	pair<ControllablesByName::iterator, ControllablesByName::iterator> r = registry_by_name.equal_range (ctl->_name);
+	for (ControllablesByName::iterator i = r.first; i != r.second; ++i) {
+		if (i->second == ctl) {
+			registry_by_name.erase (i);
+			break;
+		}
+	}
+}
+
+/** Remove a controllable from registry_by_id; registry_lock must be held */
+void
+Controllable::unindex_id (Controllable* ctl)
+{
+	pair<ControllablesByID::iterator, ControllablesByID::iterator> r = registry_by_id.equal_range (ctl->id());
+	for (ControllablesByID::iterator i = r.first; i != r.second; ++i) {
+		if (i->second == ctl) {
+			registry_by_id.erase (i);
 			break;
 		}
 	}
@@ -78,12 +102,8 @@ Controllable::by_id (const ID& id)
 {
 	Glib::RWLock::ReaderLock lm (registry_lock);
 
-	for (Controllables::iterator i = registry.begin(); i != registry.end(); ++i) {
-		if ((*i)->id() == id) {
-			return (*i);
-		}
-	}
-	return 0;
+	ControllablesByID::const_iterator i = registry_by_id.find (id);
+	return i != registry_by_id.end() ? i->second : 0;
 }
 
 Controllable*
@@ -91,12 +111,8 @@ Controllable::by_name (const string& str)
 {
 	Glib::RWLock::ReaderLock lm (registry_lock);
 
-	for (Controllables::iterator i = registry.begin(); i != registry.end(); ++i) {
-		if ((*i)->_name == str) {
-			return (*i);
-		}
-	}
-	return 0;
+	ControllablesByName::const_iterator i = registry_by_name.find (str);
+	return i != registry_by_name.end() ? i->second : 0;
 }
 
 XMLNode&
@@ -130,7 +146,16 @@ Controllable::set_state (const XMLNode& node, int /*version*/)
 	Stateful::save_extra_xml (node);
 
 	if ((prop = node.property (X_("id"))) != 0) {
+		/* re-index under the new ID */
+		Glib::RWLock::WriterLock lm (registry_lock);
+		bool const registered = (registry.find (this) != registry.end());
+		if (registered) {
+			unindex_id (this);
+		}
 		_id = prop->value();
+		if (registered) {
+			registry_by_id.insert (make_pair (_id, this));
+		}
 	} else {
 		error << _("Controllable state node has no ID property") << endmsg;
 		return -1;
@@ -26,10 +26,6 @@
 #include <iostream>
 #include <cstdio>
 
-#ifdef __APPLE__
-#include <mach/mach_time.h>
-#endif
-
 #include "pbd/compose.h"
 #include "pbd/file_manager.h"
 #include "pbd/debug.h"
@@ -40,7 +36,10 @@ using namespace PBD;
 FileManager* FileDescriptor::_manager;
 
 FileManager::FileManager ()
-	: _open (0)
+	: _lru_head (0)
+	, _lru_tail (0)
+	, _open (0)
+	, _fast_hits (0)
 {
 	struct rlimit rl;
 	int const r = getrlimit (RLIMIT_NOFILE, &rl);
@@ -57,73 +56,109 @@ FileManager::FileManager ()
 
 void
 FileManager::add (FileDescriptor* d)
+{
+	/* There is nothing to do until the file is opened; it goes on
+	   the LRU list once it has been opened and released.
+	*/
+	d->_lru_prev = d->_lru_next = 0;
+	d->_in_lru = false;
+}
+
+/** Set the maximum number of files to hold open.  Files which are open
+ *  and unallocated will be closed to get down to the new limit.
+ */
+void
+FileManager::set_max_open (int n)
 {
 	Glib::Mutex::Lock lm (_mutex);
-	_files.push_back (d);
+
+	_max_open = n;
+
+	while (_open > _max_open && _lru_head) {
+		FileDescriptor* d = _lru_head;
+		lru_unlink (d);
+		close (d);
+		_stats.evictions++;
+	}
 }
 
 /** @return true on error, otherwise false */
 bool
 FileManager::allocate (FileDescriptor* d)
 {
+	/* If somebody else has this file allocated it cannot be closed
+	   under our feet, so all we need to do is to bump its refcount.
+	   A refcount only goes to or from 0 with the lock held.
+	*/
+	gint r = g_atomic_int_get (&d->_refcount);
+	while (r > 0) {
+		if (g_atomic_int_compare_and_exchange (&d->_refcount, r, r + 1)) {
+			g_atomic_int_inc (&_fast_hits);
+			return false;
+		}
+		r = g_atomic_int_get (&d->_refcount);
+	}
+
 	Glib::Mutex::Lock lm (_mutex);
 
-	if (!d->is_open()) {
+	if (d->is_open()) {
+
+		if (d->_in_lru) {
+			lru_unlink (d);
+		}
+
+		_stats.hits++;
+
+	} else {
 		
 		/* this file needs to be opened */
 		
-		if (_open == _max_open) {
+		if (_open >= _max_open) {
 
-			/* We already have the maximum allowed number of files opened, so we must try to close one.
-			   Find the unallocated, open file with the lowest last_used time.
+			/* We already have the maximum allowed number of files opened, so we must try to close one:
+			   the unallocated, open file which was released longest ago.
 			*/
 
-			double lowest_last_used = DBL_MAX;
-			list<FileDescriptor*>::iterator oldest = _files.end ();
-
-			for (list<FileDescriptor*>::iterator i = _files.begin(); i != _files.end(); ++i) {
-				if ((*i)->is_open() && (*i)->_refcount == 0) {
-					if ((*i)->_last_used < lowest_last_used) {
-						lowest_last_used = (*i)->_last_used;
-						oldest = i;
-					}
-				}
-			}
+			FileDescriptor* oldest = _lru_head;
 
-			if (oldest == _files.end()) {
+			if (oldest == 0) {
 				/* no unallocated and open files exist, so there's nothing we can do */
+				_stats.failures++;
 				return true;
 			}
 
-			close (*oldest);
+			lru_unlink (oldest);
+			close (oldest);
+			_stats.evictions++;
 			DEBUG_TRACE (
 				DEBUG::FileManager,
 				string_compose (
 					"closed file for %1 to release file handle; now have %2 of %3 open\n",
-					(*oldest)->_path, _open, _max_open
+					oldest->_path, _open, _max_open
 					)
 				);
 		}
 
+		struct timeval before;
+		gettimeofday (&before, 0);
+
 		if (d->open ()) {
 			DEBUG_TRACE (DEBUG::FileManager, string_compose ("open of %1 failed.\n", d->_path));
+			_stats.failures++;
 			return true;
 		}
 
+		struct timeval after;
+		gettimeofday (&after, 0);
+
 		_open++;
+		_stats.opens++;
+		_stats.open_usecs += (after.tv_sec - before.tv_sec) * 1000000 + (after.tv_usec - before.tv_usec);
 
 		DEBUG_TRACE (DEBUG::FileManager, string_compose ("opened file for %1; now have %2 of %3 open.\n", d->_path, _open, _max_open));
 	}
 
-#ifdef __APPLE__
-	d->_last_used = mach_absolute_time();
-#else
-	struct timespec t;
-	clock_gettime (CLOCK_MONOTONIC, &t);
-	d->_last_used = t.tv_sec + (double) t.tv_nsec / 10e9;
-#endif
-
-	d->_refcount++;
+	g_atomic_int_inc (&d->_refcount);
 	
 	return false;
 }
@@ -132,10 +167,26 @@ FileManager::allocate (FileDescriptor* d)
 void
 FileManager::release (FileDescriptor* d)
 {
+	/* If somebody else is still using this file, all we need to do
+	   is to drop its refcount.  The last user takes the lock, so that
+	   a file is always on the LRU list when it is open with a
+	   refcount of 0.
+	*/
+	gint r = g_atomic_int_get (&d->_refcount);
+	while (r > 1) {
+		if (g_atomic_int_compare_and_exchange (&d->_refcount, r, r - 1)) {
+			return;
+		}
+		r = g_atomic_int_get (&d->_refcount);
+	}
+
 	Glib::Mutex::Lock lm (_mutex);
 
-	d->_refcount--;
-	assert (d->_refcount >= 0);
+	assert (g_atomic_int_get (&d->_refcount) > 0);
+
+	if (g_atomic_int_dec_and_test (&d->_refcount) && d->is_open()) {
+		lru_link (d);
+	}
 }
 
 /** Remove a file from our lists.  It will be closed if it is currently open. */
@@ -144,6 +195,10 @@ FileManager::remove (FileDescriptor* d)
 {
 	Glib::Mutex::Lock lm (_mutex);
 
+	if (d->_in_lru) {
+		lru_unlink (d);
+	}
+
 	if (d->is_open ()) {
 		close (d);
 		DEBUG_TRACE (
@@ -151,8 +206,6 @@ FileManager::remove (FileDescriptor* d)
 			string_compose ("closed file for %1; file is being removed; now have %2 of %3 open\n", d->_path, _open, _max_open)
 			);
 	}
-
-	_files.remove (d);
 }
 
 void
@@ -165,11 +218,72 @@ FileManager::close (FileDescriptor* d)
 	_open--;
 }
 
+/** Add a file to the most-recently-released end of the LRU list */
+void
+FileManager::lru_link (FileDescriptor* d)
+{
+	/* we must have a lock on our mutex */
+
+	d->_lru_prev = _lru_tail;
+	d->_lru_next = 0;
+
+	if (_lru_tail) {
+		_lru_tail->_lru_next = d;
+	} else {
+		_lru_head = d;
+	}
+
+	_lru_tail = d;
+	d->_in_lru = true;
+}
+
+void
+FileManager::lru_unlink (FileDescriptor* d)
+{
+	/* we must have a lock on our mutex */
+
+	if (d->_lru_prev) {
+		d->_lru_prev->_lru_next = d->_lru_next;
+	} else {
+		_lru_head = d->_lru_next;
+	}
+
+	if (d->_lru_next) {
+		d->_lru_next->_lru_prev = d->_lru_prev;
+	} else {
+		_lru_tail = d->_lru_prev;
+	}
+
+	d->_lru_prev = d->_lru_next = 0;
+	d->_in_lru = false;
+}
+
+FileManager::Stats
+FileManager::stats () const
+{
+	Glib::Mutex::Lock lm (_mutex);
+
+	Stats s = _stats;
+	s.hits += (guint) g_atomic_int_get (&_fast_hits);
+	return s;
+}
+
+void
+FileManager::reset_stats ()
+{
+	Glib::Mutex::Lock lm (_mutex);
+
+	_stats = Stats ();
+	g_atomic_int_set (&_fast_hits, 0);
+}
+
 FileDescriptor::FileDescriptor (string const & n, bool w)
 	: _refcount (0)
-	, _last_used (0)
 	, _path (n)
 	, _writeable (w)
+	, _lru_prev (0)
+	, _lru_next (0)
+	, _in_lru (false)
 {
 
 }
@@ -13,49 +13,67 @@
 using namespace PBD;
 using namespace std;
 
-FPU::FPU ()
-{
-	unsigned long cpuflags = 0;
-
-	_flags = Flags (0);
-
-#ifndef ARCH_X86
-	return;
-#endif
+#ifdef ARCH_X86
 
-	
+static void
+cpuid (uint32_t leaf, uint32_t subleaf, uint32_t regs[4])
+{
 #ifndef USE_X86_64_ASM
+	/* %ebx may be the PIC register on i386, so swap it out rather
+	   than telling gcc that it is clobbered.
+	*/
 	asm volatile (
-		"mov $1, %%eax\n"
-		"pushl %%ebx\n"
+		"xchgl %%ebx, %1\n"
 		"cpuid\n"
-		"movl %%edx, %0\n"
-		"popl %%ebx\n"
-		: "=r" (cpuflags)
-		: 
-		: "%eax", "%ecx", "%edx"
+		"xchgl %%ebx, %1\n"
+		: "=a" (regs[0]), "=&r" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
+		: "0" (leaf), "2" (subleaf)
 		);
-	
 #else
-	
-	/* asm notes: although we explicitly save&restore rbx, we must tell
-	   gcc that ebx,rbx is clobbered so that it doesn't try to use it as an intermediate
-	   register when storing rbx. gcc 4.3 didn't make this "mistake", but gcc 4.4
-	   does, at least on x86_64.
-	*/
-
 	asm volatile (
-		"pushq %%rbx\n"
-		"movq $1, %%rax\n"
 		"cpuid\n"
-		"movq %%rdx, %0\n"
-		"popq %%rbx\n"
-		: "=r" (cpuflags)
-		: 
-		: "%rax", "%rbx", "%rcx", "%rdx"
+		: "=a" (regs[0]), "=b" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
+		: "0" (leaf), "2" (subleaf)
 		);
+#endif
+}
+
+/** @return the low word of XCR0, which says which register state the OS
+ *  saves across context switches.  Only valid if CPUID says OSXSAVE.
+ */
+static uint32_t
+xgetbv0 ()
+{
+	uint32_t lo;
+	uint32_t hi;
+
+	/* xgetbv, spelled out for assemblers that don't know it */
+	asm volatile (
+		".byte 0x0f, 0x01, 0xd0\n"
+		: "=a" (lo), "=d" (hi)
+		: "c" (0)
+		);
+
+	return lo;
+}
+
+#endif /* ARCH_X86 */
+
+FPU::FPU ()
+{
+	_flags = Flags (0);
+
+#ifdef ARCH_X86
+
+	uint32_t regs[4];
+
+	cpuid (0, 0, regs);
 
-#endif /* USE_X86_64_ASM */
+	uint32_t const max_leaf = regs[0];
+
+	cpuid (1, 0, regs);
+
+	uint32_t const cpuflags = regs[3];
 
 	if (cpuflags & (1<<25)) {
 		_flags = Flags (_flags | (HasSSE|HasFlushToZero));
@@ -65,6 +83,29 @@ FPU::FPU ()
 		_flags = Flags (_flags | HasSSE2);
 	}
 
+	/* AVX needs both the CPU (ECX bit 28) and the OS, which must have
+	   enabled XSAVE (ECX bit 27) and be saving the XMM and YMM state.
+	*/
+
+	if ((regs[2] & (1<<27)) && (regs[2] & (1<<28))) {
+
+		uint32_t const xcr0 = xgetbv0 ();
+
+		if ((xcr0 & 0x6) == 0x6) {
+
+			_flags = Flags (_flags | HasAVX);
+
+			/* AVX-512 additionally needs the opmask and ZMM state saved */
+
+			if (max_leaf >= 7 && (xcr0 & 0xe0) == 0xe0) {
+				cpuid (7, 0, regs);
+				if (regs[1] & (1<<16)) {
+					_flags = Flags (_flags | HasAVX512F);
+				}
+			}
+		}
+	}
+
 	if (cpuflags & (1 << 24)) {
 		
 		char* fxbuf = 0;
@@ -102,7 +143,9 @@ FPU::FPU ()
 			free (fxbuf);
 		}
 	}
-}			
+
+#endif /* ARCH_X86 */
+}
 
 FPU::~FPU ()
 {
@@ -82,12 +82,45 @@ AbstractUI<RequestObject>::get_request (RequestType rt)
 		return vec.buf[0];
 	}
 
+	if (rt == BaseUI::CallSlot) {
+		Glib::Mutex::Lock lm (request_list_lock);
+
+		if (!request_pool.empty()) {
+			RequestObject* req = request_pool.back ();
+			request_pool.pop_back ();
+			req->type = rt;
+			req->valid = true;
+			return req;
+		}
+	}
+
 	RequestObject* req = new RequestObject;
 	req->type = rt;
 
 	return req;
 }
 
+/** Keep a request from the generic request list for re-use, or delete it.
+ *  Must be called with request_list_lock held.
+ */
+template <typename RequestObject> void
+AbstractUI<RequestObject>::recycle_request (RequestObject* req)
+{
+	if (req->type != BaseUI::CallSlot || request_pool.size() >= max_pooled_requests) {
+		delete req;
+		return;
+	}
+
+	if (request_pool.capacity() < max_pooled_requests) {
+		request_pool.reserve (max_pooled_requests);
+	}
+
+	/* drop anything bound into the slot now, rather than when the request is re-used */
+	req->the_slot = boost::function<void()> ();
+	req->invalidation = 0;
+	request_pool.push_back (req);
+}
+
 template <typename RequestObject> void
 AbstractUI<RequestObject>::handle_ui_requests ()
 {
@@ -152,7 +185,9 @@ AbstractUI<RequestObject>::handle_ui_requests ()
 
 	while (!request_list.empty()) {
 		RequestObject* req = request_list.front ();
-		request_list.pop_front ();
+
+		/* keep the list node for a later request */
+		request_nodes.splice (request_nodes.end(), request_list, request_list.begin());
 
                 /* We need to use this lock, because its the one
                    returned by slot_invalidation_mutex() and protects
@@ -161,7 +196,7 @@ AbstractUI<RequestObject>::handle_ui_requests ()
 
                 request_buffer_map_lock.lock ();
                 if (!req->valid) {
-                        delete req;
+                        recycle_request (req);
                         request_buffer_map_lock.unlock ();
                         continue;
                 }
@@ -181,9 +216,9 @@ AbstractUI<RequestObject>::handle_ui_requests ()
 
 		do_request (req);
 
-		delete req;
-
 		lm.acquire();
+
+		recycle_request (req);
 	}
 }
 
@@ -206,7 +241,13 @@ AbstractUI<RequestObject>::send_request (RequestObject *req)
 			   single-reader/single-writer semantics
 			*/
 			Glib::Mutex::Lock lm (request_list_lock);
-			request_list.push_back (req);
+
+			if (!request_nodes.empty()) {
+				request_list.splice (request_list.end(), request_nodes, request_nodes.begin());
+				request_list.back() = req;
+			} else {
+				request_list.push_back (req);
+			}
 		}
 
 		request_channel.wakeup ();
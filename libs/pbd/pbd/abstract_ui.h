@@ -22,6 +22,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include <pthread.h>
 
 #include <glibmm/thread.h>
@@ -38,7 +39,11 @@ class AbstractUI : public BaseUI
 {
   public:
 	AbstractUI (const std::string& name);
-	virtual ~AbstractUI() {}
+	virtual ~AbstractUI() {
+		for (typename std::vector<RequestObject*>::iterator i = request_pool.begin(); i != request_pool.end(); ++i) {
+			delete *i;
+		}
+	}
 
 	void register_thread (std::string, pthread_t, std::string, uint32_t num_requests);
 	void call_slot (EventLoop::InvalidationRecord*, const boost::function<void()>&);
@@ -64,8 +69,19 @@ class AbstractUI : public BaseUI
 	
 	Glib::Mutex               request_list_lock;
 	std::list<RequestObject*> request_list;
-	
+
+	/* Requests from threads which have no request buffer are kept for
+	   re-use once they have been handled, along with the list nodes
+	   which held them, so that a thread which calls slots in this
+	   UI over and over again does not allocate memory each time.
+	   These are protected by request_list_lock.
+	*/
+	static const uint32_t     max_pooled_requests = 256;
+	std::vector<RequestObject*> request_pool;
+	std::list<RequestObject*> request_nodes;
+
 	RequestObject* get_request (RequestType);
+	void recycle_request (RequestObject *);
 	void handle_ui_requests ();
 	void send_request (RequestObject *);
 
@@ -47,6 +47,11 @@ public:
 		return false;
 	}
 
+	/** @return rough number of bytes of memory used to store this command */
+	virtual size_t approximate_size () const {
+		return sizeof (Command) + _name.size();
+	}
+
 protected:
 	Command() {}
 	Command(const std::string& name) : _name(name) {}
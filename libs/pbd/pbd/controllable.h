@@ -24,6 +24,8 @@
 #include <set>
 #include <map>
 
+#include <boost/unordered_map.hpp>
+
 #include "pbd/signals.h"
 #include <glibmm/thread.h>
 
@@ -98,8 +100,16 @@ class Controllable : public PBD::StatefulDestructible {
 	static void remove (Controllable*);
 
 	typedef std::set<PBD::Controllable*> Controllables;
+	typedef boost::unordered_multimap<PBD::ID, PBD::Controllable*> ControllablesByID;
+	typedef boost::unordered_multimap<std::string, PBD::Controllable*> ControllablesByName;
+
+	static void unindex_id (Controllable*);
+
+	/* all of these are protected by registry_lock */
 	static Glib::StaticRWLock registry_lock;
 	static Controllables registry;
+	static ControllablesByID registry_by_id;
+	static ControllablesByName registry_by_name;
 };
 
 /* a utility class for the occasions when you need but do not have
@@ -22,8 +22,8 @@
 
 #include <sys/types.h>
 #include <string>
-#include <map>
-#include <list>
+#include <stdint.h>
+#include <glib.h>
 #include <glibmm/thread.h>
 #include "pbd/signals.h"
 
@@ -39,7 +39,8 @@ class FileManager;
  *  FileDescriptors are reference counted as they are allocated and
  *  released.  When a descriptor's refcount is 0, the file on the
  *  filesystem is eligible to be closed if necessary to free up file
- *  handles for other files.
+ *  handles for other files; the one that has been idle for longest is
+ *  closed first.
  *
  *  The upshot of all this is that Ardour can manage the number of
  *  open files to stay within limits imposed by the operating system.
@@ -59,12 +60,15 @@ public:
 	/** Emitted when the file is closed */
 	PBD::Signal0<void> Closed;
 
+	static FileManager* manager ();
+
 protected:
 
 	friend class FileManager;
 
 	/* These methods and variables must be called / accessed
-	   with a lock held on the FileManager's mutex
+	   with a lock held on the FileManager's mutex, except
+	   for _refcount, which is only changed atomically.
 	*/
 
 	/** @return false on success, true on failure */
@@ -72,15 +76,17 @@ protected:
 	virtual void close () = 0;
 	virtual bool is_open () const = 0;
 
-	int _refcount; ///< number of active users of this file
-	double _last_used; ///< monotonic time that this file was last allocated
+	volatile gint _refcount; ///< number of active users of this file
 	std::string _path; ///< file path
 	bool _writeable; ///< true if it should be opened writeable, otherwise false
 
-	FileManager* manager ();
-	
 private:
-	
+
+	/* links in the FileManager's list of open, unallocated files */
+	FileDescriptor* _lru_prev;
+	FileDescriptor* _lru_next;
+	bool _in_lru;
+
 	static FileManager* _manager;
 };
 
@@ -128,7 +134,17 @@ private:
 };
 
 
-/** Class to limit the number of files held open */
+/** Class to limit the number of files held open.
+ *
+ *  Files which are open but not allocated are kept on a list in the
+ *  order in which they were released, so that finding the one to
+ *  close when we run out of handles, and taking a file off the list
+ *  when it is allocated again, are both O(1).
+ *
+ *  Allocating a file which somebody else already has allocated only
+ *  bumps its refcount, without taking the lock; so does releasing
+ *  a file which somebody else is still using.
+ */
 class FileManager
 {
 public:
@@ -140,14 +156,36 @@ public:
 	void release (FileDescriptor *);
 	bool allocate (FileDescriptor *);
 
+	void set_max_open (int);
+	int max_open () const { return _max_open; }
+
+	/** Counts of what allocate() has had to do since the last reset_stats() */
+	struct Stats {
+		Stats () : hits (0), opens (0), evictions (0), failures (0), open_usecs (0) {}
+
+		uint64_t hits;       ///< allocations of files which were already open
+		uint64_t opens;      ///< allocations which had to open the file
+		uint64_t evictions;  ///< files closed to make room for others
+		uint64_t failures;   ///< allocations which failed
+		uint64_t open_usecs; ///< total time spent opening files
+	};
+
+	Stats stats () const;
+	void reset_stats ();
+
 private:
 	
 	void close (FileDescriptor *);
+	void lru_link (FileDescriptor *);
+	void lru_unlink (FileDescriptor *);
 
-	std::list<FileDescriptor*> _files; ///< files we know about
-	Glib::Mutex _mutex; ///< mutex for _files, _open and FileDescriptor contents
+	mutable Glib::Mutex _mutex; ///< mutex for the LRU list, _open, _stats and FileDescriptor contents
+	FileDescriptor* _lru_head; ///< open, unallocated file which was released longest ago
+	FileDescriptor* _lru_tail; ///< open, unallocated file which was released most recently
 	int _open; ///< number of open files
 	int _max_open; ///< maximum number of open files
+	Stats _stats;
+	volatile gint _fast_hits; ///< hits which did not need the lock, and so are not in _stats
 };
 
 }
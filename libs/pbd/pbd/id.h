@@ -21,6 +21,7 @@
 #define __pbd_id_h__
 
 #include <stdint.h>
+#include <cstddef>
 #include <string>
 
 #include <glibmm/thread.h>
@@ -50,6 +51,11 @@ class ID {
 		return _id < other._id;
 	}
 
+	/** for boost::hash, so that IDs can be used as keys of unordered containers */
+	friend std::size_t hash_value (const ID& id) {
+		return (std::size_t) id._id;
+	}
+
 	void print (char* buf, uint32_t bufsize) const;
         std::string to_s() const;
 	
@@ -153,6 +153,12 @@ public:
 		return *node;
 	}
 
+	size_t approximate_size () const {
+		return sizeof (*this) + _name.size()
+			+ (before ? before->approximate_size() : 0)
+			+ (after ? after->approximate_size() : 0);
+	}
+
 protected:
 	MementoCommandBinder<obj_T>* _binder;
 	XMLNode* before;
@@ -158,6 +158,10 @@ public:
 		}
 	}
 
+	size_t approximate_size () const {
+		return sizeof (*this);
+	}
+
 protected:
 
 	void set (T const& v) {
@@ -149,6 +149,9 @@ public:
 	/** Set this property's current state from another */
 	virtual void apply_changes (PropertyBase const *) = 0;
 
+	/** @return rough number of bytes of memory used by this property */
+	virtual size_t approximate_size () const { return sizeof (PropertyBase); }
+
 	const gchar* property_name () const { return g_quark_to_string (_property_id); }
 	PropertyID   property_id () const   { return _property_id; }
 
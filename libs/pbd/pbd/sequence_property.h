@@ -343,6 +343,11 @@ class SequenceProperty : public PropertyBase
         
         const ChangeRecord& changes () const { return _changes; }
 
+	size_t approximate_size () const {
+		/* each change is a node in a std::set */
+		return sizeof (*this) + (_changes.added.size() + _changes.removed.size()) * (sizeof (typename Container::value_type) + 4 * sizeof (void*));
+	}
+
 protected:
 
 	/* copy construction only by subclasses */
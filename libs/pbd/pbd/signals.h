@@ -21,19 +21,103 @@
 #define __pbd_signals_h__
 
 #include <list>
+#include <vector>
+#include <utility>
+
+#include <glib.h>
 #include <glibmm/thread.h>
 
-#include <boost/signals2.hpp>
 #include <boost/noncopyable.hpp>
+#include <boost/function.hpp>
 #include <boost/bind.hpp>
 #include <boost/bind/protect.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/optional.hpp>
 
 #include "pbd/event_loop.h"
 
 namespace PBD {
 
-typedef boost::signals2::connection UnscopedConnection;
-typedef boost::signals2::scoped_connection ScopedConnection;
+class Connection;
+
+class SignalBase
+{
+  public:
+	virtual ~SignalBase () {}
+	virtual void disconnect (boost::shared_ptr<Connection>) = 0;
+
+  protected:
+	/** held while slots are connected or disconnected, and while the signal is destroyed */
+	Glib::Mutex _mutex;
+};
+
+/** A connection between a signal and one of its slots */
+class Connection : public boost::enable_shared_from_this<Connection>, public boost::noncopyable
+{
+  public:
+	Connection (SignalBase* b) : _signal (b), _connected (1) {}
+
+	void disconnect () {
+		Glib::Mutex::Lock lm (_mutex);
+		g_atomic_int_set (&_connected, 0);
+		if (_signal) {
+			_signal->disconnect (shared_from_this ());
+			_signal = 0;
+		}
+	}
+
+	/** @return true if the slot is still connected; safe to call from any thread */
+	bool connected () const {
+		return g_atomic_int_get (&_connected);
+	}
+
+	/** Called by the signal when it is destroyed */
+	void signal_going_away () {
+		Glib::Mutex::Lock lm (_mutex);
+		g_atomic_int_set (&_connected, 0);
+		_signal = 0;
+	}
+
+  private:
+	Glib::Mutex _mutex;
+	SignalBase* _signal;
+	mutable gint _connected;
+};
+
+typedef boost::shared_ptr<Connection> UnscopedConnection;
+
+/** A connection which is broken when this object is destroyed.  It cannot
+ *  be copied, since each copy would break the connection when destroyed.
+ */
+class ScopedConnection : public boost::noncopyable
+{
+  public:
+	ScopedConnection () {}
+	ScopedConnection (UnscopedConnection c) : _c (c) {}
+	~ScopedConnection () {
+		disconnect ();
+	}
+
+	void disconnect () {
+		if (_c) {
+			_c->disconnect ();
+		}
+	}
+
+	ScopedConnection& operator= (UnscopedConnection const & o) {
+		if (_c == o) {
+			return *this;
+		}
+
+		disconnect ();
+		_c = o;
+		return *this;
+	}
+
+  private:
+	UnscopedConnection _c;
+};
 
 class ScopedConnectionList  : public boost::noncopyable
 {
@@ -53,7 +137,7 @@ class ScopedConnectionList  : public boost::noncopyable
 	   when adding or dropping connections, which are generally occuring
 	   in object creation and UI operations, the contention on this 
 	   lock is low and not of significant consequence. Even though
-	   boost::signals2 is thread-safe, this additional list of
+	   our signals are thread-safe, this additional list of
 	   scoped connections needs to be protected in 2 cases:
 
 	   (1) (unlikely) we make a connection involving a callback on the
@@ -70,257 +154,389 @@ class ScopedConnectionList  : public boost::noncopyable
 	ConnectionList _list;
 };
 
+/** The default way of combining the values returned by a signal's slots:
+ *  the value returned by the last slot, or nothing if there are no slots.
+ */
 template<typename R>
-class Signal0 {
-public:
-    Signal0 () {}
-    typedef boost::signals2::signal<R()> SignalType;
-
-    void connect_same_thread (ScopedConnection& c, 
-		  const typename SignalType::slot_function_type& slot) {
-	    c = _signal.connect (slot);
-    }
-
-    void connect_same_thread (ScopedConnectionList& clist, 
-		  const typename SignalType::slot_function_type& slot) {
-	    clist.add_connection (_signal.connect (slot));
-    }
-
-    void connect (ScopedConnectionList& clist, 
-                  PBD::EventLoop::InvalidationRecord* ir, 
-		  const typename SignalType::slot_function_type& slot,
-		  PBD::EventLoop* event_loop) {
-	    if (ir) {
-		    ir->event_loop = event_loop;
-	    }
-	    clist.add_connection (_signal.connect (boost::bind (&EventLoop::call_slot, event_loop, ir, slot)));
-    }
-    
-    void connect (ScopedConnection& c, 
-                  PBD::EventLoop::InvalidationRecord* ir, 
-		  const typename SignalType::slot_function_type& slot,
-		  PBD::EventLoop* event_loop) {
-	    if (ir) {
-		    ir->event_loop = event_loop;
-	    }
-	    c = _signal.connect (boost::bind (&EventLoop::call_slot, event_loop, ir, slot));
-    }
-    
-    typename SignalType::result_type operator()() {
-	    return _signal ();
-    }
-
-    bool empty() const { return _signal.empty(); }
-    
-private:
-    SignalType _signal;
+class OptionalLastValue
+{
+  public:
+	typedef boost::optional<R> result_type;
+
+	template <typename Iter>
+	result_type operator() (Iter first, Iter last) const {
+		result_type r;
+		while (first != last) {
+			r = *first;
+			++first;
+		}
+
+		return r;
+	}
+};
+
+/** A slot which passes its arguments to another slot, to be called in an event loop */
+template<typename F>
+class EventLoopSlot
+{
+  public:
+	EventLoopSlot (boost::function<F> const & f, EventLoop* l, EventLoop::InvalidationRecord* ir)
+		: _f (f), _event_loop (l), _ir (ir) {}
+
+	void operator() () {
+		_event_loop->call_slot (_ir, _f);
+	}
+
+	template<typename A1>
+	void operator() (A1 a1) {
+		_event_loop->call_slot (_ir, boost::bind (_f, a1));
+	}
+
+	template<typename A1, typename A2>
+	void operator() (A1 a1, A2 a2) {
+		_event_loop->call_slot (_ir, boost::bind (_f, a1, a2));
+	}
+
+	template<typename A1, typename A2, typename A3>
+	void operator() (A1 a1, A2 a2, A3 a3) {
+		_event_loop->call_slot (_ir, boost::bind (_f, a1, a2, a3));
+	}
+
+	template<typename A1, typename A2, typename A3, typename A4>
+	void operator() (A1 a1, A2 a2, A3 a3, A4 a4) {
+		_event_loop->call_slot (_ir, boost::bind (_f, a1, a2, a3, a4));
+	}
+
+  private:
+	boost::function<F> _f;
+	EventLoop* _event_loop;
+	EventLoop::InvalidationRecord* _ir;
+};
+
+/** The parts of a signal which do not depend on how many arguments it has.
+ *
+ *  The slots are kept in an array which is replaced, rather than modified,
+ *  when a slot is connected or disconnected.  Emission uses the current
+ *  array without locking, so a signal can be emitted from a realtime thread
+ *  without blocking or allocating memory (though a slot which is called in
+ *  an event loop will still copy its arguments).  A replaced array is not
+ *  deleted until no emission is in progress.  A slot which is disconnected
+ *  during an emission is not called after its disconnection.
+ */
+template<typename F>
+class SignalImpl : public SignalBase
+{
+  public:
+	typedef boost::function<F> slot_function_type;
+
+	SignalImpl () : _slots (new Slots), _emissions (0) {}
+
+	~SignalImpl () {
+		/* Connection::disconnect takes the connection's lock and then our
+		   _mutex, so we must not hold _mutex while taking the connections'
+		   locks.  Once signal_going_away() has returned for a connection,
+		   it can no longer call back into us.
+		*/
+		std::vector<boost::shared_ptr<Connection> > connections;
+
+		{
+			Glib::Mutex::Lock lm (_mutex);
+			Slots* s = (Slots*) _slots;
+			for (typename Slots::iterator i = s->begin(); i != s->end(); ++i) {
+				connections.push_back (i->first);
+			}
+		}
+
+		for (typename std::vector<boost::shared_ptr<Connection> >::iterator i = connections.begin(); i != connections.end(); ++i) {
+			(*i)->signal_going_away ();
+		}
+
+		Glib::Mutex::Lock lm (_mutex);
+		delete (Slots*) _slots;
+		delete_retired_slots ();
+	}
+
+	void connect_same_thread (ScopedConnection& c, const slot_function_type& slot) {
+		c = _connect (slot);
+	}
+
+	void connect_same_thread (ScopedConnectionList& clist, const slot_function_type& slot) {
+		clist.add_connection (_connect (slot));
+	}
+
+	void connect (ScopedConnectionList& clist,
+		      PBD::EventLoop::InvalidationRecord* ir,
+		      const slot_function_type& slot,
+		      PBD::EventLoop* event_loop) {
+		if (ir) {
+			ir->event_loop = event_loop;
+		}
+		clist.add_connection (_connect (EventLoopSlot<F> (slot, event_loop, ir)));
+	}
+
+	void connect (ScopedConnection& c,
+		      PBD::EventLoop::InvalidationRecord* ir,
+		      const slot_function_type& slot,
+		      PBD::EventLoop* event_loop) {
+		if (ir) {
+			ir->event_loop = event_loop;
+		}
+		c = _connect (EventLoopSlot<F> (slot, event_loop, ir));
+	}
+
+	bool empty () const {
+		Emission e (*this);
+		return e.slots->empty ();
+	}
+
+	void disconnect (boost::shared_ptr<Connection> c) {
+		Glib::Mutex::Lock lm (_mutex);
+
+		Slots* s = new Slots (*((Slots*) _slots));
+		for (typename Slots::iterator i = s->begin(); i != s->end(); ++i) {
+			if (i->first == c) {
+				s->erase (i);
+				break;
+			}
+		}
+
+		replace_slots (s);
+	}
+
+  protected:
+	typedef std::pair<boost::shared_ptr<Connection>, slot_function_type> Slot;
+	typedef std::vector<Slot> Slots;
+
+	/** Access to the current slots for the lifetime of an emission */
+	class Emission {
+	  public:
+		Emission (SignalImpl const & s) : _signal (s) {
+			g_atomic_int_inc (&_signal._emissions);
+			slots = (Slots const *) g_atomic_pointer_get (&_signal._slots);
+		}
+
+		~Emission () {
+			g_atomic_int_add (&_signal._emissions, -1);
+		}
+
+		Slots const * slots;
+
+	  private:
+		SignalImpl const & _signal;
+	};
+
+	friend class Emission;
+
+  private:
+	mutable volatile gpointer _slots;
+	mutable gint _emissions; ///< number of emissions in progress
+	std::list<Slots*> _retired;  ///< replaced slots which an emission may still be using
+
+	UnscopedConnection _connect (slot_function_type const & f) {
+		boost::shared_ptr<Connection> c (new Connection (this));
+		Glib::Mutex::Lock lm (_mutex);
+
+		Slots* s = new Slots (*((Slots*) _slots));
+		s->push_back (Slot (c, f));
+		replace_slots (s);
+
+		return c;
+	}
+
+	/** Make some new slots current; must be called with _mutex held */
+	void replace_slots (Slots* s) {
+		_retired.push_back ((Slots*) _slots);
+		g_atomic_pointer_set (&_slots, s);
+
+		/* an emission which starts after this sees the new slots, so if
+		   there are none now, nothing can be using the old ones
+		*/
+		if (g_atomic_int_get (&_emissions) == 0) {
+			delete_retired_slots ();
+		}
+	}
+
+	void delete_retired_slots () {
+		for (typename std::list<Slots*>::iterator i = _retired.begin(); i != _retired.end(); ++i) {
+			delete *i;
+		}
+		_retired.clear ();
+	}
+};
+
+/* Signals whose slots take from 0 to 4 arguments.  The values returned by the
+   slots are combined by C; signals which return void have their own emission,
+   which does not allocate.
+*/
+
+template<typename R, typename C = OptionalLastValue<R> >
+class Signal0 : public SignalImpl<R()>
+{
+  public:
+	typename C::result_type operator() () {
+		typedef typename SignalImpl<R()>::Slots Slots;
+		typename SignalImpl<R()>::Emission e (*this);
+		std::list<R> r;
+		for (typename Slots::const_iterator i = e.slots->begin(); i != e.slots->end(); ++i) {
+			if (i->first->connected ()) {
+				r.push_back ((i->second) ());
+			}
+		}
+
+		C c;
+		return c (r.begin(), r.end());
+	}
+};
+
+template<typename C>
+class Signal0<void, C> : public SignalImpl<void()>
+{
+  public:
+	void operator() () {
+		typedef typename SignalImpl<void()>::Slots Slots;
+		typename SignalImpl<void()>::Emission e (*this);
+		for (typename Slots::const_iterator i = e.slots->begin(); i != e.slots->end(); ++i) {
+			if (i->first->connected ()) {
+				(i->second) ();
+			}
+		}
+	}
+};
+
+template<typename R, typename A1, typename C = OptionalLastValue<R> >
+class Signal1 : public SignalImpl<R(A1)>
+{
+  public:
+	typename C::result_type operator() (A1 a1) {
+		typedef typename SignalImpl<R(A1)>::Slots Slots;
+		typename SignalImpl<R(A1)>::Emission e (*this);
+		std::list<R> r;
+		for (typename Slots::const_iterator i = e.slots->begin(); i != e.slots->end(); ++i) {
+			if (i->first->connected ()) {
+				r.push_back ((i->second) (a1));
+			}
+		}
+
+		C c;
+		return c (r.begin(), r.end());
+	}
+};
+
+template<typename A1, typename C>
+class Signal1<void, A1, C> : public SignalImpl<void(A1)>
+{
+  public:
+	void operator() (A1 a1) {
+		typedef typename SignalImpl<void(A1)>::Slots Slots;
+		typename SignalImpl<void(A1)>::Emission e (*this);
+		for (typename Slots::const_iterator i = e.slots->begin(); i != e.slots->end(); ++i) {
+			if (i->first->connected ()) {
+				(i->second) (a1);
+			}
+		}
+	}
+};
+
+template<typename R, typename A1, typename A2, typename C = OptionalLastValue<R> >
+class Signal2 : public SignalImpl<R(A1, A2)>
+{
+  public:
+	typename C::result_type operator() (A1 a1, A2 a2) {
+		typedef typename SignalImpl<R(A1, A2)>::Slots Slots;
+		typename SignalImpl<R(A1, A2)>::Emission e (*this);
+		std::list<R> r;
+		for (typename Slots::const_iterator i = e.slots->begin(); i != e.slots->end(); ++i) {
+			if (i->first->connected ()) {
+				r.push_back ((i->second) (a1, a2));
+			}
+		}
+
+		C c;
+		return c (r.begin(), r.end());
+	}
+};
+
+template<typename A1, typename A2, typename C>
+class Signal2<void, A1, A2, C> : public SignalImpl<void(A1, A2)>
+{
+  public:
+	void operator() (A1 a1, A2 a2) {
+		typedef typename SignalImpl<void(A1, A2)>::Slots Slots;
+		typename SignalImpl<void(A1, A2)>::Emission e (*this);
+		for (typename Slots::const_iterator i = e.slots->begin(); i != e.slots->end(); ++i) {
+			if (i->first->connected ()) {
+				(i->second) (a1, a2);
+			}
+		}
+	}
 };
 
-template<typename R, typename A, typename C = boost::signals2::optional_last_value<R> >
-class Signal1 {
-public:
-    Signal1 () {}
-    typedef boost::signals2::signal<R(A), C> SignalType;
-
-    void connect_same_thread (ScopedConnectionList& clist, 
-		  const typename SignalType::slot_function_type& slot) {
-	    clist.add_connection (_signal.connect (slot));
-    }
-
-    void connect_same_thread (ScopedConnection& c, 
-		     const typename SignalType::slot_function_type& slot) {
-	    c = _signal.connect (slot);
-    }
-
-    static void compositor (typename boost::function<void(A)> f, EventLoop* event_loop, EventLoop::InvalidationRecord* ir, A arg) {
-	    event_loop->call_slot (ir, boost::bind (f, arg));
-    }
-
-    void connect (ScopedConnectionList& clist, 
-                  PBD::EventLoop::InvalidationRecord* ir, 
-		  const typename SignalType::slot_function_type& slot,
-		  PBD::EventLoop* event_loop) {
-	    if (ir) {
-		    ir->event_loop = event_loop;
-	    }
-	    clist.add_connection (_signal.connect (boost::bind (&compositor, slot, event_loop, ir, _1)));
-    }
-
-    void connect (ScopedConnection& c, 
-                  PBD::EventLoop::InvalidationRecord* ir, 
-		  const typename SignalType::slot_function_type& slot,
-		  PBD::EventLoop* event_loop) {
-	    if (ir) {
-		    ir->event_loop = event_loop;
-	    }
-	    c = _signal.connect (boost::bind (&compositor, slot, event_loop, ir, _1));
-
-    }
-    
-    typename SignalType::result_type operator()(A arg1) {
-	    return _signal (arg1);
-    }
-    
-    bool empty() const { return _signal.empty(); }
-
-private:
-    SignalType _signal;
+template<typename R, typename A1, typename A2, typename A3, typename C = OptionalLastValue<R> >
+class Signal3 : public SignalImpl<R(A1, A2, A3)>
+{
+  public:
+	typename C::result_type operator() (A1 a1, A2 a2, A3 a3) {
+		typedef typename SignalImpl<R(A1, A2, A3)>::Slots Slots;
+		typename SignalImpl<R(A1, A2, A3)>::Emission e (*this);
+		std::list<R> r;
+		for (typename Slots::const_iterator i = e.slots->begin(); i != e.slots->end(); ++i) {
+			if (i->first->connected ()) {
+				r.push_back ((i->second) (a1, a2, a3));
+			}
+		}
+
+		C c;
+		return c (r.begin(), r.end());
+	}
 };
 
-template<typename R, typename A1, typename A2>
-class Signal2 {
-public:
-    Signal2 () {}
-    typedef boost::signals2::signal<R(A1, A2)> SignalType;
-
-    void connect_same_thread (ScopedConnectionList& clist, 
-		  const typename SignalType::slot_function_type& slot) {
-	    clist.add_connection (_signal.connect (slot));
-    }
-
-    void connect_same_thread (ScopedConnection& c, 
-		     const typename SignalType::slot_function_type& slot) {
-	    c = _signal.connect (slot);
-    }
-
-    static void compositor (typename boost::function<void(A1,A2)> f, PBD::EventLoop* event_loop, 
-                            EventLoop::InvalidationRecord* ir,
-                            A1 arg1, A2 arg2) {
-	    event_loop->call_slot (ir, boost::bind (f, arg1, arg2));
-    }
-
-    void connect (ScopedConnectionList& clist, 
-                  PBD::EventLoop::InvalidationRecord* ir, 
-		  const typename SignalType::slot_function_type& slot,
-		  PBD::EventLoop* event_loop) {
-	    if (ir) {
-		    ir->event_loop = event_loop;
-	    }
-	    clist.add_connection (_signal.connect (boost::bind (&compositor, slot, event_loop, ir, _1, _2)));
-    }
-
-    void connect (ScopedConnection& c, 
-                  PBD::EventLoop::InvalidationRecord* ir, 
-		  const typename SignalType::slot_function_type& slot,
-		  PBD::EventLoop* event_loop) {
-	    if (ir) {
-		    ir->event_loop = event_loop;
-	    }
-	    c = _signal.connect (boost::bind (&compositor, slot, event_loop, ir, _1, _2));
-    }
-
-    typename SignalType::result_type operator()(A1 arg1, A2 arg2) {
-	    return _signal (arg1, arg2);
-    }
-    
-    bool empty() const { return _signal.empty(); }
-
-private:
-    SignalType _signal;
+template<typename A1, typename A2, typename A3, typename C>
+class Signal3<void, A1, A2, A3, C> : public SignalImpl<void(A1, A2, A3)>
+{
+  public:
+	void operator() (A1 a1, A2 a2, A3 a3) {
+		typedef typename SignalImpl<void(A1, A2, A3)>::Slots Slots;
+		typename SignalImpl<void(A1, A2, A3)>::Emission e (*this);
+		for (typename Slots::const_iterator i = e.slots->begin(); i != e.slots->end(); ++i) {
+			if (i->first->connected ()) {
+				(i->second) (a1, a2, a3);
+			}
+		}
+	}
 };
 
-template<typename R, typename A1, typename A2, typename A3>
-class Signal3 {
-public:
-    Signal3 () {}
-    typedef boost::signals2::signal<R(A1,A2,A3)> SignalType;
-
-    void connect_same_thread (ScopedConnectionList& clist, 
-		  const typename SignalType::slot_function_type& slot) {
-	    clist.add_connection (_signal.connect (slot));
-    }
-
-    void connect_same_thread (ScopedConnection& c, 
-			      const typename SignalType::slot_function_type& slot) {
-	    c = _signal.connect (slot);
-    }
-
-    static void compositor (typename boost::function<void(A1,A2,A3)> f, PBD::EventLoop* event_loop, 
-                            EventLoop::InvalidationRecord* ir, 
-                            A1 arg1, A2 arg2, A3 arg3) {
-	    event_loop->call_slot (ir, boost::bind (f, arg1, arg2, arg3));
-    }
-
-    void connect (ScopedConnectionList& clist, 
-                  PBD::EventLoop::InvalidationRecord* ir, 
-		  const typename SignalType::slot_function_type& slot,
-		  PBD::EventLoop* event_loop) {
-	    if (ir) {
-		    ir->event_loop = event_loop;
-	    }
-	    clist.add_connection (_signal.connect (boost::bind (&compositor, slot, event_loop, ir, _1, _2, _3)));
-    }
-    
-    void connect (ScopedConnection& c, 
-                  PBD::EventLoop::InvalidationRecord* ir, 
-		  const typename SignalType::slot_function_type& slot,
-		  PBD::EventLoop* event_loop) {
-	    if (ir) {
-		    ir->event_loop = event_loop;
-	    }
-	    c = _signal.connect (_signal.connect (boost::bind (&compositor, slot, event_loop, ir, _1, _2, _3)));
-    }
-    
-    typename SignalType::result_type operator()(A1 arg1, A2 arg2, A3 arg3) {
-	    return _signal (arg1, arg2, arg3);
-    }
-    
-    bool empty() const { return _signal.empty(); }
-
-private:
-    SignalType _signal;
+template<typename R, typename A1, typename A2, typename A3, typename A4, typename C = OptionalLastValue<R> >
+class Signal4 : public SignalImpl<R(A1, A2, A3, A4)>
+{
+  public:
+	typename C::result_type operator() (A1 a1, A2 a2, A3 a3, A4 a4) {
+		typedef typename SignalImpl<R(A1, A2, A3, A4)>::Slots Slots;
+		typename SignalImpl<R(A1, A2, A3, A4)>::Emission e (*this);
+		std::list<R> r;
+		for (typename Slots::const_iterator i = e.slots->begin(); i != e.slots->end(); ++i) {
+			if (i->first->connected ()) {
+				r.push_back ((i->second) (a1, a2, a3, a4));
+			}
+		}
+
+		C c;
+		return c (r.begin(), r.end());
+	}
 };
 
-template<typename R, typename A1, typename A2, typename A3, typename A4>
-class Signal4 {
-public:
-    Signal4 () {}
-    typedef boost::signals2::signal<R(A1,A2,A3,A4)> SignalType;
-
-    void connect_same_thread (ScopedConnectionList& clist, 
-		  const typename SignalType::slot_function_type& slot) {
-	    clist.add_connection (_signal.connect (slot));
-    }
-
-    void connect_same_thread (ScopedConnection& c, 
-			      const typename SignalType::slot_function_type& slot) {
-	    c = _signal.connect (slot);
-    }
-
-    static void compositor (typename boost::function<void(A1,A2,A3)> f, PBD::EventLoop* event_loop, 
-                            EventLoop::InvalidationRecord* ir, 
-                            A1 arg1, A2 arg2, A3 arg3, A4 arg4) {
-	    event_loop->call_slot (ir, boost::bind (f, arg1, arg2, arg3, arg4));
-    }
-
-    void connect (ScopedConnectionList& clist, 
-                  PBD::EventLoop::InvalidationRecord* ir, 
-		  const typename SignalType::slot_function_type& slot,
-		  PBD::EventLoop* event_loop) {
-	    if (ir) {
-		    ir->event_loop = event_loop;
-	    }
-	    clist.add_connection (_signal.connect (boost::bind (&compositor, slot, event_loop, ir, _1, _2, _3, _4)));
-    }
-    
-    void connect (ScopedConnection& c, 
-                  PBD::EventLoop::InvalidationRecord* ir, 
-		  const typename SignalType::slot_function_type& slot,
-		  PBD::EventLoop* event_loop) {
-	    if (ir) {
-		    ir->event_loop = event_loop;
-	    }
-	    c = _signal.connect (_signal.connect (boost::bind (&compositor, slot, event_loop, ir, _1, _2, _3, _4)));
-    }
-    
-    typename SignalType::result_type operator()(A1 arg1, A2 arg2, A3 arg3, A4 arg4) {
-	    return _signal (arg1, arg2, arg3, arg4);
-    }
-    
-    bool empty() const { return _signal.empty(); }
-
-private:
-    SignalType _signal;
+template<typename A1, typename A2, typename A3, typename A4, typename C>
+class Signal4<void, A1, A2, A3, A4, C> : public SignalImpl<void(A1, A2, A3, A4)>
+{
+  public:
+	void operator() (A1 a1, A2 a2, A3 a3, A4 a4) {
+		typedef typename SignalImpl<void(A1, A2, A3, A4)>::Slots Slots;
+		typename SignalImpl<void(A1, A2, A3, A4)>::Emission e (*this);
+		for (typename Slots::const_iterator i = e.slots->begin(); i != e.slots->end(); ++i) {
+			if (i->first->connected ()) {
+				(i->second) (a1, a2, a3, a4);
+			}
+		}
+	}
 };
 
 } /* namespace */
@@ -0,0 +1,91 @@
+/*
+    Copyright (C) 2011 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __libpbd_state_diff_property_h__
+#define __libpbd_state_diff_property_h__
+
+#include "pbd/property_basics.h"
+#include "pbd/xml++.h"
+
+namespace PBD {
+
+class Stateful;
+
+/** A property which records changes to its owner as the range of
+ *  children of the owner's state node which were replaced, and the
+ *  nodes which replaced them.
+ *
+ *  This suits objects whose state is a list of similar things, such as
+ *  markers or tempo sections, of which an edit usually changes only
+ *  one or two; the undo history then holds the things which changed,
+ *  rather than two copies of all of them.
+ *
+ *  clear_changes() takes a copy of the owner's state to compare with
+ *  later, so it must be called before the edit is made; the copy is
+ *  dropped once get_changes_as_properties() has recorded the edit.
+ *  Changes are applied by patching the owner's current state and
+ *  passing it to the owner's set_state().
+ */
+class StateDiffProperty : public PropertyBase
+{
+public:
+	StateDiffProperty (PropertyID, Stateful &);
+	StateDiffProperty (StateDiffProperty const &);
+	~StateDiffProperty ();
+
+	/* the owner's state is saved by the owner */
+	bool set_value (XMLNode const &) { return false; }
+	void get_value (XMLNode &) const {}
+
+	void clear_changes ();
+	bool changed () const;
+	void invert ();
+
+	void get_changes_as_xml (XMLNode *) const;
+	void get_changes_as_properties (PropertyList &, Command *) const;
+	StateDiffProperty* clone_from_xml (XMLNode const &) const;
+
+	StateDiffProperty* clone () const;
+	void apply_changes (PropertyBase const *);
+	size_t approximate_size () const;
+
+private:
+	StateDiffProperty (PropertyID);
+
+	void clear_diff ();
+	XMLNode* patch (XMLNode const &) const;
+
+	/** object whose state we describe, or 0 if we are just a record of changes */
+	Stateful* _owner;
+	/** owner's state when clear_changes() was last called, until the
+	 *  change since then has been recorded
+	 */
+	mutable XMLNode* _old_state;
+
+	/* the change: children from _offset to _offset + _removed.size()
+	   were replaced by _added
+	*/
+	size_t _offset;
+	XMLNodeList _removed;
+	XMLNodeList _added;
+};
+
+}
+
+#endif /* __libpbd_state_diff_property_h__ */
@@ -82,6 +82,9 @@ class Stateful {
 	 */
 	PBD::Signal1<void,const PropertyChange&> PropertyChanged;
 
+	/** Emitted when add_extra_xml() changes the extra XML node */
+	PBD::Signal0<void> ExtraXMLChanged;
+
 	static int current_state_version;
 	static int loading_state_version;
 
@@ -32,12 +32,19 @@ class PropertyList;
 
 /** A Command which stores its action as the differences between the before and after
  *  state of a Stateful object.
+ *
+ *  The object may either be managed by a shared_ptr, or be one which
+ *  lives as long as the session (like the Locations or the TempoMap)
+ *  and which is passed by reference; in the latter case the command
+ *  forgets the object when it is destroyed.
  */
 class StatefulDiffCommand : public Command
 {
 public:
 	StatefulDiffCommand (boost::shared_ptr<StatefulDestructible>);
 	StatefulDiffCommand (boost::shared_ptr<StatefulDestructible>, XMLNode const &);
+	StatefulDiffCommand (StatefulDestructible &);
+	StatefulDiffCommand (StatefulDestructible &, XMLNode const &);
 	~StatefulDiffCommand ();
 
 	void operator() ();
@@ -46,10 +53,16 @@ public:
 	XMLNode& get_state ();
 
 	bool empty () const;
+	size_t approximate_size () const;
 
 private:
-	boost::weak_ptr<Stateful> _object; ///< the object in question
+	boost::weak_ptr<Stateful> _object; ///< the object in question, if it is managed by a shared_ptr
+	Stateful* _unmanaged_object; ///< the object in question, if not
         PBD::PropertyList* _changes; ///< property changes to execute this command
+
+	void set_changes_from_xml (StatefulDestructible const &, XMLNode const &);
+	void unmanaged_object_destroyed ();
+	void apply (PropertyList const &);
 };
 
 };
@@ -52,6 +52,8 @@ class UndoTransaction : public Command
 
 	XMLNode &get_state();
 
+	size_t approximate_size () const;
+
 	void set_timestamp (struct timeval &t) {
 		_timestamp = t;
 	}
@@ -103,6 +105,9 @@ class UndoHistory : public PBD::ScopedConnectionList
 
 	void set_depth (uint32_t);
 
+	/** @return rough number of bytes of memory used by the undo and redo lists */
+	size_t approximate_size () const;
+
 	PBD::Signal0<void> Changed;
 	PBD::Signal0<void> BeginUndoRedo;
 	PBD::Signal0<void> EndUndoRedo;
@@ -0,0 +1,151 @@
+/*
+    Copyright (C) 2011 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __pbd_work_stealing_deque_h__
+#define __pbd_work_stealing_deque_h__
+
+#include <glib.h>
+
+namespace PBD {
+
+/** A fixed-size, lock-free work-stealing deque of pointers (Chase & Lev, 2005).
+ *
+ *  Exactly one thread (the owner) may call push() and pop(), which operate
+ *  LIFO on the bottom of the deque.  Any other thread may call steal(),
+ *  which removes FIFO from the top.  Nothing allocates after construction,
+ *  so all three are safe to use from a realtime thread.
+ *
+ *  The storage does not grow: push() fails if the deque is full.  Indices
+ *  are free-running and compared by difference, so they may wrap.
+ */
+template<class T>
+class WorkStealingDeque
+{
+  public:
+	WorkStealingDeque (guint sz) {
+		guint power_of_two;
+		for (power_of_two = 1; 1U<<power_of_two < sz; power_of_two++) {}
+		size = 1<<power_of_two;
+		size_mask = size - 1;
+		buf = new gpointer[size];
+		reset ();
+	}
+
+	~WorkStealingDeque () {
+		delete [] buf;
+	}
+
+	void reset () {
+		/* !!! NOT THREAD SAFE !!! */
+		g_atomic_int_set (&top, 0);
+		g_atomic_int_set (&bottom, 0);
+	}
+
+	/** Owner only. @return false if the deque is full */
+	bool push (T* item) {
+		guint b = (guint) g_atomic_int_get (&bottom);
+		guint t = (guint) g_atomic_int_get (&top);
+
+		if (b - t >= size) {
+			return false;
+		}
+
+		g_atomic_pointer_set (&buf[b & size_mask], item);
+
+		/* g_atomic_int_set() is a full barrier, so the item is
+		   visible before the new bottom is.
+		*/
+		g_atomic_int_set (&bottom, (gint) (b + 1));
+		return true;
+	}
+
+	/** Owner only. @return the most recently pushed item, or 0 if empty */
+	T* pop () {
+		guint b = (guint) g_atomic_int_get (&bottom) - 1;
+
+		/* publish the reservation before looking at top, so that
+		   a concurrent steal() either sees it or we see its CAS.
+		*/
+		g_atomic_int_set (&bottom, (gint) b);
+
+		guint t = (guint) g_atomic_int_get (&top);
+		gint n = (gint) (b - t);
+
+		if (n < 0) {
+			/* empty */
+			g_atomic_int_set (&bottom, (gint) t);
+			return 0;
+		}
+
+		T* item = (T*) g_atomic_pointer_get (&buf[b & size_mask]);
+
+		if (n > 0) {
+			/* more than one item left: no thief can reach this one */
+			return item;
+		}
+
+		/* last item: race any thieves for it */
+		if (!g_atomic_int_compare_and_exchange (&top, (gint) t, (gint) (t + 1))) {
+			item = 0;
+		}
+
+		g_atomic_int_set (&bottom, (gint) (t + 1));
+		return item;
+	}
+
+	/** Any thread. @return the oldest item, or 0 if empty or if
+	 *  another thread won the race for it.
+	 */
+	T* steal () {
+		guint t = (guint) g_atomic_int_get (&top);
+		guint b = (guint) g_atomic_int_get (&bottom);
+
+		if ((gint) (b - t) <= 0) {
+			return 0;
+		}
+
+		T* item = (T*) g_atomic_pointer_get (&buf[t & size_mask]);
+
+		if (!g_atomic_int_compare_and_exchange (&top, (gint) t, (gint) (t + 1))) {
+			return 0;
+		}
+
+		return item;
+	}
+
+	/** Any thread; the answer may be stale by the time it is used. */
+	bool empty () const {
+		guint t = (guint) g_atomic_int_get (&top);
+		guint b = (guint) g_atomic_int_get (&bottom);
+		return (gint) (b - t) <= 0;
+	}
+
+	guint capacity () const { return size; }
+
+  private:
+	gpointer* buf;
+	guint size;
+	guint size_mask;
+	mutable volatile gint top;
+	mutable volatile gint bottom;
+};
+
+} /* namespace */
+
+#endif /* __pbd_work_stealing_deque_h__ */
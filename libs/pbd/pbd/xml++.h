@@ -60,6 +60,8 @@ public:
 
 	const std::string& write_buffer() const;
 
+	static std::string write_node (const XMLNode&, int level = 0);
+
 private:
 	bool read_internal(bool validate);
 	
@@ -112,6 +114,12 @@ public:
 
 	void dump (std::ostream &, std::string p = "") const;
 
+	bool operator== (const XMLNode&) const;
+	bool operator!= (const XMLNode& other) const { return !(*this == other); }
+
+	/** @return rough number of bytes of memory used by this node and its children */
+	size_t approximate_size () const;
+
 private:
 	std::string         _name;
 	bool                _is_content;
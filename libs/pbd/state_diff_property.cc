@@ -0,0 +1,397 @@
+/*
+    Copyright (C) 2011 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <cassert>
+#include <cstdlib>
+#include <set>
+
+#include "pbd/compose.h"
+#include "pbd/convert.h"
+#include "pbd/error.h"
+#include "pbd/property_list.h"
+#include "pbd/state_diff_property.h"
+#include "pbd/stateful.h"
+
+#include "i18n.h"
+
+using namespace std;
+using namespace PBD;
+
+StateDiffProperty::StateDiffProperty (PropertyID pid, Stateful& owner)
+	: PropertyBase (pid)
+	, _owner (&owner)
+	, _old_state (0)
+	, _offset (0)
+{
+
+}
+
+StateDiffProperty::StateDiffProperty (PropertyID pid)
+	: PropertyBase (pid)
+	, _owner (0)
+	, _old_state (0)
+	, _offset (0)
+{
+
+}
+
+/** Copy only the record of changes; the copy has no owner */
+StateDiffProperty::StateDiffProperty (StateDiffProperty const & other)
+	: PropertyBase (other)
+	, _owner (0)
+	, _old_state (0)
+	, _offset (other._offset)
+{
+	for (XMLNodeConstIterator i = other._removed.begin(); i != other._removed.end(); ++i) {
+		_removed.push_back (new XMLNode (**i));
+	}
+
+	for (XMLNodeConstIterator i = other._added.begin(); i != other._added.end(); ++i) {
+		_added.push_back (new XMLNode (**i));
+	}
+}
+
+StateDiffProperty::~StateDiffProperty ()
+{
+	delete _old_state;
+	clear_diff ();
+}
+
+void
+StateDiffProperty::clear_diff ()
+{
+	for (XMLNodeIterator i = _removed.begin(); i != _removed.end(); ++i) {
+		delete *i;
+	}
+
+	for (XMLNodeIterator i = _added.begin(); i != _added.end(); ++i) {
+		delete *i;
+	}
+
+	_removed.clear ();
+	_added.clear ();
+	_offset = 0;
+}
+
+void
+StateDiffProperty::clear_changes ()
+{
+	if (!_owner) {
+		clear_diff ();
+		return;
+	}
+
+	delete _old_state;
+	_old_state = &_owner->get_state ();
+}
+
+bool
+StateDiffProperty::changed () const
+{
+	if (!_owner) {
+		return !_removed.empty() || !_added.empty();
+	}
+
+	if (!_old_state) {
+		return false;
+	}
+
+	XMLNode* current = &_owner->get_state ();
+	bool const c = (*current != *_old_state);
+	delete current;
+
+	return c;
+}
+
+void
+StateDiffProperty::invert ()
+{
+	_removed.swap (_added);
+}
+
+void
+StateDiffProperty::get_changes_as_properties (PropertyList& changes, Command *) const
+{
+	if (!_owner || !_old_state) {
+		return;
+	}
+
+	XMLNode* current = &_owner->get_state ();
+
+	XMLNodeList const & before = _old_state->children ();
+	XMLNodeList const & after = current->children ();
+
+	/* skip the children which are the same at the start... */
+
+	XMLNodeConstIterator b = before.begin ();
+	XMLNodeConstIterator a = after.begin ();
+	size_t offset = 0;
+
+	while (b != before.end() && a != after.end() && **b == **a) {
+		++b;
+		++a;
+		++offset;
+	}
+
+	/* ... and at the end */
+
+	XMLNodeConstIterator b_end = before.end ();
+	XMLNodeConstIterator a_end = after.end ();
+
+	while (b_end != b && a_end != a) {
+		XMLNodeConstIterator pb = b_end;
+		XMLNodeConstIterator pa = a_end;
+		--pb;
+		--pa;
+		if (**pb != **pa) {
+			break;
+		}
+		b_end = pb;
+		a_end = pa;
+	}
+
+	if (b != b_end || a != a_end) {
+		StateDiffProperty* p = new StateDiffProperty (property_id ());
+		p->_offset = offset;
+		for (; b != b_end; ++b) {
+			p->_removed.push_back (new XMLNode (**b));
+		}
+		for (; a != a_end; ++a) {
+			p->_added.push_back (new XMLNode (**a));
+		}
+		changes.add (p);
+	}
+
+	delete current;
+
+	/* the change is recorded, so we no longer need a copy of the whole state */
+	delete _old_state;
+	_old_state = 0;
+}
+
+/** @return a copy of a state node with our change applied to it */
+XMLNode*
+StateDiffProperty::patch (XMLNode const & state) const
+{
+	XMLNode* patched = new XMLNode (state.name ());
+
+	XMLPropertyList const & props = state.properties ();
+	for (XMLPropertyConstIterator i = props.begin(); i != props.end(); ++i) {
+		patched->add_property ((*i)->name().c_str(), (*i)->value());
+	}
+
+	XMLNodeList const & children = state.children ();
+
+	/* The usual case: the children we are to remove are where we
+	   expect them to be.
+	*/
+
+	bool in_place = true;
+
+	XMLNodeConstIterator i = children.begin ();
+	for (size_t n = 0; n < _offset && i != children.end(); ++n) {
+		++i;
+	}
+
+	XMLNodeConstIterator j = i;
+	for (XMLNodeConstIterator r = _removed.begin(); r != _removed.end(); ++r, ++j) {
+		if (j == children.end() || **j != **r) {
+			in_place = false;
+			break;
+		}
+	}
+
+	if (!in_place) {
+
+		/* Something else has changed the owner since this change was
+		   made.  If the children are identified by ID, remove the ones
+		   we are replacing wherever they are now, and put the new ones
+		   where the old ones used to be; otherwise there is nothing
+		   much better to do than to replace whatever is there.
+		*/
+
+		set<string> ids;
+		for (XMLNodeConstIterator r = _removed.begin(); r != _removed.end(); ++r) {
+			XMLProperty const * prop = (*r)->property (X_("id"));
+			if (!prop) {
+				ids.clear ();
+				break;
+			}
+			ids.insert (prop->value ());
+		}
+
+		if (!ids.empty()) {
+
+			for (XMLNodeConstIterator a = _added.begin(); a != _added.end(); ++a) {
+				XMLProperty const * prop = (*a)->property (X_("id"));
+				if (prop) {
+					ids.insert (prop->value ());
+				}
+			}
+
+			/* put the new children where the first of the ones they
+			   replace is now, or at the old offset if none of them is
+			   still there
+			*/
+
+			XMLNodeConstIterator at = children.end ();
+			for (XMLNodeConstIterator c = children.begin(); c != children.end(); ++c) {
+				XMLProperty const * prop = (*c)->property (X_("id"));
+				if (prop && ids.find (prop->value ()) != ids.end ()) {
+					at = c;
+					break;
+				}
+			}
+
+			size_t n = 0;
+			bool added = false;
+			for (XMLNodeConstIterator c = children.begin(); c != children.end(); ++c) {
+				if (!added && (c == at || (at == children.end() && n == _offset))) {
+					for (XMLNodeConstIterator a = _added.begin(); a != _added.end(); ++a) {
+						patched->add_child_copy (**a);
+					}
+					added = true;
+				}
+				XMLProperty const * prop = (*c)->property (X_("id"));
+				if (!prop || ids.find (prop->value ()) == ids.end ()) {
+					patched->add_child_copy (**c);
+					++n;
+				}
+			}
+
+			if (!added) {
+				for (XMLNodeConstIterator a = _added.begin(); a != _added.end(); ++a) {
+					patched->add_child_copy (**a);
+				}
+			}
+
+			return patched;
+		}
+
+		warning << string_compose (_("%1 has changed since this edit; undo/redo may not be accurate"), state.name ()) << endmsg;
+	}
+
+	XMLNodeConstIterator c = children.begin ();
+	for (size_t n = 0; n < _offset && c != children.end(); ++n, ++c) {
+		patched->add_child_copy (**c);
+	}
+
+	for (XMLNodeConstIterator a = _added.begin(); a != _added.end(); ++a) {
+		patched->add_child_copy (**a);
+	}
+
+	for (size_t n = 0; n < _removed.size() && c != children.end(); ++n) {
+		++c;
+	}
+
+	for (; c != children.end(); ++c) {
+		patched->add_child_copy (**c);
+	}
+
+	return patched;
+}
+
+void
+StateDiffProperty::apply_changes (PropertyBase const * p)
+{
+	if (!_owner) {
+		return;
+	}
+
+	StateDiffProperty const * change = dynamic_cast<StateDiffProperty const *> (p);
+	assert (change);
+
+	XMLNode* current = &_owner->get_state ();
+	XMLNode* patched = change->patch (*current);
+	delete current;
+
+	_owner->set_state (*patched, Stateful::current_state_version);
+	delete patched;
+}
+
+void
+StateDiffProperty::get_changes_as_xml (XMLNode* history_node) const
+{
+	XMLNode* node = history_node->add_child (capitalize (property_name()).c_str());
+	node->add_property (X_("offset"), (long) _offset);
+
+	XMLNode* removed = node->add_child (X_("Removed"));
+	for (XMLNodeConstIterator i = _removed.begin(); i != _removed.end(); ++i) {
+		removed->add_child_copy (**i);
+	}
+
+	XMLNode* added = node->add_child (X_("Added"));
+	for (XMLNodeConstIterator i = _added.begin(); i != _added.end(); ++i) {
+		added->add_child_copy (**i);
+	}
+}
+
+StateDiffProperty*
+StateDiffProperty::clone_from_xml (XMLNode const & history_node) const
+{
+	XMLNode const * node = history_node.child (capitalize (property_name()).c_str());
+	if (!node) {
+		return 0;
+	}
+
+	StateDiffProperty* p = new StateDiffProperty (property_id ());
+
+	XMLProperty const * prop = node->property (X_("offset"));
+	if (prop) {
+		p->_offset = atoi (prop->value().c_str());
+	}
+
+	XMLNode const * removed = node->child (X_("Removed"));
+	if (removed) {
+		for (XMLNodeConstIterator i = removed->children().begin(); i != removed->children().end(); ++i) {
+			p->_removed.push_back (new XMLNode (**i));
+		}
+	}
+
+	XMLNode const * added = node->child (X_("Added"));
+	if (added) {
+		for (XMLNodeConstIterator i = added->children().begin(); i != added->children().end(); ++i) {
+			p->_added.push_back (new XMLNode (**i));
+		}
+	}
+
+	return p;
+}
+
+StateDiffProperty*
+StateDiffProperty::clone () const
+{
+	return new StateDiffProperty (*this);
+}
+
+size_t
+StateDiffProperty::approximate_size () const
+{
+	size_t s = sizeof (StateDiffProperty);
+
+	for (XMLNodeConstIterator i = _removed.begin(); i != _removed.end(); ++i) {
+		s += (*i)->approximate_size () + 2 * sizeof (void*);
+	}
+
+	for (XMLNodeConstIterator i = _added.begin(); i != _added.end(); ++i) {
+		s += (*i)->approximate_size () + 2 * sizeof (void*);
+	}
+
+	return s;
+}
@@ -65,6 +65,8 @@ Stateful::add_extra_xml (XMLNode& node)
 
 	_extra_xml->remove_nodes (node.name());
 	_extra_xml->add_child_nocopy (node);
+
+	ExtraXMLChanged (); /* EMIT SIGNAL */
 }
 
 XMLNode *
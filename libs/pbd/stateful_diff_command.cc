@@ -34,6 +34,7 @@ using namespace PBD;
 
 StatefulDiffCommand::StatefulDiffCommand (boost::shared_ptr<StatefulDestructible> s)
         : _object (s)
+	, _unmanaged_object (0)
         , _changes (0)
 {
 	_changes = s->get_changes_as_properties (this);
@@ -47,23 +48,54 @@ StatefulDiffCommand::StatefulDiffCommand (boost::shared_ptr<StatefulDestructible
 
 StatefulDiffCommand::StatefulDiffCommand (boost::shared_ptr<StatefulDestructible> s, XMLNode const & n)
 	: _object (s)
+	, _unmanaged_object (0)
         , _changes (0)
+{
+	set_changes_from_xml (*s, n);
+
+        /* if the stateful object that this command refers to goes away,
+           be sure to notify owners of this command.
+        */
+
+        s->DropReferences.connect_same_thread (*this, boost::bind (&Destructible::drop_references, this));
+}
+
+/** Create a new StatefulDiffCommand by examining the changes made to a Stateful
+ *  since the last time that clear_changes was called on it.
+ *  @param s Stateful object, which is not managed by a shared_ptr.
+ */
+StatefulDiffCommand::StatefulDiffCommand (StatefulDestructible& s)
+	: _unmanaged_object (&s)
+        , _changes (0)
+{
+	_changes = s.get_changes_as_properties (this);
+
+	s.DropReferences.connect_same_thread (*this, boost::bind (&Destructible::drop_references, this));
+	s.Destroyed.connect_same_thread (*this, boost::bind (&StatefulDiffCommand::unmanaged_object_destroyed, this));
+}
+
+StatefulDiffCommand::StatefulDiffCommand (StatefulDestructible& s, XMLNode const & n)
+	: _unmanaged_object (&s)
+        , _changes (0)
+{
+	set_changes_from_xml (s, n);
+
+	s.DropReferences.connect_same_thread (*this, boost::bind (&Destructible::drop_references, this));
+	s.Destroyed.connect_same_thread (*this, boost::bind (&StatefulDiffCommand::unmanaged_object_destroyed, this));
+}
+
+void
+StatefulDiffCommand::set_changes_from_xml (StatefulDestructible const & s, XMLNode const & n)
 {
         const XMLNodeList& children (n.children());
 
         for (XMLNodeList::const_iterator i = children.begin(); i != children.end(); ++i) {
                 if ((*i)->name() == X_("Changes")) {
-                        _changes = s->property_factory (**i);
+                        _changes = s.property_factory (**i);
                 }
 	}
 
         assert (_changes != 0);
-
-        /* if the stateful object that this command refers to goes away,
-           be sure to notify owners of this command.
-        */
-
-        s->DropReferences.connect_same_thread (*this, boost::bind (&Destructible::drop_references, this));
 }
 
 StatefulDiffCommand::~StatefulDiffCommand ()
@@ -74,31 +106,46 @@ StatefulDiffCommand::~StatefulDiffCommand ()
 }
 
 void
-StatefulDiffCommand::operator() ()
+StatefulDiffCommand::unmanaged_object_destroyed ()
 {
-	boost::shared_ptr<Stateful> s (_object.lock());
-
-	if (s) {
-                s->apply_changes (*_changes);
-	}
+	_unmanaged_object = 0;
+	drop_references ();
 }
 
 void
-StatefulDiffCommand::undo ()
+StatefulDiffCommand::apply (PropertyList const & p)
 {
+	if (_unmanaged_object) {
+		_unmanaged_object->apply_changes (p);
+		return;
+	}
+
 	boost::shared_ptr<Stateful> s (_object.lock());
 
 	if (s) {
-		PropertyList p = *_changes;
-		p.invert ();
                 s->apply_changes (p);
 	}
 }
 
+void
+StatefulDiffCommand::operator() ()
+{
+	apply (*_changes);
+}
+
+void
+StatefulDiffCommand::undo ()
+{
+	PropertyList p = *_changes;
+	p.invert ();
+	apply (p);
+}
+
 XMLNode&
 StatefulDiffCommand::get_state ()
 {
-	boost::shared_ptr<Stateful> s (_object.lock());
+	boost::shared_ptr<Stateful> sp (_object.lock());
+	Stateful* s = _unmanaged_object ? _unmanaged_object : sp.get ();
 
 	if (!s) {
 		/* XXX should we throw? */
@@ -108,7 +155,7 @@ StatefulDiffCommand::get_state ()
 	XMLNode* node = new XMLNode (X_("StatefulDiffCommand"));
 
 	node->add_property ("obj-id", s->id().to_s());
-	node->add_property ("type-name", demangled_name (*s.get()));
+	node->add_property ("type-name", demangled_name (*s));
 
         XMLNode* changes = new XMLNode (X_("Changes"));
 
@@ -124,3 +171,15 @@ StatefulDiffCommand::empty () const
 {
 	return _changes->empty();
 }
+
+size_t
+StatefulDiffCommand::approximate_size () const
+{
+	size_t s = sizeof (StatefulDiffCommand) + _name.size();
+
+	for (PropertyList::const_iterator i = _changes->begin(); i != _changes->end(); ++i) {
+		s += i->second->approximate_size () + 4 * sizeof (void*);
+	}
+
+	return s;
+}
@@ -0,0 +1,195 @@
+#include <iostream>
+#include <vector>
+#include <cstdio>
+#include <pthread.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "file_manager_test.h"
+#include "pbd/file_manager.h"
+#include "pbd/compose.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (FileManagerTest);
+
+using namespace std;
+using namespace PBD;
+
+namespace {
+
+static const int n_files = 8;
+
+vector<string>
+make_files ()
+{
+	vector<string> paths;
+	for (int i = 0; i < n_files; ++i) {
+		string const p = string_compose ("/tmp/pbd_file_manager_test_%1_%2", getpid (), i);
+		FILE* f = fopen (p.c_str (), "w");
+		CPPUNIT_ASSERT (f);
+		fclose (f);
+		paths.push_back (p);
+	}
+	return paths;
+}
+
+void
+remove_files (vector<string> const & paths)
+{
+	for (vector<string>::const_iterator i = paths.begin(); i != paths.end(); ++i) {
+		unlink (i->c_str ());
+	}
+}
+
+}
+
+void
+FileManagerTest::setUp ()
+{
+	_old_max_open = FileDescriptor::manager()->max_open ();
+}
+
+void
+FileManagerTest::tearDown ()
+{
+	FileDescriptor::manager()->set_max_open (_old_max_open);
+}
+
+void
+FileManagerTest::testLRU ()
+{
+	FileManager* m = FileDescriptor::manager ();
+	vector<string> paths = make_files ();
+
+	m->set_max_open (2);
+	m->reset_stats ();
+
+	FdFileDescriptor a (paths[0], false, 0444);
+	FdFileDescriptor b (paths[1], false, 0444);
+	FdFileDescriptor c (paths[2], false, 0444);
+
+	/* open a and b, then release b before a, so that b is the oldest */
+	CPPUNIT_ASSERT (a.allocate () >= 0);
+	CPPUNIT_ASSERT (b.allocate () >= 0);
+	b.release ();
+	a.release ();
+	CPPUNIT_ASSERT_EQUAL ((uint64_t) 2, m->stats().opens);
+
+	/* opening c must close b */
+	CPPUNIT_ASSERT (c.allocate () >= 0);
+	CPPUNIT_ASSERT_EQUAL ((uint64_t) 1, m->stats().evictions);
+
+	/* so a is still open */
+	CPPUNIT_ASSERT (a.allocate () >= 0);
+	CPPUNIT_ASSERT_EQUAL ((uint64_t) 3, m->stats().opens);
+	CPPUNIT_ASSERT_EQUAL ((uint64_t) 1, m->stats().hits);
+
+	/* a second user of a does not need to do anything */
+	CPPUNIT_ASSERT (a.allocate () >= 0);
+	CPPUNIT_ASSERT_EQUAL ((uint64_t) 2, m->stats().hits);
+	a.release ();
+
+	/* both open files are allocated, so b cannot be opened */
+	CPPUNIT_ASSERT_EQUAL (-1, b.allocate ());
+	CPPUNIT_ASSERT_EQUAL ((uint64_t) 1, m->stats().failures);
+
+	/* once c is released, it is the one to go */
+	c.release ();
+	CPPUNIT_ASSERT (b.allocate () >= 0);
+	CPPUNIT_ASSERT_EQUAL ((uint64_t) 2, m->stats().evictions);
+	CPPUNIT_ASSERT_EQUAL ((uint64_t) 4, m->stats().opens);
+
+	a.release ();
+	b.release ();
+
+	remove_files (paths);
+}
+
+/* Several threads allocate and release a handful of files, more than can
+   be open at once.  Every successful allocation must return a file which
+   stays open until it is released.
+*/
+
+namespace {
+
+static const int n_threads = 4;
+static const int n_iterations = 20000;
+
+struct Shared {
+	vector<FdFileDescriptor*> files;
+	volatile gint errors;
+	volatile gint failures;
+};
+
+void*
+user (void* arg)
+{
+	Shared* s = (Shared*) arg;
+	unsigned int seed = (unsigned int) (size_t) pthread_self ();
+
+	for (int i = 0; i < n_iterations; ++i) {
+		FdFileDescriptor* f = s->files[rand_r (&seed) % s->files.size ()];
+		int const fd = f->allocate ();
+		if (fd < 0) {
+			g_atomic_int_inc (&s->failures);
+			continue;
+		}
+		if (fcntl (fd, F_GETFD) == -1) {
+			g_atomic_int_inc (&s->errors);
+		}
+		f->release ();
+	}
+
+	return 0;
+}
+
+}
+
+void
+FileManagerTest::testConcurrent ()
+{
+	FileManager* m = FileDescriptor::manager ();
+	vector<string> paths = make_files ();
+
+	/* enough for every thread to have a file allocated at once */
+	m->set_max_open (n_threads);
+	m->reset_stats ();
+
+	Shared s;
+	s.errors = 0;
+	s.failures = 0;
+	for (int i = 0; i < n_files; ++i) {
+		s.files.push_back (new FdFileDescriptor (paths[i], false, 0444));
+	}
+
+	struct timeval start;
+	gettimeofday (&start, 0);
+
+	pthread_t threads[n_threads];
+	for (int i = 0; i < n_threads; ++i) {
+		pthread_create (&threads[i], 0, user, &s);
+	}
+	for (int i = 0; i < n_threads; ++i) {
+		pthread_join (threads[i], 0);
+	}
+
+	struct timeval stop;
+	gettimeofday (&stop, 0);
+
+	FileManager::Stats const st = m->stats ();
+
+	cerr << "\nFileManager: " << n_threads * n_iterations << " allocations in "
+	     << ((stop.tv_sec - start.tv_sec) * 1000000 + (stop.tv_usec - start.tv_usec)) << " usecs; "
+	     << st.hits << " hits, " << st.opens << " opens, " << st.evictions << " evictions, "
+	     << (st.opens ? st.open_usecs / st.opens : 0) << " usecs per open\n";
+
+	CPPUNIT_ASSERT_EQUAL (0, (int) s.errors);
+	CPPUNIT_ASSERT_EQUAL (0, (int) s.failures);
+	CPPUNIT_ASSERT_EQUAL ((uint64_t) n_threads * n_iterations, st.hits + st.opens);
+	CPPUNIT_ASSERT (st.opens - st.evictions <= (uint64_t) n_threads);
+
+	for (vector<FdFileDescriptor*>::iterator i = s.files.begin(); i != s.files.end(); ++i) {
+		delete *i;
+	}
+
+	remove_files (paths);
+}
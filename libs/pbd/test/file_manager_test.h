@@ -0,0 +1,20 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class FileManagerTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (FileManagerTest);
+	CPPUNIT_TEST (testLRU);
+	CPPUNIT_TEST (testConcurrent);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void setUp ();
+	void tearDown ();
+
+	void testLRU ();
+	void testConcurrent ();
+
+private:
+	int _old_max_open;
+};
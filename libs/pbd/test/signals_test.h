@@ -5,8 +5,18 @@ class SignalsTest : public CppUnit::TestFixture
 {
 	CPPUNIT_TEST_SUITE (SignalsTest);
 	CPPUNIT_TEST (testDestruction);
+	CPPUNIT_TEST (testEmission);
+	CPPUNIT_TEST (testDisconnection);
+	CPPUNIT_TEST (testDisconnectionDuringEmission);
+	CPPUNIT_TEST (testCombiner);
+	CPPUNIT_TEST (benchmark);
 	CPPUNIT_TEST_SUITE_END ();
 
 public:
 	void testDestruction ();
+	void testEmission ();
+	void testDisconnection ();
+	void testDisconnectionDuringEmission ();
+	void testCombiner ();
+	void benchmark ();
 };
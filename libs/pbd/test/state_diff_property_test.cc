@@ -0,0 +1,162 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "pbd/property_list.h"
+#include "pbd/state_diff_property.h"
+#include "pbd/stateful.h"
+#include "pbd/xml++.h"
+
+#include "state_diff_property_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (StateDiffPropertyTest);
+
+using namespace std;
+using namespace PBD;
+
+namespace Properties {
+	PBD::PropertyDescriptor<bool> items;
+}
+
+void
+StateDiffPropertyTest::make_property_quarks ()
+{
+	Properties::items.property_id = g_quark_from_static_string ("items");
+}
+
+/** A Stateful whose state is a list of named items, like Locations */
+class ItemList : public Stateful
+{
+public:
+	ItemList ()
+		: _items_property (Properties::items.property_id, *this)
+	{
+		add_property (_items_property);
+	}
+
+	XMLNode& get_state ()
+	{
+		XMLNode* node = new XMLNode ("Items");
+		for (vector<pair<string, string> >::const_iterator i = items.begin(); i != items.end(); ++i) {
+			XMLNode* c = node->add_child ("Item");
+			c->add_property ("id", i->first);
+			c->add_property ("value", i->second);
+		}
+		return *node;
+	}
+
+	int set_state (XMLNode const & node, int)
+	{
+		items.clear ();
+		for (XMLNodeConstIterator i = node.children().begin(); i != node.children().end(); ++i) {
+			items.push_back (make_pair ((*i)->property ("id")->value(), (*i)->property ("value")->value()));
+		}
+		return 0;
+	}
+
+	vector<pair<string, string> > items;
+
+private:
+	StateDiffProperty _items_property;
+};
+
+static void
+fill (ItemList& l, int n)
+{
+	for (int i = 0; i < n; ++i) {
+		char buf[16];
+		snprintf (buf, sizeof (buf), "%d", i);
+		l.items.push_back (make_pair (string (buf), string ("v") + buf));
+	}
+}
+
+void
+StateDiffPropertyTest::testDiff ()
+{
+	ItemList l;
+	fill (l, 100);
+
+	l.clear_changes ();
+	CPPUNIT_ASSERT (!l.changed ());
+
+	l.items[50].second = "changed";
+	CPPUNIT_ASSERT (l.changed ());
+
+	PropertyList* changes = l.get_changes_as_properties (0);
+	CPPUNIT_ASSERT_EQUAL (size_t (1), changes->size ());
+
+	/* the snapshot taken by clear_changes() has been dropped */
+	CPPUNIT_ASSERT (!l.changed ());
+
+	/* only the changed item should be recorded */
+	XMLNode history ("Changes");
+	changes->begin()->second->get_changes_as_xml (&history);
+	XMLNode const * c = history.child ("Items");
+	CPPUNIT_ASSERT (c);
+	CPPUNIT_ASSERT_EQUAL (string ("50"), c->property ("offset")->value ());
+	CPPUNIT_ASSERT_EQUAL (size_t (1), c->child ("Removed")->children().size ());
+	CPPUNIT_ASSERT_EQUAL (size_t (1), c->child ("Added")->children().size ());
+
+	XMLNode& state = l.get_state ();
+	CPPUNIT_ASSERT (changes->begin()->second->approximate_size () < state.approximate_size () / 10);
+	delete &state;
+
+	delete changes;
+}
+
+void
+StateDiffPropertyTest::testUndoRedo ()
+{
+	ItemList l;
+	fill (l, 10);
+	vector<pair<string, string> > const before = l.items;
+
+	l.clear_changes ();
+	l.items.erase (l.items.begin() + 3);
+	l.items.insert (l.items.begin() + 7, make_pair (string ("new"), string ("x")));
+	vector<pair<string, string> > const after = l.items;
+
+	PropertyList* changes = l.get_changes_as_properties (0);
+
+	/* undo, as StatefulDiffCommand does it */
+	PropertyList undo = *changes;
+	undo.invert ();
+	l.apply_changes (undo);
+	CPPUNIT_ASSERT (l.items == before);
+
+	/* and redo; the change also survives a trip through XML */
+	XMLNode history ("Changes");
+	changes->begin()->second->get_changes_as_xml (&history);
+	PropertyList* redo = l.property_factory (history);
+	CPPUNIT_ASSERT_EQUAL (size_t (1), redo->size ());
+	l.apply_changes (*redo);
+	CPPUNIT_ASSERT (l.items == after);
+
+	delete redo;
+	delete changes;
+}
+
+void
+StateDiffPropertyTest::testUndoAfterOtherEdit ()
+{
+	ItemList l;
+	fill (l, 10);
+
+	l.clear_changes ();
+	l.items[5].second = "changed";
+	PropertyList* changes = l.get_changes_as_properties (0);
+
+	/* something else inserts an item before the one we changed */
+	l.items.insert (l.items.begin(), make_pair (string ("other"), string ("y")));
+
+	PropertyList undo = *changes;
+	undo.invert ();
+	l.apply_changes (undo);
+
+	CPPUNIT_ASSERT_EQUAL (size_t (11), l.items.size ());
+	CPPUNIT_ASSERT_EQUAL (string ("other"), l.items[0].first);
+	CPPUNIT_ASSERT_EQUAL (string ("5"), l.items[6].first);
+	CPPUNIT_ASSERT_EQUAL (string ("v5"), l.items[6].second);
+
+	delete changes;
+}
@@ -0,0 +1,18 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class StateDiffPropertyTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (StateDiffPropertyTest);
+	CPPUNIT_TEST (testDiff);
+	CPPUNIT_TEST (testUndoRedo);
+	CPPUNIT_TEST (testUndoAfterOtherEdit);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void testDiff ();
+	void testUndoRedo ();
+	void testUndoAfterOtherEdit ();
+
+	static void make_property_quarks ();
+};
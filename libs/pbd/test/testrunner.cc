@@ -4,12 +4,16 @@
 #include <cppunit/TestResultCollector.h>
 #include <cppunit/TestRunner.h>
 #include <cppunit/BriefTestProgressListener.h>
+#include "pbd/id.h"
 #include "scalar_properties.h"
+#include "state_diff_property_test.h"
 
 int
 main ()
 {
+	PBD::ID::init ();
 	ScalarPropertiesTest::make_property_quarks ();
+	StateDiffPropertyTest::make_property_quarks ();
 	
 	CppUnit::TestResult testresult;
 
@@ -0,0 +1,267 @@
+#include <iostream>
+#include <vector>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <algorithm>
+#include "work_stealing_deque_test.h"
+#include "pbd/work_stealing_deque.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (WorkStealingDequeTest);
+
+using namespace std;
+using namespace PBD;
+
+void
+WorkStealingDequeTest::testOwner ()
+{
+	WorkStealingDeque<int> d (4);
+	int items[5];
+
+	CPPUNIT_ASSERT (d.empty ());
+	CPPUNIT_ASSERT (d.pop () == 0);
+	CPPUNIT_ASSERT (d.steal () == 0);
+
+	for (int i = 0; i < 4; ++i) {
+		CPPUNIT_ASSERT (d.push (&items[i]));
+	}
+
+	/* full */
+	CPPUNIT_ASSERT (!d.push (&items[4]));
+
+	/* owner is LIFO, thieves are FIFO */
+	CPPUNIT_ASSERT (d.pop () == &items[3]);
+	CPPUNIT_ASSERT (d.steal () == &items[0]);
+	CPPUNIT_ASSERT (d.pop () == &items[2]);
+	CPPUNIT_ASSERT (d.pop () == &items[1]);
+	CPPUNIT_ASSERT (d.pop () == 0);
+	CPPUNIT_ASSERT (d.empty ());
+
+	/* indices keep running; make sure they wrap the buffer */
+	for (int n = 0; n < 100; ++n) {
+		CPPUNIT_ASSERT (d.push (&items[n % 5]));
+		CPPUNIT_ASSERT (d.steal () == &items[n % 5]);
+	}
+}
+
+/* Concurrent test: one owner pushes and pops, several thieves steal.
+   Every item must be taken exactly once.
+*/
+
+namespace {
+
+static const int n_items = 200000;
+
+struct Shared {
+	WorkStealingDeque<int>* deque;
+	int* items;
+	volatile gint taken[n_items];
+	volatile gint done;
+};
+
+void*
+thief (void* arg)
+{
+	Shared* s = (Shared*) arg;
+
+	while (!g_atomic_int_get (&s->done)) {
+		int* i;
+		if ((i = s->deque->steal ()) != 0) {
+			g_atomic_int_inc (&s->taken[i - s->items]);
+		}
+	}
+
+	return 0;
+}
+
+}
+
+void
+WorkStealingDequeTest::testConcurrentSteal ()
+{
+	Shared* s = new Shared;
+	s->deque = new WorkStealingDeque<int> (64);
+	s->items = new int[n_items];
+	s->done = 0;
+
+	for (int n = 0; n < n_items; ++n) {
+		s->taken[n] = 0;
+	}
+
+	pthread_t thieves[3];
+	for (int n = 0; n < 3; ++n) {
+		pthread_create (&thieves[n], 0, thief, s);
+	}
+
+	int next = 0;
+	while (next < n_items) {
+		/* push a few, then pop one, so that the owner and the thieves
+		   regularly race for the last item.
+		*/
+		for (int n = 0; n < 3 && next < n_items; ++n) {
+			if (s->deque->push (&s->items[next])) {
+				++next;
+			}
+		}
+
+		int* i;
+		if ((i = s->deque->pop ()) != 0) {
+			g_atomic_int_inc (&s->taken[i - s->items]);
+		}
+	}
+
+	int* i;
+	while ((i = s->deque->pop ()) != 0) {
+		g_atomic_int_inc (&s->taken[i - s->items]);
+	}
+
+	g_atomic_int_set (&s->done, 1);
+
+	for (int n = 0; n < 3; ++n) {
+		pthread_join (thieves[n], 0);
+	}
+
+	for (int n = 0; n < n_items; ++n) {
+		CPPUNIT_ASSERT_EQUAL (1, (int) s->taken[n]);
+	}
+
+	delete [] s->items;
+	delete s->deque;
+	delete s;
+}
+
+/* Benchmark: a fork-join "cycle" of independent nodes, like a
+   session's tracks feeding the master bus, run by 1..N threads that
+   each own a deque and steal from the others.  Prints the mean cycle
+   time per thread count.
+*/
+
+namespace {
+
+static const int n_nodes = 256;
+static const int n_cycles = 200;
+
+struct Node {
+	float state;
+	void process () {
+		/* a few microseconds of DSP-like work */
+		for (int n = 0; n < 2000; ++n) {
+			state = state * 0.999f + 0.001f;
+		}
+	}
+};
+
+struct Pool {
+	vector<WorkStealingDeque<Node>*> deques;
+	Node nodes[n_nodes];
+	volatile gint remaining;
+	volatile gint cycle;
+	volatile gint quit;
+};
+
+struct Worker {
+	Pool* pool;
+	uint32_t id;
+};
+
+void
+run_cycle (Pool* p, uint32_t id)
+{
+	uint32_t const n = p->deques.size ();
+
+	while (g_atomic_int_get (&p->remaining) > 0) {
+		Node* node = p->deques[id]->pop ();
+		for (uint32_t i = 1; !node && i < n; ++i) {
+			node = p->deques[(id + i) % n]->steal ();
+		}
+		if (node) {
+			node->process ();
+			g_atomic_int_add (&p->remaining, -1);
+		}
+	}
+}
+
+void*
+bench_thread (void* arg)
+{
+	Worker* w = (Worker*) arg;
+	gint seen = 0;
+
+	while (!g_atomic_int_get (&w->pool->quit)) {
+		gint c = g_atomic_int_get (&w->pool->cycle);
+		if (c != seen) {
+			seen = c;
+			run_cycle (w->pool, w->id);
+		}
+	}
+
+	return 0;
+}
+
+double
+bench (uint32_t n_threads)
+{
+	Pool p;
+	vector<pthread_t> threads (n_threads);
+	vector<Worker> workers (n_threads);
+
+	for (uint32_t n = 0; n < n_threads; ++n) {
+		p.deques.push_back (new WorkStealingDeque<Node> (n_nodes));
+	}
+
+	for (int n = 0; n < n_nodes; ++n) {
+		p.nodes[n].state = 0;
+	}
+
+	p.remaining = 0;
+	p.cycle = 0;
+	p.quit = 0;
+
+	for (uint32_t n = 1; n < n_threads; ++n) {
+		workers[n].pool = &p;
+		workers[n].id = n;
+		pthread_create (&threads[n], 0, bench_thread, &workers[n]);
+	}
+
+	struct timeval start, end;
+	gettimeofday (&start, 0);
+
+	for (int c = 0; c < n_cycles; ++c) {
+		/* like Graph::prep(): the cycle starts on one thread, which
+		   makes every initial node ready in its own queue.
+		*/
+		g_atomic_int_set (&p.remaining, n_nodes);
+		for (int n = 0; n < n_nodes; ++n) {
+			p.deques[0]->push (&p.nodes[n]);
+		}
+		g_atomic_int_inc (&p.cycle);
+		run_cycle (&p, 0);
+	}
+
+	gettimeofday (&end, 0);
+
+	g_atomic_int_set (&p.quit, 1);
+	for (uint32_t n = 1; n < n_threads; ++n) {
+		pthread_join (threads[n], 0);
+	}
+
+	for (uint32_t n = 0; n < n_threads; ++n) {
+		delete p.deques[n];
+	}
+
+	return ((end.tv_sec - start.tv_sec) * 1e6 + (end.tv_usec - start.tv_usec)) / n_cycles;
+}
+
+}
+
+void
+WorkStealingDequeTest::testScaling ()
+{
+	long ncpu = sysconf (_SC_NPROCESSORS_ONLN);
+
+	cout << "\n";
+	for (uint32_t t = 1; t <= (uint32_t) max (1L, ncpu); t *= 2) {
+		cout << "work stealing: " << t << " thread(s): " << bench (t) << " usecs per cycle\n";
+	}
+}
@@ -151,6 +151,18 @@ XMLNode &UndoTransaction::get_state()
     return *node;
 }
 
+size_t
+UndoTransaction::approximate_size () const
+{
+	size_t s = sizeof (UndoTransaction) + _name.size();
+
+	for (list<Command*>::const_iterator i = actions.begin(); i != actions.end(); ++i) {
+		s += (*i)->approximate_size () + 2 * sizeof (void*);
+	}
+
+	return s;
+}
+
 class UndoRedoSignaller {
 public:
     UndoRedoSignaller (UndoHistory& uh) 
@@ -196,6 +208,22 @@ UndoHistory::set_depth (uint32_t d)
 	}
 }
 
+size_t
+UndoHistory::approximate_size () const
+{
+	size_t s = 0;
+
+	for (std::list<UndoTransaction*>::const_iterator i = UndoList.begin(); i != UndoList.end(); ++i) {
+		s += (*i)->approximate_size ();
+	}
+
+	for (std::list<UndoTransaction*>::const_iterator i = RedoList.begin(); i != RedoList.end(); ++i) {
+		s += (*i)->approximate_size ();
+	}
+
+	return s;
+}
+
 void
 UndoHistory::add (UndoTransaction* const ut)
 {
@@ -191,6 +191,33 @@ XMLTree::write_buffer() const
 	return retval;
 }
 
+/** @return a node and its children as UTF-8 XML text, with no XML declaration and
+ *  no trailing newline, indented as if the node were at the given depth in a document.
+ */
+string
+XMLTree::write_node (const XMLNode& n, int level)
+{
+	xmlDocPtr doc;
+	xmlBufferPtr buf;
+
+	doc = xmlNewDoc((xmlChar*) XML_VERSION);
+	/* without this, non-ASCII characters in attributes are written as character references */
+	doc->encoding = xmlStrdup((xmlChar*) "UTF-8");
+	writenode(doc, const_cast<XMLNode*> (&n), doc->children, 1);
+
+	buf = xmlBufferCreate();
+	xmlOutputBufferPtr out = xmlOutputBufferCreateBuffer(buf, 0);
+	xmlNodeDumpOutput(out, doc, xmlDocGetRootElement(doc), level, 1, "UTF-8");
+	xmlOutputBufferClose(out);
+
+	string retval ((const char*) xmlBufferContent(buf), xmlBufferLength(buf));
+
+	xmlBufferFree(buf);
+	xmlFreeDoc(doc);
+
+	return retval;
+}
+
 XMLNode::XMLNode(const string& n)
 	: _name(n)
 	, _is_content(false)
@@ -593,6 +620,54 @@ static XMLSharedNodeList* find_impl(xmlXPathContext* ctxt, const string& xpath)
 	return nodes;
 }
 
+/** @return true if the other node has the same name, content, properties
+ *  (in the same order) and children as this one.
+ */
+bool
+XMLNode::operator== (const XMLNode& other) const
+{
+	if (_name != other._name || _content != other._content) {
+		return false;
+	}
+
+	if (_proplist.size() != other._proplist.size() || _children.size() != other._children.size()) {
+		return false;
+	}
+
+	XMLPropertyConstIterator j = other._proplist.begin();
+	for (XMLPropertyConstIterator i = _proplist.begin(); i != _proplist.end(); ++i, ++j) {
+		if ((*i)->name() != (*j)->name() || (*i)->value() != (*j)->value()) {
+			return false;
+		}
+	}
+
+	XMLNodeConstIterator m = other._children.begin();
+	for (XMLNodeConstIterator n = _children.begin(); n != _children.end(); ++n, ++m) {
+		if (**n != **m) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+size_t
+XMLNode::approximate_size () const
+{
+	size_t s = sizeof (XMLNode) + _name.size() + _content.size();
+
+	for (XMLPropertyConstIterator i = _proplist.begin(); i != _proplist.end(); ++i) {
+		/* the property, and its entries in _proplist and _propmap */
+		s += sizeof (XMLProperty) + (*i)->name().size() * 2 + (*i)->value().size() + 8 * sizeof (void*);
+	}
+
+	for (XMLNodeConstIterator i = _children.begin(); i != _children.end(); ++i) {
+		s += (*i)->approximate_size () + 2 * sizeof (void*);
+	}
+
+	return s;
+}
+
 /** Dump a node, its properties and children to a stream */
 void
 XMLNode::dump (ostream& s, string p) const